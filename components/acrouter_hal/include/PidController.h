@@ -0,0 +1,115 @@
+/**
+ * @file PidController.h
+ * @brief Positional PI/PID engine for the regulating router modes
+ *
+ * Used by RouterController for AUTO, ECO and GRID_LIMIT when their engine is PI
+ * or PID (ControlEngine::P keeps the legacy incremental step, error/control_gain
+ * per update).
+ *
+ *   u = Kp*e + I + D,   I += Ki*e*dt,   D = -Kd * d(measurement)/dt (filtered)
+ *
+ * - Derivative on measurement: a setpoint change (GRID_LIMIT limit edit) never
+ *   kicks the output, and the derivative is low-pass filtered so 5 Hz sensor
+ *   noise does not reach the load.
+ * - Anti-windup, two layers: the integrator is clamped so u never leaves
+ *   [out_min, out_max], and track() back-calculates it to the output the plant
+ *   actually got (cascade saturation, relay debounce, ECO's no-increase rule).
+ * - Bumpless start: the first step after reset() seeds I so u equals the
+ *   current output — enabling a loop or switching modes never jumps the load.
+ * - Deadband: |e| <= deadband is treated as e = 0 (hold), so the loop does not
+ *   hunt inside the balance threshold.
+ *
+ * Units are the caller's: AUTO error in W and output in W (cascade power), ECO
+ * error in W and output in %, GRID_LIMIT error in A and output in %. Not
+ * thread-safe — owned by the control task.
+ */
+
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Controller engine per regulating mode
+ */
+enum class ControlEngine : uint8_t {
+    P = 0,          ///< Legacy incremental step (level += error / control_gain)
+    PI,             ///< Positional PI with anti-windup
+    PID             ///< PI + derivative on measurement
+};
+
+/**
+ * @brief Engine and gains of one control loop
+ */
+struct PidGains {
+    ControlEngine engine;   ///< Engine selection
+    float kp;               ///< Proportional gain (output unit per error unit)
+    float ki;               ///< Integral gain (per error unit per second)
+    float kd;               ///< Derivative gain (output unit * s per measurement unit)
+
+    PidGains() : engine(ControlEngine::P), kp(0.0f), ki(0.0f), kd(0.0f) {}
+    PidGains(ControlEngine e, float p, float i, float d) : engine(e), kp(p), ki(i), kd(d) {}
+};
+
+/**
+ * @brief PI/PID controller (positional form)
+ */
+class PidController {
+public:
+    PidController();
+
+    /**
+     * @brief Set engine and gains (resets the loop; next step is bumpless)
+     */
+    void setGains(const PidGains& gains);
+
+    /**
+     * @brief Get engine and gains
+     */
+    const PidGains& getGains() const { return m_gains; }
+
+    /**
+     * @brief Forget the loop state; the next step() starts bumplessly
+     */
+    void reset() { m_primed = false; }
+
+    /**
+     * @brief Run one control step
+     *
+     * @param setpoint    Target of the measurement
+     * @param measurement Measured value (same unit as setpoint)
+     * @param output_now  Output currently applied (seeds a bumpless start)
+     * @param dt_s        Seconds since the previous step
+     * @param out_min     Lower output limit
+     * @param out_max     Upper output limit
+     * @param deadband    |setpoint - measurement| at or below this counts as 0
+     * @return Commanded output, within [out_min, out_max]
+     */
+    float step(float setpoint, float measurement, float output_now, float dt_s,
+               float out_min, float out_max, float deadband);
+
+    /**
+     * @brief Back-calculate the integrator to the output actually applied
+     *
+     * Call after actuation when the plant may not have taken the commanded
+     * output. A no-op when applied equals the last command.
+     */
+    void track(float applied);
+
+    /** @brief Last P / I / D contributions (diagnostics) */
+    float lastP() const { return m_p; }
+    float lastI() const { return m_i; }
+    float lastD() const { return m_d; }
+
+private:
+    PidGains m_gains;
+    bool  m_primed;         ///< false until the first step after reset()
+    float m_i;              ///< Integrator (output units)
+    float m_p;              ///< Last proportional term
+    float m_d;              ///< Last derivative term
+    float m_dmeas;          ///< Filtered d(measurement)/dt
+    float m_prev_meas;      ///< Measurement at the previous step
+    float m_u;              ///< Last commanded output
+};
+
+#endif // PID_CONTROLLER_H
@@ -0,0 +1,105 @@
+/**
+ * @file PlantEstimator.h
+ * @brief Online plant-gain estimate of one AUTO cascade priority level
+ *
+ * The AUTO cascade places watts through a model: nominal power (hw-dimmer-power
+ * / relay power) through the output curve. When the model is off — a second
+ * heater on the same output, a wrong nameplate, element ageing — every move
+ * lands short or long, and the loop gain is off by the same factor.
+ *
+ * Each cycle RouterController pushes the level's modelled power (W, after
+ * actuation) and feeds the second difference of the grid power:
+ *
+ *   d2P_grid(k) = b1*d2u(k-1) + b2*d2u(k-2) + b3*d2u(k-3) + (other levels) + noise
+ *
+ * The three taps absorb the measurement lag (200 ms module windows that are not
+ * phase-aligned with the control cycle, ESP-NOW latency), so no dead time has to
+ * be known. The plant gain — observed W per modelled W — is b1 + b2 + b3.
+ * Second rather than first differences cancel slow drift (PV ramps under a cloud
+ * edge), which the loop follows and would otherwise correlate with our moves.
+ *
+ * - Recursive least squares, updated only on cycles with excitation (a move of
+ *   the level inside the tap window), with forgetting on those cycles only, so a
+ *   quiet plant neither drifts nor winds the covariance up.
+ * - Cycles disturbed by a load switching are corrected (the step's echo in the
+ *   next second difference) or rejected by the caller, which also only counts
+ *   moves well above the noise-driven ones of a PI loop.
+ *
+ * W per % of the level follows as gain * nominal / 100. The gain scales the
+ * level's model, not the curve shape: a per-dimmer correction of the curve is
+ * not identifiable from the grid meter (dimmers of a level move together), so
+ * each dimmer keeps its configured dimmer_curve_t. Not thread-safe — owned
+ * by the control task, under RouterController's map lock.
+ */
+
+#ifndef PLANT_ESTIMATOR_H
+#define PLANT_ESTIMATOR_H
+
+#include <stdint.h>
+
+class PlantEstimator {
+public:
+    static constexpr uint8_t TAPS = 3;
+
+    PlantEstimator();
+
+    /**
+     * @brief Forget everything: gain 1 (model trusted), history cleared
+     */
+    void reset();
+
+    /**
+     * @brief Restore a persisted estimate (history cleared, moderate confidence)
+     */
+    void restore(const float taps[TAPS], uint16_t samples);
+
+    /**
+     * @brief Forget the move history only (control gap, mode change)
+     */
+    void clearHistory() { m_hist_n = 0; }
+
+    /**
+     * @brief Record the level's modelled power after this cycle's actuation (W)
+     */
+    void push(float model_w);
+
+    /**
+     * @brief Regressor of the current cycle: the last TAPS move changes, newest first
+     * @return false until TAPS + 2 pushes since the last clearHistory()
+     */
+    bool regressor(float phi[TAPS]) const;
+
+    /**
+     * @brief Predicted grid change from @p phi (W)
+     */
+    float predict(const float phi[TAPS]) const;
+
+    /**
+     * @brief One RLS step on the shared residual of this cycle
+     *
+     * @param phi  This level's regressor (regressor())
+     * @param e    This level's share of observed minus predicted grid change (W)
+     */
+    void update(const float phi[TAPS], float e);
+
+    /** @brief Observed W per modelled W, clamped to [GAIN_MIN, GAIN_MAX] */
+    float gain() const;
+
+    /** @brief Accepted (excited) updates since reset, saturating */
+    uint16_t samples() const { return m_samples; }
+
+    /** @brief Tap weights (persistence) */
+    const float* taps() const { return m_theta; }
+
+    static constexpr float GAIN_MIN = 0.25f;
+    static constexpr float GAIN_MAX = 4.0f;
+
+private:
+    float    m_theta[TAPS];         ///< Tap weights (W grid per W modelled)
+    float    m_p[TAPS][TAPS];       ///< Covariance (normalised units)
+    float    m_hist[TAPS + 2];      ///< Modelled power, newest first (W)
+    uint8_t  m_hist_n;              ///< Valid entries in m_hist
+    uint16_t m_samples;
+};
+
+#endif // PLANT_ESTIMATOR_H
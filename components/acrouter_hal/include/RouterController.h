@@ -6,11 +6,38 @@
  * excess solar energy to a load (heater) instead of exporting to the grid.
  *
  * @section Algorithm
- * The controller uses a proportional algorithm to maintain P_grid close to 0:
+ * The controller maintains P_grid close to 0:
  * - P_grid < 0 (EXPORT): Increase dimmer (redirect to load)
  * - P_grid > 0 (IMPORT): Decrease dimmer (reduce load)
  * - P_grid ≈ 0 (BALANCE): Hold current level
  *
+ * AUTO drives the multi-device cascade in watts: the controller asks for a
+ * total cascade power, which is placed priority by priority (same priority in
+ * proportion to nominal power, relays whole) and turned into each dimmer's
+ * level through its curve model (dimmer_curve.h) only at the output.
+ *
+ * Optionally (setFeedForward()), AUTO also predicts the balancing heater power
+ * from the load and solar channels and applies changes of that prediction in
+ * the same cycle, ahead of the feedback; without both channels, or while the
+ * prediction disagrees with the grid reading, it runs feedback-only.
+ *
+ * The power model of each priority level can be tuned online (setPlantTuning()):
+ * the observed grid response to the cascade's own moves gives a plant gain per
+ * level (PlantEstimator.h), persisted in NVS; in ADAPT the level's nominal power
+ * is scaled by it, which schedules the effective loop gain of every engine.
+ *
+ * Every merged frame carries the acquisition time of each channel (sensor_hub).
+ * The controller measures sensor-to-actuation latency from it (getControlLatency())
+ * and, in AUTO, compensates the dead time: cascade moves made after the grid
+ * reading's averaging window opened are only partly in that reading, so the
+ * unseen part is added to it (setDeadTimeCompensation()) instead of being
+ * corrected a second time.
+ *
+ * AUTO, ECO and GRID_LIMIT each select an engine (PidController.h): the legacy
+ * incremental step (P: level += error / control_gain per update) or a positional
+ * PI / PID with anti-windup and derivative-on-measurement, with per-mode gains
+ * (setPidGains(), persisted by ConfigManager).
+ *
  * @section MinimalConfig
  * Minimum required sensors for Solar Router mode:
  * - 1x Dimmer channel (output)
@@ -34,6 +61,8 @@
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "acrouter_events.h"
+#include "PidController.h"
+#include "PlantEstimator.h"
 
 // Use new dimmer manager (pure C API)
 extern "C" {
@@ -60,6 +89,44 @@ namespace RouterConfig {
 
     // Update rate
     constexpr uint32_t UPDATE_INTERVAL_MS = 200;        // Sensor Hub merged-update interval (5 Hz)
+
+    // PI/PID engine (opt-in per mode, default engine is P; gains in PidController.h units)
+    constexpr float PID_MAX_GAIN = 10.0f;               // Sanity ceiling for kp/ki/kd
+    constexpr float PID_MAX_GAP_S = 2.0f;               // Longer gap between updates → bumpless restart
+    constexpr float PID_MIN_DT_S = 0.02f;               // dt floor (back-to-back merges)
+    constexpr uint32_t P_STEP_MAX_FRAMES = 8;           // Cap on source frames one P step stands for
+    constexpr float AUTO_KP = 0.05f;                    // W/W  (AUTO output is cascade watts)
+    constexpr float AUTO_KI = 5.0f;                     // W/(W*s)
+    constexpr float AUTO_KD = 0.02f;                    // W*s/W
+    constexpr float ECO_KP = 0.01f;                     // %/W
+    constexpr float ECO_KI = 0.06f;                     // %/(W*s)
+    constexpr float ECO_KD = 0.002f;                    // %*s/W
+    constexpr float GRID_LIMIT_KP = 2.0f;               // %/A
+    constexpr float GRID_LIMIT_KI = 10.0f;              // %/(A*s)  (legacy step ≈ 2.5)
+    constexpr float GRID_LIMIT_KD = 0.1f;               // %*s/A
+
+    // AUTO cascade (watts domain)
+    constexpr float CASCADE_MIN_STEP_W = 0.5f;          // W, smaller PI moves are held
+    constexpr float CASCADE_RELAY_MARGIN_W = 50.0f;     // W, surplus beyond a relay's power to switch it ON
+
+    // AUTO feed-forward from the load + solar channels
+    constexpr float FF_DEADBAND_W = 25.0f;              // W, smaller predicted changes are left to feedback
+    constexpr float FF_MAX_ERROR_W = 150.0f;            // W, prediction error above which FF suspends
+    constexpr float FF_ERROR_ALPHA = 0.05f;             // EWMA weight of the prediction error (~4 s)
+
+    // AUTO plant-gain estimation (PlantEstimator.h), per priority level
+    constexpr float PLANT_MIN_EXCITATION_W = 100.0f;     // W, smaller moves do not update the estimate
+    constexpr float PLANT_OUTLIER_W = 40.0f;            // W, residual beyond this plus PLANT_OUTLIER_REL
+    constexpr float PLANT_OUTLIER_REL = 0.5f;            //    of the prediction is a disturbance, not plant
+    constexpr uint16_t PLANT_MIN_SAMPLES = 10;          // Updates before an estimate is applied
+    constexpr float PLANT_APPLY_ALPHA = 0.1f;           // Applied gain follows the estimate (per update)
+    constexpr float PLANT_SAVE_DELTA = 0.05f;           // Relative change that makes an estimate worth saving
+    constexpr uint32_t PLANT_SAVE_INTERVAL_S = 600;     // Min seconds between NVS saves (flash wear)
+
+    // Measurement age and dead time
+    constexpr uint32_t MEAS_WINDOW_MS = 200;            // Averaging window a source frame covers (5 Hz modules)
+    constexpr uint8_t DEADTIME_MAX_MOVES = 4;           // AUTO moves tracked until fully in the grid reading
+    constexpr uint16_t LATENCY_SAMPLES = 128;           // Sensor-to-actuation samples behind p50/p99
 }
 
 /**
@@ -77,6 +144,25 @@ enum class RouterMode : uint8_t {
     // SCHEDULE     ///< Phase 2: Time-based control
 };
 
+/**
+ * @brief Regulating modes with their own controller engine and gains
+ */
+enum class PidLoop : uint8_t {
+    AUTO = 0,       ///< P_grid → 0 (W)
+    ECO,            ///< P_grid <= 0, reduce-only (W)
+    GRID_LIMIT,     ///< |I_grid| <= limit (A)
+    COUNT
+};
+
+/**
+ * @brief AUTO plant-gain tuning
+ */
+enum class PlantTuning : uint8_t {
+    OFF = 0,        ///< No estimation; the cascade trusts nominal power
+    LEARN,          ///< Estimate and report, cascade still uses nominal power
+    ADAPT           ///< Estimate and scale each level's power model by it
+};
+
 /**
  * @brief Router operating state
  */
@@ -105,10 +191,12 @@ struct DeviceRef {
     uint8_t id;             ///< Device ID
     uint16_t power_w;       ///< Nominal power in watts
     float target_level;     ///< Target level (0.0-100.0 for dimmers, 0/100 for relays)
+    dimmer_curve_t curve;   ///< Level → power model of the output (dimmers only)
 
-    DeviceRef() : type(DeviceType::DIMMER), id(0), power_w(0), target_level(0.0f) {}
+    DeviceRef() : type(DeviceType::DIMMER), id(0), power_w(0), target_level(0.0f),
+                  curve(DIMMER_CURVE_RMS) {}
     DeviceRef(DeviceType t, uint8_t device_id, uint16_t pwr)
-        : type(t), id(device_id), power_w(pwr), target_level(0.0f) {}
+        : type(t), id(device_id), power_w(pwr), target_level(0.0f), curve(DIMMER_CURVE_RMS) {}
 };
 
 /**
@@ -121,9 +209,37 @@ struct PriorityLevel {
     uint8_t device_count;               ///< Number of devices at this priority
     uint8_t device_capacity;            ///< Allocated capacity
     uint32_t total_power_w;             ///< Sum of all nominal powers
+    float plant_gain;                   ///< Applied observed-W per modelled-W (1 = nominal)
+    PlantEstimator plant;               ///< Online estimate behind plant_gain
 
     PriorityLevel() : priority(255), device_type(DeviceType::DIMMER), devices(nullptr),
-                      device_count(0), device_capacity(0), total_power_w(0) {}
+                      device_count(0), device_capacity(0), total_power_w(0), plant_gain(1.0f) {}
+};
+
+/**
+ * @brief Plant-gain estimate of one priority level (getPlantEstimates())
+ */
+struct PlantGainInfo {
+    uint8_t priority;                   ///< Priority value
+    DeviceType type;                    ///< Device type of the level
+    uint32_t nominal_w;                 ///< Sum of nominal powers (W)
+    float gain;                         ///< Estimated observed W per modelled W
+    float w_per_pct;                    ///< Estimated W per % of the level (gain * nominal / 100)
+    float applied_gain;                 ///< Gain the cascade currently uses
+    uint16_t samples;                   ///< Excited updates behind the estimate
+};
+
+/**
+ * @brief Sensor-to-actuation latency and dead-time compensation (getControlLatency())
+ */
+struct ControlLatency {
+    uint32_t samples;                   ///< Actuations measured since boot
+    float p50_ms;                       ///< Median acquisition-to-output latency (last LATENCY_SAMPLES)
+    float p99_ms;                       ///< 99th percentile (ms)
+    float max_ms;                       ///< Maximum since boot (ms)
+    float age_ms;                       ///< Age of the regulated reading at the last update (ms)
+    float pending_w;                    ///< AUTO: own moves not yet in the grid reading (W)
+    bool deadtime_comp;                 ///< Dead-time compensation enabled
 };
 
 /**
@@ -139,6 +255,9 @@ struct RouterStatus {
     float power_load;                   ///< Current load power (W) - from CURRENT_LOAD sensor
     float control_gain;                 ///< Current control gain
     float balance_threshold;            ///< Current balance threshold (W)
+    bool ff_active;                     ///< AUTO feed-forward in use this cycle
+    float ff_power_w;                   ///< Last feed-forward step applied (W)
+    float ff_error_w;                   ///< Prediction error: mean |P_grid - (P_load - P_solar model)| (W)
     uint32_t last_update_ms;            ///< Timestamp of last update
     bool valid;                         ///< True if status is valid
 
@@ -152,6 +271,9 @@ struct RouterStatus {
         power_load(0.0f),
         control_gain(RouterConfig::DEFAULT_CONTROL_GAIN),
         balance_threshold(RouterConfig::DEFAULT_BALANCE_THRESHOLD),
+        ff_active(false),
+        ff_power_w(0.0f),
+        ff_error_w(0.0f),
         last_update_ms(0),
         valid(false)
     {}
@@ -177,8 +299,8 @@ struct RouterStatus {
  * router.begin(0);  // Use dimmer ID 0
  * router.setMode(RouterMode::AUTO);
  *
- * // Measurements arrive via the event bus (Sensor Hub -> ACROUTER_EVENT_MERGED_UPDATE);
- * // RouterController subscribes and calls update(const acrouter_measurements_t&).
+ * // Measurements arrive via the measurement ring (sources -> Sensor Hub, drained by
+ * // the control task) and update(const acrouter_measurements_t&) runs per merge.
  * @endcode
  */
 class RouterController {
@@ -208,11 +330,11 @@ public:
     void update(const acrouter_measurements_t& measurements);
 
     /**
-     * @brief Subscribe to event bus for measurement updates
+     * @brief Start the control task and attach it to the measurement ring
      *
-     * Registers event handler for ACROUTER_EVENT_POWER_UPDATE.
-     * Call after esp_event_loop_create_default() (done by WiFiManager).
-     * When Sensor Hub is active, subscribes to ACROUTER_EVENT_MERGED_UPDATE instead.
+     * Call after sensor_hub_init(). If the task cannot be started (or the ring
+     * already has a consumer), subscribes to ACROUTER_EVENT_MERGED_UPDATE and
+     * runs update() inline in the event-loop task instead.
      *
      * @return ESP_OK on success
      */
@@ -309,6 +431,78 @@ public:
      */
     float getGridCurrentLimit() const { return m_grid_current_limit_a; }
 
+    /**
+     * @brief Enable/disable AUTO feed-forward from the load and solar channels
+     *
+     * Needs live load and solar power; falls back to feedback-only without them.
+     */
+    void setFeedForward(bool enabled);
+
+    /**
+     * @brief Check whether AUTO feed-forward is enabled
+     */
+    bool isFeedForwardEnabled() const { return m_ff_enabled; }
+
+    /**
+     * @brief Set AUTO plant-gain tuning (OFF / LEARN / ADAPT)
+     */
+    void setPlantTuning(PlantTuning mode);
+
+    /**
+     * @brief Get AUTO plant-gain tuning
+     */
+    PlantTuning getPlantTuning() const { return m_plant_mode; }
+
+    /**
+     * @brief Forget every plant-gain estimate (RAM and NVS); levels back to nominal
+     */
+    void resetPlantEstimates();
+
+    /**
+     * @brief Plant-gain estimates of the active priority levels
+     * @param out Array to fill
+     * @param max Capacity of @p out
+     * @return Number of entries written
+     */
+    uint8_t getPlantEstimates(PlantGainInfo* out, uint8_t max) const;
+
+    /**
+     * @brief Enable/disable AUTO dead-time compensation
+     *
+     * Needs acquisition timestamps (control task path); without them AUTO runs
+     * uncompensated.
+     */
+    void setDeadTimeCompensation(bool enabled);
+
+    /**
+     * @brief Check whether AUTO dead-time compensation is enabled
+     */
+    bool isDeadTimeCompensationEnabled() const { return m_dtc_enabled; }
+
+    /**
+     * @brief Sensor-to-actuation latency percentiles and dead-time state
+     */
+    void getControlLatency(ControlLatency& out) const;
+
+    /**
+     * @brief Set the controller engine and gains of one regulating mode
+     *
+     * ControlEngine::P keeps the legacy step (gains ignored, control_gain /
+     * GRID_LIMIT_GAIN apply). Gains are clamped to 0..PID_MAX_GAIN. Takes effect
+     * on the next update, bumplessly.
+     */
+    void setPidGains(PidLoop loop, const PidGains& gains);
+
+    /**
+     * @brief Get the controller engine and gains of one regulating mode
+     */
+    const PidGains& getPidGains(PidLoop loop) const;
+
+    /**
+     * @brief Built-in default engine and gains of one regulating mode
+     */
+    static PidGains defaultPidGains(PidLoop loop);
+
     // === Status ===
 
     /**
@@ -379,16 +573,82 @@ private:
     /**
      * @brief Process AUTO mode algorithm
      * @param power_grid Grid power in watts (+ import, - export)
+     * @param has_solar Live solar power in m_status.power_solar (feed-forward)
+     * @param has_load Live load power in m_status.power_load (feed-forward)
+     */
+    void processAutoMode(float power_grid, bool has_solar, bool has_load);
+
+    /**
+     * @brief AUTO feed-forward: change of the predicted balancing heater power
+     *
+     * Predicts P_grid from the load and solar channels under both wirings (load
+     * CT before or after the heaters) and keeps the better-matching one. Also
+     * maintains m_status.ff_active / ff_error_w.
+     *
+     * @return Watts to add to the cascade this cycle (0 = feedback-only)
+     */
+    float autoFeedForward(float power_grid, bool has_solar, bool has_load);
+
+    /**
+     * @brief Feed this cycle's grid change to the per-level plant estimators
+     *
+     * Pushes each level's modelled power, updates the excited levels on the
+     * shared residual and, in ADAPT, moves their applied plant_gain.
+     */
+    void updatePlantEstimates(float power_grid);
+
+    /**
+     * @brief AUTO: cascade power moved since the grid reading's window opened and
+     *        therefore not (fully) in it (W); drops moves the reading already covers
+     */
+    float unseenCascadeMoves();
+
+    /**
+     * @brief Record one acquisition-to-output latency sample (map lock held)
+     */
+    void recordLatency(uint32_t latency_us);
+
+    /**
+     * @brief Copy the live estimates into m_plant_store (map lock held)
+     */
+    void stashPlantEstimates();
+
+    /**
+     * @brief Load m_plant_store from NVS
+     */
+    void loadPlantGains();
+
+    /**
+     * @brief Write the estimates to NVS (takes the map lock to snapshot them)
+     */
+    esp_err_t savePlantGains();
+
+    /**
+     * @brief Place a total cascade power on the priority levels
+     *
+     * Relays first (whole devices, see processRelayPriority()), then the dimmer
+     * levels water-filled in priority order with the rest; each dimmer's share
+     * becomes a level through its curve model.
+     *
+     * @param target_w Total power the cascade should draw (W)
+     * @param should_log Whether to log debug info
      */
-    void processAutoMode(float power_grid);
+    void allocateCascadePower(float target_w, bool should_log);
 
     /**
-     * @brief Process relay priority level control
+     * @brief Switch the relays of one priority level
+     *
+     * ON once @p available_w covers the relay and the dimmer levels ahead of it
+     * (plus CASCADE_RELAY_MARGIN_W); OFF once it no longer covers the relay.
+     *
      * @param level Priority level containing relays
-     * @param remaining_delta Remaining delta to distribute (updated by function)
+     * @param available_w Cascade power not yet taken by higher-priority relays (W)
+     * @param upstream_dimmer_w Nominal power of the dimmer levels ahead of this one (W)
+     * @param relay_w Power of the relays left ON (accumulated, W)
      * @param should_log Whether to log debug info
      */
-    void processRelayPriority(PriorityLevel& level, float& remaining_delta, bool should_log);
+    void processRelayPriority(PriorityLevel& level, float available_w, float upstream_dimmer_w,
+                              float& relay_w, bool should_log);
 
     /**
      * @brief Process ECO mode algorithm
@@ -427,13 +687,47 @@ private:
      * @brief Dedicated control-loop task (isolation from the shared event-loop).
      *
      * The heavy update() must NOT run in the default event-loop task, where a busy
-     * web/MQTT handler could delay the ~5 Hz control cadence. onPowerUpdateEvent()
-     * only enqueues the freshest merged measurement into m_ctrl_queue (latest-wins
-     * mailbox); this task consumes it and runs update() on its own core (APP_CPU on
+     * web/MQTT handler could delay the ~5 Hz control cadence. This task is the
+     * acrouter_meas_ring consumer: woken by onRingWake(), it drains frames through
+     * sensor_hub_pump() and runs update() per merge on its own core (APP_CPU on
      * dual-core, priority-isolated on single-core) with its own Task-WDT.
      */
     static void controlTask(void* arg);
 
+    /**
+     * @brief Measurement-ring wake hook (any producer task): notifies controlTask
+     */
+    static void onRingWake(void* arg);
+
+    /**
+     * @brief Modelled power of one cascade device (W): nominal power through the
+     *        curve model for dimmers, nominal power when ON for relays
+     */
+    float devicePower(const DeviceRef& dev) const;
+
+    /**
+     * @brief Modelled power of one priority level (W, before its plant_gain)
+     */
+    float levelModelPower(const PriorityLevel& level) const;
+
+    /**
+     * @brief Estimated total power of the AUTO cascade (W), plus its capacity,
+     *        each level's model scaled by its plant_gain
+     */
+    float cascadePower(float* capacity_w) const;
+
+    /**
+     * @brief Watts per percent of the dimmer level at the cascade's fill boundary
+     *        (legacy P engine: its error / control_gain step is in that level's %),
+     *        0 when the cascade has no dimmer level
+     */
+    float marginalWattsPerPercent(bool increasing) const;
+
+    /**
+     * @brief Forget every PI/PID loop state (next step restarts bumplessly)
+     */
+    void resetPidLoops();
+
     /**
      * @brief Apply dimmer level with clamping
      * @param level Target level (will be clamped to 0-100)
@@ -477,9 +771,64 @@ private:
     /// (MQTT/web task) frees + reallocs the device arrays the control loop iterates.
     SemaphoreHandle_t m_priority_mutex;
 
+    // === PI/PID engine ===
+    PidController m_pid[static_cast<uint8_t>(PidLoop::COUNT)];  ///< One loop per regulating mode
+    int64_t m_ctrl_last_us;                 ///< Time of the previous update() (dt source)
+    float   m_ctrl_dt_s;                    ///< Seconds since the previous update(); 0 = restart
+    uint32_t m_hub_frames_seen;             ///< Sensor Hub frames_in at the previous update()
+    uint32_t m_ctrl_frames;                 ///< Source frames folded into this merge (>= 1)
+
+    // === AUTO feed-forward ===
+    bool  m_ff_enabled;                     ///< setFeedForward()
+    bool  m_ff_primed;                      ///< m_ff_need_w holds a prediction
+    float m_ff_need_w;                      ///< Balancing heater power last acted on (W)
+    float m_ff_heater_w;                    ///< Cascade power applied after the previous cycle (W)
+    float m_ff_heater_prev_w;               ///< ... and after the cycle before that (W)
+    bool  m_ff_rebase;                      ///< Re-reference m_ff_need_w on the next settled cycle
+    float m_ff_err_incl_w;                  ///< Prediction error, load CT includes the heaters (W)
+    float m_ff_err_excl_w;                  ///< Prediction error, load CT excludes the heaters (W)
+
+    // === AUTO plant-gain estimation ===
+    /// Persisted estimate of one level, matched on rebuild by its configuration
+    struct PlantGainRecord {
+        uint8_t  priority;
+        uint8_t  type;                      ///< DeviceType
+        uint8_t  device_count;
+        uint8_t  valid;
+        uint32_t total_power_w;
+        float    taps[PlantEstimator::TAPS];
+        uint16_t samples;
+        uint16_t reserved;
+    };
+    PlantTuning m_plant_mode;               ///< setPlantTuning()
+    bool  m_plant_primed;                   ///< m_plant_prev_grid holds the previous cycle
+    float m_plant_prev_grid;                ///< Grid power of the previous AUTO cycle (W)
+    float m_plant_prev2_grid;               ///< ... and of the cycle before that (W)
+    uint8_t m_plant_paired;                 ///< Consecutive cycles in m_plant_prev*_grid (0..2)
+    uint8_t m_plant_hold;                   ///< Cycles left without learning after a disturbance
+    float   m_plant_echo_w;                 ///< Last disturbance step, expected back next cycle (W)
+    bool  m_plant_save_due;                 ///< An estimate moved enough to be saved
+    int64_t m_plant_saved_us;               ///< Time of the last NVS save (0 = none this boot)
+    PlantGainRecord m_plant_store[MAX_PRIORITY_LEVELS];  ///< NVS mirror + estimates of removed levels
+
+    // === Measurement age / dead time ===
+    struct CascadeMove {
+        int64_t at_us;                      ///< When the outputs were written
+        float   delta_w;                    ///< Cascade power change (W)
+    };
+    bool     m_dtc_enabled;                 ///< setDeadTimeCompensation()
+    bool     m_actuated;                    ///< An output was written during this update()
+    uint64_t m_grid_acq_us;                 ///< Acquisition time of this update's grid reading (0 = unknown)
+    float    m_dtc_pending_w;               ///< Last unseenCascadeMoves() result (W)
+    CascadeMove m_moves[RouterConfig::DEADTIME_MAX_MOVES];
+    uint8_t  m_move_count;
+    uint32_t m_lat_us[RouterConfig::LATENCY_SAMPLES];  ///< Ring of latency samples (µs)
+    uint16_t m_lat_head;                    ///< Next write index in m_lat_us
+    uint32_t m_lat_total;                   ///< Samples since boot
+    uint32_t m_lat_max_us;                  ///< Maximum since boot (µs)
+    uint32_t m_meas_age_us;                 ///< Age of the regulated reading at the last update (µs)
+
     // === Isolated control task ===
-    /// Length-1 mailbox holding the freshest merged measurement for the control task.
-    QueueHandle_t m_ctrl_queue;
     /// Dedicated control task (own core/priority/WDT) — decoupled from the event loop.
     TaskHandle_t  m_ctrl_task;
 
@@ -0,0 +1,84 @@
+/**
+ * @file PidController.cpp
+ * @brief Positional PI/PID engine implementation
+ */
+
+#include "PidController.h"
+#include <cmath>
+
+// Derivative filter time constant: two 200 ms measurement periods. Enough to
+// stop per-frame sensor noise from stepping the load, short next to a cloud edge.
+static constexpr float PID_D_FILTER_S = 0.4f;
+
+// A track() mismatch below this is rounding, not saturation.
+static constexpr float PID_TRACK_EPS = 1e-3f;
+
+PidController::PidController()
+    : m_primed(false)
+    , m_i(0.0f)
+    , m_p(0.0f)
+    , m_d(0.0f)
+    , m_dmeas(0.0f)
+    , m_prev_meas(0.0f)
+    , m_u(0.0f)
+{
+}
+
+void PidController::setGains(const PidGains& gains) {
+    m_gains = gains;
+    reset();
+}
+
+float PidController::step(float setpoint, float measurement, float output_now, float dt_s,
+                          float out_min, float out_max, float deadband) {
+    if (out_max < out_min) out_max = out_min;
+
+    float e = setpoint - measurement;
+    if (fabsf(e) <= deadband) e = 0.0f;
+
+    const float kp = m_gains.kp;
+    const float ki = m_gains.ki;
+    const float kd = (m_gains.engine == ControlEngine::PID) ? m_gains.kd : 0.0f;
+
+    if (!m_primed || !(dt_s > 0.0f)) {
+        // Bumpless (re)start: seed the integrator so u == output_now.
+        m_dmeas     = 0.0f;
+        m_prev_meas = measurement;
+        m_p         = kp * e;
+        m_d         = 0.0f;
+        m_i         = output_now - m_p;
+        m_primed    = true;
+        m_u         = output_now;
+        return output_now;
+    }
+
+    // Derivative on measurement, first-order filtered.
+    const float raw  = (measurement - m_prev_meas) / dt_s;
+    m_dmeas         += (raw - m_dmeas) * (dt_s / (PID_D_FILTER_S + dt_s));
+    m_prev_meas      = measurement;
+
+    m_p  = kp * e;
+    m_d  = -kd * m_dmeas;
+    m_i += ki * e * dt_s;
+
+    // Integral clamping: the integrator may only carry u up to a limit, never past it.
+    float u = m_p + m_i + m_d;
+    if (u > out_max) {
+        m_i -= u - out_max;
+        u = out_max;
+    } else if (u < out_min) {
+        m_i += out_min - u;
+        u = out_min;
+    }
+    m_u = u;
+    return u;
+}
+
+void PidController::track(float applied) {
+    if (!m_primed) return;
+    const float diff = applied - m_u;
+    if (fabsf(diff) <= PID_TRACK_EPS) return;
+    // Back-calculation: the plant took `applied`, not m_u — the integrator follows.
+    m_i += diff;
+    m_u  = applied;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file PlantEstimator.cpp
+ * @brief Online plant-gain estimate (RLS over the cascade moves) implementation
+ */
+
+#include "PlantEstimator.h"
+#include <cmath>
+#include <cstring>
+
+// Regressor and residual are scaled to the measurement noise (~10 W per 5 Hz
+// frame) so the covariance is O(1): a 100 W move carries 10 noise units.
+static constexpr float PLANT_NORM_W = 10.0f;
+
+// Forgetting on excited cycles only: ~100 moves of memory.
+static constexpr float PLANT_LAMBDA = 0.99f;
+
+// Covariance: fresh (prior is the nominal model, loosely held), after restoring
+// a persisted estimate, and the ceiling that stops windup between moves.
+static constexpr float PLANT_P_FRESH    = 1.0f;
+static constexpr float PLANT_P_RESTORED = 0.05f;
+static constexpr float PLANT_P_MAX_TRACE = 3.0f;
+
+PlantEstimator::PlantEstimator() {
+    reset();
+}
+
+void PlantEstimator::reset() {
+    // Prior: the model is right, its effect split over the first two frames.
+    m_theta[0] = 0.5f;
+    m_theta[1] = 0.5f;
+    m_theta[2] = 0.0f;
+    memset(m_p, 0, sizeof(m_p));
+    for (uint8_t i = 0; i < TAPS; i++) m_p[i][i] = PLANT_P_FRESH;
+    memset(m_hist, 0, sizeof(m_hist));
+    m_hist_n  = 0;
+    m_samples = 0;
+}
+
+void PlantEstimator::restore(const float taps[TAPS], uint16_t samples) {
+    reset();
+    for (uint8_t i = 0; i < TAPS; i++) {
+        if (!std::isfinite(taps[i])) return;    // corrupt record: stay on the prior
+    }
+    memcpy(m_theta, taps, sizeof(m_theta));
+    for (uint8_t i = 0; i < TAPS; i++) m_p[i][i] = PLANT_P_RESTORED;
+    m_samples = samples;
+}
+
+void PlantEstimator::push(float model_w) {
+    for (uint8_t i = TAPS + 1; i > 0; i--) m_hist[i] = m_hist[i - 1];
+    m_hist[0] = model_w;
+    if (m_hist_n < TAPS + 2) m_hist_n++;
+}
+
+bool PlantEstimator::regressor(float phi[TAPS]) const {
+    if (m_hist_n < TAPS + 2) return false;
+    for (uint8_t i = 0; i < TAPS; i++) phi[i] = m_hist[i] - 2.0f * m_hist[i + 1] + m_hist[i + 2];
+    return true;
+}
+
+float PlantEstimator::predict(const float phi[TAPS]) const {
+    float y = 0.0f;
+    for (uint8_t i = 0; i < TAPS; i++) y += m_theta[i] * phi[i];
+    return y;
+}
+
+void PlantEstimator::update(const float phi[TAPS], float e) {
+    float x[TAPS];
+    for (uint8_t i = 0; i < TAPS; i++) x[i] = phi[i] / PLANT_NORM_W;
+    const float en = e / PLANT_NORM_W;
+
+    float px[TAPS];
+    float den = PLANT_LAMBDA;
+    for (uint8_t i = 0; i < TAPS; i++) {
+        px[i] = 0.0f;
+        for (uint8_t j = 0; j < TAPS; j++) px[i] += m_p[i][j] * x[j];
+        den += x[i] * px[i];
+    }
+    if (!(den > 0.0f)) return;
+
+    float trace = 0.0f;
+    for (uint8_t i = 0; i < TAPS; i++) {
+        const float k = px[i] / den;
+        m_theta[i] += k * en;
+        for (uint8_t j = 0; j < TAPS; j++) {
+            m_p[i][j] = (m_p[i][j] - k * px[j]) / PLANT_LAMBDA;
+        }
+        trace += m_p[i][i];
+    }
+    if (trace > PLANT_P_MAX_TRACE) {
+        const float s = PLANT_P_MAX_TRACE / trace;
+        for (uint8_t i = 0; i < TAPS; i++) {
+            for (uint8_t j = 0; j < TAPS; j++) m_p[i][j] *= s;
+        }
+    }
+    if (m_samples < UINT16_MAX) m_samples++;
+}
+
+float PlantEstimator::gain() const {
+    float g = 0.0f;
+    for (uint8_t i = 0; i < TAPS; i++) g += m_theta[i];
+    if (!std::isfinite(g) || g < GAIN_MIN) return GAIN_MIN;
+    return (g > GAIN_MAX) ? GAIN_MAX : g;
+}
@@ -4,11 +4,16 @@
  */
 
 #include "RouterController.h"
+#include "acrouter_meas_ring.h"
+#include "sensor_hub.h"
+#include "dimmer_curve.h"
 #include "esp_log.h"
 #include "esp_task_wdt.h"
 #include "esp_timer.h"
 #include "esp_system.h"
+#include "nvs.h"
 #include "sdkconfig.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
@@ -44,6 +49,10 @@
 
 static const char* TAG = "RouterCtrl";
 
+// Plant-gain estimates live in their own namespace (one blob), like the device registry.
+#define ROUTER_NVS_NS        "router"
+#define ROUTER_NVS_PLANT_KEY "plant_gain"
+
 // ============================================================
 // Singleton Instance
 // ============================================================
@@ -65,13 +74,48 @@ RouterController::RouterController()
     , m_active_priority_count(0)
     , m_multi_device_mode(false)
     , m_priority_mutex(nullptr)
-    , m_ctrl_queue(nullptr)
+    , m_ctrl_last_us(0)
+    , m_ctrl_dt_s(0.0f)
+    , m_hub_frames_seen(0)
+    , m_ctrl_frames(1)
+    , m_ff_enabled(false)
+    , m_ff_primed(false)
+    , m_ff_need_w(0.0f)
+    , m_ff_heater_w(0.0f)
+    , m_ff_heater_prev_w(0.0f)
+    , m_ff_rebase(false)
+    , m_ff_err_incl_w(0.0f)
+    , m_ff_err_excl_w(0.0f)
+    , m_plant_mode(PlantTuning::OFF)
+    , m_plant_primed(false)
+    , m_plant_prev_grid(0.0f)
+    , m_plant_prev2_grid(0.0f)
+    , m_plant_paired(0)
+    , m_plant_hold(0)
+    , m_plant_echo_w(0.0f)
+    , m_plant_save_due(false)
+    , m_plant_saved_us(0)
+    , m_dtc_enabled(true)
+    , m_actuated(false)
+    , m_grid_acq_us(0)
+    , m_dtc_pending_w(0.0f)
+    , m_move_count(0)
+    , m_lat_head(0)
+    , m_lat_total(0)
+    , m_lat_max_us(0)
+    , m_meas_age_us(0)
     , m_ctrl_task(nullptr)
     , m_initialized(false)
 {
+    for (uint8_t i = 0; i < static_cast<uint8_t>(PidLoop::COUNT); i++) {
+        m_pid[i].setGains(defaultPidGains(static_cast<PidLoop>(i)));
+    }
     // Guards the priority map against a rebuild (MQTT/web task) racing the control
     // loop's iteration. Created here so it exists before begin()'s first rebuild.
     m_priority_mutex = xSemaphoreCreateMutex();
+    memset(m_plant_store, 0, sizeof(m_plant_store));
+    memset(m_moves, 0, sizeof(m_moves));
+    memset(m_lat_us, 0, sizeof(m_lat_us));
 }
 
 RouterController::~RouterController() {
@@ -118,7 +162,9 @@ bool RouterController::begin(uint8_t dimmer_id) {
     // Ensure dimmer is off
     dimmer_set_level(m_dimmer_id, 0);
 
-    // Build priority map (for future multi-device support)
+    // Build priority map (for future multi-device support), resuming the
+    // plant-gain estimates learned before the reboot
+    loadPlantGains();
     rebuildPriorityMap();
 
     ESP_LOGI(TAG, "RouterController initialized, dimmer_id=%d (legacy mode)", dimmer_id);
@@ -142,27 +188,30 @@ void RouterController::setPrimaryDimmer(uint8_t id) {
 // ============================================================
 
 esp_err_t RouterController::subscribeEvents() {
-    /* Spin up the dedicated, isolated control task BEFORE registering the event
-     * handler, so the handler always has a valid mailbox to enqueue into. The heavy
-     * update() runs in this task (own core/priority/WDT), never in the shared event
-     * loop — a busy web/MQTT handler can no longer stall the control cadence. */
-    if (!m_ctrl_queue) {
-        m_ctrl_queue = xQueueCreate(1, sizeof(acrouter_measurements_t));  // latest-wins mailbox
-    }
-    if (m_ctrl_queue && !m_ctrl_task) {
+    /* Spin up the dedicated, isolated control task and make it the measurement-ring
+     * consumer: sources publish straight into the ring, the task drains it through
+     * sensor_hub_pump() and runs update() on its own core/priority/WDT. Neither the
+     * shared event loop nor a busy web/MQTT handler sits on the control path. */
+    if (!m_ctrl_task) {
         BaseType_t ok = xTaskCreatePinnedToCore(
             &RouterController::controlTask, "router_ctrl", ROUTER_CTRL_STACK,
             this, ROUTER_CTRL_PRIO, &m_ctrl_task, ROUTER_CTRL_CORE);
         if (ok != pdPASS) {
-            m_ctrl_task = nullptr;  // onPowerUpdateEvent falls back to inline update()
+            m_ctrl_task = nullptr;  // fall back to MERGED_UPDATE + inline update()
             ESP_LOGE(TAG, "Failed to start control task — control will run inline (degraded)");
         }
     }
+    if (m_ctrl_task) {
+        esp_err_t err = acrouter_meas_ring_attach(&RouterController::onRingWake, this);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Control task consumes the measurement ring (MERGED_UPDATE = telemetry only)");
+            return ESP_OK;
+        }
+        ESP_LOGE(TAG, "Measurement ring busy (%s) — using MERGED_UPDATE", esp_err_to_name(err));
+    }
 
-    /* Subscribe to MERGED_UPDATE (from Sensor Hub) — preferred path.
-     * Sensor Hub already merges all sources (ADC, I2C, ESP-NOW) with
-     * priority logic before posting MERGED_UPDATE.
-     * If Sensor Hub is not initialized yet, we fall back to POWER_UPDATE. */
+    /* Degraded path: Sensor Hub posts MERGED_UPDATE on the event loop and
+     * onPowerUpdateEvent() runs update() inline. */
     esp_err_t err = esp_event_handler_register(
         ACROUTER_EVENT, ACROUTER_EVENT_MERGED_UPDATE,
         &RouterController::onPowerUpdateEvent, this);
@@ -178,23 +227,29 @@ esp_err_t RouterController::subscribeEvents() {
 void RouterController::onPowerUpdateEvent(void* handler_arg, esp_event_base_t base,
                                           int32_t id, void* event_data) {
     RouterController* self = static_cast<RouterController*>(handler_arg);
-    const acrouter_measurements_t* m = static_cast<const acrouter_measurements_t*>(event_data);
-    if (!self || !m) {
+    const acrouter_meas_packed_t* pk = static_cast<const acrouter_meas_packed_t*>(event_data);
+    if (!self || !pk) {
         return;
     }
-    // Fast, non-blocking hand-off to the isolated control task (latest-wins mailbox).
-    // This runs in the shared event-loop task, so it must do NO heavy work here.
-    // Gate on the TASK (not just the queue): if the task failed to start, the mailbox
-    // would have no consumer — fall back to an inline update() so control still runs.
-    if (self->m_ctrl_task && self->m_ctrl_queue) {
-        xQueueOverwrite(self->m_ctrl_queue, m);
-    } else {
-        self->update(*m);  // degraded fallback if the control task never started
+    // Only registered when the control task could not be started / attached to the
+    // measurement ring: run the control inline in the event-loop task (degraded).
+    acrouter_measurements_t m;
+    if (!acrouter_meas_unpack(pk, &m, (uint64_t)esp_timer_get_time())) {
+        return;
+    }
+    self->update(m);
+}
+
+void RouterController::onRingWake(void* arg) {
+    RouterController* self = static_cast<RouterController*>(arg);
+    if (self && self->m_ctrl_task) {
+        xTaskNotifyGive(self->m_ctrl_task);
     }
 }
 
-// Dedicated control loop — see header. Consumes the freshest merged measurement and
-// runs the control math off the shared event loop, on its own core/priority, WDT-guarded.
+// Dedicated control loop — see header. Drains the measurement ring through the Sensor
+// Hub and runs the control math off the shared event loop, on its own core/priority,
+// WDT-guarded.
 void RouterController::controlTask(void* arg) {
     RouterController* self = static_cast<RouterController*>(arg);
     const bool wdt = (esp_task_wdt_add(NULL) == ESP_OK);
@@ -225,23 +280,30 @@ void RouterController::controlTask(void* arg) {
     }
 #endif
     int64_t hb_last = esp_timer_get_time();
+    int64_t last_merge_us = hb_last;
     uint32_t hb_updates = 0;
 
     for (;;) {
-        // Block for the next merged measurement, but wake at least every tick so the
-        // Task-WDT stays fed even during a sensor gap. On a gap the control simply
-        // holds its last state (staleness→failsafe is a planned follow-up).
-        if (xQueueReceive(self->m_ctrl_queue, &m, pdMS_TO_TICKS(ROUTER_CTRL_TICK_MS)) == pdTRUE) {
+        // Block until a source commits a frame (or the hub's epoch deadline kicks us),
+        // but wake at least every tick so the Task-WDT stays fed during a sensor gap.
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ROUTER_CTRL_TICK_MS));
+        bool merged = false;
+        while (sensor_hub_pump(&m)) {
             self->update(m);
             hb_updates++;
-        } else {
+            merged = true;
+        }
+        if (merged) {
+            last_merge_us = esp_timer_get_time();
+        } else if (esp_timer_get_time() - last_merge_us >= (int64_t)ROUTER_CTRL_TICK_MS * 1000) {
+            last_merge_us = esp_timer_get_time();
             // C2: a full tick (>1s) with no merged measurement means ALL sources are
             // silent (single rbAmp dead / I2C bus fault / ESP-NOW grid node down) — there
-            // are no POWER_UPDATE events at all, so update() would otherwise never run and
+            // are no measurement frames at all, so update() would otherwise never run and
             // the load would hold its last level forever. Drive update() with an empty
             // (valid, no-data) frame so each mode's failsafe fires: AUTO/ECO/GRID_LIMIT
             // decay toward off, OFFGRID decays on no-solar, OFF/MANUAL/BOOST hold setpoint.
-            // (Normal 5 Hz cadence returns from the queue well within the tick, so this
+            // (Normal 5 Hz cadence merges well within the tick, so this
             // never triggers while any source is live.)
             acrouter_measurements_t empty = {};
             empty.valid = true;   // valid frame, all has_* = false → "no data"
@@ -279,6 +341,32 @@ void RouterController::update(const acrouter_measurements_t& m) {
 
     m_status.last_update_ms = millis();
 
+    // Control period for the PI/PID loops. A long gap (sensor outage, control task
+    // stalled) restarts them bumplessly instead of integrating across it.
+    const int64_t now_us = esp_timer_get_time();
+    const float gap_s = (m_ctrl_last_us != 0) ? (float)(now_us - m_ctrl_last_us) / 1e6f : 0.0f;
+    m_ctrl_last_us = now_us;
+    if (gap_s <= 0.0f || gap_s > RouterConfig::PID_MAX_GAP_S) {
+        resetPidLoops();
+        m_ctrl_dt_s = 0.0f;
+    } else {
+        m_ctrl_dt_s = (gap_s < RouterConfig::PID_MIN_DT_S) ? RouterConfig::PID_MIN_DT_S : gap_s;
+    }
+
+    // Source frames behind this merge: one per frame merged on arrival, every
+    // role's frame when the hub coalesces an epoch. The P step is defined per
+    // frame, so it is compounded over these to keep its response per second.
+    sensor_hub_stats_t hub;
+    sensor_hub_get_stats(&hub);
+    const uint32_t folded = hub.frames_in - m_hub_frames_seen;
+    m_hub_frames_seen = hub.frames_in;
+    if (m_ctrl_dt_s <= 0.0f || folded == 0) {
+        m_ctrl_frames = 1;
+    } else {
+        m_ctrl_frames = (folded > RouterConfig::P_STEP_MAX_FRAMES) ? RouterConfig::P_STEP_MAX_FRAMES
+                                                                    : folded;
+    }
+
     // Extract power values from unified measurements. A channel counts as present only
     // when its has_* flag is set AND the value is finite: a driver glitch can surface a
     // NaN/Inf with has_*=true, and NaN silently defeats every comparison below (clamps and
@@ -301,6 +389,27 @@ void RouterController::update(const acrouter_measurements_t& m) {
     m_status.power_solar = power_solar;
     m_status.power_load = power_load;
 
+    // Acquisition time of the reading the mode regulates on (0 = unknown: degraded
+    // event path, injected frame). Latency is measured from it to the output write.
+    m_grid_acq_us = (has_grid_power || has_grid_current) ? m.acquired_us[ACROUTER_CH_GRID] : 0;
+    uint64_t input_acq_us = 0;
+    switch (m_status.mode) {
+        case RouterMode::AUTO:
+        case RouterMode::ECO:
+        case RouterMode::GRID_LIMIT:
+            input_acq_us = m_grid_acq_us;
+            break;
+        case RouterMode::OFFGRID:
+            input_acq_us = has_solar_power ? m.acquired_us[ACROUTER_CH_SOLAR] : 0;
+            break;
+        default:
+            break;
+    }
+    if (input_acq_us != 0 && (uint64_t)now_us >= input_acq_us) {
+        m_meas_age_us = (uint32_t)((uint64_t)now_us - input_acq_us);
+    }
+    m_actuated = false;
+
     // Serialize the mode processing (which iterates m_priority_levels[] and drives
     // its devices) against rebuildPriorityMap() on the MQTT/web task — otherwise the
     // rebuild's delete[]/realloc frees the arrays under us (use-after-free, D2).
@@ -319,7 +428,7 @@ void RouterController::update(const acrouter_measurements_t& m) {
             // Regulate only with a live grid-power reading; otherwise a stale/lost grid
             // sensor reads 0 W and AUTO would treat it as balanced and hold. Fail safe.
             if (has_grid_power) {
-                processAutoMode(power_grid);
+                processAutoMode(power_grid, has_solar_power, has_load_power);
             } else {
                 failsafeDecay();
             }
@@ -380,215 +489,632 @@ void RouterController::update(const acrouter_measurements_t& m) {
             break;
     }
 
+    if (m_actuated && input_acq_us != 0) {
+        const uint64_t out_us = (uint64_t)esp_timer_get_time();
+        if (out_us >= input_acq_us) recordLatency((uint32_t)(out_us - input_acq_us));
+    }
+
     if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
+
+    // Persist moved plant-gain estimates outside the map lock, rate-limited for flash wear.
+    if (m_plant_save_due &&
+        (m_plant_saved_us == 0 ||
+         now_us - m_plant_saved_us >= (int64_t)RouterConfig::PLANT_SAVE_INTERVAL_S * 1000000LL)) {
+        m_plant_save_due = false;
+        m_plant_saved_us = now_us;
+        esp_err_t err = savePlantGains();
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "plant-gain save failed: %s", esp_err_to_name(err));
+        }
+    }
 }
 
 // ============================================================
 // AUTO Mode Algorithm
 // ============================================================
 
-void RouterController::processAutoMode(float power_grid) {
+void RouterController::processAutoMode(float power_grid, bool has_solar, bool has_load) {
     // Multi-Device Solar Router Algorithm:
     // Goal: P_grid → 0 (zero export/import)
     //
     // error > 0 when EXPORTING (power_grid < 0) → need to INCREASE load
     // error < 0 when IMPORTING (power_grid > 0) → need to DECREASE load
     //
-    // Priority-based cascade:
-    // - Same priority → parallel/proportional distribution
-    // - Different priorities → cascade activation (0 first, then 1, 2, ...)
+    // The controller works in WATTS: its output is the total power the cascade
+    // should draw. allocateCascadePower() fills the priority levels in order
+    // (0 first, then 1, 2, ...; same priority → shared in proportion to nominal
+    // power) and converts each dimmer's share to a level only at the output.
 
-    // Check if within balance threshold
-    if (fabs(power_grid) <= m_status.balance_threshold) {
-        // Within threshold - hold current levels
-        updateState(power_grid);
-        return;
-    }
+    PidController& pid = m_pid[static_cast<uint8_t>(PidLoop::AUTO)];
+    const bool legacy = (pid.getGains().engine == ControlEngine::P);
 
-    // Calculate error and total delta
-    float error = -power_grid;  // Invert: export = positive error
-    float total_delta = error / m_status.control_gain;
+    if (m_plant_mode != PlantTuning::OFF) {
+        updatePlantEstimates(power_grid);
+    }
 
-    // Available power to distribute (positive = export, need to increase load)
-    float remaining_delta = total_delta;
+    float capacity_w = 0.0f;
+    const float power_now = cascadePower(&capacity_w);
+    // A relay switches ON only with CASCADE_RELAY_MARGIN_W beyond its power, so
+    // the target may exceed the capacity by that much (dimmers just saturate) —
+    // otherwise a relay-only cascade could never switch on.
+    const float target_max_w = capacity_w + RouterConfig::CASCADE_RELAY_MARGIN_W;
+
+    // Feed-forward acts on the disturbance now; feedback then sees the grid as it
+    // will be once that step lands, so the two do not both correct the same watts.
+    // Same for our own recent moves that the reading does not fully contain yet.
+    const float ff_w = autoFeedForward(power_grid, has_solar, has_load);
+    m_ff_heater_prev_w = m_ff_heater_w;
+    m_ff_heater_w = power_now;
+    m_dtc_pending_w = unseenCascadeMoves();
+    const float grid_expected = power_grid + m_dtc_pending_w + ff_w;
+
+    float error = -grid_expected;  // Invert: export = positive error
+    float target_w;
+
+    if (legacy) {
+        // Check if within balance threshold
+        if (fabs(grid_expected) <= m_status.balance_threshold) {
+            // Within threshold - hold current levels (a feed-forward step still
+            // goes out; the state is then updated once, after allocation)
+            if (ff_w == 0.0f) {
+                updateState(power_grid);
+                return;
+            }
+            error = 0.0f;
+        }
+        // Legacy step: error / control_gain percent of the priority level being
+        // trimmed, expressed in watts so the allocator can place it exactly.
+        // Relays only: nothing to trim by percent, and a few watts per cycle never
+        // add up to a whole relay (the target restarts from the cascade's actual
+        // power) — offer the error itself, as the pre-watts cascade switched a
+        // relay on any export and off on any import.
+        // The step closes w_per_pct / control_gain of the error per source frame;
+        // an epoch merge stands for several frames and takes the compounded
+        // step (1 - (1 - k)^n) those frames would have, never more than the error.
+        const float w_per_pct = marginalWattsPerPercent(error > 0.0f);
+        float step_w = error;
+        if (w_per_pct > 0.0f) {
+            const float k = w_per_pct / m_status.control_gain;
+            step_w = (k < 1.0f && m_ctrl_frames > 1)
+                         ? error * (1.0f - powf(1.0f - k, (float)m_ctrl_frames))
+                         : error * k;
+        }
+        target_w = power_now + ff_w + step_w;
+    } else {
+        target_w = ff_w + pid.step(0.0f, grid_expected, power_now, m_ctrl_dt_s,
+                                   0.0f, target_max_w, m_status.balance_threshold);
+        if (fabsf(target_w - power_now) < RouterConfig::CASCADE_MIN_STEP_W) {
+            pid.track(power_now);
+            updateState(power_grid);
+            return;
+        }
+    }
+    if (target_w < 0.0f) target_w = 0.0f;
+    if (target_w > target_max_w) target_w = target_max_w;
 
     // Debug logging preparation
     static uint32_t last_log = 0;
     bool should_log = (millis() - last_log >= 5000);
 
     if (should_log) {
-        ESP_LOGI(TAG, "AUTO: P_grid=%.1fW, error=%.1f, total_delta=%.2f%%",
-                 power_grid, error, total_delta);
+        ESP_LOGI(TAG, "AUTO: P_grid=%.1fW, error=%.1f, cascade %.0fW -> %.0fW (of %.0fW)",
+                 power_grid, error, power_now, target_w, capacity_w);
     }
 
-    // Iterate through priority levels (sorted 0→255)
-    for (uint8_t i = 0; i < m_active_priority_count; i++) {
-        PriorityLevel& level = m_priority_levels[i];
+    allocateCascadePower(target_w, should_log);
+    m_ff_heater_w = cascadePower(nullptr);
+
+    // Remember the move until the grid reading has covered it (dead time).
+    const float moved_w = m_ff_heater_w - power_now;
+    if (fabsf(moved_w) >= RouterConfig::CASCADE_MIN_STEP_W) {
+        if (m_move_count == RouterConfig::DEADTIME_MAX_MOVES) {
+            memmove(&m_moves[0], &m_moves[1], sizeof(m_moves[0]) * (RouterConfig::DEADTIME_MAX_MOVES - 1));
+            m_move_count--;
+        }
+        m_moves[m_move_count].at_us = esp_timer_get_time();
+        m_moves[m_move_count].delta_w = moved_w;
+        m_move_count++;
+    }
 
-        // Skip if no devices at this level
+    // Anti-windup: relays switch whole devices (or not at all inside their debounce)
+    // and dimmers take whole percents — integrate what was actually applied.
+    if (!legacy) {
+        pid.track(m_ff_heater_w);
+    }
+
+    // Update legacy single-dimmer status for backward compatibility
+    // Use primary dimmer (m_dimmer_id) if it exists
+    dimmer_status_t dimmer_status;
+    if (dimmer_get_status(m_dimmer_id, &dimmer_status) == ESP_OK) {
+        m_status.dimmer_percent = dimmer_status.level_percent;
+        m_target_level = (float)m_status.dimmer_percent;
+        m_status.target_level = m_target_level;
+    }
+
+    // Update state
+    updateState(power_grid);
+
+    if (should_log) {
+        last_log = millis();
+    }
+}
+
+// ============================================================
+// Watts-domain cascade
+// ============================================================
+
+float RouterController::devicePower(const DeviceRef& dev) const {
+    if (dev.type == DeviceType::RELAY) {
+        relay_status_t rs;
+        bool on = (relay_get_status(dev.id, &rs) == ESP_OK) && rs.state == RELAY_STATE_ON;
+        return on ? (float)dev.power_w : 0.0f;
+    }
+    return (float)dev.power_w * dimmer_curve_power_fraction(dev.curve, dev.target_level);
+}
+
+float RouterController::levelModelPower(const PriorityLevel& level) const {
+    float p = 0.0f;
+    for (uint8_t j = 0; j < level.device_count; j++) {
+        p += devicePower(level.devices[j]);
+    }
+    return p;
+}
+
+float RouterController::cascadePower(float* capacity_w) const {
+    float sum = 0.0f;
+    float cap = 0.0f;
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        const PriorityLevel& level = m_priority_levels[i];
         if (level.device_count == 0 || level.total_power_w == 0) {
             continue;
         }
+        sum += level.plant_gain * levelModelPower(level);
+        cap += level.plant_gain * (float)level.total_power_w;
+    }
+    if (capacity_w) *capacity_w = cap;
+    return sum;
+}
 
-        // Handle RELAY devices differently from DIMMER devices
-        if (level.device_type == DeviceType::RELAY) {
-            // Relay control: binary ON/OFF decision
-            processRelayPriority(level, remaining_delta, should_log);
-            // Note: remaining_delta is updated inside processRelayPriority
+float RouterController::marginalWattsPerPercent(bool increasing) const {
+    // The dimmer level at the fill boundary: the first one not yet full when
+    // adding load, the last one not yet empty when shedding it.
+    const PriorityLevel* marginal = nullptr;
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        const PriorityLevel& level = m_priority_levels[i];
+        if (level.device_type != DeviceType::DIMMER || level.total_power_w == 0) {
             continue;
         }
+        const float fill = levelModelPower(level) / (float)level.total_power_w;
+        if (increasing) {
+            marginal = &level;
+            if (fill < 0.999f) break;
+        } else {
+            if (fill > 0.001f || !marginal) marginal = &level;
+        }
+    }
+    return marginal ? marginal->plant_gain * (float)marginal->total_power_w / 100.0f : 0.0f;
+}
 
-        // Calculate current total level for this priority
-        float current_total_level = 0.0f;
-        for (uint8_t j = 0; j < level.device_count; j++) {
-            DeviceRef& dev = level.devices[j];
-            current_total_level += dev.target_level;
+void RouterController::allocateCascadePower(float target_w, bool should_log) {
+    // Pass 1 — relays, in priority order. A relay is all-or-nothing, so it goes
+    // ON only once the target covers it AND the dimmer levels ahead of it are
+    // full (the cascade reached it), plus a margin; it stays ON while the target
+    // still covers it — the dimmers ahead then trim around it. Whatever the
+    // relay manager actually did (debounce) is what the dimmers see.
+    float relay_w = 0.0f;
+    float upstream_dimmer_w = 0.0f;
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        PriorityLevel& level = m_priority_levels[i];
+        if (level.device_count == 0 || level.total_power_w == 0) {
+            continue;
+        }
+        if (level.device_type == DeviceType::RELAY) {
+            processRelayPriority(level, target_w - relay_w, upstream_dimmer_w, relay_w, should_log);
+        } else {
+            upstream_dimmer_w += level.plant_gain * (float)level.total_power_w;
         }
+    }
 
-        // Calculate average level for this priority
-        float avg_level = current_total_level / level.device_count;
+    // Pass 2 — dimmers, water-filled in priority order with what the relays left.
+    // Same priority shares in proportion to nominal power: every device of the
+    // level draws the same fraction of its own nominal power. Watts here are
+    // estimated real watts: the level's nominal power scaled by its plant_gain.
+    float remaining_w = target_w - relay_w;
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        PriorityLevel& level = m_priority_levels[i];
+        if (level.device_type != DeviceType::DIMMER || level.device_count == 0 ||
+            level.total_power_w == 0) {
+            continue;
+        }
+        const float level_w = level.plant_gain * (float)level.total_power_w;
+        float share_w = (remaining_w > 0.0f) ? remaining_w : 0.0f;
+        if (share_w > level_w) share_w = level_w;
+        remaining_w -= share_w;
+        const float fraction = share_w / level_w;
 
-        // Check saturation limits (use tighter thresholds to prevent premature cascade)
-        bool at_maximum = (avg_level >= 99.9f);  // Allow small tolerance
-        bool at_minimum = (avg_level <= 0.5f);   // Consider minimum if avg < 0.5%
+        for (uint8_t j = 0; j < level.device_count; j++) {
+            DeviceRef& dev = level.devices[j];
+            const float new_level = dimmer_curve_level_for_fraction(dev.curve, fraction);
+            const uint8_t percent = static_cast<uint8_t>(new_level + 0.5f);
 
-        // Determine if this priority can accept the remaining delta
-        if (remaining_delta > 0) {
-            // Need to INCREASE load (exporting)
-            if (at_maximum) {
-                // This priority is saturated, continue to next
-                if (should_log) {
-                    ESP_LOGI(TAG, "  Priority %d: at maximum (%.1f%%), cascade to next",
-                             level.priority, avg_level);
+            // Only whole-percent changes reach the hardware. Surface a failed I2C/RF
+            // write (MAJOR-5) and keep the old level, so the power estimate stays
+            // true and the next cycle retries.
+            if (percent != static_cast<uint8_t>(dev.target_level + 0.5f)) {
+                esp_err_t derr = dimmer_set_level(dev.id, percent);
+                if (derr != ESP_OK) {
+                    ESP_LOGW(TAG, "cascade dimmer %d set_level(%u%%) failed: %s",
+                             dev.id, percent, esp_err_to_name(derr));
+                    continue;
                 }
-                continue;
+                m_actuated = true;
             }
+            dev.target_level = new_level;
 
-            // Calculate how much this priority can accept
-            float max_increase = (100.0f - avg_level);  // Room to 100%
-            float delta_to_apply = (remaining_delta < max_increase) ? remaining_delta : max_increase;
+            if (should_log) {
+                ESP_LOGI(TAG, "  Dimmer %d [P%d]: %.0fW of %dW -> %.1f%% (%d%%, %s)",
+                         dev.id, level.priority, fraction * dev.power_w, dev.power_w,
+                         dev.target_level, percent, dimmer_curve_str(dev.curve));
+            }
+        }
+    }
+}
+
+// ============================================================
+// AUTO feed-forward
+// ============================================================
 
-            // Distribute EQUALLY across all devices at same priority
-            // Each device's 100% already represents its nominal power,
-            // so equal % change = proportional power change
-            float device_delta = delta_to_apply / level.device_count;
+float RouterController::autoFeedForward(float power_grid, bool has_solar, bool has_load) {
+    m_status.ff_power_w = 0.0f;
+    if (!m_ff_enabled || !has_solar || !has_load) {
+        m_status.ff_active = false;
+        m_status.ff_error_w = 0.0f;
+        m_ff_primed = false;
+        return 0.0f;
+    }
 
-            for (uint8_t j = 0; j < level.device_count; j++) {
-                DeviceRef& dev = level.devices[j];
+    // Magnitudes: CT orientation decides the sign of these channels, not the flow.
+    const float solar = fabsf(m_status.power_solar);
+    const float load  = fabsf(m_status.power_load);
+    const float heater = m_ff_heater_w;     // on during the window these readings cover
+
+    // Our own last move is only partly inside the readings' 200 ms windows (modules
+    // are not phase-aligned with this cycle): the model cannot separate it from a
+    // disturbance. Leave that cycle to feedback and re-reference on the next one.
+    if (fabsf(heater - m_ff_heater_prev_w) > RouterConfig::FF_DEADBAND_W) {
+        m_ff_rebase = true;
+        return 0.0f;
+    }
 
-                // Update target level
-                dev.target_level += device_delta;
+    // P_grid = load - solar if the load CT sees the heaters, load + heater - solar
+    // if it does not. Track how well each wiring predicts the grid reading.
+    const float a = RouterConfig::FF_ERROR_ALPHA;
+    if (!m_ff_primed) {
+        m_ff_err_incl_w = fabsf(power_grid - (load - solar));
+        m_ff_err_excl_w = fabsf(power_grid - (load + heater - solar));
+    } else {
+        m_ff_err_incl_w += a * (fabsf(power_grid - (load - solar)) - m_ff_err_incl_w);
+        m_ff_err_excl_w += a * (fabsf(power_grid - (load + heater - solar)) - m_ff_err_excl_w);
+    }
+    const bool incl = (m_ff_err_incl_w <= m_ff_err_excl_w);
+    m_status.ff_error_w = incl ? m_ff_err_incl_w : m_ff_err_excl_w;
+
+    // Heater power that would balance the grid: solar minus the house base load.
+    const float base = incl ? load - heater : load;
+    const float need = solar - base;
+
+    if (!m_ff_primed || m_ff_rebase) {
+        m_status.ff_active = m_ff_primed && (m_status.ff_error_w <= RouterConfig::FF_MAX_ERROR_W);
+        m_ff_need_w = need;
+        m_ff_primed = true;
+        m_ff_rebase = false;
+        return 0.0f;
+    }
 
-                // Clamp to 0-100
-                if (dev.target_level > 100.0f) dev.target_level = 100.0f;
-                if (dev.target_level < 0.0f) dev.target_level = 0.0f;
+    // A prediction that disagrees with the grid meter (CT mislabelled, one channel
+    // stale, a load outside both CTs) would inject error: feedback-only until it agrees.
+    m_status.ff_active = (m_status.ff_error_w <= RouterConfig::FF_MAX_ERROR_W);
+    if (!m_status.ff_active || fabsf(need - m_ff_need_w) <= RouterConfig::FF_DEADBAND_W) {
+        if (!m_status.ff_active) m_ff_need_w = need;
+        return 0.0f;
+    }
+    const float step = need - m_ff_need_w;
+    m_ff_need_w = need;
+    m_status.ff_power_w = step;
+    return step;
+}
 
-                // Apply to dimmer hardware. Surface a failed I2C/RF write (MAJOR-5): the
-                // proportional loop retries implicitly next cycle, but silence hid real faults.
-                uint8_t percent = static_cast<uint8_t>(dev.target_level + 0.5f);
-                esp_err_t derr = dimmer_set_level(dev.id, percent);
-                if (derr != ESP_OK) {
-                    ESP_LOGW(TAG, "cascade dimmer %d set_level(%u%%) failed: %s",
-                             dev.id, percent, esp_err_to_name(derr));
-                }
+void RouterController::setFeedForward(bool enabled) {
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    m_ff_enabled = enabled;
+    m_ff_primed = false;
+    m_status.ff_active = false;
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
+    ESP_LOGI(TAG, "AUTO feed-forward %s", enabled ? "enabled" : "disabled");
+}
 
-                if (should_log) {
-                    ESP_LOGI(TAG, "  Dimmer %d [P%d]: delta=%.2f%%, new=%.1f%% (%d%%)",
-                             dev.id, level.priority, device_delta, dev.target_level, percent);
-                }
-            }
+// ============================================================
+// Measurement age and dead time
+// ============================================================
 
-            // Deduct from remaining
-            remaining_delta -= delta_to_apply;
+float RouterController::unseenCascadeMoves() {
+    if (m_grid_acq_us == 0) {
+        m_move_count = 0;       // no timing: run uncompensated, forget the history
+        return 0.0f;
+    }
+    // The grid frame averages [acquired - window, acquired]: a move made inside
+    // that window shows in proportion to the part of it that followed the move.
+    // Sources stamp at read time, never before the window end, so the estimate
+    // errs towards "already seen" (under-compensation).
+    const float window_us = (float)RouterConfig::MEAS_WINDOW_MS * 1000.0f;
+    float unseen_w = 0.0f;
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < m_move_count; i++) {
+        const float seen = (float)((int64_t)m_grid_acq_us - m_moves[i].at_us) / window_us;
+        if (seen >= 1.0f) continue;                 // fully in the reading — done
+        unseen_w += (1.0f - (seen > 0.0f ? seen : 0.0f)) * m_moves[i].delta_w;
+        m_moves[kept++] = m_moves[i];
+    }
+    m_move_count = kept;
+    return m_dtc_enabled ? unseen_w : 0.0f;
+}
 
-            // If fully consumed, stop
-            if (remaining_delta <= 0.01f) {
-                break;
-            }
+void RouterController::recordLatency(uint32_t latency_us) {
+    m_lat_us[m_lat_head] = latency_us;
+    m_lat_head = (uint16_t)((m_lat_head + 1) % RouterConfig::LATENCY_SAMPLES);
+    m_lat_total++;
+    if (latency_us > m_lat_max_us) m_lat_max_us = latency_us;
+}
 
-        } else if (remaining_delta < 0) {
-            // Need to DECREASE load (importing)
-            if (at_minimum) {
-                // This priority is already at minimum, continue to next
-                if (should_log) {
-                    ESP_LOGI(TAG, "  Priority %d: at minimum (%.1f%%), cascade to next",
-                             level.priority, avg_level);
-                }
-                continue;
-            }
+void RouterController::setDeadTimeCompensation(bool enabled) {
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    m_dtc_enabled = enabled;
+    m_dtc_pending_w = 0.0f;
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
+    ESP_LOGI(TAG, "AUTO dead-time compensation %s", enabled ? "enabled" : "disabled");
+}
 
-            // Calculate how much this priority can decrease
-            float max_decrease = -avg_level;  // Room to 0%
-            float delta_to_apply = (remaining_delta > max_decrease) ? remaining_delta : max_decrease;
+void RouterController::getControlLatency(ControlLatency& out) const {
+    uint32_t sorted[RouterConfig::LATENCY_SAMPLES];
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    const uint32_t n = (m_lat_total < RouterConfig::LATENCY_SAMPLES) ? m_lat_total
+                                                                     : RouterConfig::LATENCY_SAMPLES;
+    memcpy(sorted, m_lat_us, n * sizeof(sorted[0]));   // the first n slots are the filled ones
+    out.samples       = m_lat_total;
+    out.max_ms        = m_lat_max_us / 1000.0f;
+    out.age_ms        = m_meas_age_us / 1000.0f;
+    out.pending_w     = m_dtc_pending_w;
+    out.deadtime_comp = m_dtc_enabled;
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
 
-            // Distribute EQUALLY across all devices at same priority
-            // Each device's 100% already represents its nominal power,
-            // so equal % change = proportional power change
-            float device_delta = delta_to_apply / level.device_count;
+    out.p50_ms = 0.0f;
+    out.p99_ms = 0.0f;
+    if (n == 0) return;
+    std::sort(sorted, sorted + n);
+    out.p50_ms = sorted[(n - 1) / 2] / 1000.0f;
+    out.p99_ms = sorted[(uint32_t)(0.99f * (float)(n - 1) + 0.5f)] / 1000.0f;
+}
 
-            for (uint8_t j = 0; j < level.device_count; j++) {
-                DeviceRef& dev = level.devices[j];
+// ============================================================
+// AUTO plant-gain estimation
+// ============================================================
 
-                // Update target level
-                dev.target_level += device_delta;
+void RouterController::updatePlantEstimates(float power_grid) {
+    if (!m_plant_primed || m_ctrl_dt_s <= 0.0f) {
+        // Restart (mode change, control gap, map rebuild): the moves before it
+        // cannot be paired with this grid reading.
+        for (uint8_t i = 0; i < m_active_priority_count; i++) {
+            m_priority_levels[i].plant.clearHistory();
+        }
+        m_plant_paired = 0;
+        m_plant_echo_w = 0.0f;
+    }
+    const bool paired = (m_plant_paired >= 2);
+    const float d_grid = power_grid - 2.0f * m_plant_prev_grid + m_plant_prev2_grid;
+    m_plant_prev2_grid = m_plant_prev_grid;
+    m_plant_prev_grid = power_grid;
+    if (m_plant_paired < 2) m_plant_paired++;
+    m_plant_primed = true;
+
+    // Regressors: each level's last moves, as applied after the previous cycles.
+    float phi[MAX_PRIORITY_LEVELS][PlantEstimator::TAPS];
+    float energy[MAX_PRIORITY_LEVELS];
+    float predicted = 0.0f;
+    float excited_energy = 0.0f;
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        PriorityLevel& level = m_priority_levels[i];
+        energy[i] = 0.0f;
+        level.plant.push(levelModelPower(level));
+        if (!level.plant.regressor(phi[i])) continue;
+        predicted += level.plant.predict(phi[i]);
+        float peak = 0.0f;
+        for (uint8_t t = 0; t < PlantEstimator::TAPS; t++) {
+            if (fabsf(phi[i][t]) > peak) peak = fabsf(phi[i][t]);
+        }
+        if (peak >= RouterConfig::PLANT_MIN_EXCITATION_W) {
+            for (uint8_t t = 0; t < PlantEstimator::TAPS; t++) energy[i] += phi[i][t] * phi[i][t];
+            excited_energy += energy[i];
+        }
+    }
+    if (!paired) return;
+
+    // A load switching is not plant response. A residual far beyond what a model
+    // error could explain marks a disturbance. Taken as a step, it comes back with
+    // the opposite sign in the next second difference, where our reaction to it
+    // lands too: that cycle is learned from with the echo removed. When the echo
+    // does not explain it (a ramp, a step split over two module windows) the
+    // cycle and the two after it are not learned from.
+    const float echo = m_plant_echo_w;
+    m_plant_echo_w = 0.0f;
+    const float e = d_grid - predicted + echo;
+    if (fabsf(e) > RouterConfig::PLANT_OUTLIER_W + RouterConfig::PLANT_OUTLIER_REL * fabsf(predicted)) {
+        if (echo == 0.0f) {
+            m_plant_echo_w = e;
+            if (m_plant_hold < 1) m_plant_hold = 1;
+        } else {
+            m_plant_hold = 3;
+        }
+    }
+    if (m_plant_hold > 0) {
+        m_plant_hold--;
+        return;
+    }
+    if (excited_energy <= 0.0f) return;
 
-                // Clamp to 0-100
-                if (dev.target_level > 100.0f) dev.target_level = 100.0f;
-                if (dev.target_level < 0.0f) dev.target_level = 0.0f;
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        if (energy[i] <= 0.0f) continue;
+        PriorityLevel& level = m_priority_levels[i];
+        // Levels that moved together share the residual by the size of their moves.
+        level.plant.update(phi[i], e * energy[i] / excited_energy);
 
-                // Apply to dimmer hardware. Surface a failed I2C/RF write (MAJOR-5): the
-                // proportional loop retries implicitly next cycle, but silence hid real faults.
-                uint8_t percent = static_cast<uint8_t>(dev.target_level + 0.5f);
-                esp_err_t derr = dimmer_set_level(dev.id, percent);
-                if (derr != ESP_OK) {
-                    ESP_LOGW(TAG, "cascade dimmer %d set_level(%u%%) failed: %s",
-                             dev.id, percent, esp_err_to_name(derr));
-                }
+        const float g = level.plant.gain();
+        if (m_plant_mode == PlantTuning::ADAPT && level.plant.samples() >= RouterConfig::PLANT_MIN_SAMPLES) {
+            level.plant_gain += RouterConfig::PLANT_APPLY_ALPHA * (g - level.plant_gain);
+        }
 
-                if (should_log) {
-                    ESP_LOGI(TAG, "  Dimmer %d [P%d]: delta=%.2f%%, new=%.1f%% (%d%%)",
-                             dev.id, level.priority, device_delta, dev.target_level, percent);
-                }
+        // Worth saving once first trusted, then when it moved against the saved value.
+        if (level.plant.samples() < RouterConfig::PLANT_MIN_SAMPLES) continue;
+        bool found = false;
+        for (uint8_t r = 0; r < MAX_PRIORITY_LEVELS && !found; r++) {
+            const PlantGainRecord& rec = m_plant_store[r];
+            if (!rec.valid || rec.priority != level.priority) continue;
+            found = true;
+            float saved = 0.0f;
+            for (uint8_t t = 0; t < PlantEstimator::TAPS; t++) saved += rec.taps[t];
+            if (rec.total_power_w != level.total_power_w || rec.device_count != level.device_count ||
+                fabsf(g - saved) > RouterConfig::PLANT_SAVE_DELTA * saved) {
+                m_plant_save_due = true;
             }
+        }
+        if (!found) m_plant_save_due = true;
+    }
+}
 
-            // Deduct from remaining
-            remaining_delta -= delta_to_apply;
-
-            // If fully consumed, stop
-            if (remaining_delta >= -0.01f) {
+void RouterController::stashPlantEstimates() {
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        const PriorityLevel& level = m_priority_levels[i];
+        if (level.plant.samples() == 0) continue;
+
+        // One record per priority value: a reconfigured level replaces its old one.
+        int slot = -1;
+        for (uint8_t r = 0; r < MAX_PRIORITY_LEVELS; r++) {
+            if (m_plant_store[r].valid && m_plant_store[r].priority == level.priority) {
+                slot = r;
                 break;
             }
+            if (slot < 0 && !m_plant_store[r].valid) slot = r;
         }
+        if (slot < 0) continue;
+
+        PlantGainRecord& rec = m_plant_store[slot];
+        rec.priority      = level.priority;
+        rec.type          = static_cast<uint8_t>(level.device_type);
+        rec.device_count  = level.device_count;
+        rec.valid         = 1;
+        rec.total_power_w = level.total_power_w;
+        memcpy(rec.taps, level.plant.taps(), sizeof(rec.taps));
+        rec.samples       = level.plant.samples();
+        rec.reserved      = 0;
     }
+}
 
-    // Update legacy single-dimmer status for backward compatibility
-    // Use primary dimmer (m_dimmer_id) if it exists
-    dimmer_status_t dimmer_status;
-    if (dimmer_get_status(m_dimmer_id, &dimmer_status) == ESP_OK) {
-        m_status.dimmer_percent = dimmer_status.level_percent;
-        m_target_level = (float)m_status.dimmer_percent;
-        m_status.target_level = m_target_level;
+void RouterController::loadPlantGains() {
+    memset(m_plant_store, 0, sizeof(m_plant_store));
+    nvs_handle_t nvs;
+    if (nvs_open(ROUTER_NVS_NS, NVS_READONLY, &nvs) != ESP_OK) {
+        return;     // first boot
+    }
+    size_t sz = sizeof(m_plant_store);
+    esp_err_t err = nvs_get_blob(nvs, ROUTER_NVS_PLANT_KEY, m_plant_store, &sz);
+    nvs_close(nvs);
+    if (err == ESP_OK && sz != sizeof(m_plant_store)) {
+        // Layout changed across an update: relearn rather than misread.
+        memset(m_plant_store, 0, sizeof(m_plant_store));
+        ESP_LOGW(TAG, "Plant-gain blob size mismatch (%u vs %u) - relearning",
+                 (unsigned)sz, (unsigned)sizeof(m_plant_store));
+    } else if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Plant-gain estimates loaded");
     }
+}
 
-    // Update state
-    updateState(power_grid);
+esp_err_t RouterController::savePlantGains() {
+    PlantGainRecord snapshot[MAX_PRIORITY_LEVELS];
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    stashPlantEstimates();
+    memcpy(snapshot, m_plant_store, sizeof(snapshot));
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
 
-    if (should_log) {
-        ESP_LOGI(TAG, "AUTO: Remaining delta: %.2f%%", remaining_delta);
-        last_log = millis();
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(ROUTER_NVS_NS, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(nvs, ROUTER_NVS_PLANT_KEY, snapshot, sizeof(snapshot));
+    if (err == ESP_OK) err = nvs_commit(nvs);
+    nvs_close(nvs);
+    ESP_LOGD(TAG, "Plant-gain estimates saved: %s", esp_err_to_name(err));
+    return err;
+}
+
+void RouterController::setPlantTuning(PlantTuning mode) {
+    if (mode > PlantTuning::ADAPT) mode = PlantTuning::ADAPT;
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    m_plant_mode = mode;
+    m_plant_primed = false;
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        PriorityLevel& level = m_priority_levels[i];
+        const bool trusted = level.plant.samples() >= RouterConfig::PLANT_MIN_SAMPLES;
+        level.plant_gain = (mode == PlantTuning::ADAPT && trusted) ? level.plant.gain() : 1.0f;
     }
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
+    static const char* names[] = {"off", "learn", "adapt"};
+    ESP_LOGI(TAG, "AUTO plant-gain tuning: %s", names[static_cast<uint8_t>(mode)]);
+}
+
+void RouterController::resetPlantEstimates() {
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        m_priority_levels[i].plant.reset();
+        m_priority_levels[i].plant_gain = 1.0f;
+    }
+    memset(m_plant_store, 0, sizeof(m_plant_store));
+    m_plant_primed = false;
+    m_plant_save_due = false;
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
+
+    nvs_handle_t nvs;
+    if (nvs_open(ROUTER_NVS_NS, NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_erase_key(nvs, ROUTER_NVS_PLANT_KEY);
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+    ESP_LOGI(TAG, "Plant-gain estimates reset to nominal");
+}
+
+uint8_t RouterController::getPlantEstimates(PlantGainInfo* out, uint8_t max) const {
+    if (!out) return 0;
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < m_active_priority_count && n < max; i++) {
+        const PriorityLevel& level = m_priority_levels[i];
+        PlantGainInfo& info = out[n++];
+        info.priority     = level.priority;
+        info.type         = level.device_type;
+        info.nominal_w    = level.total_power_w;
+        info.gain         = level.plant.gain();
+        info.w_per_pct    = info.gain * (float)level.total_power_w / 100.0f;
+        info.applied_gain = level.plant_gain;
+        info.samples      = level.plant.samples();
+    }
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
+    return n;
 }
 
 // ============================================================
 // Relay Priority Control
 // ============================================================
 
-void RouterController::processRelayPriority(PriorityLevel& level, float& remaining_delta, bool should_log) {
-    // Simplified relay control (v1.3.0)
-    // TODO: Add intelligent power-based control with safety margin in future release
-    // For now: simple ON/OFF based on remaining_delta > 0
-
-    // Iterate through all relays at this priority
+void RouterController::processRelayPriority(PriorityLevel& level, float available_w,
+                                            float upstream_dimmer_w, float& relay_w,
+                                            bool should_log) {
     for (uint8_t j = 0; j < level.device_count; j++) {
         DeviceRef& dev = level.devices[j];
 
@@ -598,49 +1124,37 @@ void RouterController::processRelayPriority(PriorityLevel& level, float& remaini
             continue;  // Skip if can't get status
         }
 
+        const float pwr = level.plant_gain * (float)dev.power_w;
         bool is_on = (relay_status.state == RELAY_STATE_ON);
-        dev.target_level = is_on ? 100.0f : 0.0f;  // Sync target with actual state
 
-        if (remaining_delta > 0) {
-            // INCREASE mode: Turn ON relays if available export power
-            if (!is_on) {
-                // Simple logic: turn ON if any remaining delta
+        if (!is_on) {
+            const float need = ((upstream_dimmer_w > pwr) ? upstream_dimmer_w : pwr) +
+                               RouterConfig::CASCADE_RELAY_MARGIN_W;
+            if (available_w >= need) {
                 relay_turn_on(dev.id, false);  // force=false (respect debounce)
-                dev.target_level = 100.0f;
-                remaining_delta = 0.0f;  // Consume all remaining (simplified)
-
-                if (should_log) {
-                    ESP_LOGI(TAG, "  Relay %d [P%d]: turned ON (power=%dW)",
-                             dev.id, level.priority, dev.power_w);
-                }
-            } else {
-                // Already ON - no action needed
                 if (should_log) {
-                    ESP_LOGI(TAG, "  Relay %d [P%d]: already ON (power=%dW)",
-                             dev.id, level.priority, dev.power_w);
+                    ESP_LOGI(TAG, "  Relay %d [P%d]: turn ON (power=%dW, available=%.0fW)",
+                             dev.id, level.priority, dev.power_w, available_w);
                 }
             }
-
-        } else if (remaining_delta < 0) {
-            // DECREASE mode: Turn OFF relays if needed
-            if (is_on) {
-                // Turn OFF to reduce load
-                relay_turn_off(dev.id, false);  // force=false (respect debounce)
-                dev.target_level = 0.0f;
-                remaining_delta += 100.0f;  // Release 100% back
-
-                if (should_log) {
-                    ESP_LOGI(TAG, "  Relay %d [P%d]: turned OFF (power=%dW)",
-                             dev.id, level.priority, dev.power_w);
-                }
-            } else {
-                // Already OFF - no action needed
-                if (should_log) {
-                    ESP_LOGI(TAG, "  Relay %d [P%d]: already OFF",
-                             dev.id, level.priority);
-                }
+        } else if (available_w < pwr) {
+            relay_turn_off(dev.id, false);  // force=false (respect debounce)
+            if (should_log) {
+                ESP_LOGI(TAG, "  Relay %d [P%d]: turn OFF (power=%dW, available=%.0fW)",
+                         dev.id, level.priority, dev.power_w, available_w);
             }
         }
+
+        // Sync with what the relay manager actually did (debounce may refuse)
+        const bool was_on = is_on;
+        is_on = (relay_get_status(dev.id, &relay_status) == ESP_OK) &&
+                relay_status.state == RELAY_STATE_ON;
+        if (is_on != was_on) m_actuated = true;
+        dev.target_level = is_on ? 100.0f : 0.0f;
+        if (is_on) {
+            relay_w += pwr;
+            available_w -= pwr;
+        }
     }
 }
 
@@ -656,6 +1170,27 @@ void RouterController::processEcoMode(float power_grid) {
     // Do not increase load when exporting (conservative)
     // Slower response than AUTO mode for stability
 
+    PidController& pid = m_pid[static_cast<uint8_t>(PidLoop::ECO)];
+    if (pid.getGains().engine != ControlEngine::P) {
+        // Reduce-only: the current level is the upper output limit, so export is
+        // tolerated (integrator clamped there) and never raises the load.
+        const float u = pid.step(0.0f, power_grid, m_target_level, m_ctrl_dt_s,
+                                 0.0f, m_target_level, m_status.balance_threshold);
+        if (u < m_target_level) {
+            applyDimmerLevel(u);
+        }
+        pid.track(m_target_level);
+        updateState(power_grid);
+
+        static uint32_t last_pid_log = 0;
+        if (millis() - last_pid_log >= 5000) {
+            ESP_LOGI(TAG, "ECO: P_grid=%.1fW, P=%.2f I=%.2f D=%.2f, dimmer=%d%%",
+                     power_grid, pid.lastP(), pid.lastI(), pid.lastD(), m_status.dimmer_percent);
+            last_pid_log = millis();
+        }
+        return;
+    }
+
     // Check if importing from grid (beyond threshold)
     if (power_grid > m_status.balance_threshold) {
         // Importing from grid - reduce load
@@ -714,6 +1249,7 @@ void RouterController::failsafeDecay() {
         applyDimmerLevel(m_target_level - 1.0f);
     }
     m_status.state = RouterState::DECREASING;
+    resetPidLoops();   // resume from wherever the decay left the load
 }
 
 // ============================================================
@@ -731,7 +1267,22 @@ void RouterController::processGridLimitMode(float grid_current_a) {
 
     m_status.power_grid = 0.0f;  // no voltage → no real power; report 0 W (current-only)
 
-    if (error < -RouterConfig::GRID_LIMIT_DEADBAND_A) {
+    PidController& pid = m_pid[static_cast<uint8_t>(PidLoop::GRID_LIMIT)];
+    if (pid.getGains().engine != ControlEngine::P) {
+        const float u = pid.step(m_grid_current_limit_a, grid_current_a, m_target_level, m_ctrl_dt_s,
+                                 RouterConfig::MIN_DIMMER_PERCENT, RouterConfig::MAX_DIMMER_PERCENT,
+                                 RouterConfig::GRID_LIMIT_DEADBAND_A);
+        if (u > m_target_level + 0.01f) {
+            m_status.state = RouterState::INCREASING;
+        } else if (u < m_target_level - 0.01f) {
+            m_status.state = RouterState::DECREASING;
+        } else {
+            m_status.state = (m_status.dimmer_percent >= RouterConfig::MAX_DIMMER_PERCENT)
+                                 ? RouterState::AT_MAXIMUM : RouterState::IDLE;
+        }
+        applyDimmerLevel(u);
+        pid.track(m_target_level);
+    } else if (error < -RouterConfig::GRID_LIMIT_DEADBAND_A) {
         // Over the limit — reduce load. error<0 → negative step.
         m_target_level += error / RouterConfig::GRID_LIMIT_GAIN;
         applyDimmerLevel(m_target_level);
@@ -758,6 +1309,62 @@ void RouterController::processGridLimitMode(float grid_current_a) {
     }
 }
 
+// ============================================================
+// PI/PID engine
+// ============================================================
+
+PidGains RouterController::defaultPidGains(PidLoop loop) {
+    switch (loop) {
+        case PidLoop::AUTO:
+            return PidGains(ControlEngine::P, RouterConfig::AUTO_KP, RouterConfig::AUTO_KI,
+                            RouterConfig::AUTO_KD);
+        case PidLoop::ECO:
+            return PidGains(ControlEngine::P, RouterConfig::ECO_KP, RouterConfig::ECO_KI,
+                            RouterConfig::ECO_KD);
+        case PidLoop::GRID_LIMIT:
+        default:
+            return PidGains(ControlEngine::P, RouterConfig::GRID_LIMIT_KP, RouterConfig::GRID_LIMIT_KI,
+                            RouterConfig::GRID_LIMIT_KD);
+    }
+}
+
+void RouterController::setPidGains(PidLoop loop, const PidGains& gains) {
+    if (loop >= PidLoop::COUNT) {
+        return;
+    }
+    auto clampGain = [](float g) {
+        if (!isfinite(g) || g < 0.0f) return 0.0f;
+        return (g > RouterConfig::PID_MAX_GAIN) ? RouterConfig::PID_MAX_GAIN : g;
+    };
+    PidGains g = gains;
+    if (g.engine > ControlEngine::PID) g.engine = ControlEngine::P;
+    g.kp = clampGain(g.kp);
+    g.ki = clampGain(g.ki);
+    g.kd = clampGain(g.kd);
+
+    // The control task reads the gains under the map lock (update()); take it too.
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
+    m_pid[static_cast<uint8_t>(loop)].setGains(g);
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
+
+    ESP_LOGI(TAG, "PID loop %u: engine=%u kp=%.4f ki=%.4f kd=%.4f",
+             static_cast<unsigned>(loop), static_cast<unsigned>(g.engine), g.kp, g.ki, g.kd);
+}
+
+const PidGains& RouterController::getPidGains(PidLoop loop) const {
+    if (loop >= PidLoop::COUNT) loop = PidLoop::AUTO;
+    return m_pid[static_cast<uint8_t>(loop)].getGains();
+}
+
+void RouterController::resetPidLoops() {
+    for (uint8_t i = 0; i < static_cast<uint8_t>(PidLoop::COUNT); i++) {
+        m_pid[i].reset();
+    }
+    m_ff_primed = false;    // feed-forward re-references on the next AUTO cycle
+    m_plant_primed = false; // plant estimators restart their move history
+    m_move_count = 0;       // a restart re-reads the plant as it is
+}
+
 void RouterController::setGridCurrentLimit(float amps) {
     if (amps < 0.0f) amps = 0.0f;
     if (amps > RouterConfig::MAX_GRID_CURRENT_LIMIT_A) amps = RouterConfig::MAX_GRID_CURRENT_LIMIT_A;
@@ -800,6 +1407,7 @@ void RouterController::applyDimmerLevel(float level) {
     if (percent != m_status.dimmer_percent) {
         esp_err_t err = dimmer_set_level(m_dimmer_id, percent);
         if (err == ESP_OK) {
+            m_actuated = true;
             m_status.dimmer_percent = percent;
             m_status.target_level = m_target_level;
         } else {
@@ -833,8 +1441,13 @@ void RouterController::setMode(RouterMode mode) {
         return;  // No change
     }
 
+    // The control task runs the mode and its loops under the map lock (update());
+    // switch both under it too, so a cycle never sees the new mode with old loop state.
+    if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
     RouterMode old_mode = m_status.mode;
     m_status.mode = mode;
+    resetPidLoops();   // the new mode's loop starts from the current level (bumpless)
+    if (m_priority_mutex) xSemaphoreGive(m_priority_mutex);
 
     ESP_LOGI(TAG, "Mode changed: %d -> %d", static_cast<int>(old_mode), static_cast<int>(mode));
 
@@ -998,6 +1611,9 @@ void RouterController::rebuildPriorityMap() {
     // iterates a half-freed map (D2). Callable from begin() and MQTT/web tasks.
     if (m_priority_mutex) xSemaphoreTake(m_priority_mutex, portMAX_DELAY);
 
+    // Keep what the levels learned; it is matched back below by configuration.
+    stashPlantEstimates();
+
     // Free existing allocations
     for (uint8_t i = 0; i < m_active_priority_count; i++) {
         if (m_priority_levels[i].devices) {
@@ -1093,6 +1709,8 @@ void RouterController::rebuildPriorityMap() {
         level->device_count = 0;
         level->total_power_w = temp_priorities[i].total_power;
         level->devices = new DeviceRef[level->device_capacity];
+        level->plant.reset();
+        level->plant_gain = 1.0f;
     }
     m_active_priority_count = temp_count;
 
@@ -1106,7 +1724,10 @@ void RouterController::rebuildPriorityMap() {
         for (uint8_t i = 0; i < m_active_priority_count; i++) {
             if (m_priority_levels[i].priority == pri) {
                 PriorityLevel* level = &m_priority_levels[i];
-                level->devices[level->device_count++] = DeviceRef(DeviceType::DIMMER, id, pwr);
+                DeviceRef dev(DeviceType::DIMMER, id, pwr);
+                dev.curve = dimmer_get_output_curve(id);
+                dev.target_level = (float)dimmer_get_level(id);   // resume, not restart from 0
+                level->devices[level->device_count++] = dev;
                 ESP_LOGD(TAG, "  Dimmer %d: priority=%d, power=%dW", id, pri, pwr);
                 break;
             }
@@ -1140,15 +1761,37 @@ void RouterController::rebuildPriorityMap() {
         }
     }
 
+    // Resume the plant-gain estimate of every level whose configuration is unchanged
+    // (same priority, type, device count and nominal power) — a new heater on a level
+    // invalidates what it learned.
+    for (uint8_t i = 0; i < m_active_priority_count; i++) {
+        PriorityLevel& level = m_priority_levels[i];
+        for (uint8_t r = 0; r < MAX_PRIORITY_LEVELS; r++) {
+            const PlantGainRecord& rec = m_plant_store[r];
+            if (rec.valid && rec.priority == level.priority &&
+                rec.type == static_cast<uint8_t>(level.device_type) &&
+                rec.device_count == level.device_count && rec.total_power_w == level.total_power_w) {
+                level.plant.restore(rec.taps, rec.samples);
+                if (m_plant_mode == PlantTuning::ADAPT &&
+                    level.plant.samples() >= RouterConfig::PLANT_MIN_SAMPLES) {
+                    level.plant_gain = level.plant.gain();
+                }
+                break;
+            }
+        }
+    }
+    m_plant_primed = false;
+
     // Summary
     ESP_LOGI(TAG, "Priority map built: %d active priority levels", m_active_priority_count);
     for (uint8_t i = 0; i < m_active_priority_count; i++) {
         const char* type_str = (m_priority_levels[i].device_type == DeviceType::DIMMER) ? "Dimmers" : "Relays";
-        ESP_LOGI(TAG, "  Priority %d: %d %s, total %lu W",
+        ESP_LOGI(TAG, "  Priority %d: %d %s, total %lu W, plant gain %.2f",
                  m_priority_levels[i].priority,
                  m_priority_levels[i].device_count,
                  type_str,
-                 (unsigned long)m_priority_levels[i].total_power_w);
+                 (unsigned long)m_priority_levels[i].total_power_w,
+                 m_priority_levels[i].plant_gain);
     }
 
     // Auto-bind the primary (single-dimmer legacy API) output to the first enabled
@@ -243,6 +243,12 @@ public:
      */
     void publishRelaysStatus();
 
+    /**
+     * @brief Publish ESP-NOW PERIOD energy totals (json/energy)
+     * @param force Publish even if no total changed since the last publish
+     */
+    void publishEnergy(bool force);
+
     /**
      * @brief Force publish all data immediately
      */
@@ -460,6 +466,7 @@ private:
     uint8_t _lastDimmer;                ///< Last published primary dimmer level
     uint8_t _lastDimmers[DIMMER_MAX_COUNT]; ///< Last published dimmer levels by id (255 = not yet published)
     int8_t _lastRelays[4];              ///< Last published relay states (-1 = not yet published, else 0/1)
+    uint32_t _lastEnergyUpdates;        ///< Energy store update count last published (UINT32_MAX = never)
 
     // Error handling
     char _lastError[64];                ///< Last error message
@@ -149,6 +149,9 @@ private:
     void handleGetEspnowNodes();     // GET /api/espnow/nodes
     void handleSetEspnowNode();      // POST /api/espnow/nodes
     void handleGetEspnowOutputs();   // GET /api/espnow/outputs
+    void handleGetEspnowEnergy();    // GET /api/espnow/energy
+    void handleGetEspnowSync();      // GET /api/espnow/sync
+    void handleEspnowLatch();        // POST /api/espnow/latch
 
     // --- Auth (A3: bearer token on write/OTA; GET open; unset = open dev mode) ---
     void loadAuthToken();            // read persisted token from NVS into _auth_token
@@ -14,6 +14,7 @@
 #endif
 #if CONFIG_ACROUTER_ESPNOW_SOURCE
 #include "esp_now_source.h"
+#include "esp_now_energy.h"
 #endif
 
 // New dimmer manager (pure C API)
@@ -123,6 +124,7 @@ MQTTManager::MQTTManager()
     , _lastMode(255)
     , _lastState(255)
     , _lastDimmer(255)
+    , _lastEnergyUpdates(UINT32_MAX)
 {
     memset(_lastError, 0, sizeof(_lastError));
     memset(_lastDimmers, 255, sizeof(_lastDimmers));
@@ -207,6 +209,7 @@ void MQTTManager::loop() {
         publishStatus();
         publishDimmersStatus();
         publishRelaysStatus();
+        publishEnergy(false);
     }
 
     // Periodic system info publishing
@@ -588,6 +591,27 @@ void MQTTManager::publishStatus() {
     doc["dimmer"] = status.dimmer_percent;
     doc["wifi_rssi"] = getWiFiRSSI();
     doc["valid"] = status.valid;
+    ControlLatency lat;
+    _router->getControlLatency(lat);
+    doc["deadtime_comp"] = lat.deadtime_comp;
+    doc["latency_p99_ms"] = lat.p99_ms;
+    // AUTO plant-gain tuning: per priority level estimate
+    static const char* tuneNames[] = {"off", "learn", "adapt"};
+    uint8_t tuneIdx = static_cast<uint8_t>(_router->getPlantTuning());
+    doc["plant_tuning"] = tuneNames[tuneIdx <= 2 ? tuneIdx : 0];
+    PlantGainInfo est[8];
+    uint8_t estCount = _router->getPlantEstimates(est, 8);
+    JsonArray plant = doc["plant"].to<JsonArray>();
+    for (uint8_t i = 0; i < estCount; i++) {
+        JsonObject p = plant.add<JsonObject>();
+        p["priority"] = est[i].priority;
+        p["type"] = (est[i].type == DeviceType::RELAY) ? "relay" : "dimmer";
+        p["nominal_w"] = est[i].nominal_w;
+        p["gain"] = est[i].gain;
+        p["w_per_pct"] = est[i].w_per_pct;
+        p["applied_gain"] = est[i].applied_gain;
+        p["samples"] = est[i].samples;
+    }
 
     String json;
     serializeJson(doc, json);
@@ -727,6 +751,44 @@ void MQTTManager::publishRelaysStatus() {
     publish(buildTopic("json", "relays").c_str(), json.c_str(), true, 1);
 }
 
+// ESP-NOW PERIOD energy totals (import/export Wh per node channel), retained.
+// Checked at the status cadence, published only when a PERIOD changed a total.
+void MQTTManager::publishEnergy(bool force) {
+#if CONFIG_ACROUTER_ESPNOW_SOURCE
+    esp_now_energy_stats_t st;
+    esp_now_energy_get_stats(&st);
+    if (!force && st.updates == _lastEnergyUpdates) return;
+    esp_now_energy_node_t nodes[ESP_NOW_ENERGY_NODES];
+    size_t n = 0;
+    esp_now_energy_get(nodes, ESP_NOW_ENERGY_NODES, &n);
+    _lastEnergyUpdates = st.updates;
+
+    JsonDocument doc;
+    JsonArray arr = doc["nodes"].to<JsonArray>();
+    for (size_t i = 0; i < n; i++) {
+        JsonObject o = arr.add<JsonObject>();
+        char mac_str[18];
+        snprintf(mac_str, sizeof(mac_str), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 nodes[i].mac[0], nodes[i].mac[1], nodes[i].mac[2],
+                 nodes[i].mac[3], nodes[i].mac[4], nodes[i].mac[5]);
+        o["mac"] = mac_str;
+        JsonArray chs = o["channels"].to<JsonArray>();
+        for (uint8_t c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+            if (!(nodes[i].ch_mask & (1u << c))) continue;
+            JsonObject co = chs.add<JsonObject>();
+            co["channel"]   = c;
+            co["import_wh"] = nodes[i].ch[c].import_wh;
+            co["export_wh"] = nodes[i].ch[c].export_wh;
+        }
+    }
+    String json;
+    serializeJson(doc, json);
+    publish(buildTopic("json", "energy").c_str(), json.c_str(), true, 1);
+#else
+    (void)force;
+#endif
+}
+
 // ============================================================================
 // Publishing - Metrics
 // ============================================================================
@@ -935,6 +997,7 @@ void MQTTManager::publishAll() {
     publishStatus();
     publishDimmersStatus();
     publishRelaysStatus();
+    publishEnergy(true);
     publishMetrics();
     publishConfig();
     publishConfigState();  // retained whole-config on connect, so a Remote-UI client
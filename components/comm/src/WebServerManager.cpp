@@ -49,6 +49,7 @@ extern "C" {
 // v2.0: DimmerLink I2C modules and Sensor Hub
 extern "C" {
 #include "i2c_bus.h"
+#include "i2c_bus_health.h"
 #include "dimmerlink_regs.h"
 #include "dimmerlink_types.h"
 #include "dimmerlink_manager.h"
@@ -57,6 +58,7 @@ extern "C" {
 #include "sensor_hub.h"
 #include "rbamp_source.h"
 #include "esp_now_source.h"
+#include "esp_now_energy.h"
 #include "espnow_proto.h"
 #include "nvs.h"
 }
@@ -409,6 +411,10 @@ void WebServerManager::setupRoutes() {
     _http_server->on("/api/espnow/nodes",         HTTP_POST, [this]() { if (!requireAuth()) return; handleSetEspnowNode(); });
     _http_server->on("/api/espnow/nodes",         HTTP_OPTIONS, corsHandler);
     _http_server->on("/api/espnow/outputs",       HTTP_GET,  [this]() { handleGetEspnowOutputs(); });
+    _http_server->on("/api/espnow/energy",        HTTP_GET,  [this]() { handleGetEspnowEnergy(); });
+    _http_server->on("/api/espnow/sync",          HTTP_GET,  [this]() { handleGetEspnowSync(); });
+    _http_server->on("/api/espnow/latch",         HTTP_POST, [this]() { if (!requireAuth()) return; handleEspnowLatch(); });
+    _http_server->on("/api/espnow/latch",         HTTP_OPTIONS, corsHandler);
     for (int i = 0; i < DL_MAX_DEVICES; i++) {
         int slot = i;
         String path = "/api/dimmerlink/" + String(i) + "/status";
@@ -871,6 +877,28 @@ String WebServerManager::buildStatusJson() {
     doc["control_gain"] = st.control_gain;
     doc["balance_threshold"] = st.balance_threshold;
     doc["valid"] = st.valid;
+    doc["ff_enabled"] = router.isFeedForwardEnabled();   // AUTO load/solar feed-forward
+    doc["ff_active"] = st.ff_active;
+    doc["ff_error_w"] = st.ff_error_w;
+    doc["ff_power_w"] = st.ff_power_w;
+    doc["deadtime_comp"] = router.isDeadTimeCompensationEnabled();   // AUTO dead-time compensation
+    // AUTO plant-gain tuning: per priority level estimate
+    static const char* tuneNames[] = {"off", "learn", "adapt"};
+    uint8_t tuneIdx = static_cast<uint8_t>(router.getPlantTuning());
+    doc["plant_tuning"] = tuneNames[tuneIdx <= 2 ? tuneIdx : 0];
+    PlantGainInfo est[8];
+    uint8_t estCount = router.getPlantEstimates(est, 8);
+    JsonArray plant = doc["plant"].to<JsonArray>();
+    for (uint8_t i = 0; i < estCount; i++) {
+        JsonObject p = plant.add<JsonObject>();
+        p["priority"] = est[i].priority;
+        p["type"] = (est[i].type == DeviceType::RELAY) ? "relay" : "dimmer";
+        p["nominal_w"] = est[i].nominal_w;
+        p["gain"] = est[i].gain;
+        p["w_per_pct"] = est[i].w_per_pct;
+        p["applied_gain"] = est[i].applied_gain;
+        p["samples"] = est[i].samples;
+    }
 
     doc["uptime"] = millis() / 1000;
     doc["free_heap"] = ESP.getFreeHeap();
@@ -973,6 +1001,18 @@ String WebServerManager::buildMetricsJson() {
     if (sg.valid && di < 4) metrics["direction"] = dirNames[di];
     else                    metrics["direction"] = static_cast<const char*>(nullptr);
 
+    // Control latency: source acquisition -> output command (last 128 actuations)
+    ControlLatency lat;
+    router.getControlLatency(lat);
+    JsonObject cl = doc["control_latency"].to<JsonObject>();
+    cl["p50_ms"] = lat.p50_ms;
+    cl["p99_ms"] = lat.p99_ms;
+    cl["max_ms"] = lat.max_ms;
+    cl["samples"] = lat.samples;
+    cl["age_ms"] = lat.age_ms;
+    cl["deadtime_comp"] = lat.deadtime_comp;
+    cl["pending_w"] = lat.pending_w;
+
     // Dimmers array — DimmerLink outputs only (I2C + ESP-NOW). v2.0: legacy GPIO/direct-TRIAC
     // dimmers removed; dimming is only via DimmerLink. Light live shape for the dashboard
     // stream (level/target/enabled/online/transitioning); config detail is in /api/dimmers/status.
@@ -1483,7 +1523,8 @@ void WebServerManager::handleSetHardwareConfig() {
     // Sensing is commissioned per module via /api/rbamp/modules and /api/espnow/nodes.
 
     // Parse I2C (Tier-1 transport). Nested i2c{ bus0{sda,scl,freq_khz,enabled},
-    // bus1{...}, rbamp_bus, rbamp_drdy_gpio }.
+    // bus1{...}, max_freq_khz, rbamp_bus, rbamp_drdy_gpio,
+    // rbamp_drdy_modules[{addr,gpio}] }. The module list replaces the saved one.
     if (doc["i2c"].is<JsonObject>()) {
         JsonObject i2c = doc["i2c"];
         if (i2c["bus0"].is<JsonObject>()) {
@@ -1500,8 +1541,27 @@ void WebServerManager::handleSetHardwareConfig() {
             if (b.containsKey("freq_khz")) config.i2c1_freq_hz  = (uint32_t)((uint16_t)(b["freq_khz"] | 100)) * 1000;
             if (b.containsKey("enabled"))  config.i2c1_enabled  = b["enabled"] | config.i2c1_enabled;
         }
+        if (i2c.containsKey("max_freq_khz")) {
+            uint16_t khz = i2c["max_freq_khz"] | 0;
+            config.i2c_max_freq_hz = (uint32_t)(khz > 400 ? 400 : khz) * 1000;
+        }
         if (i2c.containsKey("rbamp_bus"))       config.rbamp_i2c_bus  = i2c["rbamp_bus"] | config.rbamp_i2c_bus;
         if (i2c.containsKey("rbamp_drdy_gpio")) config.rbamp_drdy_gpio = (int8_t)(i2c["rbamp_drdy_gpio"] | config.rbamp_drdy_gpio);
+        if (i2c["rbamp_drdy_modules"].is<JsonArray>()) {
+            uint8_t n = 0;
+            for (JsonObject m : i2c["rbamp_drdy_modules"].as<JsonArray>()) {
+                uint8_t addr = m["addr"] | 0;
+                int gpio = m["gpio"] | -1;
+                if (addr < 0x08 || addr > 0x77 || gpio < 0 || n >= HW_RBAMP_DRDY_LINES) continue;
+                config.rbamp_drdy_addr[n] = addr;
+                config.rbamp_drdy_line[n] = (int8_t)gpio;
+                n++;
+            }
+            for (; n < HW_RBAMP_DRDY_LINES; n++) {
+                config.rbamp_drdy_addr[n] = 0;
+                config.rbamp_drdy_line[n] = -1;
+            }
+        }
     }
 
     // Parse ESP-NOW transport (Tier-1 hardware)
@@ -1693,8 +1753,16 @@ String WebServerManager::buildHardwareConfigJson() {
     bus1["scl"] = config.i2c1_scl_gpio;
     bus1["freq_khz"] = (uint16_t)(config.i2c1_freq_hz / 1000);
     bus1["enabled"] = config.i2c1_enabled;
+    i2c["max_freq_khz"] = (uint16_t)(config.i2c_max_freq_hz / 1000);  // 0 = fixed clock
     i2c["rbamp_bus"] = config.rbamp_i2c_bus;         // 0|1
     i2c["rbamp_drdy_gpio"] = config.rbamp_drdy_gpio;  // -1 = timer poll
+    JsonArray drdyMods = i2c["rbamp_drdy_modules"].to<JsonArray>();  // per-module lines
+    for (uint8_t i = 0; i < HW_RBAMP_DRDY_LINES; i++) {
+        if (!config.rbamp_drdy_addr[i]) continue;
+        JsonObject m = drdyMods.add<JsonObject>();
+        m["addr"] = config.rbamp_drdy_addr[i];
+        m["gpio"] = config.rbamp_drdy_line[i];
+    }
 
     // ========================================
     // Dimmers Section
@@ -2791,6 +2859,51 @@ void WebServerManager::handleI2CStatus() {
         doc["dimmerlink_enabled"] = dl_manager_get_enabled_count();
         doc["dimmerlink_active"] = dl_manager_get_active_count();
     }
+    // Per-bus utilisation over the last 1 s window (i2c_bus transactions + rbAmp polls)
+    const HardwareConfig& hw = HardwareConfigManager::getInstance().getConfig();
+    JsonArray buses = doc["buses"].to<JsonArray>();
+    for (uint8_t b = 0; b < I2C_BUS_MAX; b++) {
+        JsonObject o = buses.add<JsonObject>();
+        o["bus"] = b;
+        o["initialized"] = i2c_bus_is_initialized(b);
+        i2c_bus_util_t ut;
+        if (i2c_bus_get_utilisation(b, &ut) != ESP_OK) continue;
+        o["util_pct"]  = ut.util_permille / 10.0f;
+        o["peak_pct"]  = ut.peak_permille / 10.0f;
+        o["busy_us"]   = ut.busy_us;
+        o["window_us"] = ut.window_us;
+        o["xfers"]     = ut.xfers;
+        o["dimmerlink"] = dl_manager_is_initialized() ? dl_manager_get_bus_count(b) : 0;
+        o["rbamp"]     = (hw.rbamp_i2c_bus == b) ? (unsigned)rbamp_source_alive_count() : 0;
+
+        // Bus health: clock policy and per-device error / latency record
+        i2c_bus_health_t hl;
+        if (i2c_bus_get_health(b, &hl) != ESP_OK) continue;
+        o["freq_hz"]       = hl.freq_hz;
+        o["adaptive"]      = hl.adaptive;
+        o["max_freq_hz"]   = hl.max_hz;
+        o["clock_up"]      = hl.steps_up;
+        o["clock_down"]    = hl.steps_down;
+        o["backed_off"]    = hl.backed_off;
+        JsonArray devs = o["devices"].to<JsonArray>();
+        i2c_bus_dev_health_t dh;
+        for (uint8_t i = 0; i2c_bus_get_device_health(b, i, &dh) == ESP_OK; i++) {
+            JsonObject d = devs.add<JsonObject>();
+            char addr_str[8];
+            snprintf(addr_str, sizeof(addr_str), "0x%02X", dh.addr);
+            d["addr"]        = addr_str;
+            d["ok"]          = dh.ok;
+            d["nack"]        = dh.nack;
+            d["timeout"]     = dh.timeout;
+            d["other"]       = dh.other;
+            d["skipped"]     = dh.skipped;
+            d["consec_fail"] = dh.consec_fail;
+            d["backoff_ms"]  = dh.backoff_left_ms;
+            d["lat_max_us"]  = dh.lat_us_max;
+            JsonArray hist = d["lat_hist"].to<JsonArray>();
+            for (uint8_t k = 0; k < I2C_BUS_LAT_BUCKETS; k++) hist.add(dh.lat_hist[k]);
+        }
+    }
     String json;
     serializeJson(doc, json);
     sendJsonResponse(200, json);
@@ -2927,16 +3040,22 @@ void WebServerManager::handleGetRbampModules() {
         snprintf(addr_str, sizeof(addr_str), "0x%02X", mods[i].i2c_addr);
         o["addr"]         = addr_str;
         o["role"]         = rbamp_role_name(mods[i].role);
+        JsonArray chr = o["channel_roles"].to<JsonArray>();
+        for (uint8_t c = 0; c < mods[i].channels && c < RBAMP_SOURCE_MAX_CHANNELS; c++) {
+            chr.add(rbamp_role_name(mods[i].ch_role[c]));
+        }
         o["channels"]     = mods[i].channels;
         o["has_voltage"]  = mods[i].has_voltage;
         o["online"]       = mods[i].online;
+        o["fw_version"]   = mods[i].fw_version;   // config cache, 0 = not read yet
+        o["hw_variant"]   = mods[i].hw_variant;
         // Last snapshot (primary channel). NaN -> null (field unavailable).
         o["voltage"]      = mods[i].voltage;
         o["current"]      = mods[i].current;
         o["power"]        = mods[i].power;
         o["power_factor"] = mods[i].power_factor;
         o["frequency"]    = mods[i].frequency;
-        // Applied CT model (poll-task cache): catalog id, or null if unset.
+        // Applied CT model (configuration cache): catalog id, or null if unset.
         uint8_t ct_code = 0;
         rbamp_source_get_ct_model(mods[i].i2c_addr, &ct_code);
         if (ct_code == 0) {
@@ -2952,15 +3071,16 @@ void WebServerManager::handleGetRbampModules() {
     }
 
     // Persisted role assignments (may include not-currently-online addresses).
-    rbamp_source_module_cfg_t roles[4];
+    rbamp_source_module_cfg_t roles[RBAMP_SOURCE_MAX_ROLES];
     size_t nr = 0;
-    rbamp_source_get_roles(roles, 4, &nr);
+    rbamp_source_get_roles(roles, RBAMP_SOURCE_MAX_ROLES, &nr);
     JsonArray rarr = doc["roles"].to<JsonArray>();
     for (size_t i = 0; i < nr; i++) {
         JsonObject o = rarr.add<JsonObject>();
         char addr_str[8];
         snprintf(addr_str, sizeof(addr_str), "0x%02X", roles[i].i2c_addr);
         o["addr"] = addr_str;
+        o["channel"] = roles[i].channel;
         o["role"] = rbamp_role_name((rbamp_source_role_t)roles[i].role);
     }
 
@@ -3010,7 +3130,12 @@ void WebServerManager::handleSetRbampModule() {
     else if (strcmp(role_str, "none") == 0)    role = RBAMP_ROLE_NONE;
     else { sendError(400, "Invalid role (grid|solar|load|voltage|none)"); return; }
 
-    esp_err_t err = rbamp_source_set_role(addr, role);
+    const uint8_t channel = body["channel"] | 0;
+    esp_err_t err = rbamp_source_set_channel_role(addr, channel, role);
+    if (err == ESP_ERR_INVALID_ARG) {
+        sendError(400, "channel out of range (0-2)");
+        return;
+    }
     if (err != ESP_OK) {
         sendError(500, esp_err_to_name(err));
         return;
@@ -3195,13 +3320,29 @@ void WebServerManager::handleGetModules() {
             o["uid"] = uid;
         }
     }
+    devreg_scan_stats_t ss;
+    devreg_get_scan_stats(&ss);
+    if (ss.total_ms) {
+        JsonObject ls = doc["last_scan"].to<JsonObject>();
+        ls["bus"]          = ss.bus;
+        ls["known"]        = ss.known;
+        ls["known_online"] = ss.known_online;
+        ls["known_ms"]     = ss.known_ms;
+        ls["quiesce_ms"]   = ss.quiesce_ms;
+        ls["swept"]        = ss.swept;
+        ls["found_new"]    = ss.found_new;
+        ls["reads"]        = ss.reads;
+        ls["uid_hits"]     = ss.uid_hits;
+        ls["total_ms"]     = ss.total_ms;
+        ls["rbamp_rescan"] = ss.rbamp_rescan;
+    }
     String json;
     serializeJson(doc, json);
     sendJsonResponse(200, json);
 }
 
-// POST /api/modules/rescan — on-demand quiescent scan + non-destructive reconcile.
-// --- Async I2C rescan: the ~2.5s bus walk runs in a worker task, off the web task
+// POST /api/modules/rescan — on-demand incremental scan + non-destructive reconcile.
+// --- Async I2C rescan: the sliced bus walk runs in a worker task, off the web task
 // (on the C2, 1 request in flight, a blocking scan froze the whole UI). POST returns
 // 202 {scanning:true} immediately; a second POST while busy → 409. The client polls
 // GET /api/modules until its `scanning` flag clears, then the list is fresh.
@@ -3275,6 +3416,16 @@ static const char* espnow_role_name(esp_now_source_role_t r) {
 void WebServerManager::handleGetEspnowNodes() {
     JsonDocument doc;
     doc["seen"] = esp_now_source_seen_count();
+    // RX path: recv-callback -> Sensor Hub publish latency (last 128 posts)
+    esp_now_source_rx_stats_t rx;
+    esp_now_source_get_rx_stats(&rx);
+    JsonObject ro = doc["rx"].to<JsonObject>();
+    ro["frames"]    = rx.frames;
+    ro["posts"]     = rx.posts;
+    ro["coalesced"] = rx.coalesced;
+    ro["p50_us"]    = rx.p50_us;
+    ro["p99_us"]    = rx.p99_us;
+    ro["max_us"]    = rx.max_us;
     esp_now_source_node_info_t nodes[4];
     size_t n = 0;
     esp_now_source_get_nodes(nodes, 4, &n);
@@ -3293,6 +3444,18 @@ void WebServerManager::handleGetEspnowNodes() {
         o["power"]        = nodes[i].power;
         o["power_factor"] = nodes[i].power_factor;
         o["frequency"]    = nodes[i].frequency;
+        // Every channel the last REALTIME frame carried, or that has a role.
+        JsonArray chs = o["channels"].to<JsonArray>();
+        for (uint8_t c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+            const bool in_frame = nodes[i].ch_mask & (1u << c);
+            if (!in_frame && nodes[i].ch_role[c] == ESPNOW_ROLE_NONE) continue;
+            JsonObject co = chs.add<JsonObject>();
+            co["channel"] = c;
+            co["role"]    = espnow_role_name(nodes[i].ch_role[c]);
+            co["live"]    = in_frame;
+            co["current"] = nodes[i].ch_current[c];
+            co["power"]   = nodes[i].ch_power[c];
+        }
     }
     String json;
     serializeJson(doc, json);
@@ -3308,6 +3471,17 @@ void WebServerManager::handleGetEspnowOutputs() {
     esp_now_source_output_node_info_t nodes[ESP_NOW_SOURCE_OUT_NODES_MAX];
     size_t n = 0;
     esp_now_source_get_output_nodes(nodes, ESP_NOW_SOURCE_OUT_NODES_MAX, &n);
+    // TX path: frames vs values carried, digest keep-alives, node-requested resyncs
+    esp_now_source_out_stats_t tx;
+    esp_now_source_get_out_stats(&tx);
+    JsonObject to = doc["tx"].to<JsonObject>();
+    to["frames"]    = tx.frames;
+    to["batched"]   = tx.batched;
+    to["items"]     = tx.items;
+    to["digests"]   = tx.digests;
+    to["resyncs"]   = tx.resyncs;
+    to["unchanged"] = tx.unchanged;
+    to["send_fail"] = tx.send_fail;
     JsonArray arr = doc["nodes"].to<JsonArray>();
     for (size_t i = 0; i < n; i++) {
         JsonObject o = arr.add<JsonObject>();
@@ -3320,6 +3494,7 @@ void WebServerManager::handleGetEspnowOutputs() {
                       : nodes[i].family == RBN_FAMILY_RELAY  ? "relay" : "unknown";
         o["online"]   = nodes[i].online;
         o["failsafe"] = nodes[i].failsafe;
+        o["batch"]    = nodes[i].batch;
         JsonArray outs = o["outputs"].to<JsonArray>();
         for (uint8_t k = 0; k < nodes[i].out_count && k < ESP_NOW_SOURCE_OUT_PER_NODE; k++) {
             const esp_now_source_output_info_t* out = &nodes[i].outputs[k];
@@ -3339,6 +3514,109 @@ void WebServerManager::handleGetEspnowOutputs() {
     sendJsonResponse(200, json);
 }
 
+// GET /api/espnow/energy — billing energy accumulated from PERIOD frames, per node
+// and channel (import/export Wh), with the store's commit state.
+void WebServerManager::handleGetEspnowEnergy() {
+    JsonDocument doc;
+    esp_now_energy_stats_t st;
+    esp_now_energy_get_stats(&st);
+    doc["commit_interval_s"] = st.commit_interval_s;
+    doc["commits"]           = st.commits;
+    doc["pending"]           = st.dirty;
+    doc["rejected_full"]     = st.rejected_full;
+    esp_now_energy_node_t nodes[ESP_NOW_ENERGY_NODES];
+    size_t n = 0;
+    esp_now_energy_get(nodes, ESP_NOW_ENERGY_NODES, &n);
+    JsonArray arr = doc["nodes"].to<JsonArray>();
+    for (size_t i = 0; i < n; i++) {
+        JsonObject o = arr.add<JsonObject>();
+        char mac_str[18];
+        snprintf(mac_str, sizeof(mac_str), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 nodes[i].mac[0], nodes[i].mac[1], nodes[i].mac[2],
+                 nodes[i].mac[3], nodes[i].mac[4], nodes[i].mac[5]);
+        o["mac"]          = mac_str;
+        o["frames"]       = nodes[i].frames;
+        o["duplicates"]   = nodes[i].duplicates;
+        o["skipped"]      = nodes[i].skipped;
+        o["restarts"]     = nodes[i].restarts;
+        o["last_node_ts"] = nodes[i].last_node_ts;
+        JsonArray chs = o["channels"].to<JsonArray>();
+        for (uint8_t c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+            if (!(nodes[i].ch_mask & (1u << c))) continue;
+            JsonObject co = chs.add<JsonObject>();
+            co["channel"]     = c;
+            co["period_type"] = nodes[i].ch[c].period_type;
+            co["periods"]     = nodes[i].ch[c].periods;
+            co["import_wh"]   = nodes[i].ch[c].import_wh;
+            co["export_wh"]   = nodes[i].ch[c].export_wh;
+        }
+    }
+    String json;
+    serializeJson(doc, json);
+    sendJsonResponse(200, json);
+}
+
+// GET /api/espnow/sync — time master (beacon counters) and, per node, the offset
+// and jitter the node reports against the hub clock in NODE_STATS.
+void WebServerManager::handleGetEspnowSync() {
+    JsonDocument doc;
+    esp_now_source_sync_stats_t st;
+    esp_now_source_sync_node_t nodes[ESP_NOW_SOURCE_MAX_NODES];
+    size_t n = 0;
+    esp_now_source_get_sync(&st, nodes, ESP_NOW_SOURCE_MAX_NODES, &n);
+    doc["enabled"]     = st.enabled;
+    doc["interval_ms"] = st.interval_ms;
+    doc["epoch"]       = st.epoch;
+    doc["beacon_id"]   = st.beacon_id;
+    doc["beacons"]     = st.beacons;
+    doc["followups"]   = st.followups;
+    doc["tx_fail"]     = st.tx_fail;
+    doc["time_resps"]  = st.time_resps;
+    doc["time_unset"]  = st.time_unset;
+    doc["latches"]     = st.latches;
+    JsonArray arr = doc["nodes"].to<JsonArray>();
+    for (size_t i = 0; i < n; i++) {
+        JsonObject o = arr.add<JsonObject>();
+        char mac_str[18];
+        snprintf(mac_str, sizeof(mac_str), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 nodes[i].mac[0], nodes[i].mac[1], nodes[i].mac[2],
+                 nodes[i].mac[3], nodes[i].mac[4], nodes[i].mac[5]);
+        o["mac"]       = mac_str;
+        o["online"]    = nodes[i].online;
+        o["time_reqs"] = nodes[i].time_reqs;
+        if (nodes[i].age_ms == UINT32_MAX) continue;   // no NODE_STATS yet
+        o["age_ms"]         = nodes[i].age_ms;
+        o["offset_us"]      = nodes[i].offset_us;
+        o["jitter_us"]      = nodes[i].jitter_us;
+        o["max_abs_us"]     = nodes[i].max_abs_us;
+        o["skew_ppm"]       = nodes[i].skew_ppm;
+        o["beacons_recv"]   = nodes[i].beacons_recv;
+        o["followups_recv"] = nodes[i].followups_recv;
+        o["beacons_missed"] = nodes[i].beacons_missed;
+        o["fits"]           = nodes[i].fits;
+    }
+    String json;
+    serializeJson(doc, json);
+    sendJsonResponse(200, json);
+}
+
+// POST /api/espnow/latch — LATCH_NOW to every sensor node, so they all close
+// their current period at the same instant.
+void WebServerManager::handleEspnowLatch() {
+    size_t sent = 0;
+    esp_err_t err = esp_now_source_latch_now(RBN_LATCH_REASON_MANUAL, &sent);
+    if (err != ESP_OK) {
+        sendError(503, "ESP-NOW source not running");
+        return;
+    }
+    JsonDocument doc;
+    doc["success"] = true;
+    doc["sent"]    = sent;
+    String json;
+    serializeJson(doc, json);
+    sendJsonResponse(200, json);
+}
+
 void WebServerManager::handleSetEspnowNode() {
     JsonDocument body;
     if (deserializeJson(body, _http_server->arg("plain"))) {
@@ -3372,7 +3650,12 @@ void WebServerManager::handleSetEspnowNode() {
     else if (strcmp(role_str, "none") == 0)    role = ESPNOW_ROLE_NONE;
     else { sendError(400, "Invalid role (grid|solar|load|voltage|none)"); return; }
 
-    esp_err_t err = esp_now_source_set_role(m, role);
+    const uint8_t channel = body["channel"] | 0;
+    esp_err_t err = esp_now_source_set_channel_role(m, channel, role);
+    if (err == ESP_ERR_INVALID_ARG) {
+        sendError(400, "channel out of range (0-3)");
+        return;
+    }
     if (err != ESP_OK) {
         sendError(500, esp_err_to_name(err));
         return;
@@ -3501,6 +3784,21 @@ String WebServerManager::buildSensorHubJson() {
         sl["priority"] = s.priority;
         if (s.has_power) sl["power_w"] = s.power;
     }
+
+    sensor_hub_stats_t hs;
+    sensor_hub_get_stats(&hs);
+    JsonObject merge = doc["merge"].to<JsonObject>();
+    merge["mode"]              = (hs.mode == SH_MERGE_EPOCH) ? "epoch" : "per_frame";
+    merge["epoch_ms"]          = hs.epoch_ms;
+    merge["expected_mask"]     = hs.expected_mask;
+    merge["frames"]            = hs.frames_in;
+    merge["merges"]            = hs.merges;
+    merge["frames_suppressed"] = hs.frames_suppressed;
+    merge["epochs_complete"]   = hs.epochs_complete;
+    merge["epochs_deadline"]   = hs.epochs_deadline;
+    merge["frames_per_s"]      = hs.frames_per_s;
+    merge["merges_per_s"]      = hs.merges_per_s;
+    merge["snapshot_retries"]  = hs.snapshot_retries;
     String json;
     serializeJson(doc, json);
     return json;
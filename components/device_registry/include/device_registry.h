@@ -88,16 +88,54 @@ typedef struct {
 /** @brief Load the persisted registry from NVS (entries start offline). */
 esp_err_t devreg_init(void);
 
+/** Addresses probed per slice of the background sweep, and the gap after each */
+#define DEVREG_SCAN_SLICE      4
+#define DEVREG_SCAN_GAP_MS     100
+
+/** Polling pause before identifying legacy/new devices (in-flight polls drain) */
+#define DEVREG_SCAN_QUIESCE_MS 300
+
+/** @brief Counters of the last devreg_scan_i2c() run. */
+typedef struct {
+    uint8_t  bus;
+    uint8_t  known;          /**< registry addresses probed first */
+    uint8_t  known_online;   /**< ... that answered */
+    uint8_t  swept;          /**< other addresses probed in the background sweep */
+    uint8_t  found_new;      /**< devices added by the sweep */
+    uint8_t  uid_hits;       /**< identities taken from the UID fingerprint cache */
+    uint16_t reads;          /**< identification reads issued */
+    uint32_t known_ms;       /**< known v1.3+ address pass */
+    uint32_t quiesce_ms;     /**< polling paused for legacy/new identification (0 = none) */
+    uint32_t total_ms;       /**< whole scan incl. sweep gaps */
+    bool     rbamp_rescan;   /**< a new rbAmp was found and the fleet rescan requested */
+} devreg_scan_stats_t;
+
 /**
  * @brief On-demand I2C scan + NON-DESTRUCTIVE reconcile (operator model).
  *
- * Pauses module polling (quiescent bus), scans, identifies each device, then:
- * present at same transport+addr → keep config, refresh identity+online; new →
- * add; missing → mark OFFLINE but KEEP (never deletes/overwrites). Persists +
- * resumes polling.
+ * Incremental, with module polling left running (the Sensor Hub stays fresh):
+ *  1. every known v1.3+ address on @p bus is re-identified first — present →
+ *     keep config, refresh identity+online; silent → mark OFFLINE but KEEP;
+ *  2. the rest of 0x08..0x77 is probed in slices of DEVREG_SCAN_SLICE addresses
+ *     with DEVREG_SCAN_GAP_MS between them, interleaved with the poll traffic;
+ *  3. known legacy addresses and the new ones are identified in one window with
+ *     polling paused (DEVREG_SCAN_QUIESCE_MS to drain, then their reads): the
+ *     legacy DimmerLink misreads under concurrent rbAmp traffic. Skipped when
+ *     there is nothing to identify there.
+ * v1.3+ devices are matched by UID against the registry (fingerprint cache):
+ * a known UID reuses its family/variant/channels instead of re-reading them, and
+ * a known v1.3+ address skips the legacy warm-up read — unless its VERSION or
+ * UID no longer match (module swapped), then it is identified from scratch. A
+ * new rbAmp the fleet does not poll yet triggers rbamp_source_rescan();
+ * otherwise the fleet is left alone. Never deletes/overwrites. Persists once at
+ * the end.
+ * Blocks the caller for the sweep (seconds) — run it from a worker task.
  */
 esp_err_t devreg_scan_i2c(uint8_t bus);
 
+/** @brief Counters of the last scan (zeroed until one ran). */
+void devreg_get_scan_stats(devreg_scan_stats_t* out);
+
 /** @brief Number of registry entries (valid, incl. offline). */
 size_t devreg_count(void);
 
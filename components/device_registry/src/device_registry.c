@@ -4,12 +4,14 @@
  */
 #include "device_registry.h"
 #include "i2c_bus.h"
+#include "i2c_bus_async.h"
 #include "rbamp_source.h"
 #include "dimmerlink_manager.h"
 #include "dimmer_manager.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs.h"
 #include <string.h>
 
@@ -28,6 +30,10 @@ static const char* TAG = "DevReg";
 #define PRODUCT_ID_RBAMP     0x01
 #define PRODUCT_ID_RBDIMMER  0x02
 
+/* Identification reads queue behind actuation and telemetry; a busy bus may
+ * hold them this long before one counts as lost. */
+#define DEVREG_ID_READ_TIMEOUT_MS  1000
+
 const char* device_family_name(device_family_t f) {
     switch (f) {
         case DEV_FAMILY_RBAMP:         return "rbAmp";
@@ -45,18 +51,52 @@ static uint8_t rbamp_variant_channels(uint8_t variant) {
     return 0;
 }
 
-esp_err_t device_identify(uint8_t bus, uint8_t addr, device_ident_t *out) {
-    if (!out) return ESP_ERR_INVALID_ARG;
+static const device_entry_t* devreg_find_uid(const uint8_t uid[12]);  /* fwd */
+
+/* One identification read (STOP framing) at background priority. A full queue
+ * falls back to the blocking call — discovery is slow, never refused. */
+static esp_err_t id_read(uint8_t bus, uint8_t addr, uint8_t reg, uint8_t *buf, size_t len) {
+    const i2c_bus_xfer_t x = {
+        .op         = I2C_BUS_OP_READ_STOP,
+        .prio       = I2C_BUS_PRIO_BACKGROUND,
+        .addr       = addr,
+        .reg        = reg,
+        .rx         = buf,
+        .len        = len,
+        .timeout_ms = DEVREG_ID_READ_TIMEOUT_MS,
+    };
+    esp_err_t err = i2c_bus_transfer(bus, &x);
+    if (err == ESP_ERR_NO_MEM) err = i2c_bus_read_reg_stop(bus, addr, reg, buf, len);
+    return err;
+}
+
+/* Identification with the registry as fingerprint cache. @p known is the
+ * registry entry expected at this address (NULL when probing a new one); reads
+ * issued are added to @p reads, *uid_hit is set when the UID matched. */
+static esp_err_t identify(uint8_t bus, uint8_t addr, device_ident_t *out,
+                          const device_entry_t *known, uint16_t *reads, bool *uid_hit) {
     memset(out, 0, sizeof(*out));
     out->bus  = bus;
     out->addr = addr;
+    *uid_hit  = false;
 
     uint8_t ver = 0;
     /* Warm-up: the legacy DimmerLink returns a stale/garbled first read after the
-     * bus has been idle — a throwaway read lets the decisive one land clean. */
-    (void)i2c_bus_read_reg_stop(bus, addr, REG_VERSION, &ver, 1);
-    esp_err_t err = i2c_bus_read_reg_stop(bus, addr, REG_VERSION, &ver, 1);
+     * bus has been idle — a throwaway read lets the decisive one land clean. A
+     * known v1.3+ device (UID on record) reads clean, so it skips this — as long
+     * as it still is that device: a VERSION outside v1.3+ or a different UID means
+     * the module was swapped, and it is identified from scratch (warm-up first). */
+    const bool trusted = known && known->has_uid;
+    if (!trusted) {
+        (void)id_read(bus, addr, REG_VERSION, &ver, 1);
+        (*reads)++;
+    }
+    esp_err_t err = id_read(bus, addr, REG_VERSION, &ver, 1);
+    (*reads)++;
     if (err != ESP_OK) return err;
+    if (trusted && !(ver >= 0x04 && ver <= 0x3F)) {
+        return identify(bus, addr, out, NULL, reads, uid_hit);
+    }
     out->version = ver;
 
     /* v1.3+ identity block is valid ONLY for a PLAUSIBLE version. 0xFF / 0x00 are
@@ -64,11 +104,27 @@ esp_err_t device_identify(uint8_t bus, uint8_t addr, device_ident_t *out) {
      * them through the v1.3+ path would read CS_CONFIG(0x54)=0x01 as product-id and
      * misclassify a legacy DimmerLink as rbAmp. Plausible v1.3+ = 0x04..0x3F. */
     if (ver >= 0x04 && ver <= 0x3F) {
-        /* v1.3+ identity block is valid. */
+        /* v1.3+ identity block is valid. UID first: a UID on record carries the
+         * rest of the fingerprint, so PRODUCT_ID / HW_VARIANT need no re-read. */
+        out->has_uid = (id_read(bus, addr, REG_UID, out->uid, sizeof(out->uid)) == ESP_OK);
+        (*reads)++;
+        if (trusted && !(out->has_uid && !memcmp(out->uid, known->uid, sizeof(out->uid)))) {
+            return identify(bus, addr, out, NULL, reads, uid_hit);
+        }
+        const device_entry_t *fp = out->has_uid ? devreg_find_uid(out->uid) : NULL;
+        if (fp && fp->family != DEV_FAMILY_UNKNOWN) {
+            out->family     = fp->family;
+            out->hw_variant = fp->hw_variant;
+            out->channels   = fp->channels;
+            out->product_id = (fp->family == DEV_FAMILY_RBAMP) ? PRODUCT_ID_RBAMP
+                            : (fp->family == DEV_FAMILY_RBDIMMER) ? PRODUCT_ID_RBDIMMER : 0;
+            *uid_hit = true;
+            return ESP_OK;
+        }
         uint8_t pid = 0, variant = 0;
-        i2c_bus_read_reg_stop(bus, addr, REG_PRODUCT_ID, &pid, 1);
-        i2c_bus_read_reg_stop(bus, addr, REG_HW_VARIANT, &variant, 1);
-        i2c_bus_read_reg_stop(bus, addr, REG_UID, out->uid, sizeof(out->uid));
+        id_read(bus, addr, REG_PRODUCT_ID, &pid, 1);
+        id_read(bus, addr, REG_HW_VARIANT, &variant, 1);
+        (*reads) += 2;
         out->product_id = pid;
         out->hw_variant = variant;
         out->has_uid = true;
@@ -90,11 +146,19 @@ esp_err_t device_identify(uint8_t bus, uint8_t addr, device_ident_t *out) {
          * Non-destructive: no probe writes. HW_VARIANT best-effort. */
         out->family   = DEV_FAMILY_LEGACY_DIMMER;
         out->channels = 1;  /* legacy = single-channel; multi-ch is future rbDimmer */
-        i2c_bus_read_reg_stop(bus, addr, REG_HW_VARIANT, &out->hw_variant, 1);
+        id_read(bus, addr, REG_HW_VARIANT, &out->hw_variant, 1);
+        (*reads)++;
     }
     return ESP_OK;
 }
 
+esp_err_t device_identify(uint8_t bus, uint8_t addr, device_ident_t *out) {
+    if (!out) return ESP_ERR_INVALID_ARG;
+    uint16_t reads = 0;
+    bool uid_hit;
+    return identify(bus, addr, out, NULL, &reads, &uid_hit);
+}
+
 /* ================================================================
  * Registry
  * ================================================================ */
@@ -111,7 +175,17 @@ static int devreg_find_i2c(uint8_t bus, uint8_t addr) {
     return -1;
 }
 
-static device_role_t seed_role_from_driver(device_family_t family, uint8_t addr);  /* fwd */
+static const device_entry_t* devreg_find_uid(const uint8_t uid[12]) {
+    for (int i = 0; i < DEVREG_MAX_DEVICES; i++) {
+        if (s_devices[i].valid && s_devices[i].has_uid &&
+            memcmp(s_devices[i].uid, uid, sizeof(s_devices[i].uid)) == 0) {
+            return &s_devices[i];
+        }
+    }
+    return NULL;
+}
+
+static device_role_t seed_role_from_driver(device_family_t family, uint8_t addr, uint8_t ch);  /* fwd */
 
 static int devreg_free_slot(void) {
     for (int i = 0; i < DEVREG_MAX_DEVICES; i++) {
@@ -158,63 +232,146 @@ esp_err_t devreg_init(void) {
     return ESP_OK;
 }
 
+/* Fold one identification into the registry: present at same transport+addr →
+ * keep config, refresh identity+online; new → add and seed its role.
+ * @return slot, or -1 when the registry is full. */
+static int reconcile(const device_ident_t *id, bool *added) {
+    int idx = devreg_find_i2c(id->bus, id->addr);
+    *added = (idx < 0);
+    if (idx < 0) {
+        idx = devreg_free_slot();
+        if (idx < 0) { ESP_LOGW(TAG, "registry full, skip 0x%02X", id->addr); return -1; }
+        memset(&s_devices[idx], 0, sizeof(s_devices[idx]));
+        s_devices[idx].valid     = true;
+        s_devices[idx].transport = DEV_TRANSPORT_I2C;
+        s_devices[idx].bus       = id->bus;
+        s_devices[idx].addr      = id->addr;
+    }
+    /* KEEP roles/config — refresh identity + online only */
+    s_devices[idx].family     = id->family;
+    s_devices[idx].hw_variant = id->hw_variant;
+    s_devices[idx].channels   = id->channels;
+    s_devices[idx].has_uid    = id->has_uid;
+    if (id->has_uid) memcpy(s_devices[idx].uid, id->uid, sizeof(id->uid));
+    s_devices[idx].online     = true;
+    /* Seed a new entry's role from the driver so sync_roles doesn't wipe it. */
+    if (*added) {
+        for (uint8_t ch = 0; ch < DEVREG_MAX_CH; ch++) {
+            s_devices[idx].roles[ch] = (uint8_t)seed_role_from_driver(id->family, id->addr, ch);
+        }
+    }
+    return idx;
+}
+
+/* Is @p addr in the rbAmp fleet (polled)? */
+static bool rbamp_polled(uint8_t addr) {
+    rbamp_source_module_info_t mods[RBAMP_SOURCE_MAX_MODULES];
+    size_t n = 0;
+    if (rbamp_source_get_modules(mods, RBAMP_SOURCE_MAX_MODULES, &n) != ESP_OK) return false;
+    for (size_t i = 0; i < n; i++) {
+        if (mods[i].i2c_addr == addr) return true;
+    }
+    return false;
+}
+
+static devreg_scan_stats_t s_scan_stats;
+
+/* Identify one address and fold it into the registry (scan bookkeeping). */
+static void scan_identify(uint8_t bus, uint8_t addr, device_entry_t *known,
+                          devreg_scan_stats_t *st, bool *new_rbamp) {
+    device_ident_t id;
+    bool hit = false, added = false;
+    if (identify(bus, addr, &id, known, &st->reads, &hit) != ESP_OK) {
+        if (known) known->online = false;     /* missing → OFFLINE, but KEEP */
+        return;
+    }
+    if (reconcile(&id, &added) < 0) return;
+    if (known) st->known_online++;
+    else if (added) st->found_new++;
+    if (hit) st->uid_hits++;
+    if (id.family == DEV_FAMILY_RBAMP && !rbamp_polled(addr)) *new_rbamp = true;
+}
+
 esp_err_t devreg_scan_i2c(uint8_t bus) {
     if (!i2c_bus_is_initialized(bus)) return ESP_ERR_INVALID_STATE;
 
-    /* Quiescent bus: pause polling and let in-flight transactions drain, so the
-     * legacy DimmerLink's reads aren't corrupted by the concurrent rbAmp poll. */
-    rbamp_source_pause(true);
-    dl_manager_pause(true);
-    vTaskDelay(pdMS_TO_TICKS(300));
-
-    /* Mark all known devices offline; re-marked online if seen this scan. */
+    /* Polling keeps running through the scan; the scan's transactions interleave
+     * with it through the bus lock, so the Sensor Hub stays fresh. Only the
+     * legacy DimmerLink needs a quiet bus to identify (its reads corrupt under
+     * concurrent rbAmp traffic): those addresses — and new ones, whose family is
+     * not known yet — are identified in one short quiesced window at the end. */
+    const int64_t t0 = esp_timer_get_time();
+    devreg_scan_stats_t st = {0};
+    st.bus = bus;
+    bool known[0x80] = {false};
+    bool new_rbamp = false;
+    device_entry_t *quiet_known[DEVREG_MAX_DEVICES];
+    uint8_t quiet_new[0x80];
+    size_t n_quiet_known = 0, n_quiet_new = 0;
+
+    /* 1. Known addresses first: the registry is current after a few reads. */
     for (int i = 0; i < DEVREG_MAX_DEVICES; i++) {
-        if (s_devices[i].valid) s_devices[i].online = false;
+        device_entry_t *d = &s_devices[i];
+        if (!d->valid || d->transport != DEV_TRANSPORT_I2C || d->bus != bus) continue;
+        known[d->addr & 0x7F] = true;
+        st.known++;
+        if (!d->has_uid || d->family == DEV_FAMILY_LEGACY_DIMMER) {
+            quiet_known[n_quiet_known++] = d;
+            continue;
+        }
+        scan_identify(bus, d->addr, d, &st, &new_rbamp);
+    }
+    st.known_ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+
+    /* 2. Background sweep of the remaining addresses, a slice at a time. */
+    uint8_t in_slice = 0;
+    for (uint8_t addr = 0x08; addr <= 0x77; addr++) {
+        if (known[addr]) continue;
+        st.swept++;
+        if (i2c_bus_probe(bus, addr) == ESP_OK) quiet_new[n_quiet_new++] = addr;
+        if (++in_slice >= DEVREG_SCAN_SLICE) {
+            in_slice = 0;
+            vTaskDelay(pdMS_TO_TICKS(DEVREG_SCAN_GAP_MS));
+        }
     }
 
-    uint8_t found[24];
-    uint8_t n = 0;
-    i2c_bus_scan(bus, found, sizeof(found), &n);
-
-    size_t added = 0, refreshed = 0;
-    for (uint8_t k = 0; k < n; k++) {
-        device_ident_t id;
-        if (device_identify(bus, found[k], &id) != ESP_OK) continue;
-
-        int idx = devreg_find_i2c(bus, found[k]);
-        bool is_new = (idx < 0);
-        if (idx < 0) {
-            idx = devreg_free_slot();
-            if (idx < 0) { ESP_LOGW(TAG, "registry full, skip 0x%02X", found[k]); continue; }
-            memset(&s_devices[idx], 0, sizeof(s_devices[idx]));
-            s_devices[idx].valid     = true;
-            s_devices[idx].transport = DEV_TRANSPORT_I2C;
-            s_devices[idx].bus       = bus;
-            s_devices[idx].addr      = found[k];
-            added++;
-        } else {
-            refreshed++;   /* KEEP roles/config — refresh identity + online only */
+    /* 3. Quiesced identification: pause polling and let in-flight transactions
+     * drain, so the legacy DimmerLink's reads aren't corrupted by the concurrent
+     * rbAmp poll. */
+    if (n_quiet_known + n_quiet_new > 0) {
+        const int64_t tq = esp_timer_get_time();
+        rbamp_source_pause(true);
+        dl_manager_pause(true);
+        vTaskDelay(pdMS_TO_TICKS(DEVREG_SCAN_QUIESCE_MS));
+        for (size_t i = 0; i < n_quiet_known; i++) {
+            scan_identify(bus, quiet_known[i]->addr, quiet_known[i], &st, &new_rbamp);
         }
-        s_devices[idx].family     = id.family;
-        s_devices[idx].hw_variant = id.hw_variant;
-        s_devices[idx].channels   = id.channels;
-        s_devices[idx].has_uid    = id.has_uid;
-        if (id.has_uid) memcpy(s_devices[idx].uid, id.uid, sizeof(id.uid));
-        s_devices[idx].online     = true;
-        /* Seed a new entry's role from the driver so sync_roles doesn't wipe it. */
-        if (is_new) {
-            s_devices[idx].roles[0] = (uint8_t)seed_role_from_driver(id.family, found[k]);
+        for (size_t i = 0; i < n_quiet_new; i++) {
+            scan_identify(bus, quiet_new[i], NULL, &st, &new_rbamp);
         }
+        rbamp_source_pause(false);
+        dl_manager_pause(false);
+        st.quiesce_ms = (uint32_t)((esp_timer_get_time() - tq) / 1000);
     }
 
     devreg_save();
-    rbamp_source_pause(false);
-    dl_manager_pause(false);
-    ESP_LOGI(TAG, "Scan bus %u: %u present, +%u new, %u refreshed (missing kept offline)",
-             bus, n, (unsigned)added, (unsigned)refreshed);
+    /* The fleet scan is a full bus walk inside the rbAmp library — only when a
+     * module it does not poll yet is actually there. */
+    if (new_rbamp) st.rbamp_rescan = (rbamp_source_rescan() == ESP_OK);
+    st.total_ms = (uint32_t)((esp_timer_get_time() - t0) / 1000);
+    s_scan_stats = st;
+    ESP_LOGI(TAG, "Scan bus %u: %u/%u known online in %lums, %u swept, +%u new, "
+                  "%u reads (%u UID hits), polling paused %lums, %lums%s",
+             bus, st.known_online, st.known, (unsigned long)st.known_ms, st.swept,
+             st.found_new, st.reads, st.uid_hits, (unsigned long)st.quiesce_ms,
+             (unsigned long)st.total_ms, st.rbamp_rescan ? ", rbAmp rescan requested" : "");
     return ESP_OK;
 }
 
+void devreg_get_scan_stats(devreg_scan_stats_t* out) {
+    if (out) *out = s_scan_stats;
+}
+
 size_t devreg_count(void) {
     size_t c = 0;
     for (int i = 0; i < DEVREG_MAX_DEVICES; i++) if (s_devices[i].valid) c++;
@@ -299,20 +456,20 @@ static bool role_to_rbamp(device_role_t r, rbamp_source_role_t* out) {
  * (e.g. rbamp_source seeds 0x51=grid from NVS/Kconfig) so a fresh registry entry
  * isn't role=none — otherwise devreg_sync_roles() pushes none back and WIPES the
  * driver's working role, killing sensing. Only for NEW entries; existing configs kept. */
-static device_role_t seed_role_from_driver(device_family_t family, uint8_t addr) {
+static device_role_t seed_role_from_driver(device_family_t family, uint8_t addr, uint8_t ch) {
     /* Output families have their role implied by family (a dimmer is a dimmer — the only
      * valid role per device_family_valid_roles). Seed it at discovery so a from-scratch
      * DimmerLink module auto-binds to a dimmer output (bridge_role -> dimmer_bind_i2c)
      * without a manual role step. (No relay device family today; relays are local GPIO.) */
     if (family == DEV_FAMILY_RBDIMMER || family == DEV_FAMILY_LEGACY_DIMMER) {
-        return DEV_ROLE_DIMMER;
+        return ch == 0 ? DEV_ROLE_DIMMER : DEV_ROLE_NONE;
     }
     if (family != DEV_FAMILY_RBAMP) return DEV_ROLE_NONE;
-    rbamp_source_module_cfg_t cfg[RBAMP_SOURCE_MAX_MODULES];
+    rbamp_source_module_cfg_t cfg[RBAMP_SOURCE_MAX_ROLES];
     size_t n = 0;
-    if (rbamp_source_get_roles(cfg, RBAMP_SOURCE_MAX_MODULES, &n) != ESP_OK) return DEV_ROLE_NONE;
+    if (rbamp_source_get_roles(cfg, RBAMP_SOURCE_MAX_ROLES, &n) != ESP_OK) return DEV_ROLE_NONE;
     for (size_t i = 0; i < n; i++) {
-        if (cfg[i].i2c_addr != addr) continue;
+        if (cfg[i].i2c_addr != addr || cfg[i].channel != ch) continue;
         switch (cfg[i].role) {
             case RBAMP_ROLE_GRID:    return DEV_ROLE_GRID;
             case RBAMP_ROLE_SOLAR:   return DEV_ROLE_SOLAR;
@@ -324,12 +481,17 @@ static device_role_t seed_role_from_driver(device_family_t family, uint8_t addr)
     return DEV_ROLE_NONE;
 }
 
-/* Bridge one entry's channel-0 role to its driver. */
+/* Bridge one entry's roles to its driver: every channel of an rbAmp (a UI3
+ * feeds up to three hub slots from one read), channel 0 of an output module. */
 static void bridge_role(const device_entry_t* d) {
     if (d->family == DEV_FAMILY_RBAMP) {
-        rbamp_source_role_t rr;
-        if (role_to_rbamp((device_role_t)d->roles[0], &rr)) {
-            rbamp_source_set_role(d->addr, rr);
+        uint8_t nch = d->channels ? d->channels : 1;
+        if (nch > RBAMP_SOURCE_MAX_CHANNELS) nch = RBAMP_SOURCE_MAX_CHANNELS;
+        for (uint8_t ch = 0; ch < nch; ch++) {
+            rbamp_source_role_t rr;
+            if (role_to_rbamp((device_role_t)d->roles[ch], &rr)) {
+                rbamp_source_set_channel_role(d->addr, ch, rr);
+            }
         }
     } else if (d->family == DEV_FAMILY_LEGACY_DIMMER || d->family == DEV_FAMILY_RBDIMMER) {
         /* A dimmer with role=dimmer becomes an I2C dimmer the RouterController
@@ -348,6 +510,10 @@ esp_err_t devreg_set_role(uint8_t bus, uint8_t addr, uint8_t channel, device_rol
     if (!device_role_valid_for_family(s_devices[idx].family, role)) {
         return ESP_ERR_INVALID_ARG;   /* e.g. a sensor role on a dimmer */
     }
+    if (s_devices[idx].family == DEV_FAMILY_RBAMP && channel > 0 &&
+        channel >= s_devices[idx].channels) {
+        return ESP_ERR_INVALID_ARG;   /* no such current channel on this variant */
+    }
     s_devices[idx].roles[channel] = (uint8_t)role;
     bridge_role(&s_devices[idx]);
     if (s_devices[idx].family == DEV_FAMILY_RBAMP) rbamp_source_save_config();
@@ -371,7 +537,11 @@ void devreg_sync_roles(void) {
         /* Don't push a none role at boot — it would wipe a role the driver already
          * holds (e.g. rbamp_source's Kconfig-seeded grid), killing sensing. An explicit
          * clear-to-none from the user still goes through devreg_set_role(). */
-        if (s_devices[i].roles[0] == DEV_ROLE_NONE) continue;
+        bool any = false;
+        for (int ch = 0; ch < DEVREG_MAX_CH; ch++) {
+            if (s_devices[i].roles[ch] != DEV_ROLE_NONE) any = true;
+        }
+        if (!any) continue;
         bridge_role(&s_devices[i]);
     }
 }
@@ -0,0 +1,44 @@
+/**
+ * @file dimmer_curve.h
+ * @brief Level ↔ power model of the dimmer curves (resistive load)
+ *
+ * A dimmer's level is not its power: how much of the nominal power a
+ * resistive load draws at a given level depends on the curve the output
+ * applies (dimmer_curve_t):
+ *
+ *   - LINEAR:      level maps linearly to conduction angle, so power follows
+ *                  P/Pnom = 1 - a/pi + sin(2a)/(2pi) at firing angle
+ *                  a = pi*(1 - level/100) — flat at both ends, steep mid-range.
+ *   - RMS:         RMS-compensated, power proportional to level.
+ *   - LOGARITHMIC: perceptual curve, modelled as (level/100)^2.
+ *
+ * Used by RouterController's watts-domain cascade to turn a power share into
+ * each dimmer's level at the output stage. Pure functions, no state.
+ */
+
+#ifndef DIMMER_CURVE_H
+#define DIMMER_CURVE_H
+
+#include "dimmer_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fraction of nominal power (0..1) drawn at @p percent on @p curve
+ */
+float dimmer_curve_power_fraction(dimmer_curve_t curve, float percent);
+
+/**
+ * @brief Level (0..100%) that draws @p fraction (0..1) of nominal power on @p curve
+ *
+ * Inverse of dimmer_curve_power_fraction(), accurate to 0.01%.
+ */
+float dimmer_curve_level_for_fraction(dimmer_curve_t curve, float fraction);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DIMMER_CURVE_H
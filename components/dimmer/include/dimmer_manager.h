@@ -117,6 +117,14 @@ uint8_t dimmer_set_level_all(uint8_t percent);
  */
 void dimmer_emergency_stop_all(void);
 
+/**
+ * @brief Re-issue level writes a backend reported lost (call periodically)
+ *
+ * Queued I2C writes complete later; one that failed is re-sent with the level
+ * last commanded, at most every 200 ms per dimmer.
+ */
+void dimmer_update_all(void);
+
 // ============================================================
 // State Control
 // ============================================================
@@ -162,6 +170,14 @@ esp_err_t dimmer_set_curve(uint8_t id, dimmer_curve_t curve);
  */
 dimmer_curve_t dimmer_get_curve(uint8_t id);
 
+/**
+ * @brief Get the curve the output actually applies
+ *
+ * Same as dimmer_get_curve() except for ESP-NOW nodes, whose curve is fixed
+ * (RMS) on the node whatever is configured here.
+ */
+dimmer_curve_t dimmer_get_output_curve(uint8_t id);
+
 /**
  * @brief Get dimmer state
  */
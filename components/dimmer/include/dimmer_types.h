@@ -185,6 +185,7 @@ typedef struct {
     bool initialized;           ///< [RUNTIME] Hardware initialized flag
     uint32_t last_update_ms;    ///< [RUNTIME] Last state update timestamp
     uint32_t last_cmd_ms;       ///< [RUNTIME] Last command timestamp (for timeout detection)
+    volatile bool level_lost;   ///< [RUNTIME] Queued level write failed (set by the backend)
 
     // ===== Hardware handle (internal use) =====
     void* hw_handle;            ///< [RUNTIME] Type-specific handle (e.g., rbdimmer_channel_t*)
@@ -0,0 +1,53 @@
+/**
+ * @file dimmer_curve.c
+ * @brief Level ↔ power model of the dimmer curves (see dimmer_curve.h)
+ */
+
+#include "dimmer_curve.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Bisection steps for the LINEAR inverse: 100% / 2^14 ≈ 0.006% */
+#define CURVE_INVERSE_STEPS     14
+
+float dimmer_curve_power_fraction(dimmer_curve_t curve, float percent) {
+    if (!(percent > 0.0f)) return 0.0f;
+    if (percent >= 100.0f) return 1.0f;
+    float x = percent / 100.0f;
+    switch (curve) {
+        case DIMMER_CURVE_LINEAR: {
+            float a = (float)M_PI * (1.0f - x);
+            return 1.0f - a / (float)M_PI + sinf(2.0f * a) / (2.0f * (float)M_PI);
+        }
+        case DIMMER_CURVE_LOGARITHMIC:
+            return x * x;
+        case DIMMER_CURVE_RMS:
+        default:
+            return x;
+    }
+}
+
+float dimmer_curve_level_for_fraction(dimmer_curve_t curve, float fraction) {
+    if (!(fraction > 0.0f)) return 0.0f;
+    if (fraction >= 1.0f) return 100.0f;
+    switch (curve) {
+        case DIMMER_CURVE_LINEAR: {
+            /* No closed form; the curve is monotonic, so bisect. */
+            float lo = 0.0f, hi = 100.0f;
+            for (int i = 0; i < CURVE_INVERSE_STEPS; i++) {
+                float mid = 0.5f * (lo + hi);
+                if (dimmer_curve_power_fraction(curve, mid) < fraction) lo = mid;
+                else hi = mid;
+            }
+            return 0.5f * (lo + hi);
+        }
+        case DIMMER_CURVE_LOGARITHMIC:
+            return 100.0f * sqrtf(fraction);
+        case DIMMER_CURVE_RMS:
+        default:
+            return 100.0f * fraction;
+    }
+}
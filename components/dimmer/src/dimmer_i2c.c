@@ -58,12 +58,35 @@ esp_err_t dimmer_i2c_channel_init(dimmer_t* d) {
     return ESP_OK;
 }
 
+/* Completion of a queued level write (I2C worker). The level was recorded at
+ * submission; a lost write is flagged for dimmer_update_all(), which restores
+ * the state and re-issues the commanded level (target_percent). */
+static void level_write_done(esp_err_t result, void* ctx) {
+    dimmer_t* d = (dimmer_t*)ctx;
+    if (result == ESP_OK) return;
+    d->state = DIMMER_STATE_ERROR;
+    ESP_LOGW(TAG, "Dimmer %d: level write to 0x%02X failed: %s",
+             d->id, d->i2c_address, esp_err_to_name(result));
+    d->level_lost = true;
+}
+
+/* Level writes are queued as actuation transactions: the control task returns
+ * at once instead of waiting for the bus behind a sensor poll. */
 esp_err_t dimmer_i2c_set_level(dimmer_t* d, uint8_t percent) {
     if (!d) return ESP_ERR_INVALID_ARG;
-    esp_err_t err = dl_device_set_dimmer_level(d->i2c_bus, d->i2c_address, percent);
-    if (err == ESP_OK) {
-        d->level_percent = percent;
-        d->state = (percent == 0) ? DIMMER_STATE_OFF : DIMMER_STATE_ON;
+    const uint8_t prev_level = d->level_percent;
+    const uint8_t prev_target = d->target_percent;
+    const dimmer_state_t prev_state = d->state;
+    d->level_percent = percent;
+    d->target_percent = percent;
+    d->state = (percent == 0) ? DIMMER_STATE_OFF : DIMMER_STATE_ON;
+
+    esp_err_t err = dl_device_set_dimmer_level_async(d->i2c_bus, d->i2c_address, percent,
+                                                     level_write_done, d);
+    if (err != ESP_OK) {
+        d->level_percent = prev_level;
+        d->target_percent = prev_target;
+        d->state = prev_state;
     }
     return err;
 }
@@ -74,10 +97,16 @@ esp_err_t dimmer_i2c_set_level_smooth(dimmer_t* d, uint8_t percent, uint32_t ms)
     uint8_t fade_100ms = (uint8_t)((ms + 50) / 100);
     if (fade_100ms == 0) fade_100ms = 1;
 
-    esp_err_t err = dl_device_set_dimmer_fade(d->i2c_bus, d->i2c_address, percent, fade_100ms);
-    if (err == ESP_OK) {
-        d->target_percent = percent;
-        d->state = DIMMER_STATE_TRANSITIONING;
+    const uint8_t prev_target = d->target_percent;
+    const dimmer_state_t prev_state = d->state;
+    d->target_percent = percent;
+    d->state = DIMMER_STATE_TRANSITIONING;
+
+    esp_err_t err = dl_device_set_dimmer_fade_async(d->i2c_bus, d->i2c_address, percent,
+                                                    fade_100ms, level_write_done, d);
+    if (err != ESP_OK) {
+        d->target_percent = prev_target;
+        d->state = prev_state;
     }
     return err;
 }
@@ -43,6 +43,10 @@ static const char* NVS_NAMESPACE = "dimmer";
 
 static dimmer_t s_dimmers[DIMMER_MAX_COUNT];
 static bool s_manager_initialized = false;
+static TickType_t s_retry_tick[DIMMER_MAX_COUNT];   // last lost-write retry per slot
+
+// Lost-write retries of one dimmer at most this often (a dead module is not hammered)
+#define DIMMER_RETRY_MS 200
 
 // ============================================================
 // Internal Helpers
@@ -51,6 +55,7 @@ static bool s_manager_initialized = false;
 static void dimmer_init_slot(uint8_t id) {
     dimmer_t* d = &s_dimmers[id];
     memset(d, 0, sizeof(dimmer_t));
+    s_retry_tick[id] = 0;
 
     // Identity
     d->id = id;
@@ -369,6 +374,26 @@ void dimmer_emergency_stop_all(void) {
     }
 }
 
+void dimmer_update_all(void) {
+    const TickType_t now = xTaskGetTickCount();
+    for (uint8_t i = 0; i < DIMMER_MAX_COUNT; i++) {
+        dimmer_t* d = &s_dimmers[i];
+        if (!d->initialized || !d->level_lost) continue;
+        if (s_retry_tick[i] != 0 && (now - s_retry_tick[i]) < pdMS_TO_TICKS(DIMMER_RETRY_MS)) continue;
+
+        // A queued level write the backend reported lost never reached the output,
+        // and the router writes only on a change: re-issue the commanded level.
+        if (!__atomic_exchange_n(&d->level_lost, false, __ATOMIC_ACQ_REL)) continue;
+        s_retry_tick[i] = now ? now : 1;
+        const uint8_t level = d->target_percent;
+        d->state = (level == 0) ? DIMMER_STATE_OFF : DIMMER_STATE_ON;
+        ESP_LOGW(TAG, "Dimmer %d: level write lost, retrying %u%%", i, level);
+        if (dimmer_dispatch_set_level(d, level) != ESP_OK) {
+            d->level_lost = true;
+        }
+    }
+}
+
 // ============================================================
 // State Control
 // ============================================================
@@ -479,6 +504,16 @@ dimmer_curve_t dimmer_get_curve(uint8_t id) {
     return s_dimmers[id].curve;
 }
 
+dimmer_curve_t dimmer_get_output_curve(uint8_t id) {
+    if (id >= DIMMER_MAX_COUNT) {
+        return DIMMER_CURVE_RMS;
+    }
+    if (s_dimmers[id].type == DIMMER_TYPE_ESPNOW) {
+        return DIMMER_CURVE_RMS;   /* fixed on the node, see dimmer_dispatch_set_curve() */
+    }
+    return s_dimmers[id].curve;
+}
+
 dimmer_state_t dimmer_get_state(uint8_t id) {
     if (id >= DIMMER_MAX_COUNT) {
         return DIMMER_STATE_ERROR;
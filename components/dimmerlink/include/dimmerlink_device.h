@@ -4,6 +4,10 @@
  *
  * Low-level API for reading/writing DimmerLink registers.
  * All functions are stateless — they just perform I2C transactions.
+ *
+ * The poll path (dl_poll_job_*) does not read snapshot by snapshot: a
+ * register-window planner coalesces the windows a device needs into the fewest
+ * multi-byte reads, and every snapshot is decoded from the one register image.
  */
 
 #ifndef DIMMERLINK_DEVICE_H
@@ -11,6 +15,8 @@
 
 #include "esp_err.h"
 #include "dimmerlink_types.h"
+#include "dimmerlink_regs.h"
+#include "i2c_bus_async.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,6 +59,138 @@ esp_err_t dl_device_read_thermal(uint8_t bus, uint8_t addr, dl_thermal_status_t*
  */
 esp_err_t dl_device_read_dimmer(uint8_t bus, uint8_t addr, dl_dimmer_status_t* status);
 
+/* ================================================================
+ * Burst poll
+ * ================================================================ */
+
+/** Snapshots a poll job can fetch (bitmask) */
+#define DL_POLL_CURRENT         (1 << 0)    /**< 0x60-0x77 current snapshot */
+#define DL_POLL_VOLTAGE         (1 << 1)    /**< 0x78-0x7D voltage */
+#define DL_POLL_THERMAL         (1 << 2)    /**< 0x40-0x45 thermal status */
+#define DL_POLL_DIMMER          (1 << 3)    /**< 0x10-0x11, 0x18, 0x20 dimmer status */
+
+/** Maximum reads in a plan (one per window if nothing coalesces) */
+#define DL_BURST_MAX_READS      6
+
+/**
+ * Unused registers a read may span to join two windows. A separate read costs
+ * about four byte times of bus traffic (START, address, pointer, STOP, START,
+ * address) plus the driver's per-transfer setup; a skipped byte costs one.
+ */
+#define DL_BURST_MAX_GAP        8
+
+/** Longest single read (bytes) */
+#define DL_BURST_MAX_LEN        32
+
+/**
+ * @brief One coalesced read: @p len registers from @p reg
+ */
+typedef struct {
+    uint8_t reg;
+    uint8_t len;
+    uint8_t windows;            ///< DL_POLL_* windows this read covers
+} dl_burst_read_t;
+
+/**
+ * @brief Read plan for one poll
+ */
+typedef struct {
+    dl_burst_read_t read[DL_BURST_MAX_READS];
+    uint8_t count;              ///< Reads in the plan
+    uint8_t bytes;              ///< Total bytes read (incl. gap registers)
+} dl_burst_plan_t;
+
+/**
+ * @brief Plan the reads for a set of snapshots
+ *
+ * Windows are taken in address order and merged while the gap between them is at
+ * most DL_BURST_MAX_GAP registers and the read stays within DL_BURST_MAX_LEN.
+ *
+ * @param what  DL_POLL_* mask
+ * @param plan  Receives the plan
+ */
+void dl_burst_plan(uint8_t what, dl_burst_plan_t* plan);
+
+/**
+ * @brief Poll result: which snapshots were read
+ */
+typedef struct {
+    dl_current_snapshot_t current;
+    dl_voltage_snapshot_t voltage;
+    dl_thermal_status_t   thermal;
+    dl_dimmer_status_t    dimmer;
+    uint8_t               ok;       ///< DL_POLL_* windows read successfully
+    uint8_t               reads;    ///< I2C reads issued
+    int64_t               done_us;  ///< When the last read completed (esp_timer)
+} dl_poll_result_t;
+
+typedef struct dl_poll_job dl_poll_job_t;
+
+/** Completion context of one read of a job */
+typedef struct {
+    dl_poll_job_t* job;
+    uint8_t        idx;
+} dl_poll_read_ref_t;
+
+/**
+ * @brief One device's poll in flight
+ *
+ * Lets a poller issue the reads of every device before waiting on any: reads
+ * of devices on bus 0 and bus 1 then run concurrently on the two bus workers.
+ * Each read is a pointer write + STOP, then a read (I2C_BUS_OP_READ_STOP):
+ * legacy DimmerLink firmware latches the register pointer only on STOP. Reads
+ * are queued at telemetry priority, so actuation writes overtake them.
+ */
+struct dl_poll_job {
+    dl_burst_plan_t    plan;
+    uint8_t            bus;
+    uint8_t            addr;
+    uint8_t            next;            ///< Next read of the plan to submit
+    volatile uint8_t   ok;              ///< DL_POLL_* windows read so far
+    volatile esp_err_t first_err;       ///< First failed read, ESP_OK if none
+    volatile int64_t   done_us;         ///< Completion time of the latest read
+    SemaphoreHandle_t  done;            ///< Given once per accepted read
+    dl_poll_read_ref_t ref[DL_BURST_MAX_READS];
+    uint8_t            map[DL_REG_MAP_SIZE];    ///< Register image, indexed by address
+};
+
+/**
+ * @brief Plan a device's poll
+ *
+ * @param job   Job (must stay in place until every accepted read completed)
+ * @param bus   I2C bus number
+ * @param addr  Device address
+ * @param what  DL_POLL_* mask
+ * @param done  Counting semaphore given once per accepted read
+ */
+void dl_poll_job_init(dl_poll_job_t* job, uint8_t bus, uint8_t addr, uint8_t what,
+                      SemaphoreHandle_t done);
+
+/**
+ * @brief Whether the job has reads left to submit
+ */
+static inline bool dl_poll_job_pending(const dl_poll_job_t* job) {
+    return job->next < job->plan.count;
+}
+
+/**
+ * @brief Submit the job's next read
+ *
+ * @return ESP_OK: accepted, @p done will be given once for it;
+ *         ESP_ERR_NO_MEM: bus queue full, retry after a completion;
+ *         other: the read failed at once (recorded, nothing to wait for)
+ */
+esp_err_t dl_poll_job_submit(dl_poll_job_t* job);
+
+/**
+ * @brief Decode every snapshot of a completed job from its register image
+ *
+ * A failed read leaves its windows out of @p out->ok.
+ *
+ * @return ESP_OK if every read succeeded, else the first error
+ */
+esp_err_t dl_poll_job_finish(const dl_poll_job_t* job, dl_poll_result_t* out);
+
 /**
  * @brief Set dimmer level (immediate)
  *
@@ -73,6 +211,23 @@ esp_err_t dl_device_set_dimmer_level(uint8_t bus, uint8_t addr, uint8_t percent)
 esp_err_t dl_device_set_dimmer_fade(uint8_t bus, uint8_t addr,
                                      uint8_t percent, uint8_t fade_100ms);
 
+/**
+ * @brief Queue a dimmer level write as an actuation transaction
+ *
+ * Returns once queued; @p done reports the bus result from the I2C worker
+ * (see i2c_bus_submit() for when it runs).
+ */
+esp_err_t dl_device_set_dimmer_level_async(uint8_t bus, uint8_t addr, uint8_t percent,
+                                           i2c_bus_done_cb_t done, void* ctx);
+
+/**
+ * @brief Queue a fade (fade time, then level) as actuation transactions
+ *
+ * @p done runs once, with the level write's result.
+ */
+esp_err_t dl_device_set_dimmer_fade_async(uint8_t bus, uint8_t addr, uint8_t percent,
+                                          uint8_t fade_100ms, i2c_bus_done_cb_t done, void* ctx);
+
 /**
  * @brief Set dimmer curve type
  */
@@ -4,7 +4,7 @@
  *
  * Manages up to DL_MAX_DEVICES DimmerLink modules on I2C bus.
  * Runs a FreeRTOS task that polls registered devices at configurable interval
- * and posts ACROUTER_EVENT_POWER_UPDATE events with measurement data.
+ * and publishes measurement frames to the measurement ring (acrouter_meas_ring).
  *
  * Usage:
  * 1. dl_manager_init()
@@ -68,7 +68,7 @@ esp_err_t dl_manager_unregister(uint8_t slot);
  * @brief Start polling task
  *
  * Creates a FreeRTOS task that polls all enabled devices at the specified interval.
- * Posts ACROUTER_EVENT_POWER_UPDATE for each device with sensor role.
+ * Publishes a measurement frame for each device with sensor role.
  *
  * @param interval_ms Polling interval in milliseconds (default: 200)
  * @return ESP_OK on success
@@ -103,6 +103,11 @@ uint8_t dl_manager_get_active_count(void);
  */
 uint8_t dl_manager_get_enabled_count(void);
 
+/**
+ * @brief Get number of enabled devices on one bus
+ */
+uint8_t dl_manager_get_bus_count(uint8_t bus);
+
 /**
  * @brief Save all device configs to NVS
  */
@@ -136,6 +141,13 @@ esp_err_t dl_manager_load_config(void);
  */
 void dl_manager_get_timing(uint32_t *last_us, uint32_t *avg_us, uint32_t *count);
 
+/**
+ * @brief I2C register reads issued in the last poll cycle (all enabled devices).
+ * @p unplanned is what the same cycle costs with one read per snapshot (and per
+ * dimmer register) instead of planned bursts. Either pointer may be NULL.
+ */
+void dl_manager_get_poll_reads(uint16_t *reads, uint16_t *unplanned);
+
 #ifdef __cplusplus
 }
 #endif
@@ -90,6 +90,9 @@ extern "C" {
 #define DL_REG_TEMP_PEAK        0x44    /* R   uint8: peak temp + 50 offset */
 #define DL_REG_TEMP_RATE        0x45    /* R   uint8: rate °C/s + 128 offset */
 
+/* Thermal status window size */
+#define DL_THERMAL_WINDOW_SIZE  6       /* Bytes from 0x40 to 0x45 inclusive */
+
 /* Thermal state enum */
 #define DL_THERMAL_NORMAL       0
 #define DL_THERMAL_WARNING      1
@@ -181,6 +184,9 @@ extern "C" {
 #define DL_REG_VS_PEAK_H        0x7C    /* R   uint8: peak voltage high */
 #define DL_REG_VS_RATIO         0x7D    /* RW  uint8: transformer ratio (1-255) */
 
+/* Voltage window size */
+#define DL_VS_WINDOW_SIZE       6       /* Bytes from 0x78 to 0x7D inclusive */
+
 /* VS_STATUS bits */
 #define DL_VS_NO_HW             (1 << 7)
 #define DL_VS_DATA_READY        (1 << 0)
@@ -197,6 +203,9 @@ extern "C" {
 #define DL_REG_CHARGE_N_2       0x84
 #define DL_REG_CHARGE_N_3       0x85    /* R   uint8: period count byte 3 (MSB) */
 
+/* Register image size covering the whole map (burst reads land at their address) */
+#define DL_REG_MAP_SIZE         0x86
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,7 +6,9 @@
 #include "dimmerlink_device.h"
 #include "dimmerlink_regs.h"
 #include "i2c_bus.h"
+#include "i2c_bus_async.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <string.h>
 
 static const char* TAG = "DL_Dev";
@@ -47,15 +49,11 @@ esp_err_t dl_device_read_info(uint8_t bus, uint8_t addr, dl_device_info_t* info)
     return ESP_OK;
 }
 
-esp_err_t dl_device_read_current(uint8_t bus, uint8_t addr, dl_current_snapshot_t* snap) {
-    uint8_t buf[DL_CS_SNAPSHOT_SIZE];
-    esp_err_t err = i2c_bus_read_reg(bus, addr, DL_REG_CS0_STATUS, buf, DL_CS_SNAPSHOT_SIZE);
-    if (err != ESP_OK) {
-        snap->valid = false;
-        return err;
-    }
+/* ================================================================
+ * Snapshot decoders (shared by the single reads and the burst poll)
+ * ================================================================ */
 
-    /* Parse snapshot from raw bytes (little-endian) */
+static void decode_current(const uint8_t* buf, dl_current_snapshot_t* snap) {
     uint8_t status = buf[0];
     snap->valid        = (status & DL_CS_STATUS_VALID) != 0;
     snap->rt_mode      = (status & DL_CS_STATUS_RT_MODE) != 0;
@@ -72,41 +70,66 @@ esp_err_t dl_device_read_current(uint8_t bus, uint8_t addr, dl_current_snapshot_
     snap->dc_offset    = le16s(&buf[19]);   /* 0x73-0x74 */
     snap->crest_factor = le16(&buf[21]);    /* 0x75-0x76 */
     /* buf[23] = reserved */
+}
+
+static void decode_voltage(const uint8_t* buf, dl_voltage_snapshot_t* snap) {
+    snap->available   = (buf[0] & DL_VS_NO_HW) == 0;
+    snap->data_ready  = (buf[0] & DL_VS_DATA_READY) != 0;
+    snap->rms_v       = (float)le16(&buf[1]) * 0.1f;  /* 0.1V units → V */
+    snap->peak_raw    = le16(&buf[3]);
+    snap->ratio       = buf[5];
+}
 
+static void decode_thermal(const uint8_t* buf, dl_thermal_status_t* status) {
+    status->temperature_c = (int8_t)buf[0] - 50;    /* +50 offset → °C */
+    status->state         = buf[1];
+    status->max_level     = buf[2];
+    status->flags         = buf[3];
+    status->peak_c        = (int8_t)buf[4] - 50;
+    status->rate_cs       = (int8_t)buf[5] - 128;   /* +128 offset → °C/s */
+    status->available     = true;
+}
+
+/* Dimmer status is scattered: decoded from a register image indexed by address */
+static void decode_dimmer(const uint8_t* map, dl_dimmer_status_t* status) {
+    status->level_percent = map[DL_REG_DIM0_LEVEL];
+    status->curve         = map[DL_REG_DIM0_CURVE];
+    status->fade_time     = map[DL_REG_DIM0_FADE_TIME];
+    status->ac_freq_hz    = map[DL_REG_AC_FREQ];
+}
+
+/* ================================================================ */
+
+esp_err_t dl_device_read_current(uint8_t bus, uint8_t addr, dl_current_snapshot_t* snap) {
+    uint8_t buf[DL_CS_SNAPSHOT_SIZE];
+    esp_err_t err = i2c_bus_read_reg(bus, addr, DL_REG_CS0_STATUS, buf, DL_CS_SNAPSHOT_SIZE);
+    if (err != ESP_OK) {
+        snap->valid = false;
+        return err;
+    }
+    decode_current(buf, snap);
     return ESP_OK;
 }
 
 esp_err_t dl_device_read_voltage(uint8_t bus, uint8_t addr, dl_voltage_snapshot_t* snap) {
-    uint8_t buf[6];
-    esp_err_t err = i2c_bus_read_reg(bus, addr, DL_REG_VS_STATUS, buf, 6);
+    uint8_t buf[DL_VS_WINDOW_SIZE];
+    esp_err_t err = i2c_bus_read_reg(bus, addr, DL_REG_VS_STATUS, buf, DL_VS_WINDOW_SIZE);
     if (err != ESP_OK) {
         snap->available = false;
         return err;
     }
-
-    snap->available   = (buf[0] & DL_VS_NO_HW) == 0;
-    snap->data_ready  = (buf[0] & DL_VS_DATA_READY) != 0;
-    snap->rms_v       = (float)le16(&buf[1]) * 0.1f;  /* 0.1V units → V */
-    snap->peak_raw    = le16(&buf[3]);
-    snap->ratio       = buf[5];
+    decode_voltage(buf, snap);
     return ESP_OK;
 }
 
 esp_err_t dl_device_read_thermal(uint8_t bus, uint8_t addr, dl_thermal_status_t* status) {
-    uint8_t buf[6];
-    esp_err_t err = i2c_bus_read_reg(bus, addr, DL_REG_TEMP_CURRENT, buf, 6);
+    uint8_t buf[DL_THERMAL_WINDOW_SIZE];
+    esp_err_t err = i2c_bus_read_reg(bus, addr, DL_REG_TEMP_CURRENT, buf, DL_THERMAL_WINDOW_SIZE);
     if (err != ESP_OK) {
         status->available = false;
         return err;
     }
-
-    status->temperature_c = (int8_t)buf[0] - 50;    /* +50 offset → °C */
-    status->state         = buf[1];
-    status->max_level     = buf[2];
-    status->flags         = buf[3];
-    status->peak_c        = (int8_t)buf[4] - 50;
-    status->rate_cs       = (int8_t)buf[5] - 128;   /* +128 offset → °C/s */
-    status->available     = true;
+    decode_thermal(buf, status);
     return ESP_OK;
 }
 
@@ -133,6 +156,129 @@ esp_err_t dl_device_read_dimmer(uint8_t bus, uint8_t addr, dl_dimmer_status_t* s
     return ESP_OK;
 }
 
+/* ================================================================
+ * Burst poll
+ * ================================================================ */
+
+/* Register windows of the poll snapshots, in address order */
+typedef struct {
+    uint8_t flag;
+    uint8_t reg;
+    uint8_t len;
+} dl_window_t;
+
+static const dl_window_t s_windows[] = {
+    { DL_POLL_DIMMER,  DL_REG_DIM0_LEVEL,   DL_REG_AC_FREQ - DL_REG_DIM0_LEVEL + 1 },
+    { DL_POLL_THERMAL, DL_REG_TEMP_CURRENT, DL_THERMAL_WINDOW_SIZE },
+    { DL_POLL_CURRENT, DL_REG_CS0_STATUS,   DL_CS_SNAPSHOT_SIZE },
+    { DL_POLL_VOLTAGE, DL_REG_VS_STATUS,    DL_VS_WINDOW_SIZE },
+};
+#define DL_WINDOW_COUNT (sizeof(s_windows) / sizeof(s_windows[0]))
+
+void dl_burst_plan(uint8_t what, dl_burst_plan_t* plan) {
+    memset(plan, 0, sizeof(*plan));
+    dl_burst_read_t* cur = NULL;
+
+    for (size_t i = 0; i < DL_WINDOW_COUNT; i++) {
+        const dl_window_t* w = &s_windows[i];
+        if (!(what & w->flag)) continue;
+
+        if (cur) {
+            unsigned end  = (unsigned)cur->reg + cur->len;          /* first reg after cur */
+            unsigned wend = (unsigned)w->reg + w->len;
+            if (w->reg >= end && w->reg - end <= DL_BURST_MAX_GAP &&
+                wend - cur->reg <= DL_BURST_MAX_LEN) {
+                cur->len      = (uint8_t)(wend - cur->reg);
+                cur->windows |= w->flag;
+                continue;
+            }
+        }
+        if (plan->count >= DL_BURST_MAX_READS) break;
+        cur = &plan->read[plan->count++];
+        cur->reg     = w->reg;
+        cur->len     = w->len;
+        cur->windows = w->flag;
+    }
+
+    for (uint8_t i = 0; i < plan->count; i++) plan->bytes += plan->read[i].len;
+}
+
+void dl_poll_job_init(dl_poll_job_t* job, uint8_t bus, uint8_t addr, uint8_t what,
+                      SemaphoreHandle_t done) {
+    dl_burst_plan(what, &job->plan);
+    job->bus       = bus;
+    job->addr      = addr;
+    job->next      = 0;
+    job->ok        = 0;
+    job->first_err = ESP_OK;
+    job->done_us   = 0;
+    job->done      = done;
+}
+
+static void job_fail(dl_poll_job_t* job, uint8_t idx, esp_err_t err) {
+    const dl_burst_read_t* r = &job->plan.read[idx];
+    ESP_LOGD(TAG, "0x%02X: burst 0x%02X+%u failed: %s",
+             job->addr, r->reg, r->len, esp_err_to_name(err));
+    if (job->first_err == ESP_OK) job->first_err = err;
+}
+
+/* Read completion (bus worker). The poller reads the job after taking `done`. */
+static void job_read_done(esp_err_t result, void* ctx) {
+    dl_poll_read_ref_t* ref = (dl_poll_read_ref_t*)ctx;
+    dl_poll_job_t* job = ref->job;
+    if (result == ESP_OK) {
+        job->ok |= job->plan.read[ref->idx].windows;
+    } else {
+        job_fail(job, ref->idx, result);
+    }
+    job->done_us = esp_timer_get_time();
+    xSemaphoreGive(job->done);
+}
+
+esp_err_t dl_poll_job_submit(dl_poll_job_t* job) {
+    if (!dl_poll_job_pending(job)) return ESP_ERR_INVALID_STATE;
+    const uint8_t idx = job->next;
+    const dl_burst_read_t* r = &job->plan.read[idx];
+
+    job->ref[idx].job = job;
+    job->ref[idx].idx = idx;
+    const i2c_bus_xfer_t x = {
+        .op   = I2C_BUS_OP_READ_STOP,
+        .prio = I2C_BUS_PRIO_TELEMETRY,
+        .addr = job->addr,
+        .reg  = r->reg,
+        .rx   = &job->map[r->reg],
+        .len  = r->len,
+        .cb   = job_read_done,
+        .ctx  = &job->ref[idx],
+    };
+    esp_err_t err = i2c_bus_submit(job->bus, &x, NULL);
+    if (err == ESP_ERR_NO_MEM) return err;      /* not consumed: retry this read */
+    job->next++;
+    if (err != ESP_OK) job_fail(job, idx, err);
+    return err;
+}
+
+esp_err_t dl_poll_job_finish(const dl_poll_job_t* job, dl_poll_result_t* out) {
+    const uint8_t* map = job->map;
+    out->ok      = job->ok;
+    out->reads   = job->next;
+    out->done_us = job->done_us;
+
+    if (out->ok & DL_POLL_CURRENT) decode_current(&map[DL_REG_CS0_STATUS], &out->current);
+    else out->current.valid = false;
+
+    if (out->ok & DL_POLL_VOLTAGE) decode_voltage(&map[DL_REG_VS_STATUS], &out->voltage);
+    else out->voltage.available = false;
+
+    if (out->ok & DL_POLL_THERMAL) decode_thermal(&map[DL_REG_TEMP_CURRENT], &out->thermal);
+    else out->thermal.available = false;
+
+    if (out->ok & DL_POLL_DIMMER) decode_dimmer(map, &out->dimmer);
+
+    return job->first_err;
+}
+
 /* ================================================================
  * Write Operations
  * ================================================================ */
@@ -151,6 +297,38 @@ esp_err_t dl_device_set_dimmer_fade(uint8_t bus, uint8_t addr,
     return i2c_bus_write_byte(bus, addr, DL_REG_DIM0_LEVEL, percent);
 }
 
+esp_err_t dl_device_set_dimmer_level_async(uint8_t bus, uint8_t addr, uint8_t percent,
+                                           i2c_bus_done_cb_t done, void* ctx) {
+    if (percent > 100) percent = 100;
+    const i2c_bus_xfer_t x = {
+        .op   = I2C_BUS_OP_WRITE,
+        .prio = I2C_BUS_PRIO_ACTUATION,
+        .addr = addr,
+        .reg  = DL_REG_DIM0_LEVEL,
+        .tx   = &percent,
+        .len  = 1,
+        .cb   = done,
+        .ctx  = ctx,
+    };
+    return i2c_bus_submit(bus, &x, NULL);
+}
+
+esp_err_t dl_device_set_dimmer_fade_async(uint8_t bus, uint8_t addr, uint8_t percent,
+                                          uint8_t fade_100ms, i2c_bus_done_cb_t done, void* ctx) {
+    /* Same class, FIFO: the fade time is on the module before the level lands. */
+    const i2c_bus_xfer_t x = {
+        .op   = I2C_BUS_OP_WRITE,
+        .prio = I2C_BUS_PRIO_ACTUATION,
+        .addr = addr,
+        .reg  = DL_REG_DIM0_FADE_TIME,
+        .tx   = &fade_100ms,
+        .len  = 1,
+    };
+    esp_err_t err = i2c_bus_submit(bus, &x, NULL);
+    if (err != ESP_OK) return err;
+    return dl_device_set_dimmer_level_async(bus, addr, percent, done, ctx);
+}
+
 esp_err_t dl_device_set_dimmer_curve(uint8_t bus, uint8_t addr, uint8_t curve) {
     return i2c_bus_write_byte(bus, addr, DL_REG_DIM0_CURVE, curve);
 }
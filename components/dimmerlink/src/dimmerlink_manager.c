@@ -7,13 +7,16 @@
 #include "dimmerlink_device.h"
 #include "dimmerlink_regs.h"
 #include "i2c_bus.h"
+#include "i2c_bus_health.h"
 #include "sdkconfig.h"
 #include "acrouter_events.h"
+#include "acrouter_meas_ring.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_task_wdt.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include <string.h>
@@ -43,21 +46,45 @@ static volatile uint32_t s_poll_last_us = 0;
 static volatile uint32_t s_poll_avg_us  = 0;
 static volatile uint32_t s_poll_count   = 0;
 
+/* Register-read count of the last cycle: planned bursts vs one read per snapshot
+ * register group as polled before burst planning (for the `timing` readout). */
+static volatile uint16_t s_poll_reads     = 0;
+static volatile uint16_t s_poll_unplanned = 0;
+static uint16_t s_cycle_reads;
+static uint16_t s_cycle_unplanned;
+
+/* One poll job per slot; reads of all devices are in flight together, so the
+ * bus-0 and bus-1 workers run their share of the cycle concurrently. */
+static dl_poll_job_t s_jobs[DL_MAX_DEVICES];
+static SemaphoreHandle_t s_cycle_done;      /* given once per completed read */
+
 /* ================================================================
  * Internal: Poll one device
  * ================================================================ */
 
-static void poll_device(uint8_t slot) {
-    dl_device_state_t* dev = &s_devices[slot];
-    if (!dev->config.enabled) return;
+/* Current (primary data) and thermal always; voltage and dimmer status by role.
+ * @p unplanned receives the reads the same poll cost before burst planning. */
+static uint8_t poll_mask(const dl_device_state_t* dev, uint16_t* unplanned) {
+    uint8_t what = DL_POLL_CURRENT | DL_POLL_THERMAL;
+    *unplanned = 2;
+    if (dev->config.role == DL_ROLE_VOLTAGE) {
+        what |= DL_POLL_VOLTAGE;
+        *unplanned += 1;
+    }
+    if (dev->config.role == DL_ROLE_DIMMER) {
+        what |= DL_POLL_DIMMER;
+        *unplanned += 4;
+    }
+    return what;
+}
 
-    uint8_t bus = dev->config.i2c_bus;
+/* Apply one device's completed poll: online tracking, snapshots, publish. */
+static void poll_device_done(uint8_t slot, const dl_poll_result_t* res, uint8_t what) {
+    dl_device_state_t* dev = &s_devices[slot];
     uint8_t addr = dev->config.i2c_addr;
-    esp_err_t err;
 
-    /* Read current sensor snapshot (primary data) */
-    err = dl_device_read_current(bus, addr, &dev->current);
-    if (err != ESP_OK) {
+    dev->current = res->current;
+    if (!(res->ok & DL_POLL_CURRENT)) {
         dev->error_count++;
         if (dev->error_count >= DL_MAX_ERRORS && dev->online) {
             dev->online = false;
@@ -75,18 +102,10 @@ static void poll_device(uint8_t slot) {
     dev->error_count = 0;
     dev->last_poll_ms = (uint32_t)(esp_timer_get_time() / 1000);
 
-    /* Read voltage if this device has voltage sensor */
-    if (dev->config.role == DL_ROLE_VOLTAGE) {
-        dl_device_read_voltage(bus, addr, &dev->voltage);
-    }
-
-    /* Read thermal if available (non-critical, ignore errors) */
-    dl_device_read_thermal(bus, addr, &dev->thermal);
-
-    /* Read dimmer status if this is a dimmer */
-    if (dev->config.role == DL_ROLE_DIMMER) {
-        dl_device_read_dimmer(bus, addr, &dev->dimmer);
-    }
+    /* Secondary windows: keep a failed one's last dimmer status, mark the rest */
+    if (what & DL_POLL_VOLTAGE) dev->voltage = res->voltage;
+    dev->thermal = res->thermal;    /* non-critical: available=false on error */
+    if (res->ok & DL_POLL_DIMMER) dev->dimmer = res->dimmer;
 
     /* Post event for sensor roles */
     if (dev->current.valid && dev->config.role >= DL_ROLE_CURRENT_GRID
@@ -96,7 +115,7 @@ static void poll_device(uint8_t slot) {
 
         meas.source = ACROUTER_SOURCE_I2C;
         meas.source_id = slot;
-        meas.timestamp_us = esp_timer_get_time();
+        meas.timestamp_us = res->done_us ? res->done_us : esp_timer_get_time();
         meas.valid = true;
 
         /* Map role to channel */
@@ -144,8 +163,61 @@ static void poll_device(uint8_t slot) {
                 break;
         }
 
-        esp_event_post(ACROUTER_EVENT, ACROUTER_EVENT_POWER_UPDATE,
-                       &meas, sizeof(meas), 0);
+        acrouter_meas_publish(&meas);
+    }
+}
+
+/* One cycle over every enabled device. Reads are submitted round-robin across
+ * devices (one per device per pass), so both bus queues fill from the start;
+ * a full queue is drained by one completion before the next attempt. */
+static void poll_cycle(void) {
+    uint8_t what[DL_MAX_DEVICES] = {0};
+    bool skip[DL_MAX_DEVICES] = {false};
+    uint16_t inflight = 0;
+
+    for (uint8_t i = 0; i < DL_MAX_DEVICES; i++) {
+        if (!s_devices[i].config.enabled) continue;
+        uint16_t unplanned;
+        what[i] = poll_mask(&s_devices[i], &unplanned);
+        s_cycle_unplanned += unplanned;
+        dl_poll_job_init(&s_jobs[i], s_devices[i].config.i2c_bus,
+                         s_devices[i].config.i2c_addr, what[i], s_cycle_done);
+        /* Backed off after repeated failures: no bus time, a failed poll. */
+        skip[i] = !i2c_bus_health_admit(s_devices[i].config.i2c_bus,
+                                        s_devices[i].config.i2c_addr);
+    }
+
+    bool more = true;
+    while (more && s_poll_running) {
+        more = false;
+        for (uint8_t i = 0; i < DL_MAX_DEVICES; i++) {
+            if (!what[i] || skip[i] || !dl_poll_job_pending(&s_jobs[i])) continue;
+            esp_err_t err = dl_poll_job_submit(&s_jobs[i]);
+            if (err == ESP_OK) {
+                inflight++;
+            } else if (err == ESP_ERR_NO_MEM) {
+                if (inflight > 0) {
+                    xSemaphoreTake(s_cycle_done, portMAX_DELAY);
+                    inflight--;
+                } else {
+                    vTaskDelay(1);      /* queue full of other pollers' reads */
+                }
+            }
+            if (dl_poll_job_pending(&s_jobs[i])) more = true;
+        }
+    }
+    /* Bounded: every queued read completes by its deadline plus one bus timeout. */
+    while (inflight > 0) {
+        xSemaphoreTake(s_cycle_done, portMAX_DELAY);
+        inflight--;
+    }
+
+    for (uint8_t i = 0; i < DL_MAX_DEVICES; i++) {
+        if (!what[i] || !s_devices[i].config.enabled) continue;
+        dl_poll_result_t res;
+        dl_poll_job_finish(&s_jobs[i], &res);
+        s_cycle_reads += res.reads;
+        poll_device_done(i, &res, what[i]);
     }
 }
 
@@ -172,15 +244,15 @@ static void dl_poll_task(void* param) {
             continue;
         }
         int64_t t0 = esp_timer_get_time();
-        for (uint8_t i = 0; i < DL_MAX_DEVICES && s_poll_running; i++) {
-            if (s_devices[i].config.enabled) {
-                poll_device(i);
-            }
-        }
+        s_cycle_reads     = 0;
+        s_cycle_unplanned = 0;
+        poll_cycle();
         uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
         s_poll_last_us = dt;
         s_poll_avg_us  = s_poll_avg_us ? (s_poll_avg_us * 7 + dt) / 8 : dt;  // EMA/8
         s_poll_count++;
+        s_poll_reads     = s_cycle_reads;
+        s_poll_unplanned = s_cycle_unplanned;
         if (wdt) esp_task_wdt_reset();
         vTaskDelay(pdMS_TO_TICKS(s_poll_interval_ms));
     }
@@ -231,6 +303,11 @@ esp_err_t dl_manager_start_polling(uint16_t interval_ms) {
         return ESP_ERR_INVALID_STATE;
     }
 
+    if (!s_cycle_done) {
+        s_cycle_done = xSemaphoreCreateCounting(DL_MAX_DEVICES * DL_BURST_MAX_READS, 0);
+        if (!s_cycle_done) return ESP_ERR_NO_MEM;
+    }
+
     s_poll_interval_ms = interval_ms > 0 ? interval_ms : DL_DEFAULT_POLL_MS;
     s_poll_running = true;
 
@@ -271,11 +348,24 @@ void dl_manager_get_timing(uint32_t *last_us, uint32_t *avg_us, uint32_t *count)
     if (count)   *count   = s_poll_count;
 }
 
+void dl_manager_get_poll_reads(uint16_t *reads, uint16_t *unplanned) {
+    if (reads)     *reads     = s_poll_reads;
+    if (unplanned) *unplanned = s_poll_unplanned;
+}
+
 const dl_device_state_t* dl_manager_get_device(uint8_t slot) {
     if (slot >= DL_MAX_DEVICES) return NULL;
     return &s_devices[slot];
 }
 
+uint8_t dl_manager_get_bus_count(uint8_t bus) {
+    uint8_t count = 0;
+    for (int i = 0; i < DL_MAX_DEVICES; i++) {
+        if (s_devices[i].config.enabled && s_devices[i].config.i2c_bus == bus) count++;
+    }
+    return count;
+}
+
 uint8_t dl_manager_get_active_count(void) {
     uint8_t count = 0;
     for (uint8_t i = 0; i < DL_MAX_DEVICES; i++) {
@@ -368,6 +458,9 @@ esp_err_t dl_manager_change_address(uint8_t cur_addr, uint8_t new_addr) {
     }
 
     dl_device_send_command(bus, cur_addr, DL_CMD_RESET);
+    /* The module answers at new_addr from now on: drop both cached handles. */
+    i2c_bus_invalidate_device(bus, cur_addr);
+    i2c_bus_invalidate_device(bus, new_addr);
     ESP_LOGI(TAG, "DimmerLink address 0x%02X -> 0x%02X (reset issued; applies on reset)",
              cur_addr, new_addr);
     return ESP_OK;
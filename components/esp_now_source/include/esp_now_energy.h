@@ -0,0 +1,121 @@
+/**
+ * @file esp_now_energy.h
+ * @brief Billing-grade energy store fed by ESP-NOW PERIOD frames (hub side).
+ *
+ * A node integrates energy on its side and sends each finished period as a
+ * PERIOD frame, holding it until the hub answers with a PERIOD_ACK. The store
+ * accumulates import / export Wh per (node, channel):
+ *
+ *   - Dedupe: a retransmit (its ACK was lost) repeats h.seq and the records;
+ *     it is recognised against the node's last ESP_NOW_ENERGY_SEQ_WINDOW
+ *     accepted (restart, seq, record fingerprint) keys, ACKed again and not
+ *     added. The protocol has no boot counter, so the hub counts restarts: a
+ *     frame that is no retransmit but does not advance the node's seq means
+ *     the node rebooted and restarted its counter, and the seqs of the past
+ *     epoch no longer match. The fingerprint covers a reused seq before that.
+ *   - One period type per channel: the first accepted type is latched, so a
+ *     node reporting both e.g. hourly and daily periods is not counted twice.
+ *   - Persistence: totals and seq windows go to NVS together, in batches, at
+ *     most every CONFIG_ACROUTER_ESPNOW_ENERGY_COMMIT_S (and on stop/flush).
+ *     Each node's blob carries a layout version and size; one in another
+ *     layout is not loaded.
+ *     The ACK is sent on receipt, so a power loss can lose at most one commit
+ *     interval of already-ACKed energy; a shorter interval trades flash wear.
+ *   - A full store rejects a new node's frame unACKed: the node keeps holding
+ *     it, nothing is lost, and no existing node is ever evicted.
+ *
+ * Thread-safe: ingest runs in the ESP-NOW receive callback, service in the
+ * inject task, the getters from web/MQTT/serial.
+ */
+#ifndef ESP_NOW_ENERGY_H
+#define ESP_NOW_ENERGY_H
+
+#include "esp_err.h"
+#include "esp_now_source.h"
+#include "espnow_proto.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_NOW_ENERGY_NODES        ESP_NOW_SOURCE_MAX_NODES  ///< metered nodes kept
+#define ESP_NOW_ENERGY_SEQ_WINDOW   8   ///< accepted seqs remembered per node (dedupe)
+
+/** Per-channel totals. */
+typedef struct {
+    uint8_t  channel;
+    uint8_t  period_type;   ///< latched rbpower period type
+    uint32_t periods;       ///< periods added
+    double   import_wh;     ///< Wh, energy_wh > 0
+    double   export_wh;     ///< Wh, energy_wh < 0 (stored positive)
+} esp_now_energy_channel_t;
+
+/** Per-node totals. */
+typedef struct {
+    uint8_t  mac[6];
+    uint32_t frames;        ///< PERIOD frames accepted
+    uint32_t duplicates;    ///< retransmits recognised by seq (ACKed, not added)
+    uint32_t restarts;      ///< seq counter restarts (node reboots) seen
+    uint32_t skipped;       ///< records not added (unknown channel, other period type, non-finite)
+    uint32_t last_node_ts;  ///< node clock of the last accepted frame (0 = not time-synced)
+    uint8_t  ch_mask;       ///< bit c = ch[c] holds data
+    esp_now_energy_channel_t ch[ESP_NOW_SOURCE_MAX_NODE_CH];
+} esp_now_energy_node_t;
+
+/** Store counters (since boot). */
+typedef struct {
+    uint32_t updates;       ///< accepted frames (changes whenever a total does)
+    uint32_t commits;       ///< NVS commits
+    uint32_t rejected_full; ///< frames left unACKed because the store was full
+    bool     dirty;         ///< totals not yet committed
+    uint32_t commit_interval_s; ///< batch interval (CONFIG_ACROUTER_ESPNOW_ENERGY_COMMIT_S)
+} esp_now_energy_stats_t;
+
+/**
+ * @brief Load the totals from NVS. With a batch still uncommitted RAM is newer
+ * than flash and is kept as is.
+ */
+esp_err_t esp_now_energy_init(void);
+
+/**
+ * @brief Account one PERIOD frame.
+ * @param mac      sender MAC.
+ * @param seq      the frame's h.seq (what the ACK echoes).
+ * @param node_ts  the frame's h.node_ts.
+ * @param recs     records (rec_count already capped by the received length).
+ * @param n        number of records.
+ * @param dup      out (optional): true if the frame was a retransmit.
+ * @return ESP_OK (ACK it — new or duplicate); ESP_ERR_NO_MEM (store full — do NOT ACK);
+ *         ESP_ERR_INVALID_ARG.
+ */
+esp_err_t esp_now_energy_ingest(const uint8_t mac[6], uint32_t seq, uint32_t node_ts,
+                                const rbn_period_rec_t *recs, size_t n, bool *dup);
+
+/**
+ * @brief Commit to NVS if dirty and the batch interval has elapsed.
+ * @return ms until the next commit is due; UINT32_MAX if nothing is pending.
+ */
+uint32_t esp_now_energy_service(void);
+
+/** @brief Commit now if dirty (stop, explicit save). */
+esp_err_t esp_now_energy_flush(void);
+
+/** @brief List metered nodes with their totals. */
+esp_err_t esp_now_energy_get(esp_now_energy_node_t *out, size_t max, size_t *n);
+
+/**
+ * @brief Clear the totals of one node (or all with @p mac NULL) and persist at once.
+ * @return ESP_OK; ESP_ERR_NOT_FOUND if @p mac is not metered.
+ */
+esp_err_t esp_now_energy_reset(const uint8_t mac[6]);
+
+void esp_now_energy_get_stats(esp_now_energy_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESP_NOW_ENERGY_H */
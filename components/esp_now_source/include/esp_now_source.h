@@ -7,9 +7,10 @@
  * ACROUTER_SOURCE_ESPNOW events (priority 0), exactly like rbamp_source does
  * for the I2C path — the merge/routing layer is transport-agnostic.
  *
- * Scope (minimal, per operator): RX rbAmp measurements only. NO master/PTP
- * time-sync, NO period/billing, NO beacon time-master. Dimmer control TX to the
- * node is a later addition (with the deferred dimmer work).
+ * Scope (minimal, per operator): RX rbAmp measurements, plus PERIOD billing
+ * energy (ACKed, deduped, persisted — see esp_now_energy.h). The hub is the
+ * time master of its nodes (see the TIME MASTER section). Output nodes: see the
+ * OUTPUT NODES section.
  *
  * Bring-up runs OPEN (unencrypted): ESP-NOW delivers unicast/broadcast frames
  * from any sender to the recv callback without a registered peer, so no keys are
@@ -36,7 +37,13 @@ extern "C" {
 /** Max wireless nodes tracked (kept small for Sensor Hub cache headroom). */
 #define ESP_NOW_SOURCE_MAX_NODES 4
 
-/** Measurement role of a node's primary channel → Sensor Hub slot. */
+/** Measurement channels decoded per node (REALTIME channel_id 0..N-1). */
+#define ESP_NOW_SOURCE_MAX_NODE_CH 4
+
+/** Commissioned (node, channel) → role entries. */
+#define ESP_NOW_SOURCE_MAX_ROLES 8
+
+/** Measurement role of a node channel → Sensor Hub slot. */
 typedef enum {
     ESPNOW_ROLE_NONE    = 0,  ///< Seen/logged only, not mapped to a slot
     ESPNOW_ROLE_GRID    = 1,
@@ -48,13 +55,17 @@ typedef enum {
 /** Live view of a seen node. */
 typedef struct {
     uint8_t               mac[6];
-    esp_now_source_role_t role;
+    esp_now_source_role_t role;         ///< role of channel 0
     bool                  online;       ///< a REALTIME frame arrived recently
     float                 voltage;      ///< V (NaN/0 if none)
     float                 current;      ///< A (primary channel)
     float                 power;        ///< W (signed)
     float                 power_factor; ///< -1..+1
     float                 frequency;    ///< Hz
+    uint8_t               ch_mask;      ///< bit c = channel c was in the last REALTIME
+    esp_now_source_role_t ch_role[ESP_NOW_SOURCE_MAX_NODE_CH];     ///< role per channel
+    float                 ch_current[ESP_NOW_SOURCE_MAX_NODE_CH];  ///< A per channel
+    float                 ch_power[ESP_NOW_SOURCE_MAX_NODE_CH];    ///< W per channel (signed)
 } esp_now_source_node_info_t;
 
 /**
@@ -65,20 +76,45 @@ typedef struct {
  */
 esp_err_t esp_now_source_init(void);
 
-/** @brief Start receiving + the inject task (posts to the Sensor Hub). */
+/**
+ * @brief Start receiving + the inject task (posts to the Sensor Hub).
+ *
+ * The inject task sleeps on its task notification: the recv callback wakes it
+ * per REALTIME frame, so a measurement reaches the hub right after it lands
+ * rather than on a poll tick. Frames of one node that arrive before the task
+ * runs coalesce into one post of the newest. Idle, it only wakes for the
+ * output keep-alive and the time-master beacons.
+ */
 esp_err_t esp_now_source_start(void);
 
 /** @brief Stop the source (deinit ESP-NOW, stop inject task). */
 void esp_now_source_stop(void);
 
 /**
- * @brief Assign a Sensor Hub role to a node by MAC (commissioning), persisted.
+ * @brief Assign a Sensor Hub role to channel 0 of a node by MAC (commissioning).
+ * Same as esp_now_source_set_channel_role(mac, 0, role).
  * @param mac   6-byte node MAC.
  * @param role  Role (NONE removes the mapping).
  * @return ESP_OK, or ESP_ERR_NO_MEM if the table is full.
  */
 esp_err_t esp_now_source_set_role(const uint8_t mac[6], esp_now_source_role_t role);
 
+/**
+ * @brief Assign a Sensor Hub role to one channel of a multi-channel node.
+ *
+ * A node may pack several channel records (e.g. grid + solar + load of a
+ * three-CT node) into one REALTIME frame; every commissioned channel of the
+ * frame is posted in one measurement, all sampled at the same instant. When two
+ * channels claim the same role, the lower channel wins. Call
+ * esp_now_source_save_config() to persist.
+ * @param mac      6-byte node MAC.
+ * @param channel  REALTIME channel_id (0..ESP_NOW_SOURCE_MAX_NODE_CH-1).
+ * @param role     Role (NONE removes the mapping).
+ * @return ESP_OK; ESP_ERR_INVALID_ARG (bad channel); ESP_ERR_NO_MEM if the table is full.
+ */
+esp_err_t esp_now_source_set_channel_role(const uint8_t mac[6], uint8_t channel,
+                                          esp_now_source_role_t role);
+
 /** @brief List currently seen nodes (identity + role + last snapshot). */
 esp_err_t esp_now_source_get_nodes(esp_now_source_node_info_t *out, size_t max, size_t *n);
 
@@ -89,6 +125,84 @@ esp_err_t esp_now_source_load_config(void);
 /** @brief Number of nodes seen since start. */
 size_t esp_now_source_seen_count(void);
 
+/** RX path counters and RX->hub latency (since boot). */
+typedef struct {
+    uint32_t frames;        ///< REALTIME frames accepted
+    uint32_t coalesced;     ///< frames superseded by a newer one before they were posted
+    uint32_t posts;         ///< measurements posted to the Sensor Hub
+    uint32_t wakeups;       ///< inject-task wake-ups carrying a frame
+    uint32_t samples;       ///< latency samples (= posts)
+    uint32_t p50_us;        ///< median recv-callback -> hub publish (last 128 posts)
+    uint32_t p99_us;        ///< 99th percentile (us)
+    uint32_t max_us;        ///< maximum since boot (us)
+} esp_now_source_rx_stats_t;
+
+/** @brief RX counters and p50/p99 RX-to-hub latency. */
+esp_err_t esp_now_source_get_rx_stats(esp_now_source_rx_stats_t *out);
+
+/* ================================================================
+ * TIME MASTER — hub side of the rbgrid sync protocol.
+ * Every CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS the hub broadcasts a SYNC_BEACON;
+ * the send callback stamps its TX instant (esp_timer) and a SYNC_FOLLOWUP then
+ * carries that stamp, so the nodes discipline their sample clocks to the hub's
+ * esp_timer without the TX queueing delay in the measurement (two-step, as in
+ * PTP). Beacon and follow-up alternate — the next beacon waits for the
+ * follow-up's send callback — so a callback is never taken for the wrong frame.
+ * TIME_REQ is answered with the hub's NTP wall clock (only once it is
+ * set). LATCH_NOW makes every sensor node close its period at the same instant.
+ * The nodes report how well they track the beacons in NODE_STATS.
+ * ================================================================ */
+
+/** Sync quality of one node, as the node reports it in NODE_STATS. */
+typedef struct {
+    uint8_t  mac[6];
+    bool     online;          ///< NODE_STATS seen in the last 30 s
+    uint32_t age_ms;          ///< since the last NODE_STATS
+    uint32_t beacons_recv;
+    uint32_t followups_recv;
+    uint32_t beacons_missed;  ///< max_beacon_id - beacons_recv
+    uint32_t fits;            ///< residual samples behind the figures below
+    float    offset_us;       ///< mean residual vs the hub clock
+    float    jitter_us;       ///< residual standard deviation
+    float    max_abs_us;      ///< largest |residual|
+    float    skew_ppm;        ///< node crystal vs hub
+    uint32_t time_reqs;       ///< TIME_REQs received from this node
+} esp_now_source_sync_node_t;
+
+/** Time-master counters (since boot). */
+typedef struct {
+    bool     enabled;         ///< beacons are sent (interval > 0)
+    uint32_t interval_ms;
+    uint32_t epoch;           ///< boot-unique master id carried in every beacon
+    uint32_t beacon_id;       ///< last beacon sent (restarts from 1 each boot)
+    uint32_t beacons;         ///< beacons sent
+    uint32_t followups;       ///< follow-ups sent (one per beacon the send-cb stamped)
+    uint32_t tx_fail;         ///< beacons not stamped, or send callbacks overdue
+    uint32_t time_resps;      ///< TIME_RESPs sent
+    uint32_t time_unset;      ///< TIME_REQs left unanswered (wall clock not set yet)
+    uint32_t latches;         ///< LATCH_NOW frames sent
+} esp_now_source_sync_stats_t;
+
+/**
+ * @brief Time-master counters plus the sync quality of every node that sent
+ * NODE_STATS or TIME_REQ.
+ * @param st     out: counters (optional).
+ * @param nodes  out: per-node view (optional).
+ * @param max    capacity of @p nodes.
+ * @param n      out: entries written (optional).
+ */
+esp_err_t esp_now_source_get_sync(esp_now_source_sync_stats_t *st,
+                                  esp_now_source_sync_node_t *nodes, size_t max, size_t *n);
+
+/**
+ * @brief Send LATCH_NOW to every known sensor node (REALTIME or PERIOD sender)
+ * back to back, so they all close their period at the same instant.
+ * @param reason  RBN_LATCH_REASON_*.
+ * @param sent    out (optional): nodes the frame was handed to.
+ * @return ESP_OK; ESP_ERR_INVALID_STATE if the source is not running.
+ */
+esp_err_t esp_now_source_latch_now(uint8_t reason, size_t *sent);
+
 /* ================================================================
  * OUTPUT NODES (dimmer / relay over ESP-NOW) — hub side.
  * Discovery = HELLO (node broadcasts family + per-output capability); control =
@@ -96,6 +210,13 @@ size_t esp_now_source_seen_count(void);
  * keep-alive cadence (<= RBN_OUTPUT_FAILSAFE_MS/2) so the node never falls to its
  * failsafe while the link is healthy. Transport-agnostic mate of the I2C dimmer
  * path: RouterController sets a level, the dispatcher routes it here for ESP-NOW.
+ *
+ * Airtime: only changed levels are sent, one frame per node per update. A node
+ * whose HELLO carries RBN_HELLO_F_BATCH_OUT gets all its changed outputs in one
+ * SET_OUTPUTS, and as keep-alive a 17-byte OUTPUT_DIGEST of the commanded state
+ * instead of the full re-assert; the full state goes out again only when the
+ * node reports a mismatch (OUTPUT_STATE RESYNC / failsafe) or re-HELLOs. Older
+ * nodes keep SET_OUTPUT per output and the full keep-alive.
  * ================================================================ */
 
 #define ESP_NOW_SOURCE_OUT_NODES_MAX 4   ///< tracked output nodes
@@ -121,18 +242,33 @@ typedef struct {
     uint8_t  out_count;
     bool     online;        ///< HELLO or OUTPUT_STATE seen recently
     bool     failsafe;      ///< node reported a failsafe trip
+    bool     batch;         ///< node takes SET_OUTPUTS + digest keep-alive
     esp_now_source_output_info_t outputs[ESP_NOW_SOURCE_OUT_PER_NODE];
 } esp_now_source_output_node_info_t;
 
+/** Output TX counters (since boot). */
+typedef struct {
+    uint32_t frames;        ///< SET_OUTPUT + SET_OUTPUTS frames sent
+    uint32_t batched;       ///< ... of which SET_OUTPUTS
+    uint32_t items;         ///< output values carried by those frames
+    uint32_t digests;       ///< OUTPUT_DIGEST keep-alives sent
+    uint32_t resyncs;       ///< full-state resends requested by a node
+    uint32_t unchanged;     ///< set_output() calls that changed nothing (not sent)
+    uint32_t send_fail;     ///< sends esp_now_send refused (retried)
+} esp_now_source_out_stats_t;
+
 /**
  * @brief Drive an output on a node: record the desired value (hub-authoritative,
- * re-asserted by keep-alive) and send a SET_OUTPUT immediately. Idempotent.
+ * re-asserted by keep-alive). A changed value wakes the inject task, which sends
+ * it together with the node's other changes of the same update (within
+ * CONFIG_ACROUTER_ESPNOW_OUT_BATCH_MS); an unchanged one sends nothing. Idempotent.
  * @param mac        node MAC (from HELLO).
  * @param output_id  target output on that node.
- * @param kind       RBN_OUT_KIND_* (must match the output; node rejects mismatch).
- * @param value      dimmer 0..1000‰ / relay 0|1 (node clamps to range).
+ * @param kind       RBN_OUT_KIND_* (must match the output).
+ * @param value      dimmer 0..1000‰ / relay 0|1 (clamped to the output's range).
  * @param ramp_ms    dimmer fade (0=immediate); ignored for relay.
- * @return ESP_OK; ESP_ERR_NOT_FOUND if no such node/output; propagated send error.
+ * @return ESP_OK (queued); ESP_ERR_NOT_FOUND if no such node/output;
+ *         ESP_ERR_INVALID_ARG on a kind mismatch.
  */
 esp_err_t esp_now_source_set_output(const uint8_t mac[6], uint8_t output_id,
                                     uint8_t kind, uint16_t value, uint16_t ramp_ms);
@@ -141,6 +277,9 @@ esp_err_t esp_now_source_set_output(const uint8_t mac[6], uint8_t output_id,
 esp_err_t esp_now_source_get_output_nodes(esp_now_source_output_node_info_t *out,
                                           size_t max, size_t *n);
 
+/** @brief Output TX counters (frames, batching, digests, resyncs). */
+esp_err_t esp_now_source_get_out_stats(esp_now_source_out_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,6 +34,8 @@ enum {
     RBN_MSG_LATCH_NOW     = 0x32,  /* reserved v2 */
     RBN_MSG_SET_OUTPUT    = 0x40,  /* hub->node: drive an output (dimmer/relay), encrypted unicast */
     RBN_MSG_OUTPUT_STATE  = 0x41,  /* node->hub: applied-state + ACK (held-until-ACK on hub) */
+    RBN_MSG_SET_OUTPUTS   = 0x42,  /* hub->node: several outputs in one frame (RBN_HELLO_F_BATCH_OUT nodes) */
+    RBN_MSG_OUTPUT_DIGEST = 0x43,  /* hub->node: keep-alive carrying only a digest of the commanded state */
 };
 
 /* Common 12-byte header (every frame begins with this). */
@@ -75,6 +77,9 @@ typedef struct __attribute__((packed)) {
     uint16_t freq_x100;
     uint8_t  flags;        /* bit0 valid, bit1 direction_export */
 } rbn_rt_rec_t;
+#define RBN_RT_CH_VBUS      0xFF   /* channel_id of the node voltage-bus record */
+#define RBN_RT_F_VALID      0x01
+#define RBN_RT_F_EXPORT     0x02
 
 /* 0x02 REALTIME frame: header + rec_count + rec_count*records. */
 typedef struct __attribute__((packed)) {
@@ -188,6 +193,7 @@ enum { RBN_FAMILY_SENSOR = 0x01, RBN_FAMILY_DIMMER = 0x02, RBN_FAMILY_RELAY = 0x
 #define RBN_HELLO_F_MAINS_POWERED  0x02
 #define RBN_HELLO_F_TIME_SYNCED    0x04
 #define RBN_HELLO_F_HAS_OUTPUTS    0x08
+#define RBN_HELLO_F_BATCH_OUT      0x10   /* node takes SET_OUTPUTS + OUTPUT_DIGEST (else SET_OUTPUT only) */
 
 /* output kind */
 enum { RBN_OUT_KIND_DIMMER = 0x01, RBN_OUT_KIND_RELAY = 0x02 };
@@ -225,9 +231,49 @@ typedef struct __attribute__((packed)) {
     uint8_t   flags;          /* RBN_SETOUT_F_* */
 } rbn_set_output_t;
 
+/* 0x42 SET_OUTPUTS (hub->node, encrypted unicast): the SET_OUTPUT body for `count` outputs of one node
+ * in one frame (h.seq = command id). Applied item by item exactly like SET_OUTPUT; the node answers with
+ * an OUTPUT_STATE per item (ack_seq = h.seq). Only sent to nodes whose HELLO carries RBN_HELLO_F_BATCH_OUT. */
+typedef struct __attribute__((packed)) {
+    uint8_t   output_id;
+    uint8_t   kind;
+    uint16_t  value;
+    uint16_t  ramp_ms;
+    uint8_t   flags;          /* RBN_SETOUT_F_* */
+} rbn_set_output_item_t;      /* 7 bytes */
+typedef struct __attribute__((packed)) {
+    rbn_hdr_t h;
+    uint8_t   count;
+    rbn_set_output_item_t items[];   /* count items (<= RBN_SET_OUTPUTS_MAX) */
+} rbn_set_outputs_t;
+#define RBN_SET_OUTPUTS_MAX 32   /* fits the 250-byte ESP-NOW payload */
+
+/* 0x43 OUTPUT_DIGEST (hub->node, encrypted unicast): keep-alive of a RBN_HELLO_F_BATCH_OUT node. Feeds the
+ * failsafe watchdog like any hub frame and carries rbn_output_digest() over the `count` outputs the hub
+ * drives. The node compares it with the same digest over the outputs it holds a hub value for: equal →
+ * silent; different (lost frame, node reboot) → one OUTPUT_STATE with RBN_OUTSTATE_F_RESYNC, and the hub
+ * resends its full state as a SET_OUTPUTS. */
+typedef struct __attribute__((packed)) {
+    rbn_hdr_t h;
+    uint8_t   count;
+    uint32_t  digest;
+} rbn_output_digest_t;
+
+/* Digest over (output_id, value LE) of each driven output, in HELLO out_cap order, where value is the
+ * last commanded value (the ramp target) clamped to the output's range. FNV-1a:
+ *   d = RBN_OUTPUT_DIGEST_INIT; for each output: d = rbn_output_digest_add(d, id, value); */
+#define RBN_OUTPUT_DIGEST_INIT 2166136261u
+static inline uint32_t rbn_output_digest_add(uint32_t d, uint8_t output_id, uint16_t value)
+{
+    const uint8_t b[3] = { output_id, (uint8_t)(value & 0xFF), (uint8_t)(value >> 8) };
+    for (int i = 0; i < 3; i++) { d ^= b[i]; d *= 16777619u; }
+    return d;
+}
+
 /* 0x41 OUTPUT_STATE (node->hub, encrypted unicast): ACK + applied state. */
 #define RBN_OUTSTATE_F_FAILSAFE_ACTIVE 0x01
 #define RBN_OUTSTATE_F_LOCAL_OVERRIDE  0x02
+#define RBN_OUTSTATE_F_RESYNC          0x04   /* OUTPUT_DIGEST mismatch: resend the full state */
 typedef struct __attribute__((packed)) {
     rbn_hdr_t h;
     uint8_t   output_id;
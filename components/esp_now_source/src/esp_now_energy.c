@@ -0,0 +1,331 @@
+/**
+ * @file esp_now_energy.c
+ * @brief ESP-NOW PERIOD energy store. See esp_now_energy.h.
+ *
+ * One slot per metered node, persisted as one NVS blob per slot ("e<i>") that
+ * leads with its layout version and size, so a blob written by another layout
+ * is recognised and skipped. Ingest only touches RAM under s_nrg_mux; the NVS
+ * writes happen in esp_now_energy_service()/flush() from a task, on a snapshot
+ * taken under the mux, so the receive callback never waits on flash.
+ */
+#include "esp_now_energy.h"
+
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "freertos/FreeRTOS.h"
+
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+static const char *TAG = "espnow_nrg";
+
+#ifndef CONFIG_ACROUTER_ESPNOW_ENERGY_COMMIT_S
+#define CONFIG_ACROUTER_ESPNOW_ENERGY_COMMIT_S 300
+#endif
+
+#define NRG_NVS_NS          "espnow_nrg"
+#define NRG_LAYOUT_VER      2
+#define NRG_COMMIT_US       ((int64_t)CONFIG_ACROUTER_ESPNOW_ENERGY_COMMIT_S * 1000000)
+
+typedef struct {
+    uint8_t  used;
+    uint8_t  mac[6];
+    uint8_t  seq_n;                                     /* filled entries of seq[] */
+    uint8_t  seq_head;                                  /* next write in seq[] */
+    uint8_t  ch_mask;
+    uint8_t  type_set;                                  /* bit c = period_type[c] latched */
+    uint8_t  period_type[ESP_NOW_SOURCE_MAX_NODE_CH];
+    uint32_t seq[ESP_NOW_ENERGY_SEQ_WINDOW];            /* of the current restart only */
+    uint32_t fp[ESP_NOW_ENERGY_SEQ_WINDOW];            /* record fingerprint per seq */
+    uint32_t seq_max;                                   /* highest seq since the last restart */
+    uint32_t restarts;                                  /* counter restarts seen (dedupe epoch) */
+    uint32_t frames;
+    uint32_t duplicates;
+    uint32_t skipped;
+    uint32_t last_node_ts;
+    uint32_t periods[ESP_NOW_SOURCE_MAX_NODE_CH];
+    double   import_wh[ESP_NOW_SOURCE_MAX_NODE_CH];
+    double   export_wh[ESP_NOW_SOURCE_MAX_NODE_CH];
+} nrg_slot_t;
+
+/* NVS blob: the header lets a load tell another layout from a damaged blob. */
+typedef struct {
+    uint16_t ver;                                       /* NRG_LAYOUT_VER */
+    uint16_t size;                                      /* sizeof(nrg_slot_t) */
+    nrg_slot_t slot;
+} nrg_blob_t;
+
+static nrg_slot_t   s_slot[ESP_NOW_ENERGY_NODES];
+static uint8_t      s_dirty;            /* bit i = s_slot[i] changed since the last commit */
+static int64_t      s_dirty_since_us;   /* first change of the pending batch */
+static uint32_t     s_updates;
+static uint32_t     s_commits;
+static uint32_t     s_rejected_full;
+static portMUX_TYPE s_nrg_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* find/alloc the slot of a MAC — call under s_nrg_mux. Never evicts: billing data
+ * stays until reset, a newcomer is refused instead. */
+static nrg_slot_t *nrg_slot(const uint8_t mac[6], int *idx)
+{
+    for (int i = 0; i < ESP_NOW_ENERGY_NODES; i++)
+        if (s_slot[i].used && memcmp(s_slot[i].mac, mac, 6) == 0) { *idx = i; return &s_slot[i]; }
+    for (int i = 0; i < ESP_NOW_ENERGY_NODES; i++)
+        if (!s_slot[i].used) {
+            memset(&s_slot[i], 0, sizeof(s_slot[i]));
+            s_slot[i].used = 1;
+            memcpy(s_slot[i].mac, mac, 6);
+            *idx = i;
+            return &s_slot[i];
+        }
+    return NULL;
+}
+
+/* FNV-1a over the records. A retransmit repeats seq AND records; a node that
+ * rebooted and restarted its counter reuses a seq with different records (one
+ * it reuses with identical records carries identical energy). */
+static uint32_t recs_fp(const rbn_period_rec_t *recs, size_t n)
+{
+    const uint8_t *b = (const uint8_t *)recs;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n * sizeof(*recs); i++) { h ^= b[i]; h *= 16777619u; }
+    return h;
+}
+
+static bool seq_seen(const nrg_slot_t *s, uint32_t seq, uint32_t fp)
+{
+    for (uint8_t k = 0; k < s->seq_n; k++)
+        if (s->seq[k] == seq && s->fp[k] == fp) return true;
+    return false;
+}
+
+static void mark_dirty(int idx)
+{
+    if (!s_dirty) s_dirty_since_us = esp_timer_get_time();
+    s_dirty |= (uint8_t)(1u << idx);
+}
+
+esp_err_t esp_now_energy_init(void)
+{
+    portENTER_CRITICAL(&s_nrg_mux);
+    const bool pending = s_dirty != 0;
+    if (!pending) memset(s_slot, 0, sizeof(s_slot));
+    portEXIT_CRITICAL(&s_nrg_mux);
+    if (pending) return ESP_OK;                 /* RAM is newer than flash */
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NRG_NVS_NS, NVS_READONLY, &nvs);
+    if (err != ESP_OK) return ESP_OK;           /* nothing stored yet */
+    unsigned n = 0, foreign = 0;
+    char key[8];
+    for (int i = 0; i < ESP_NOW_ENERGY_NODES; i++) {
+        nrg_blob_t blob;
+        size_t len = 0;
+        snprintf(key, sizeof(key), "e%d", i);
+        if (nvs_get_blob(nvs, key, NULL, &len) != ESP_OK) continue;
+        if (len != sizeof(blob) || nvs_get_blob(nvs, key, &blob, &len) != ESP_OK ||
+            blob.ver != NRG_LAYOUT_VER || blob.size != sizeof(blob.slot)) {
+            foreign++;
+            continue;
+        }
+        nrg_slot_t *tmp = &blob.slot;
+        if (!tmp->used) continue;
+        if (tmp->seq_n > ESP_NOW_ENERGY_SEQ_WINDOW) tmp->seq_n = ESP_NOW_ENERGY_SEQ_WINDOW;
+        tmp->seq_head %= ESP_NOW_ENERGY_SEQ_WINDOW;
+        portENTER_CRITICAL(&s_nrg_mux);
+        s_slot[i] = *tmp;
+        portEXIT_CRITICAL(&s_nrg_mux);
+        n++;
+    }
+    nvs_close(nvs);
+    if (foreign) ESP_LOGW(TAG, "%u stored node(s) in another layout (want v%u) - not loaded", foreign, NRG_LAYOUT_VER);
+    ESP_LOGI(TAG, "Loaded energy totals of %u node(s)", n);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_energy_ingest(const uint8_t mac[6], uint32_t seq, uint32_t node_ts,
+                                const rbn_period_rec_t *recs, size_t n, bool *dup)
+{
+    if (!mac || (!recs && n)) return ESP_ERR_INVALID_ARG;
+    esp_err_t rc = ESP_OK;
+    bool is_dup = false;
+    const uint32_t fp = recs_fp(recs, n);
+
+    portENTER_CRITICAL(&s_nrg_mux);
+    int idx = -1;
+    nrg_slot_t *s = nrg_slot(mac, &idx);
+    if (!s) {
+        s_rejected_full++;
+        rc = ESP_ERR_NO_MEM;
+    } else if (seq_seen(s, seq, fp)) {
+        s->duplicates++;                /* its ACK was lost: ACK again, add nothing */
+        is_dup = true;
+    } else {
+        /* Not a retransmit, yet not above the node's counter: it restarted it
+         * (reboot). Its old seqs are a past epoch — forget them, or a new period
+         * reusing one with the same records would be taken for a retransmit. */
+        if (s->seq_n && seq <= s->seq_max) {
+            s->restarts++;
+            s->seq_n    = 0;
+            s->seq_head = 0;
+            s->seq_max  = seq;
+        } else if (seq > s->seq_max || !s->seq_n) {
+            s->seq_max = seq;
+        }
+        for (size_t r = 0; r < n; r++) {
+            const rbn_period_rec_t *rec = &recs[r];
+            const uint8_t c = rec->channel_id;
+            const float e = rec->energy_wh;
+            if (c >= ESP_NOW_SOURCE_MAX_NODE_CH || !isfinite(e)) { s->skipped++; continue; }
+            if (!(s->type_set & (1u << c))) {
+                s->type_set |= (uint8_t)(1u << c);
+                s->period_type[c] = rec->period_type;
+            } else if (s->period_type[c] != rec->period_type) {
+                s->skipped++;           /* another aggregation of the same energy */
+                continue;
+            }
+            if (e >= 0.0f) s->import_wh[c] += e;
+            else           s->export_wh[c] -= e;
+            s->periods[c]++;
+            s->ch_mask |= (uint8_t)(1u << c);
+        }
+        s->seq[s->seq_head] = seq;
+        s->fp[s->seq_head]  = fp;
+        s->seq_head = (uint8_t)((s->seq_head + 1) % ESP_NOW_ENERGY_SEQ_WINDOW);
+        if (s->seq_n < ESP_NOW_ENERGY_SEQ_WINDOW) s->seq_n++;
+        s->frames++;
+        if (node_ts) s->last_node_ts = node_ts;
+        s_updates++;
+        mark_dirty(idx);
+    }
+    portEXIT_CRITICAL(&s_nrg_mux);
+
+    if (dup) *dup = is_dup;
+    return rc;
+}
+
+/* Write the dirty slots and commit. Task context only (NVS). */
+static esp_err_t nrg_commit(void)
+{
+    nrg_slot_t snap[ESP_NOW_ENERGY_NODES];
+    portENTER_CRITICAL(&s_nrg_mux);
+    const uint8_t dirty = s_dirty;
+    memcpy(snap, s_slot, sizeof(snap));
+    s_dirty = 0;
+    portEXIT_CRITICAL(&s_nrg_mux);
+    if (!dirty) return ESP_OK;
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NRG_NVS_NS, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        char key[8];
+        nrg_blob_t blob;
+        for (int i = 0; i < ESP_NOW_ENERGY_NODES && err == ESP_OK; i++) {
+            if (!(dirty & (1u << i))) continue;
+            snprintf(key, sizeof(key), "e%d", i);
+            if (snap[i].used) {
+                blob.ver  = NRG_LAYOUT_VER;
+                blob.size = (uint16_t)sizeof(blob.slot);
+                blob.slot = snap[i];
+                err = nvs_set_blob(nvs, key, &blob, sizeof(blob));
+            } else {
+                const esp_err_t e = nvs_erase_key(nvs, key);
+                if (e != ESP_OK && e != ESP_ERR_NVS_NOT_FOUND) err = e;
+            }
+        }
+        if (err == ESP_OK) err = nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+
+    portENTER_CRITICAL(&s_nrg_mux);
+    if (err == ESP_OK) {
+        s_commits++;
+    } else {
+        /* keep the batch pending; the next service() retries it */
+        if (!s_dirty) s_dirty_since_us = esp_timer_get_time();
+        s_dirty |= dirty;
+    }
+    portEXIT_CRITICAL(&s_nrg_mux);
+    if (err != ESP_OK) ESP_LOGW(TAG, "Energy commit failed: %s", esp_err_to_name(err));
+    return err;
+}
+
+uint32_t esp_now_energy_service(void)
+{
+    portENTER_CRITICAL(&s_nrg_mux);
+    const bool dirty = s_dirty != 0;
+    const int64_t due_us = s_dirty_since_us + NRG_COMMIT_US;
+    portEXIT_CRITICAL(&s_nrg_mux);
+    if (!dirty) return UINT32_MAX;
+
+    const int64_t now = esp_timer_get_time();
+    if (now < due_us) return (uint32_t)((due_us - now + 999) / 1000);
+    /* a failed commit stays pending and is retried one interval later */
+    return (nrg_commit() == ESP_OK) ? UINT32_MAX : (uint32_t)(NRG_COMMIT_US / 1000);
+}
+
+esp_err_t esp_now_energy_flush(void)
+{
+    return nrg_commit();
+}
+
+esp_err_t esp_now_energy_get(esp_now_energy_node_t *out, size_t max, size_t *n)
+{
+    if (!out || !n) return ESP_ERR_INVALID_ARG;
+    size_t cnt = 0;
+    for (int i = 0; i < ESP_NOW_ENERGY_NODES && cnt < max; i++) {
+        portENTER_CRITICAL(&s_nrg_mux);
+        const nrg_slot_t s = s_slot[i];
+        portEXIT_CRITICAL(&s_nrg_mux);
+        if (!s.used) continue;
+        esp_now_energy_node_t *o = &out[cnt++];
+        memset(o, 0, sizeof(*o));
+        memcpy(o->mac, s.mac, 6);
+        o->frames       = s.frames;
+        o->duplicates   = s.duplicates;
+        o->restarts     = s.restarts;
+        o->skipped      = s.skipped;
+        o->last_node_ts = s.last_node_ts;
+        o->ch_mask      = s.ch_mask;
+        for (uint8_t c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+            o->ch[c].channel     = c;
+            o->ch[c].period_type = s.period_type[c];
+            o->ch[c].periods     = s.periods[c];
+            o->ch[c].import_wh   = s.import_wh[c];
+            o->ch[c].export_wh   = s.export_wh[c];
+        }
+    }
+    *n = cnt;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_energy_reset(const uint8_t mac[6])
+{
+    bool found = false;
+    portENTER_CRITICAL(&s_nrg_mux);
+    for (int i = 0; i < ESP_NOW_ENERGY_NODES; i++) {
+        if (!s_slot[i].used || (mac && memcmp(s_slot[i].mac, mac, 6) != 0)) continue;
+        memset(&s_slot[i], 0, sizeof(s_slot[i]));
+        mark_dirty(i);
+        found = true;
+    }
+    if (found) s_updates++;
+    portEXIT_CRITICAL(&s_nrg_mux);
+    if (!found) return mac ? ESP_ERR_NOT_FOUND : ESP_OK;
+    return nrg_commit();
+}
+
+void esp_now_energy_get_stats(esp_now_energy_stats_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_nrg_mux);
+    out->updates       = s_updates;
+    out->commits       = s_commits;
+    out->rejected_full = s_rejected_full;
+    out->dirty         = s_dirty != 0;
+    out->commit_interval_s = CONFIG_ACROUTER_ESPNOW_ENERGY_COMMIT_S;
+    portEXIT_CRITICAL(&s_nrg_mux);
+}
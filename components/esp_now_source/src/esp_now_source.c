@@ -4,21 +4,26 @@
  *
  * Pattern mirrors rbgrid's esp_now_hub.c (recv-cb stashes under a portMUX, an
  * inject task drains + posts off-callback) but stripped to the minimum: RX
- * REALTIME only, open (no crypto), no PTP/beacon/period. Maps a node's primary
- * channel to a Sensor Hub role exactly like rbamp_source's publish_snapshot.
+ * REALTIME and PERIOD, open (no crypto), two-step SYNC_BEACON/FOLLOWUP time
+ * master. Every channel record of a REALTIME frame is decoded and mapped to its
+ * Sensor Hub role exactly like rbamp_source's publish_snapshot, so one frame is
+ * one multi-channel snapshot.
  */
 #include "esp_now_source.h"
+#include "esp_now_energy.h"
 #include "espnow_proto.h"
 #include <math.h>          // isfinite() — drop NaN/Inf arriving on the wire
 
 #include "sdkconfig.h"
 #include "acrouter_events.h"
+#include "acrouter_meas_ring.h"
 #include "acrouter_measurements.h"
 
 #include "esp_now.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_timer.h"
+#include "esp_random.h"
 #include "esp_log.h"
 #include "nvs.h"
 
@@ -27,18 +32,46 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
 
 static const char *TAG = "espnow_src";
 
+#ifndef CONFIG_ACROUTER_ESPNOW_COALESCE_MS
+#define CONFIG_ACROUTER_ESPNOW_COALESCE_MS 0
+#endif
+#ifndef CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS
+#define CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS 0
+#endif
+#ifndef CONFIG_ACROUTER_ESPNOW_OUT_BATCH_MS
+#define CONFIG_ACROUTER_ESPNOW_OUT_BATCH_MS 0
+#endif
+
 #define ESPNOW_SRC_NVS_NS        "espnow_src"
 #define ESPNOW_PRESENCE_TO_MS    2000   /* node considered offline after this w/o REALTIME */
-#define ESPNOW_INJECT_MS         200    /* inject cadence */
+#define ESPNOW_LAT_SAMPLES       128    /* RX->hub latency samples behind p50/p99 */
+
+/* Inject-task wake-up: the task notification value is the mailbox. Bit i = seen
+ * slot i has a fresh frame (set by the recv-cb); ESPNOW_WAKE_OUT = the output
+ * keep-alive schedule changed. Bits OR together, so a burst of frames from one
+ * node between two wake-ups coalesces into one post of the newest. */
+#define ESPNOW_WAKE_OUT          (1u << 31)
+#define ESPNOW_WAKE_ENERGY       (1u << 30)  /* PERIOD accepted: (re)schedule the batch commit */
+#define ESPNOW_WAKE_SYNC         (1u << 29)  /* beacon TX stamped: send its follow-up */
+#define ESPNOW_WAKE_OUT_SET      (1u << 28)  /* set_output() queued a changed level */
+#define ESPNOW_WAKE_CTRL         (ESPNOW_WAKE_OUT | ESPNOW_WAKE_ENERGY | ESPNOW_WAKE_SYNC | ESPNOW_WAKE_OUT_SET)
 
-/* ---- seen-node table (written by recv-cb, drained by inject task) ---- */
+/* ---- seen-node table (written by recv-cb, drained by inject task) ----
+ * One entry per node; the channel arrays hold the last REALTIME frame's records
+ * (ch_mask says which), so a drained snapshot never mixes two frames. */
 typedef struct {
     bool     used;
     uint8_t  mac[6];
-    float    i, v, p, pf, freq;
+    uint8_t  ch_mask;
+    float    i[ESP_NOW_SOURCE_MAX_NODE_CH];
+    float    p[ESP_NOW_SOURCE_MAX_NODE_CH];
+    float    pf[ESP_NOW_SOURCE_MAX_NODE_CH];
+    float    v, freq;
     bool     has_v;
     int64_t  last_us;
     bool     fresh;
@@ -47,15 +80,18 @@ typedef struct {
 static seen_t s_seen[ESP_NOW_SOURCE_MAX_NODES];
 static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
 
-/* ---- node→role registry (commissioning) ---- */
-typedef struct { bool used; uint8_t mac[6]; uint8_t role; } node_role_t;
-static node_role_t s_node_role[ESP_NOW_SOURCE_MAX_NODES];
+/* ---- (node, channel)→role registry (commissioning) ---- */
+typedef struct { bool used; uint8_t mac[6]; uint8_t channel; uint8_t role; } node_role_t;
+static node_role_t s_node_role[ESP_NOW_SOURCE_MAX_ROLES];
 
 /* ---- output-node table (dimmer/relay over ESP-NOW) ----
- * Written by recv-cb (HELLO/OUTPUT_STATE) and the inject task (desired/keep-alive);
- * guarded by s_mux. ESP-NOW send/add_peer are done OUTSIDE the critical section. */
+ * Written by recv-cb (HELLO/OUTPUT_STATE), set_output() (desired + dirty) and the
+ * inject task (sends); guarded by s_mux. ESP-NOW send/add_peer are done OUTSIDE the
+ * critical section. Only the inject task sends SET_OUTPUT(S): one frame per node
+ * carries every output changed since the last one. */
 #define ESPNOW_OUT_KEEPALIVE_MS (RBN_OUTPUT_FAILSAFE_MS / 2)   /* re-assert cadence (2500ms) */
 #define ESPNOW_OUT_OFFLINE_MS   (RBN_OUTPUT_FAILSAFE_MS + 1000)/* node offline w/o any frame */
+#define ESPNOW_OUT_RETRY_MS     20                             /* after a refused esp_now_send */
 typedef struct {
     bool     used;
     uint8_t  mac[6];
@@ -70,17 +106,65 @@ typedef struct {
     uint8_t  last_result[ESP_NOW_SOURCE_OUT_PER_NODE];
     uint32_t last_ack_seq;
     bool     failsafe;
+    bool     batch;           /* HELLO_F_BATCH_OUT: SET_OUTPUTS + digest keep-alive */
+    uint8_t  dirty;           /* bit k = desired_val[k] changed, not sent yet */
+    bool     resync;          /* node reported a mismatch: resend every driven output */
     int64_t  last_frame_us;   /* any HELLO/OUTPUT_STATE */
-    int64_t  last_cmd_us;     /* last SET_OUTPUT we sent */
+    int64_t  last_cmd_us;     /* last SET_OUTPUT(S)/digest we sent */
     bool     peer_added;
 } out_node_t;
 static out_node_t s_out[ESP_NOW_SOURCE_OUT_NODES_MAX];
 static uint32_t   s_out_seq = 1;
+static esp_now_source_out_stats_t s_out_stats;   /* under s_mux */
 
 static bool          s_initialized = false;
 static volatile bool s_running     = false;
 static TaskHandle_t  s_inject_task  = NULL;
 
+/* ---- RX->hub latency (written by the inject task; counters under s_mux) ---- */
+static uint32_t s_lat_us[ESPNOW_LAT_SAMPLES];
+static uint32_t s_lat_head;
+static uint32_t s_lat_total;
+static uint32_t s_lat_max_us;
+static uint32_t s_rx_frames;
+static uint32_t s_rx_coalesced;
+static uint32_t s_posts;
+static uint32_t s_wakeups;
+
+/* ---- time master (beacon/follow-up, TIME_RESP, LATCH_NOW; under s_mux) ----
+ * s_sync_pending is the beacon whose TX the send-cb has to stamp; the stamp is
+ * handed to the inject task (s_sync_tx_id/us), which sends the follow-up.
+ * The send-cb only sees "a broadcast left", so at most one broadcast is in
+ * flight: the next beacon waits for the follow-up's callback
+ * (s_sync_followup_us), and a callback is only ever the one frame's. */
+#define ESPNOW_SYNC_STATS_TO_MS  30000        /* node sync view stale w/o NODE_STATS */
+#define ESPNOW_SYNC_CB_TO_MS     100          /* broadcast send-cb overdue: give up on it */
+#define ESPNOW_UNIX_VALID_S      1700000000   /* wall clock below this = not set (no NTP yet) */
+typedef struct {
+    bool     used;
+    uint8_t  mac[6];
+    uint32_t beacons_recv, followups_recv, max_beacon_id, fits;
+    float    resid_mean_us, resid_sd_us, resid_maxabs_us, skew_ppm;
+    uint32_t time_reqs;
+    int64_t  last_stats_us;
+} sync_node_t;
+static sync_node_t s_sync_node[ESP_NOW_SOURCE_MAX_NODES];
+static const uint8_t s_bcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static uint32_t s_sync_epoch;
+static uint32_t s_sync_beacon_id;
+static uint32_t s_sync_pending;
+static int64_t  s_sync_pending_us;            /* when the pending beacon was sent */
+static int64_t  s_sync_followup_us;           /* follow-up awaiting its send-cb (0 = none) */
+static uint32_t s_sync_tx_id;
+static int64_t  s_sync_tx_us;
+static int64_t  s_sync_next_us;
+static uint32_t s_sync_beacons;
+static uint32_t s_sync_followups;
+static uint32_t s_sync_tx_fail;
+static uint32_t s_sync_time_resps;
+static uint32_t s_sync_time_unset;
+static uint32_t s_sync_latches;
+
 /* ---- helpers ---- */
 
 static bool mac_eq(const uint8_t *a, const uint8_t *b) { return memcmp(a, b, 6) == 0; }
@@ -108,20 +192,18 @@ static seen_t *seen_slot(const uint8_t mac[6])
     return &s_seen[oldest];
 }
 
-static esp_now_source_role_t role_for_mac(const uint8_t mac[6])
+static void roles_for_mac(const uint8_t mac[6], esp_now_source_role_t roles[ESP_NOW_SOURCE_MAX_NODE_CH])
 {
     /* Read the commissioning table under s_mux — set_role (web/serial task) mutates
      * it field-by-field while the inject/get_nodes readers walk it (D3). Callers reach
      * this OUTSIDE any critical section, so taking s_mux here does not nest. */
-    esp_now_source_role_t r = ESPNOW_ROLE_NONE;
+    for (int c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) roles[c] = ESPNOW_ROLE_NONE;
     portENTER_CRITICAL(&s_mux);
-    for (int i = 0; i < ESP_NOW_SOURCE_MAX_NODES; i++)
-        if (s_node_role[i].used && mac_eq(s_node_role[i].mac, mac)) {
-            r = (esp_now_source_role_t)s_node_role[i].role;
-            break;
-        }
+    for (int i = 0; i < ESP_NOW_SOURCE_MAX_ROLES; i++)
+        if (s_node_role[i].used && mac_eq(s_node_role[i].mac, mac) &&
+            s_node_role[i].channel < ESP_NOW_SOURCE_MAX_NODE_CH)
+            roles[s_node_role[i].channel] = (esp_now_source_role_t)s_node_role[i].role;
     portEXIT_CRITICAL(&s_mux);
-    return r;
 }
 
 static int slot_channel_for_role(esp_now_source_role_t role)
@@ -134,35 +216,43 @@ static int slot_channel_for_role(esp_now_source_role_t role)
     }
 }
 
-/* Build an acrouter_measurements_t from one node's primary-channel sample and
- * post it. Same role/power/voltage gating as rbamp_source. */
-static void post_node(const seen_t *s, esp_now_source_role_t role, uint8_t node_idx)
+/* Build one acrouter_measurements_t from every commissioned channel of a node's
+ * last REALTIME frame and post it. Same role/power/voltage gating as rbamp_source:
+ * the lower channel wins a slot two channels claim. The frame is stamped with its
+ * RX instant, so the hub's age and the control latency include the radio hop.
+ * Returns true if a measurement was posted. */
+static bool post_node(const seen_t *s, const esp_now_source_role_t roles[ESP_NOW_SOURCE_MAX_NODE_CH],
+                      uint8_t node_idx)
 {
-    if (role == ESPNOW_ROLE_NONE) return;
-
     acrouter_measurements_t meas;
     acrouter_measurements_init(&meas);
     meas.source       = ACROUTER_SOURCE_ESPNOW;
     meas.source_id    = node_idx;
-    meas.timestamp_us = esp_timer_get_time();
+    meas.timestamp_us = s->last_us;
 
     bool any = false;
-    const int ch = slot_channel_for_role(role);
-    if (ch >= 0 && isfinite(s->i)) {    /* drop a non-finite current outright (NaN/Inf on the wire) */
-        meas.current_rms[ch] = s->i;
+    bool wants_voltage = false;
+    for (int c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+        if (roles[c] == ESPNOW_ROLE_NONE) continue;
+        if (roles[c] == ESPNOW_ROLE_GRID || roles[c] == ESPNOW_ROLE_VOLTAGE) wants_voltage = true;
+        if (!(s->ch_mask & (1u << c))) continue;          /* channel not in this frame */
+        const int ch = slot_channel_for_role(roles[c]);
+        if (ch < 0 || meas.has_current[ch]) continue;     /* no slot, or a lower channel holds it */
+        if (!isfinite(s->i[c])) continue;   /* drop a non-finite current outright (NaN/Inf on the wire) */
+        meas.current_rms[ch] = s->i[c];
         meas.has_current[ch] = true;
         any = true;
-        if (s->has_v && isfinite(s->p)) {  /* real power only with a finite voltage reference */
-            meas.power_active[ch] = s->p;   /* signed: + import / - export */
+        if (s->has_v && isfinite(s->p[c])) {  /* real power only with a finite voltage reference */
+            meas.power_active[ch] = s->p[c];   /* signed: + import / - export */
             meas.has_power[ch]    = true;
-            meas.direction[ch]    = (s->p >  0.05f) ? ACROUTER_DIR_CONSUMING
-                                  : (s->p < -0.05f) ? ACROUTER_DIR_SUPPLYING
-                                                    : ACROUTER_DIR_ZERO;
+            meas.direction[ch]    = (s->p[c] >  0.05f) ? ACROUTER_DIR_CONSUMING
+                                  : (s->p[c] < -0.05f) ? ACROUTER_DIR_SUPPLYING
+                                                       : ACROUTER_DIR_ZERO;
         } else {
             meas.direction[ch] = ACROUTER_DIR_UNKNOWN;
         }
     }
-    if ((role == ESPNOW_ROLE_GRID || role == ESPNOW_ROLE_VOLTAGE) && s->has_v && s->v > 1.0f) {
+    if (wants_voltage && s->has_v && s->v > 1.0f) {
         meas.voltage_rms = s->v;
         meas.has_voltage = true;
         any = true;
@@ -170,8 +260,9 @@ static void post_node(const seen_t *s, esp_now_source_role_t role, uint8_t node_
 
     meas.valid = any;
     if (any) {
-        esp_event_post(ACROUTER_EVENT, ACROUTER_EVENT_POWER_UPDATE, &meas, sizeof(meas), 0);
+        acrouter_meas_publish(&meas);
     }
+    return any;
 }
 
 /* ---- output-node helpers ---- */
@@ -237,8 +328,8 @@ static esp_err_t out_send(const uint8_t mac[6], uint8_t output_id, uint8_t kind,
 
     rbn_set_output_t f;
     memset(&f, 0, sizeof(f));
-    /* Atomic RMW — out_send() runs from both the inject task (keep-alive) and the
-     * control/web/serial task; a plain s_out_seq++ could lose an increment (D7). */
+    /* Atomic RMW — s_out_seq also numbers the ACK/TIME_RESP frames the recv-cb
+     * sends and the LATCH_NOW frames; a plain s_out_seq++ could lose an increment (D7). */
     uint32_t seq = __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED);
     rbn_hdr_init(&f.h, RBN_MSG_SET_OUTPUT, seq, 0);
     f.output_id = output_id;
@@ -264,14 +355,22 @@ static void on_hello(const esp_now_recv_info_t *info, const uint8_t *data, int l
 
     portENTER_CRITICAL(&s_mux);
     out_node_t *n = out_slot(info->src_addr);
+    bool wake = false;
     if (n) {
         n->family        = m->family;
         n->hw_model      = m->hw_model;
         n->out_count     = oc;
+        n->batch         = (m->flags & RBN_HELLO_F_BATCH_OUT) != 0;
         n->last_frame_us = now;
-        for (uint8_t i = 0; i < oc; i++) n->caps[i] = m->out_cap[i];
+        for (uint8_t i = 0; i < oc; i++) {
+            n->caps[i] = m->out_cap[i];
+            /* a HELLO may follow a node reboot: re-send what we drive right away */
+            if (n->desired_set[i]) n->resync = wake = true;
+        }
     }
     portEXIT_CRITICAL(&s_mux);
+    TaskHandle_t t = s_inject_task;
+    if (wake && t && s_running) xTaskNotify(t, ESPNOW_WAKE_OUT_SET, eSetBits);
 }
 
 /* OUTPUT_STATE → record applied value + ack + liveness (under mux). */
@@ -281,6 +380,7 @@ static void on_output_state(const esp_now_recv_info_t *info, const uint8_t *data
     const rbn_output_state_t *m = (const rbn_output_state_t *)data;
     const int64_t now = esp_timer_get_time();
 
+    bool wake = false;
     portENTER_CRITICAL(&s_mux);
     out_node_t *n = out_find(info->src_addr);
     if (n) {
@@ -294,6 +394,116 @@ static void on_output_state(const esp_now_recv_info_t *info, const uint8_t *data
                 break;
             }
         }
+        /* digest mismatch or a failsafe trip: the node no longer holds our state */
+        if ((m->flags & (RBN_OUTSTATE_F_RESYNC | RBN_OUTSTATE_F_FAILSAFE_ACTIVE)) && !n->resync) {
+            n->resync = wake = true;
+            s_out_stats.resyncs++;
+        }
+    }
+    portEXIT_CRITICAL(&s_mux);
+    TaskHandle_t t = s_inject_task;
+    if (wake && t && s_running) xTaskNotify(t, ESPNOW_WAKE_OUT_SET, eSetBits);
+}
+
+/* PERIOD → energy store, then PERIOD_ACK straight from the RX path so the node can
+ * release the frame it holds. A retransmit is ACKed again (its first ACK was lost);
+ * a frame the full store refused is NOT ACKed, so the node keeps it. */
+static void on_period(const esp_now_recv_info_t *info, const uint8_t *data, int len)
+{
+    if (len < (int)sizeof(rbn_period_t)) return;
+    const rbn_period_t *m = (const rbn_period_t *)data;
+    size_t nrec = ((size_t)len - sizeof(rbn_period_t)) / sizeof(rbn_period_rec_t);
+    if (nrec > m->rec_count) nrec = m->rec_count;
+
+    bool dup = false;
+    if (esp_now_energy_ingest(info->src_addr, m->h.seq, m->h.node_ts, m->recs, nrec, &dup) != ESP_OK)
+        return;
+
+    if (out_ensure_peer(info->src_addr) == ESP_OK) {
+        rbn_period_ack_t ack;
+        memset(&ack, 0, sizeof(ack));
+        rbn_hdr_init(&ack.h, RBN_MSG_PERIOD_ACK, __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED), 0);
+        ack.ack_seq = m->h.seq;
+        esp_now_send(info->src_addr, (const uint8_t *)&ack, sizeof(ack));
+    }
+    TaskHandle_t t = s_inject_task;
+    if (!dup && t && s_running) xTaskNotify(t, ESPNOW_WAKE_ENERGY, eSetBits);
+}
+
+/* find/alloc a time-master view slot for a MAC — call under s_mux. */
+static sync_node_t *sync_node_slot(const uint8_t mac[6])
+{
+    sync_node_t *free_slot = NULL;
+    for (int i = 0; i < ESP_NOW_SOURCE_MAX_NODES; i++) {
+        if (s_sync_node[i].used && mac_eq(s_sync_node[i].mac, mac)) return &s_sync_node[i];
+        if (!s_sync_node[i].used && !free_slot) free_slot = &s_sync_node[i];
+    }
+    if (free_slot) {
+        memset(free_slot, 0, sizeof(*free_slot));
+        memcpy(free_slot->mac, mac, 6);
+        free_slot->used = true;
+    }
+    return free_slot;
+}
+
+/* hub wall clock (Unix s), 0 until NTP has set it — the node_ts of hub frames. */
+static uint32_t hub_unix_s(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec >= ESPNOW_UNIX_VALID_S ? (uint32_t)tv.tv_sec : 0;
+}
+
+/* TIME_REQ → TIME_RESP straight from the RX path (the node halves the RTT, so
+ * the reply must not wait behind the inject task). Unanswered until NTP has set
+ * the wall clock: the node keeps asking rather than anchor to 1970. */
+static void on_time_req(const esp_now_recv_info_t *info, const uint8_t *data, int len)
+{
+    if (len < (int)sizeof(rbn_time_req_t)) return;
+    const rbn_time_req_t *m = (const rbn_time_req_t *)data;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    const bool valid = tv.tv_sec >= ESPNOW_UNIX_VALID_S;
+
+    portENTER_CRITICAL(&s_mux);
+    sync_node_t *n = sync_node_slot(info->src_addr);
+    if (n) n->time_reqs++;
+    if (!valid) s_sync_time_unset++;
+    portEXIT_CRITICAL(&s_mux);
+    if (!valid || out_ensure_peer(info->src_addr) != ESP_OK) return;
+
+    rbn_time_resp_t r;
+    memset(&r, 0, sizeof(r));
+    rbn_hdr_init(&r.h, RBN_MSG_TIME_RESP, __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED),
+                 (uint32_t)tv.tv_sec);
+    r.req_token   = m->req_token;
+    r.hub_unix_ms = (uint64_t)tv.tv_sec * 1000u + (uint64_t)(tv.tv_usec / 1000);
+    if (esp_now_send(info->src_addr, (const uint8_t *)&r, sizeof(r)) == ESP_OK) {
+        portENTER_CRITICAL(&s_mux);
+        s_sync_time_resps++;
+        portEXIT_CRITICAL(&s_mux);
+    }
+}
+
+/* NODE_STATS → the node's own view of how well it tracks the beacons (under mux). */
+static void on_node_stats(const esp_now_recv_info_t *info, const uint8_t *data, int len)
+{
+    if (len < (int)sizeof(rbn_node_stats_t)) return;
+    const rbn_node_stats_t *m = (const rbn_node_stats_t *)data;
+    const int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_mux);
+    sync_node_t *n = sync_node_slot(info->src_addr);
+    if (n) {
+        n->beacons_recv    = m->beacons_recv;
+        n->followups_recv  = m->followups_recv;
+        n->max_beacon_id   = m->max_beacon_id;
+        n->fits            = m->fits;
+        n->resid_mean_us   = isfinite(m->resid_mean_us)   ? m->resid_mean_us   : 0.0f;
+        n->resid_sd_us     = isfinite(m->resid_sd_us)     ? m->resid_sd_us     : 0.0f;
+        n->resid_maxabs_us = isfinite(m->resid_maxabs_us) ? m->resid_maxabs_us : 0.0f;
+        n->skew_ppm        = isfinite(m->skew_ppm)        ? m->skew_ppm        : 0.0f;
+        n->last_stats_us   = now;
     }
     portEXIT_CRITICAL(&s_mux);
 }
@@ -306,77 +516,361 @@ static void on_recv(const esp_now_recv_info_t *info, const uint8_t *data, int le
 
     if (h->msg_type == RBN_MSG_HELLO)        { on_hello(info, data, len);        return; }
     if (h->msg_type == RBN_MSG_OUTPUT_STATE) { on_output_state(info, data, len); return; }
+    if (h->msg_type == RBN_MSG_PERIOD)       { on_period(info, data, len);       return; }
+    if (h->msg_type == RBN_MSG_TIME_REQ)     { on_time_req(info, data, len);     return; }
+    if (h->msg_type == RBN_MSG_NODE_STATS)   { on_node_stats(info, data, len);   return; }
     if (h->msg_type != RBN_MSG_REALTIME) return;   /* sensor path below */
     if (len < (int)(sizeof(rbn_realtime_t) + sizeof(rbn_rt_rec_t))) return;
 
+    /* Decode every record the frame actually carries (rec_count, capped by len)
+     * into a local snapshot first, so the critical section is a plain copy. */
     const rbn_realtime_t *m = (const rbn_realtime_t *)data;
-    if (m->rec_count < 1) return;
-    const rbn_rt_rec_t *rec = &m->recs[0];         /* primary channel */
+    size_t nrec = ((size_t)len - sizeof(rbn_realtime_t)) / sizeof(rbn_rt_rec_t);
+    if (nrec > m->rec_count) nrec = m->rec_count;
+    seen_t d;
+    memset(&d, 0, sizeof(d));
+    bool vbus = false;
+    for (size_t r = 0; r < nrec; r++) {
+        const rbn_rt_rec_t *rec = &m->recs[r];
+        if (!(rec->flags & RBN_RT_F_VALID)) continue;
+        const bool has_v = (rec->v_rms > 0.5f);
+        if (rec->channel_id == RBN_RT_CH_VBUS) {       /* node voltage bus: overrides a channel's V */
+            d.v = rec->v_rms; d.has_v = has_v; vbus = true;
+            if (rec->freq_x100) d.freq = rec->freq_x100 / 100.0f;
+            continue;
+        }
+        const uint8_t c = rec->channel_id;
+        if (c >= ESP_NOW_SOURCE_MAX_NODE_CH || (d.ch_mask & (1u << c))) continue;
+        d.ch_mask |= (uint8_t)(1u << c);
+        d.i[c]  = rec->i_rms;
+        d.p[c]  = rec->p_active;
+        d.pf[c] = rec->pf_x1000 / 1000.0f;
+        if (!vbus && !d.has_v && has_v) { d.v = rec->v_rms; d.has_v = true; }
+        if (d.freq == 0.0f) d.freq = rec->freq_x100 / 100.0f;
+    }
+    if (!d.ch_mask && !vbus) return;
     const int64_t now = esp_timer_get_time();
+    int idx = -1;
 
     portENTER_CRITICAL(&s_mux);
     seen_t *s = seen_slot(info->src_addr);
     if (s) {
-        s->i       = rec->i_rms;
-        s->v       = rec->v_rms;
-        s->p       = rec->p_active;
-        s->pf      = rec->pf_x1000 / 1000.0f;
-        s->freq    = rec->freq_x100 / 100.0f;
-        s->has_v   = (rec->v_rms > 0.5f);
+        idx = (int)(s - s_seen);
+        s_rx_frames++;
+        if (s->fresh) s_rx_coalesced++;     /* superseded before the inject task posted it */
+        s->ch_mask = d.ch_mask;
+        memcpy(s->i,  d.i,  sizeof(s->i));
+        memcpy(s->p,  d.p,  sizeof(s->p));
+        memcpy(s->pf, d.pf, sizeof(s->pf));
+        s->v       = d.v;
+        s->freq    = d.freq;
+        s->has_v   = d.has_v;
         s->last_us = now;
         s->fresh   = true;
     }
     portEXIT_CRITICAL(&s_mux);
+
+    /* Wake the inject task now instead of letting the frame wait for a poll. The
+     * recv-cb runs in the WiFi task (task context), so the plain notify is correct. */
+    TaskHandle_t t = s_inject_task;
+    if (idx >= 0 && t && s_running) xTaskNotify(t, 1u << idx, eSetBits);
 }
 
-/* ---- keep-alive: re-assert every driven output at <= FAILSAFE_MS/2 (inject task) ---- */
-static void out_keepalive_tick(void)
+/* ---- ESP-NOW send callback (WiFi task): the beacon's TX stamp ----
+ * Fires once the frame has left the radio, so the stamp excludes the send
+ * queue and channel access; the follow-up carries it to the nodes. */
+static void on_sent(const esp_now_send_info_t *tx, esp_now_send_status_t status)
+{
+    const int64_t now = esp_timer_get_time();   /* first: this is the TX instant */
+    if (!tx || !mac_eq(tx->des_addr, s_bcast)) return;
+    uint32_t id = 0;
+    bool wake;
+    portENTER_CRITICAL(&s_mux);
+    if (s_sync_followup_us) {
+        s_sync_followup_us = 0;                 /* the follow-up's: the next beacon may go */
+        wake = true;
+    } else {
+        id = s_sync_pending;
+        s_sync_pending = 0;
+        if (id && status == ESP_NOW_SEND_SUCCESS) { s_sync_tx_id = id; s_sync_tx_us = now; }
+        else if (id)                              s_sync_tx_fail++;
+        wake = id && status == ESP_NOW_SEND_SUCCESS;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    TaskHandle_t t = s_inject_task;
+    if (wake && t && s_running) xTaskNotify(t, ESPNOW_WAKE_SYNC, eSetBits);
+}
+
+/* ---- output TX: changed levels, resyncs and keep-alive (inject task) ----
+ * Per node, in one pass:
+ *   - outputs changed since the last pass (dirty) or, after a mismatch report,
+ *     every driven output: one SET_OUTPUTS for a batch-capable node, one
+ *     SET_OUTPUT per output for an older node;
+ *   - otherwise, once per ESPNOW_OUT_KEEPALIVE_MS: an OUTPUT_DIGEST for a batch-
+ *     capable node, the full re-assert for an older node.
+ * A frame esp_now_send refuses is marked dirty again and retried shortly; one
+ * lost on air is caught by the next digest. Returns how long the inject task may
+ * sleep before the next keep-alive is due (portMAX_DELAY when nothing is driven). */
+static TickType_t out_tick(void)
 {
     const int64_t now = esp_timer_get_time();
+    int64_t next_us = INT64_MAX;
     for (int i = 0; i < ESP_NOW_SOURCE_OUT_NODES_MAX; i++) {
         uint8_t  mac[6];
-        bool     due = false;
-        uint8_t  ids[ESP_NOW_SOURCE_OUT_PER_NODE], kinds[ESP_NOW_SOURCE_OUT_PER_NODE];
-        uint16_t vals[ESP_NOW_SOURCE_OUT_PER_NODE], ramps[ESP_NOW_SOURCE_OUT_PER_NODE];
-        uint8_t  ndrive = 0;
+        bool     batch = false, digest_only = false;
+        uint8_t  slot[ESP_NOW_SOURCE_OUT_PER_NODE];
+        rbn_set_output_item_t items[ESP_NOW_SOURCE_OUT_PER_NODE];
+        uint8_t  nitems = 0, ndriven = 0;
+        uint32_t digest = RBN_OUTPUT_DIGEST_INIT;
 
         portENTER_CRITICAL(&s_mux);
-        if (s_out[i].used &&
-            (now - s_out[i].last_cmd_us) >= (int64_t)ESPNOW_OUT_KEEPALIVE_MS * 1000) {
-            for (uint8_t k = 0; k < s_out[i].out_count && k < ESP_NOW_SOURCE_OUT_PER_NODE; k++) {
-                if (!s_out[i].desired_set[k]) continue;
-                ids[ndrive]   = s_out[i].caps[k].output_id;
-                kinds[ndrive] = s_out[i].caps[k].kind;
-                vals[ndrive]  = s_out[i].desired_val[k];
-                ramps[ndrive] = 0;   /* re-assert is a hold, no re-ramp */
-                ndrive++;
+        out_node_t *n = &s_out[i];
+        if (n->used) {
+            uint8_t driven = 0;
+            for (uint8_t k = 0; k < n->out_count && k < ESP_NOW_SOURCE_OUT_PER_NODE; k++) {
+                if (!n->desired_set[k]) continue;
+                driven |= (uint8_t)(1u << k);
+                ndriven++;
+                digest = rbn_output_digest_add(digest, n->caps[k].output_id, n->desired_val[k]);
+            }
+            const bool due = driven &&
+                (now - n->last_cmd_us) >= (int64_t)ESPNOW_OUT_KEEPALIVE_MS * 1000;
+            uint8_t send = (uint8_t)((n->dirty | (n->resync ? driven : 0)) & driven);
+            if (!send && due && !n->batch) send = driven;   /* older node: full re-assert */
+            digest_only = !send && due && n->batch;
+            for (uint8_t k = 0; k < ESP_NOW_SOURCE_OUT_PER_NODE; k++) {
+                if (!(send & (1u << k))) continue;
+                slot[nitems] = k;
+                items[nitems].output_id = n->caps[k].output_id;
+                items[nitems].kind      = n->caps[k].kind;
+                items[nitems].value     = n->desired_val[k];
+                /* only a fresh change ramps; a re-assert is a hold */
+                items[nitems].ramp_ms   = (n->dirty & (1u << k)) ? n->desired_ramp[k] : 0;
+                items[nitems].flags     = 0;
+                nitems++;
+            }
+            if (nitems || digest_only) {
+                memcpy(mac, n->mac, 6);
+                batch          = n->batch;
+                n->dirty       = 0;
+                n->resync      = false;
+                n->last_cmd_us = now;
+            }
+            if (driven) {
+                const int64_t at = n->last_cmd_us + (int64_t)ESPNOW_OUT_KEEPALIVE_MS * 1000;
+                if (at < next_us) next_us = at;
             }
-            if (ndrive) { due = true; memcpy(mac, s_out[i].mac, 6); s_out[i].last_cmd_us = now; }
         }
         portEXIT_CRITICAL(&s_mux);
+        if (!nitems && !digest_only) continue;
+
+        uint8_t  failed = 0;
+        uint32_t frames = 0;
+        if (out_ensure_peer(mac) != ESP_OK) {
+            for (uint8_t d = 0; d < nitems; d++) failed |= (uint8_t)(1u << slot[d]);
+        } else if (digest_only) {
+            rbn_output_digest_t f;
+            memset(&f, 0, sizeof(f));
+            rbn_hdr_init(&f.h, RBN_MSG_OUTPUT_DIGEST, __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED), 0);
+            f.count  = ndriven;
+            f.digest = digest;
+            esp_now_send(mac, (const uint8_t *)&f, sizeof(f));   /* a miss is healed by the next one */
+        } else if (batch) {
+            uint8_t buf[sizeof(rbn_set_outputs_t) + sizeof(items)];
+            rbn_set_outputs_t *f = (rbn_set_outputs_t *)buf;
+            rbn_hdr_init(&f->h, RBN_MSG_SET_OUTPUTS, __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED), 0);
+            f->count = nitems;
+            memcpy(f->items, items, nitems * sizeof(items[0]));
+            if (esp_now_send(mac, buf, sizeof(rbn_set_outputs_t) + nitems * sizeof(items[0])) == ESP_OK)
+                frames = 1;
+            else
+                for (uint8_t d = 0; d < nitems; d++) failed |= (uint8_t)(1u << slot[d]);
+        } else {
+            for (uint8_t d = 0; d < nitems; d++) {
+                if (out_send(mac, items[d].output_id, items[d].kind, items[d].value, items[d].ramp_ms) == ESP_OK)
+                    frames++;
+                else
+                    failed |= (uint8_t)(1u << slot[d]);
+            }
+        }
 
-        if (!due) continue;
-        for (uint8_t d = 0; d < ndrive; d++) out_send(mac, ids[d], kinds[d], vals[d], ramps[d]);
+        portENTER_CRITICAL(&s_mux);
+        s_out_stats.frames  += frames;
+        s_out_stats.items   += (uint32_t)nitems - (uint32_t)__builtin_popcount(failed);
+        s_out_stats.digests += digest_only ? 1u : 0u;
+        if (batch && frames) s_out_stats.batched++;
+        if (failed) {
+            s_out_stats.send_fail++;
+            if (s_out[i].used && mac_eq(s_out[i].mac, mac)) s_out[i].dirty |= failed;
+        }
+        portEXIT_CRITICAL(&s_mux);
+        if (failed && now + (int64_t)ESPNOW_OUT_RETRY_MS * 1000 < next_us)
+            next_us = now + (int64_t)ESPNOW_OUT_RETRY_MS * 1000;
     }
+    if (next_us == INT64_MAX) return portMAX_DELAY;
+    const int64_t wait_ms = (next_us - now) / 1000;
+    return wait_ms > 0 ? pdMS_TO_TICKS(wait_ms) + 1 : 1;
 }
 
-/* ---- inject task: drain fresh samples off-callback, post to Sensor Hub ---- */
+/* ---- time master: follow-up of a stamped beacon, next beacon when due (inject task) ----
+ * Returns how long the inject task may sleep before the next beacon is due
+ * (portMAX_DELAY when beacons are off). */
+static TickType_t sync_tick(void)
+{
+#if CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS > 0
+    const int64_t interval_us = (int64_t)CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS * 1000;
+    const int64_t cb_to_us = (int64_t)ESPNOW_SYNC_CB_TO_MS * 1000;
+    uint32_t tx_id;
+    int64_t  tx_us;
+    int64_t  now = esp_timer_get_time();
+    bool     busy;
+    portENTER_CRITICAL(&s_mux);
+    tx_id = s_sync_tx_id;
+    tx_us = s_sync_tx_us;
+    s_sync_tx_id = 0;
+    /* A send-cb that never came would hold the beacons off for good. */
+    if (s_sync_followup_us && now - s_sync_followup_us > cb_to_us) {
+        s_sync_followup_us = 0;
+        s_sync_tx_fail++;
+    }
+    if (s_sync_pending && now - s_sync_pending_us > cb_to_us) {
+        s_sync_pending = 0;
+        s_sync_tx_fail++;
+    }
+    if (tx_id) s_sync_followup_us = now;        /* armed before send, as the beacon */
+    busy = s_sync_followup_us || s_sync_pending;
+    portEXIT_CRITICAL(&s_mux);
+
+    if (tx_id) {
+        rbn_sync_followup_t f;
+        memset(&f, 0, sizeof(f));
+        rbn_hdr_init(&f.h, RBN_MSG_SYNC_FOLLOWUP, __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED),
+                     hub_unix_s());
+        f.beacon_id = tx_id;
+        f.hub_tx_us = (uint64_t)tx_us;
+        if (esp_now_send(s_bcast, (const uint8_t *)&f, sizeof(f)) == ESP_OK) {
+            portENTER_CRITICAL(&s_mux);
+            s_sync_followups++;
+            portEXIT_CRITICAL(&s_mux);
+        } else {
+            portENTER_CRITICAL(&s_mux);
+            s_sync_followup_us = 0;
+            busy = s_sync_pending != 0;
+            portEXIT_CRITICAL(&s_mux);
+        }
+    }
+
+    /* The next beacon only once no broadcast awaits its send-cb (the follow-up's
+     * callback wakes the task); until then, poll at the callback timeout. */
+    if (busy && now >= s_sync_next_us) return pdMS_TO_TICKS(ESPNOW_SYNC_CB_TO_MS) + 1;
+    if (now >= s_sync_next_us && out_ensure_peer(s_bcast) == ESP_OK) {
+        /* keep the cadence, but after a stall restart it rather than burst */
+        s_sync_next_us += interval_us;
+        if (s_sync_next_us <= now) s_sync_next_us = now + interval_us;
+
+        uint8_t prim = 0;
+        wifi_second_chan_t sec;
+        esp_wifi_get_channel(&prim, &sec);
+        rbn_sync_beacon_t b;
+        memset(&b, 0, sizeof(b));
+        rbn_hdr_init(&b.h, RBN_MSG_SYNC_BEACON, __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED),
+                     hub_unix_s());
+        b.beacon_id   = s_sync_beacon_id + 1;
+        b.epoch       = s_sync_epoch;
+        b.hub_channel = prim;
+
+        portENTER_CRITICAL(&s_mux);
+        s_sync_beacon_id  = b.beacon_id;
+        s_sync_pending    = b.beacon_id;        /* armed before send: the cb may beat the return */
+        s_sync_pending_us = esp_timer_get_time();
+        portEXIT_CRITICAL(&s_mux);
+        if (esp_now_send(s_bcast, (const uint8_t *)&b, sizeof(b)) == ESP_OK) {
+            portENTER_CRITICAL(&s_mux);
+            s_sync_beacons++;
+            portEXIT_CRITICAL(&s_mux);
+        } else {
+            portENTER_CRITICAL(&s_mux);
+            if (s_sync_pending == b.beacon_id) { s_sync_pending = 0; s_sync_tx_fail++; }
+            portEXIT_CRITICAL(&s_mux);
+        }
+        now = esp_timer_get_time();
+    }
+    const int64_t wait_ms = (s_sync_next_us - now) / 1000;
+    return wait_ms > 0 ? pdMS_TO_TICKS(wait_ms) + 1 : 1;
+#else
+    return portMAX_DELAY;
+#endif
+}
+
+static void lat_record(uint32_t us)
+{
+    portENTER_CRITICAL(&s_mux);
+    s_lat_us[s_lat_head] = us;
+    s_lat_head = (s_lat_head + 1) % ESPNOW_LAT_SAMPLES;
+    s_lat_total++;
+    if (us > s_lat_max_us) s_lat_max_us = us;
+    s_posts++;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* ---- inject task: woken per frame by the recv-cb, posts to Sensor Hub ---- */
 static void esp_now_inject_task(void *arg)
 {
     (void)arg;
-    ESP_LOGI(TAG, "Inject task started (interval=%dms)", ESPNOW_INJECT_MS);
+    ESP_LOGI(TAG, "Inject task started (notify-driven, coalesce=%dms, out batch=%dms, beacon=%dms)",
+             CONFIG_ACROUTER_ESPNOW_COALESCE_MS, CONFIG_ACROUTER_ESPNOW_OUT_BATCH_MS,
+             CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS);
+    TickType_t wait = 0;
     while (s_running) {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, wait);
+        if (!s_running) break;
+        if (bits) {
+            portENTER_CRITICAL(&s_mux);
+            s_wakeups++;
+            portEXIT_CRITICAL(&s_mux);
+        }
+#if CONFIG_ACROUTER_ESPNOW_COALESCE_MS > 0
+        /* Optional burst window: let the other nodes' frames of the same round land,
+         * then post them back to back. Costs up to the window in latency. */
+        if (bits & ~ESPNOW_WAKE_CTRL) {
+            uint32_t more = 0;
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_ACROUTER_ESPNOW_COALESCE_MS));
+            xTaskNotifyWait(0, UINT32_MAX, &more, 0);
+            bits |= more;
+        }
+#endif
         for (int i = 0; i < ESP_NOW_SOURCE_MAX_NODES; i++) {
+            if (!(bits & (1u << i))) continue;
             portENTER_CRITICAL(&s_mux);
             bool go = s_seen[i].used && s_seen[i].fresh;
             seen_t snap = s_seen[i];
             s_seen[i].fresh = false;
             portEXIT_CRITICAL(&s_mux);
             if (!go) continue;
-            post_node(&snap, role_for_mac(snap.mac), (uint8_t)i);
+            esp_now_source_role_t roles[ESP_NOW_SOURCE_MAX_NODE_CH];
+            roles_for_mac(snap.mac, roles);
+            if (post_node(&snap, roles, (uint8_t)i)) {
+                lat_record((uint32_t)(esp_timer_get_time() - snap.last_us));
+            }
         }
-        out_keepalive_tick();   /* re-assert driven outputs so nodes hold off failsafe */
-        vTaskDelay(pdMS_TO_TICKS(ESPNOW_INJECT_MS));
+#if CONFIG_ACROUTER_ESPNOW_OUT_BATCH_MS > 0
+        /* Output batch window: the control task sets its dimmers one by one (on the
+         * other core); let the whole update land so each node gets one frame. */
+        if (bits & ESPNOW_WAKE_OUT_SET) vTaskDelay(pdMS_TO_TICKS(CONFIG_ACROUTER_ESPNOW_OUT_BATCH_MS));
+#endif
+        wait = out_tick();   /* changed levels, resyncs, keep-alive (nodes hold off failsafe) */
+        const TickType_t sync_wait = sync_tick();   /* follow-up / next beacon */
+        if (sync_wait < wait) wait = sync_wait;
+        const uint32_t commit_ms = esp_now_energy_service();   /* batched energy NVS commit */
+        if (commit_ms != UINT32_MAX && (wait == portMAX_DELAY || pdMS_TO_TICKS(commit_ms) < wait))
+            wait = pdMS_TO_TICKS(commit_ms) + 1;
     }
     ESP_LOGI(TAG, "Inject task stopped");
     s_inject_task = NULL;
@@ -401,10 +895,20 @@ esp_err_t esp_now_source_init(void)
         return err;
     }
     esp_now_register_recv_cb(on_recv);
+    esp_now_register_send_cb(on_sent);
+
+    /* A new epoch per boot: the nodes reset their servo when it changes, since
+     * beacon_id and the esp_timer base restart with us. */
+    do { s_sync_epoch = esp_random(); } while (s_sync_epoch == 0);
+    s_sync_beacon_id   = 0;
+    s_sync_pending     = 0;
+    s_sync_followup_us = 0;
 
     esp_now_source_load_config();
+    esp_now_energy_init();
     s_initialized = true;
-    ESP_LOGI(TAG, "Initialized (open RX) on WiFi channel %u", prim);
+    ESP_LOGI(TAG, "Initialized (open RX) on WiFi channel %u, sync epoch %08lx",
+             prim, (unsigned long)s_sync_epoch);
     return ESP_OK;
 }
 
@@ -432,24 +936,35 @@ esp_err_t esp_now_source_start(void)
 void esp_now_source_stop(void)
 {
     s_running = false;
+    TaskHandle_t t = s_inject_task;
+    if (t) xTaskNotify(t, ESPNOW_WAKE_OUT, eSetBits);   /* leave a portMAX_DELAY wait now */
     for (int i = 0; i < 50 && s_inject_task != NULL; i++) vTaskDelay(pdMS_TO_TICKS(20));
     if (s_initialized) {
         esp_now_unregister_recv_cb();
+        esp_now_unregister_send_cb();
         esp_now_deinit();
         s_initialized = false;
     }
+    esp_now_energy_flush();   /* don't leave ACKed energy in RAM only */
 }
 
 esp_err_t esp_now_source_set_role(const uint8_t mac[6], esp_now_source_role_t role)
 {
-    if (!mac) return ESP_ERR_INVALID_ARG;
+    return esp_now_source_set_channel_role(mac, 0, role);
+}
+
+esp_err_t esp_now_source_set_channel_role(const uint8_t mac[6], uint8_t channel,
+                                          esp_now_source_role_t role)
+{
+    if (!mac || channel >= ESP_NOW_SOURCE_MAX_NODE_CH) return ESP_ERR_INVALID_ARG;
     esp_err_t rc = ESP_ERR_NO_MEM;
-    /* Mutate the commissioning table under s_mux so role_for_mac() readers never see a
+    /* Mutate the commissioning table under s_mux so roles_for_mac() readers never see a
      * torn mac/role or a half-populated slot (D3). Pure memory ops — no blocking. */
     portENTER_CRITICAL(&s_mux);
     /* update / remove existing */
-    for (int i = 0; i < ESP_NOW_SOURCE_MAX_NODES; i++) {
-        if (s_node_role[i].used && mac_eq(s_node_role[i].mac, mac)) {
+    for (int i = 0; i < ESP_NOW_SOURCE_MAX_ROLES; i++) {
+        if (s_node_role[i].used && mac_eq(s_node_role[i].mac, mac) &&
+            s_node_role[i].channel == channel) {
             if (role == ESPNOW_ROLE_NONE) s_node_role[i].used = false;
             else                          s_node_role[i].role = (uint8_t)role;
             rc = ESP_OK;
@@ -457,10 +972,11 @@ esp_err_t esp_now_source_set_role(const uint8_t mac[6], esp_now_source_role_t ro
         }
     }
     if (role == ESPNOW_ROLE_NONE) { rc = ESP_OK; goto done; }
-    for (int i = 0; i < ESP_NOW_SOURCE_MAX_NODES; i++) {
+    for (int i = 0; i < ESP_NOW_SOURCE_MAX_ROLES; i++) {
         if (!s_node_role[i].used) {
             memcpy(s_node_role[i].mac, mac, 6);
-            s_node_role[i].role = (uint8_t)role;
+            s_node_role[i].channel = channel;
+            s_node_role[i].role    = (uint8_t)role;
             s_node_role[i].used = true;   /* publish the slot last */
             rc = ESP_OK;
             goto done;
@@ -481,14 +997,23 @@ esp_err_t esp_now_source_get_nodes(esp_now_source_node_info_t *out, size_t max,
         seen_t s = s_seen[i];
         portEXIT_CRITICAL(&s_mux);
         if (!s.used) continue;
+        /* primary = the lowest channel the last frame carried */
+        int prim = 0;
+        while (prim < ESP_NOW_SOURCE_MAX_NODE_CH - 1 && !(s.ch_mask & (1u << prim))) prim++;
         memcpy(out[cnt].mac, s.mac, 6);
-        out[cnt].role         = role_for_mac(s.mac);
+        roles_for_mac(s.mac, out[cnt].ch_role);
+        out[cnt].role         = out[cnt].ch_role[0];
         out[cnt].online       = (s.last_us != 0) && ((now - s.last_us) < (int64_t)ESPNOW_PRESENCE_TO_MS * 1000);
         out[cnt].voltage      = s.has_v ? s.v : 0.0f;
-        out[cnt].current      = s.i;
-        out[cnt].power        = s.has_v ? s.p : 0.0f;
-        out[cnt].power_factor = s.pf;
+        out[cnt].current      = s.i[prim];
+        out[cnt].power        = s.has_v ? s.p[prim] : 0.0f;
+        out[cnt].power_factor = s.pf[prim];
         out[cnt].frequency    = s.freq;
+        out[cnt].ch_mask      = s.ch_mask;
+        for (int c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+            out[cnt].ch_current[c] = s.i[c];
+            out[cnt].ch_power[c]   = s.has_v ? s.p[c] : 0.0f;
+        }
         cnt++;
     }
     *n = cnt;
@@ -502,12 +1027,14 @@ esp_err_t esp_now_source_save_config(void)
     if (err != ESP_OK) return err;
     uint8_t count = 0;
     char key[8];
-    for (int i = 0; i < ESP_NOW_SOURCE_MAX_NODES; i++) {
+    for (int i = 0; i < ESP_NOW_SOURCE_MAX_ROLES; i++) {
         if (!s_node_role[i].used) continue;
         snprintf(key, sizeof(key), "m%u", (unsigned)count);
         nvs_set_blob(nvs, key, s_node_role[i].mac, 6);
         snprintf(key, sizeof(key), "r%u", (unsigned)count);
         nvs_set_u8(nvs, key, s_node_role[i].role);
+        snprintf(key, sizeof(key), "c%u", (unsigned)count);
+        nvs_set_u8(nvs, key, s_node_role[i].channel);
         count++;
     }
     nvs_set_u8(nvs, "n", count);
@@ -524,7 +1051,7 @@ esp_err_t esp_now_source_load_config(void)
     if (err != ESP_OK) return err;
     uint8_t count = 0;
     if (nvs_get_u8(nvs, "n", &count) != ESP_OK) { nvs_close(nvs); return ESP_ERR_NVS_NOT_FOUND; }
-    if (count > ESP_NOW_SOURCE_MAX_NODES) count = ESP_NOW_SOURCE_MAX_NODES;
+    if (count > ESP_NOW_SOURCE_MAX_ROLES) count = ESP_NOW_SOURCE_MAX_ROLES;
     memset(s_node_role, 0, sizeof(s_node_role));
     char key[8];
     for (uint8_t i = 0; i < count; i++) {
@@ -534,8 +1061,13 @@ esp_err_t esp_now_source_load_config(void)
         snprintf(key, sizeof(key), "r%u", (unsigned)i);
         uint8_t r = 0;
         nvs_get_u8(nvs, key, &r);
-        s_node_role[i].used = true;
-        s_node_role[i].role = r;
+        snprintf(key, sizeof(key), "c%u", (unsigned)i);
+        uint8_t c = 0;                  /* saves without a channel key are channel 0 */
+        nvs_get_u8(nvs, key, &c);
+        if (c >= ESP_NOW_SOURCE_MAX_NODE_CH) continue;
+        s_node_role[i].used    = true;
+        s_node_role[i].channel = c;
+        s_node_role[i].role    = r;
     }
     nvs_close(nvs);
     ESP_LOGI(TAG, "Loaded %u node role(s) from NVS", (unsigned)count);
@@ -556,27 +1088,36 @@ esp_err_t esp_now_source_set_output(const uint8_t mac[6], uint8_t output_id,
                                     uint8_t kind, uint16_t value, uint16_t ramp_ms)
 {
     if (!mac) return ESP_ERR_INVALID_ARG;
-    const int64_t now = esp_timer_get_time();
-    bool found = false;
+    esp_err_t rc = ESP_ERR_NOT_FOUND;   /* unknown node/output (not yet HELLO'd) */
+    bool changed = false;
 
     portENTER_CRITICAL(&s_mux);
     out_node_t *n = out_find(mac);
     if (n) {
         for (uint8_t k = 0; k < n->out_count && k < ESP_NOW_SOURCE_OUT_PER_NODE; k++) {
-            if (n->caps[k].output_id == output_id) {
-                n->desired_set[k]  = true;
-                n->desired_val[k]  = value;
-                n->desired_ramp[k] = ramp_ms;
-                n->last_cmd_us     = now;
-                found = true;
+            if (n->caps[k].output_id != output_id) continue;
+            if (n->caps[k].kind != kind) { rc = ESP_ERR_INVALID_ARG; break; }
+            /* clamp like the node does, so the keep-alive digest matches its state */
+            if (value < n->caps[k].range_min) value = n->caps[k].range_min;
+            if (value > n->caps[k].range_max) value = n->caps[k].range_max;
+            rc = ESP_OK;
+            if (n->desired_set[k] && n->desired_val[k] == value) {
+                s_out_stats.unchanged++;   /* the keep-alive already holds it */
                 break;
             }
+            n->desired_set[k]  = true;
+            n->desired_val[k]  = value;
+            n->desired_ramp[k] = ramp_ms;
+            n->dirty          |= (uint8_t)(1u << k);
+            changed = true;
+            break;
         }
     }
     portEXIT_CRITICAL(&s_mux);
 
-    if (!found) return ESP_ERR_NOT_FOUND;   /* unknown node/output (not yet HELLO'd) */
-    return out_send(mac, output_id, kind, value, ramp_ms);   /* send now; keep-alive re-asserts */
+    TaskHandle_t t = s_inject_task;
+    if (changed && t) xTaskNotify(t, ESPNOW_WAKE_OUT_SET, eSetBits);   /* sent by the inject task */
+    return rc;
 }
 
 esp_err_t esp_now_source_get_output_nodes(esp_now_source_output_node_info_t *out,
@@ -599,6 +1140,7 @@ esp_err_t esp_now_source_get_output_nodes(esp_now_source_output_node_info_t *out
         o->online    = (s.last_frame_us != 0) &&
                        ((now - s.last_frame_us) < (int64_t)ESPNOW_OUT_OFFLINE_MS * 1000);
         o->failsafe  = s.failsafe;
+        o->batch     = s.batch;
         for (uint8_t k = 0; k < s.out_count && k < ESP_NOW_SOURCE_OUT_PER_NODE; k++) {
             o->outputs[k].output_id   = s.caps[k].output_id;
             o->outputs[k].kind        = s.caps[k].kind;
@@ -614,3 +1156,125 @@ esp_err_t esp_now_source_get_output_nodes(esp_now_source_output_node_info_t *out
     *n = cnt;
     return ESP_OK;
 }
+
+esp_err_t esp_now_source_get_out_stats(esp_now_source_out_stats_t *out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_out_stats;
+    portEXIT_CRITICAL(&s_mux);
+    return ESP_OK;
+}
+
+esp_err_t esp_now_source_get_rx_stats(esp_now_source_rx_stats_t *out)
+{
+    if (!out) return ESP_ERR_INVALID_ARG;
+    uint32_t sorted[ESPNOW_LAT_SAMPLES];
+    portENTER_CRITICAL(&s_mux);
+    const uint32_t n = (s_lat_total < ESPNOW_LAT_SAMPLES) ? s_lat_total : ESPNOW_LAT_SAMPLES;
+    memcpy(sorted, s_lat_us, n * sizeof(sorted[0]));   /* the first n slots are the filled ones */
+    out->frames    = s_rx_frames;
+    out->coalesced = s_rx_coalesced;
+    out->posts     = s_posts;
+    out->wakeups   = s_wakeups;
+    out->samples   = s_lat_total;
+    out->max_us    = s_lat_max_us;
+    portEXIT_CRITICAL(&s_mux);
+
+    out->p50_us = 0;
+    out->p99_us = 0;
+    if (n == 0) return ESP_OK;
+    qsort(sorted, n, sizeof(sorted[0]), cmp_u32);
+    out->p50_us = sorted[(n - 1) / 2];
+    out->p99_us = sorted[(uint32_t)(0.99f * (float)(n - 1) + 0.5f)];
+    return ESP_OK;
+}
+
+/* ---- time-master public API ---- */
+
+esp_err_t esp_now_source_get_sync(esp_now_source_sync_stats_t *st,
+                                  esp_now_source_sync_node_t *nodes, size_t max, size_t *n)
+{
+    const int64_t now = esp_timer_get_time();
+    if (st) {
+        memset(st, 0, sizeof(*st));
+        st->enabled     = CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS > 0;
+        st->interval_ms = CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS;
+        portENTER_CRITICAL(&s_mux);
+        st->epoch      = s_sync_epoch;
+        st->beacon_id  = s_sync_beacon_id;
+        st->beacons    = s_sync_beacons;
+        st->followups  = s_sync_followups;
+        st->tx_fail    = s_sync_tx_fail;
+        st->time_resps = s_sync_time_resps;
+        st->time_unset = s_sync_time_unset;
+        st->latches    = s_sync_latches;
+        portEXIT_CRITICAL(&s_mux);
+    }
+    size_t cnt = 0;
+    for (int i = 0; nodes && i < ESP_NOW_SOURCE_MAX_NODES && cnt < max; i++) {
+        portENTER_CRITICAL(&s_mux);
+        sync_node_t s = s_sync_node[i];
+        portEXIT_CRITICAL(&s_mux);
+        if (!s.used) continue;
+        esp_now_source_sync_node_t *o = &nodes[cnt++];
+        memset(o, 0, sizeof(*o));
+        memcpy(o->mac, s.mac, 6);
+        o->online         = s.last_stats_us != 0 &&
+                            (now - s.last_stats_us) < (int64_t)ESPNOW_SYNC_STATS_TO_MS * 1000;
+        o->age_ms         = s.last_stats_us ? (uint32_t)((now - s.last_stats_us) / 1000) : UINT32_MAX;
+        o->beacons_recv   = s.beacons_recv;
+        o->followups_recv = s.followups_recv;
+        o->beacons_missed = s.max_beacon_id > s.beacons_recv ? s.max_beacon_id - s.beacons_recv : 0;
+        o->fits           = s.fits;
+        o->offset_us      = s.resid_mean_us;
+        o->jitter_us      = s.resid_sd_us;
+        o->max_abs_us     = s.resid_maxabs_us;
+        o->skew_ppm       = s.skew_ppm;
+        o->time_reqs      = s.time_reqs;
+    }
+    if (n) *n = cnt;
+    return ESP_OK;
+}
+
+esp_err_t esp_now_source_latch_now(uint8_t reason, size_t *sent)
+{
+    if (sent) *sent = 0;
+    if (!s_initialized || !s_running) return ESP_ERR_INVALID_STATE;
+
+    /* sensor nodes = REALTIME senders + PERIOD senders (a node may only meter) */
+    uint8_t macs[ESP_NOW_SOURCE_MAX_NODES + ESP_NOW_ENERGY_NODES][6];
+    size_t  nm = 0;
+    portENTER_CRITICAL(&s_mux);
+    for (int i = 0; i < ESP_NOW_SOURCE_MAX_NODES; i++)
+        if (s_seen[i].used) memcpy(macs[nm++], s_seen[i].mac, 6);
+    portEXIT_CRITICAL(&s_mux);
+    esp_now_energy_node_t metered[ESP_NOW_ENERGY_NODES];
+    size_t ne = 0;
+    esp_now_energy_get(metered, ESP_NOW_ENERGY_NODES, &ne);
+    for (size_t i = 0; i < ne; i++) {
+        bool known = false;
+        for (size_t k = 0; k < nm && !known; k++) known = mac_eq(macs[k], metered[i].mac);
+        if (!known) memcpy(macs[nm++], metered[i].mac, 6);
+    }
+
+    /* one boundary for all, frames back to back: the nodes latch within the
+     * few hundred us the sends take, not on their own free-running periods */
+    rbn_latch_now_t f;
+    memset(&f, 0, sizeof(f));
+    f.reason        = reason;
+    f.boundary_unix = hub_unix_s();
+    size_t ok = 0;
+    for (size_t k = 0; k < nm; k++) {
+        if (out_ensure_peer(macs[k]) != ESP_OK) continue;
+        rbn_hdr_init(&f.h, RBN_MSG_LATCH_NOW, __atomic_fetch_add(&s_out_seq, 1, __ATOMIC_RELAXED),
+                     f.boundary_unix);
+        if (esp_now_send(macs[k], (const uint8_t *)&f, sizeof(f)) == ESP_OK) ok++;
+    }
+    portENTER_CRITICAL(&s_mux);
+    s_sync_latches += (uint32_t)ok;
+    portEXIT_CRITICAL(&s_mux);
+    ESP_LOGI(TAG, "LATCH_NOW (reason %u) sent to %u/%u node(s)", reason, (unsigned)ok, (unsigned)nm);
+    if (sent) *sent = ok;
+    return ESP_OK;
+}
@@ -34,9 +34,13 @@ typedef enum {
     /**
      * @brief Power measurement update from any single source
      *
-     * Posted by: rbAmp (I2C), DimmerLink, ESP-NOW sources
+     * Posted by: acrouter_meas_publish() while no ring consumer is attached,
+     *            console/web measurement injection
      * Data: acrouter_measurements_t*
      * Rate: ~200ms per source
+     *
+     * Sources publish to acrouter_meas_ring (see acrouter_meas_ring.h); this
+     * event is the fallback path, not the control hot path.
      */
     ACROUTER_EVENT_POWER_UPDATE = 0,
 
@@ -44,9 +48,11 @@ typedef enum {
      * @brief Merged measurement update from Sensor Hub
      *
      * Posted by: Sensor Hub (after merging all sources with priority logic)
-     * Data: acrouter_measurements_t*
+     * Data: acrouter_meas_packed_t* (acrouter_meas_packed.h; unpack with
+     *       acrouter_meas_unpack() against esp_timer_get_time())
      * Rate: ~200ms
-     * Subscribers: RouterController, MQTTManager, WebServerManager
+     * Subscribers: telemetry listeners. RouterController subscribes only when
+     *              its control task is not consuming the measurement ring.
      */
     ACROUTER_EVENT_MERGED_UPDATE,
 
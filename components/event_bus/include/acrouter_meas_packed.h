@@ -0,0 +1,196 @@
+/**
+ * @file acrouter_meas_packed.h
+ * @brief Compact, versioned form of acrouter_measurements_t
+ *
+ * acrouter_measurements_t is the convenient working form (floats, one bool per
+ * availability flag, a 4-byte enum per direction, 64-bit timestamp). The packed
+ * form is what travels and is stored on the hot path — the measurement ring,
+ * the Sensor Hub source cache and the MERGED_UPDATE telemetry event:
+ *
+ *   - one availability bitmask (valid / voltage / current[ch] / power[ch]),
+ *   - 2-bit directions,
+ *   - fixed-point values, meaningful only when their flag bit is set:
+ *       voltage 0.01 V (u16, 0..655.35 V), current 0.01 A (u16, 0..655.35 A),
+ *       active power 1 W (s16, ±32767 W, saturating),
+ *   - the low 32 bits of the esp_timer timestamp (re-extended on unpack
+ *     against a reference time; valid within ±35 min of it).
+ *
+ * 24 bytes vs 64 for the working struct. Non-finite values (NaN/Inf from a
+ * driver glitch) are dropped at pack time by clearing their flag, so nothing
+ * downstream of the pack ever sees them (MAJOR-7).
+ *
+ * The layout is versioned: a reader must reject a frame whose version it does
+ * not know (acrouter_meas_unpack() returns false).
+ */
+
+#ifndef ACROUTER_MEAS_PACKED_H
+#define ACROUTER_MEAS_PACKED_H
+
+#include "acrouter_measurements.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Current packed layout version */
+#define ACROUTER_MEAS_PACKED_VERSION    1
+
+/** Availability flags (acrouter_meas_packed_t::flags) */
+#define ACROUTER_PK_VALID               0x01u
+#define ACROUTER_PK_HAS_VOLTAGE         0x02u
+#define ACROUTER_PK_HAS_CURRENT(ch)     ((uint8_t)(0x04u << (ch)))   /* 0x04..0x10 */
+#define ACROUTER_PK_HAS_POWER(ch)       ((uint8_t)(0x20u << (ch)))   /* 0x20..0x80 */
+
+/** Fixed-point scales (value = raw * LSB) */
+#define ACROUTER_PK_VOLTAGE_LSB         0.01f
+#define ACROUTER_PK_CURRENT_LSB         0.01f
+#define ACROUTER_PK_POWER_LSB           1.0f
+
+/**
+ * @brief Packed measurement frame (v1, 24 bytes)
+ */
+typedef struct {
+    uint8_t  version;                           ///< ACROUTER_MEAS_PACKED_VERSION
+    uint8_t  flags;                             ///< ACROUTER_PK_* availability bits
+    uint8_t  dirs;                              ///< 2 bits per channel (acrouter_direction_t)
+    uint8_t  source;                            ///< acrouter_source_t
+    uint8_t  source_id;                         ///< Source instance ID
+    uint8_t  reserved;                          ///< 0
+    uint16_t voltage_cv;                        ///< RMS voltage, 0.01 V
+    uint16_t current_ca[ACROUTER_CH_COUNT];     ///< RMS current, 0.01 A
+    int16_t  power_w[ACROUTER_CH_COUNT];        ///< Active power, 1 W (+ import / - export)
+    uint32_t timestamp_us32;                    ///< Low 32 bits of timestamp_us
+} acrouter_meas_packed_t;
+
+#ifdef __cplusplus
+static_assert(sizeof(acrouter_meas_packed_t) == 24, "acrouter_meas_packed_t v1 must stay 24 bytes");
+#else
+_Static_assert(sizeof(acrouter_meas_packed_t) == 24, "acrouter_meas_packed_t v1 must stay 24 bytes");
+#endif
+
+/* ---- fixed-point helpers (round to nearest, saturate; NaN → 0) ---- */
+
+static inline uint16_t acrouter_pk_u16(float v, float lsb) {
+    float x = v / lsb + 0.5f;
+    if (!(x > 0.0f)) return 0;
+    if (x >= 65535.0f) return 65535;
+    return (uint16_t)x;
+}
+
+static inline int16_t acrouter_pk_s16(float v, float lsb) {
+    float x = v / lsb;
+    if (!(x > -32767.0f)) return (x == x) ? -32767 : 0;
+    if (x >= 32767.0f) return 32767;
+    return (int16_t)(x + (x >= 0.0f ? 0.5f : -0.5f));
+}
+
+/* ---- field accessors (read a packed frame without unpacking it) ---- */
+
+static inline bool acrouter_pk_has_voltage(const acrouter_meas_packed_t* p) {
+    return (p->flags & ACROUTER_PK_HAS_VOLTAGE) != 0;
+}
+
+static inline bool acrouter_pk_has_current(const acrouter_meas_packed_t* p, int ch) {
+    return (p->flags & ACROUTER_PK_HAS_CURRENT(ch)) != 0;
+}
+
+static inline bool acrouter_pk_has_power(const acrouter_meas_packed_t* p, int ch) {
+    return (p->flags & ACROUTER_PK_HAS_POWER(ch)) != 0;
+}
+
+static inline float acrouter_pk_voltage(const acrouter_meas_packed_t* p) {
+    return (float)p->voltage_cv * ACROUTER_PK_VOLTAGE_LSB;
+}
+
+static inline float acrouter_pk_current(const acrouter_meas_packed_t* p, int ch) {
+    return (float)p->current_ca[ch] * ACROUTER_PK_CURRENT_LSB;
+}
+
+static inline float acrouter_pk_power(const acrouter_meas_packed_t* p, int ch) {
+    return (float)p->power_w[ch] * ACROUTER_PK_POWER_LSB;
+}
+
+static inline acrouter_direction_t acrouter_pk_direction(const acrouter_meas_packed_t* p, int ch) {
+    return (acrouter_direction_t)((p->dirs >> (2 * ch)) & 0x3u);
+}
+
+/** Full timestamp_us, re-extended against @p ref_us (within ±35 min of it). */
+static inline uint64_t acrouter_pk_timestamp(const acrouter_meas_packed_t* p, uint64_t ref_us) {
+    return ref_us - (uint64_t)(int64_t)(int32_t)((uint32_t)ref_us - p->timestamp_us32);
+}
+
+/* ---- conversion ---- */
+
+/**
+ * @brief Pack a working-form frame (non-finite values lose their flag)
+ */
+static inline void acrouter_meas_pack(const acrouter_measurements_t* m, acrouter_meas_packed_t* p) {
+    uint8_t flags = m->valid ? ACROUTER_PK_VALID : 0;
+    uint8_t dirs = 0;
+
+    p->version   = ACROUTER_MEAS_PACKED_VERSION;
+    p->source    = (uint8_t)m->source;
+    p->source_id = m->source_id;
+    p->reserved  = 0;
+    p->timestamp_us32 = (uint32_t)m->timestamp_us;
+
+    p->voltage_cv = 0;
+    if (m->has_voltage && isfinite(m->voltage_rms)) {
+        p->voltage_cv = acrouter_pk_u16(m->voltage_rms, ACROUTER_PK_VOLTAGE_LSB);
+        flags |= ACROUTER_PK_HAS_VOLTAGE;
+    }
+    for (int ch = 0; ch < ACROUTER_CH_COUNT; ch++) {
+        p->current_ca[ch] = 0;
+        p->power_w[ch]    = 0;
+        if (m->has_current[ch] && isfinite(m->current_rms[ch])) {
+            p->current_ca[ch] = acrouter_pk_u16(m->current_rms[ch], ACROUTER_PK_CURRENT_LSB);
+            flags |= ACROUTER_PK_HAS_CURRENT(ch);
+        }
+        if (m->has_power[ch] && isfinite(m->power_active[ch])) {
+            p->power_w[ch] = acrouter_pk_s16(m->power_active[ch], ACROUTER_PK_POWER_LSB);
+            flags |= ACROUTER_PK_HAS_POWER(ch);
+        }
+        dirs |= (uint8_t)(((unsigned)m->direction[ch] & 0x3u) << (2 * ch));
+    }
+    p->flags = flags;
+    p->dirs  = dirs;
+}
+
+/**
+ * @brief Unpack into the working form
+ *
+ * @param p       Packed frame
+ * @param m       Output frame
+ * @param ref_us  Reference esp_timer time (usually now) to re-extend the
+ *                32-bit timestamp against
+ * @return false (m = init, invalid) if the version is unknown
+ */
+static inline bool acrouter_meas_unpack(const acrouter_meas_packed_t* p, acrouter_measurements_t* m,
+                                        uint64_t ref_us) {
+    acrouter_measurements_init(m);
+    if (p->version != ACROUTER_MEAS_PACKED_VERSION) return false;
+
+    m->source       = (acrouter_source_t)p->source;
+    m->source_id    = p->source_id;
+    m->valid        = (p->flags & ACROUTER_PK_VALID) != 0;
+    m->timestamp_us = acrouter_pk_timestamp(p, ref_us);
+    m->has_voltage  = acrouter_pk_has_voltage(p);
+    m->voltage_rms  = acrouter_pk_voltage(p);
+    for (int ch = 0; ch < ACROUTER_CH_COUNT; ch++) {
+        m->has_current[ch]  = acrouter_pk_has_current(p, ch);
+        m->current_rms[ch]  = acrouter_pk_current(p, ch);
+        m->has_power[ch]    = acrouter_pk_has_power(p, ch);
+        m->power_active[ch] = acrouter_pk_power(p, ch);
+        m->direction[ch]    = acrouter_pk_direction(p, ch);
+    }
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACROUTER_MEAS_PACKED_H
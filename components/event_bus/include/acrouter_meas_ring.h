@@ -0,0 +1,116 @@
+/**
+ * @file acrouter_meas_ring.h
+ * @brief Measurement ring - sources → Sensor Hub → control task hot path
+ *
+ * Multi-producer / single-consumer ring of preallocated slots holding the
+ * compact acrouter_meas_packed_t form (24 B). Sources (rbamp_source,
+ * esp_now_source, dimmerlink_manager) publish their frames here instead of
+ * posting ACROUTER_EVENT_POWER_UPDATE; the
+ * consumer (RouterController's control task, via sensor_hub_pump()) reads each
+ * frame in place and releases the slot. The shared esp_event loop is no longer
+ * on the control path — it only carries MERGED_UPDATE as a fan-out for
+ * telemetry listeners.
+ *
+ * Until a consumer attaches (or if it never does, e.g. the control task failed
+ * to start), acrouter_meas_publish() falls back to posting POWER_UPDATE, so the
+ * legacy event-driven path keeps working unchanged.
+ *
+ * Producers reserve a slot under a short portMUX, pack the frame into it and
+ * commit it; the consumer takes slots strictly in order. A full ring drops the
+ * NEW frame (counted) — the next 200 ms frame supersedes it anyway.
+ */
+
+#ifndef ACROUTER_MEAS_RING_H
+#define ACROUTER_MEAS_RING_H
+
+#include "esp_err.h"
+#include "acrouter_measurements.h"
+#include "acrouter_meas_packed.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Ring depth (power of two). 16 = > 3 s of frames from a 4-module fleet. */
+#define ACROUTER_MEAS_RING_DEPTH    16
+
+/**
+ * @brief Consumer wake-up hook
+ *
+ * Called (outside any critical section) after every commit and on
+ * acrouter_meas_ring_kick(). Must be short — typically xTaskNotifyGive().
+ */
+typedef void (*acrouter_meas_wake_fn_t)(void* arg);
+
+/**
+ * @brief Ring counters (since boot)
+ */
+typedef struct {
+    uint32_t published;     ///< Frames committed to the ring
+    uint32_t consumed;      ///< Frames released by the consumer
+    uint32_t dropped;       ///< Frames dropped because the ring was full
+    uint32_t fallback;      ///< Frames posted as POWER_UPDATE (no consumer attached)
+    uint32_t high_water;    ///< Max slots in use at once
+} acrouter_meas_ring_stats_t;
+
+/**
+ * @brief Attach the (single) consumer
+ *
+ * @param wake  Wake-up hook, may be NULL for a polling consumer
+ * @param arg   Passed to wake
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if a consumer is already attached
+ */
+esp_err_t acrouter_meas_ring_attach(acrouter_meas_wake_fn_t wake, void* arg);
+
+/**
+ * @brief Detach the consumer; publish() falls back to POWER_UPDATE again
+ *
+ * Frames still in the ring are discarded.
+ */
+void acrouter_meas_ring_detach(void);
+
+/**
+ * @brief Check whether a consumer is attached
+ */
+bool acrouter_meas_ring_attached(void);
+
+/**
+ * @brief Publish one measurement frame (any task)
+ *
+ * @return ESP_OK, ESP_ERR_NO_MEM if the ring is full (frame dropped), or the
+ *         esp_event_post() result on the no-consumer fallback
+ */
+esp_err_t acrouter_meas_publish(const acrouter_measurements_t* m);
+
+/**
+ * @brief Peek the oldest committed frame (consumer only)
+ *
+ * The frame stays valid, in place, until acrouter_meas_ring_release().
+ *
+ * @return Frame, or NULL if the ring is empty (or the next slot is still
+ *         being filled by its producer)
+ */
+const acrouter_meas_packed_t* acrouter_meas_ring_peek(void);
+
+/**
+ * @brief Release the frame returned by acrouter_meas_ring_peek() (consumer only)
+ */
+void acrouter_meas_ring_release(void);
+
+/**
+ * @brief Wake the consumer without a frame (e.g. an epoch deadline)
+ */
+void acrouter_meas_ring_kick(void);
+
+/**
+ * @brief Get ring counters
+ */
+void acrouter_meas_ring_get_stats(acrouter_meas_ring_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACROUTER_MEAS_RING_H
@@ -69,6 +69,7 @@ typedef struct {
 
     // Metadata
     uint64_t timestamp_us;                          ///< Measurement timestamp (esp_timer_get_time)
+    uint64_t acquired_us[ACROUTER_CH_COUNT];        ///< Merged frames: source timestamp_us per channel (0 = unknown)
     acrouter_source_t source;                       ///< Data source type
     uint8_t source_id;                              ///< Source instance ID (e.g., DimmerLink slot)
     bool valid;                                     ///< Overall data validity
@@ -90,6 +91,7 @@ static inline void acrouter_measurements_init(acrouter_measurements_t* m) {
         m->direction[i] = ACROUTER_DIR_UNKNOWN;
         m->has_current[i] = false;
         m->has_power[i] = false;
+        m->acquired_us[i] = 0;
     }
     m->timestamp_us = 0;
     m->source = ACROUTER_SOURCE_NONE;
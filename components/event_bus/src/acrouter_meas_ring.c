@@ -0,0 +1,121 @@
+/**
+ * @file acrouter_meas_ring.c
+ * @brief Measurement ring (MPSC). See acrouter_meas_ring.h.
+ *
+ * s_head (next slot to reserve) is only advanced under s_mux; s_tail (next slot
+ * to consume) only by the consumer. A slot is published by storing its ticket
+ * (reservation index + 1) with release semantics after the copy, so the
+ * consumer never reads a half-written frame even when a later producer commits
+ * first — it simply waits for the earlier slot (the filler is microseconds
+ * behind and will wake it again on commit).
+ */
+
+#include "acrouter_meas_ring.h"
+#include "acrouter_events.h"
+#include "freertos/FreeRTOS.h"
+
+#define RING_MASK   (ACROUTER_MEAS_RING_DEPTH - 1)
+
+_Static_assert((ACROUTER_MEAS_RING_DEPTH & RING_MASK) == 0,
+               "ACROUTER_MEAS_RING_DEPTH must be a power of two");
+
+typedef struct {
+    acrouter_meas_packed_t meas;
+    uint32_t               ticket;      ///< reservation index + 1 once committed
+} ring_slot_t;
+
+static ring_slot_t                 s_ring[ACROUTER_MEAS_RING_DEPTH];
+static uint32_t                    s_head;      /* under s_mux */
+static uint32_t                    s_tail;      /* consumer-owned, read by producers */
+static portMUX_TYPE                s_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool                        s_attached;
+static acrouter_meas_wake_fn_t     s_wake;
+static void*                       s_wake_arg;
+static acrouter_meas_ring_stats_t  s_stats;     /* under s_mux (consumed: consumer + atomic) */
+
+static void wake_consumer(void) {
+    acrouter_meas_wake_fn_t fn = s_wake;
+    void* arg = s_wake_arg;
+    if (fn) fn(arg);
+}
+
+esp_err_t acrouter_meas_ring_attach(acrouter_meas_wake_fn_t wake, void* arg) {
+    portENTER_CRITICAL(&s_mux);
+    if (s_attached) {
+        portEXIT_CRITICAL(&s_mux);
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_wake     = wake;
+    s_wake_arg = arg;
+    s_tail     = s_head;            /* start empty */
+    __atomic_store_n(&s_attached, true, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&s_mux);
+    return ESP_OK;
+}
+
+void acrouter_meas_ring_detach(void) {
+    portENTER_CRITICAL(&s_mux);
+    __atomic_store_n(&s_attached, false, __ATOMIC_RELEASE);
+    s_wake     = NULL;
+    s_wake_arg = NULL;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+bool acrouter_meas_ring_attached(void) {
+    return __atomic_load_n(&s_attached, __ATOMIC_ACQUIRE);
+}
+
+esp_err_t acrouter_meas_publish(const acrouter_measurements_t* m) {
+    if (!m) return ESP_ERR_INVALID_ARG;
+
+    if (!acrouter_meas_ring_attached()) {
+        portENTER_CRITICAL(&s_mux);
+        s_stats.fallback++;
+        portEXIT_CRITICAL(&s_mux);
+        return esp_event_post(ACROUTER_EVENT, ACROUTER_EVENT_POWER_UPDATE, m, sizeof(*m), 0);
+    }
+
+    portENTER_CRITICAL(&s_mux);
+    uint32_t used = s_head - __atomic_load_n(&s_tail, __ATOMIC_ACQUIRE);
+    if (used >= ACROUTER_MEAS_RING_DEPTH) {
+        s_stats.dropped++;
+        portEXIT_CRITICAL(&s_mux);
+        return ESP_ERR_NO_MEM;
+    }
+    uint32_t idx = s_head++;
+    if (used + 1 > s_stats.high_water) s_stats.high_water = used + 1;
+    s_stats.published++;
+    portEXIT_CRITICAL(&s_mux);
+
+    ring_slot_t* slot = &s_ring[idx & RING_MASK];
+    acrouter_meas_pack(m, &slot->meas);
+    __atomic_store_n(&slot->ticket, idx + 1, __ATOMIC_RELEASE);
+
+    wake_consumer();
+    return ESP_OK;
+}
+
+const acrouter_meas_packed_t* acrouter_meas_ring_peek(void) {
+    if (!acrouter_meas_ring_attached()) return NULL;
+    uint32_t idx = s_tail;
+    ring_slot_t* slot = &s_ring[idx & RING_MASK];
+    if (__atomic_load_n(&slot->ticket, __ATOMIC_ACQUIRE) != idx + 1) return NULL;
+    return &slot->meas;
+}
+
+void acrouter_meas_ring_release(void) {
+    __atomic_store_n(&s_tail, s_tail + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&s_stats.consumed, 1, __ATOMIC_RELAXED);
+}
+
+void acrouter_meas_ring_kick(void) {
+    if (acrouter_meas_ring_attached()) wake_consumer();
+}
+
+void acrouter_meas_ring_get_stats(acrouter_meas_ring_stats_t* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+    out->consumed = __atomic_load_n(&s_stats.consumed, __ATOMIC_RELAXED);
+}
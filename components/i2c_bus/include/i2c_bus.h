@@ -11,6 +11,19 @@
  *
  * All DimmerLink modules (sensors, dimmers, relays) share the same bus.
  * Thread-safe: the ESP-IDF i2c_master driver handles bus arbitration.
+ *
+ * Device handles are kept in a per-bus LRU cache (I2C_BUS_HANDLE_CACHE_SIZE)
+ * instead of being added/removed around every transaction. Callers that move a
+ * module to another address invalidate it (i2c_bus_invalidate_device());
+ * i2c_bus_scan() and i2c_bus_deinit() flush the whole bus.
+ *
+ * These calls block the caller for the whole transaction. Output writes and the
+ * DimmerLink poll go through the prioritised per-bus queue (i2c_bus_async.h).
+ *
+ * Each transaction is recorded per device (i2c_bus_health.h): a device that
+ * keeps failing is backed off — its reads return ESP_ERR_NOT_ALLOWED without
+ * touching the bus; writes (outputs) still go out, with the short probe
+ * timeout — and the clock may adapt when enabled.
  */
 
 #ifndef I2C_BUS_H
@@ -33,6 +46,40 @@ extern "C" {
 #define I2C_BUS_DEFAULT_SCL     22
 #define I2C_BUS_DEFAULT_FREQ    100000  /* 100 kHz - DimmerLink Standard Mode */
 
+/** Cached device handles per bus (DimmerLink modules + a few discovery probes) */
+#define I2C_BUS_HANDLE_CACHE_SIZE   8
+
+/** Utilisation window (us): one second, five 5 Hz poll cycles */
+#define I2C_BUS_UTIL_WINDOW_US      1000000
+
+/**
+ * @brief Device-handle cache counters of one bus (since i2c_bus_init)
+ */
+typedef struct {
+    uint32_t hits;              ///< Transactions served by a cached handle
+    uint32_t misses;            ///< Transactions that had to add the device
+    uint32_t evictions;         ///< LRU handles removed to make room
+    uint32_t invalidations;     ///< Handles removed by invalidate / scan
+    uint32_t add_us_avg;        ///< i2c_master_bus_add_device() cost, EMA/8 (us)
+    uint32_t rm_us_avg;         ///< i2c_master_bus_rm_device() cost, EMA/8 (us)
+    uint8_t  cached;            ///< Handles currently held
+} i2c_bus_cache_stats_t;
+
+/**
+ * @brief Bus occupancy of one bus
+ *
+ * Busy time is the wall time of every i2c_bus transaction (lock wait excluded)
+ * plus what libraries driving the handle themselves report through
+ * i2c_bus_account_busy(). Closed windows are I2C_BUS_UTIL_WINDOW_US long.
+ */
+typedef struct {
+    uint32_t window_us;         ///< Length of the last closed window
+    uint32_t busy_us;           ///< Bus time in that window
+    uint32_t xfers;             ///< i2c_bus transactions in that window
+    uint16_t util_permille;     ///< busy / window, 0-1000
+    uint16_t peak_permille;     ///< Highest closed window since i2c_bus_init
+} i2c_bus_util_t;
+
 /**
  * @brief Initialize an I2C bus as master
  *
@@ -72,7 +119,8 @@ bool i2c_bus_is_initialized(uint8_t bus_num);
  * @param data      Buffer to receive data
  * @param len       Number of bytes to read
  * @return ESP_OK on success, ESP_ERR_TIMEOUT on bus timeout,
- *         ESP_ERR_NOT_FOUND if device does not ACK
+ *         ESP_ERR_NOT_FOUND if device does not ACK, ESP_ERR_NOT_ALLOWED while
+ *         the device is backed off
  */
 esp_err_t i2c_bus_read_reg(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
                            uint8_t* data, size_t len);
@@ -98,7 +146,9 @@ esp_err_t i2c_bus_read_reg_stop(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
  * @param reg       Register address to write to
  * @param data      Data buffer to write
  * @param len       Number of bytes to write
- * @return ESP_OK on success
+ * @return ESP_OK on success. Never refused by the backoff: an output write is
+ *         not throttled like a poll, it only runs with the short probe timeout
+ *         while the device is backed off.
  */
 esp_err_t i2c_bus_write_reg(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
                             const uint8_t* data, size_t len);
@@ -141,6 +191,71 @@ esp_err_t i2c_bus_read_byte(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
 esp_err_t i2c_bus_scan(uint8_t bus_num, uint8_t* found_addrs, uint8_t max_addrs,
                        uint8_t* found_count);
 
+/**
+ * @brief Probe one address
+ *
+ * Same test as i2c_bus_scan() for a single address: a bare address probe, then a
+ * 1-byte register-pointer write for slaves that do not ACK the bare probe. Lets a
+ * caller walk the bus in slices between other traffic instead of in one go.
+ *
+ * @param bus_num   Bus number
+ * @param dev_addr  7-bit device address
+ * @return ESP_OK if a device acknowledged, ESP_ERR_INVALID_STATE if the bus is
+ *         not initialized, else the driver error
+ */
+esp_err_t i2c_bus_probe(uint8_t bus_num, uint8_t dev_addr);
+
+/**
+ * @brief Drop the cached handle of one device
+ *
+ * Call when a module changes address (the next transaction re-adds it).
+ *
+ * @param bus_num   Bus number
+ * @param dev_addr  7-bit device address
+ * @return ESP_OK (also when nothing was cached), ESP_ERR_INVALID_STATE if the
+ *         bus is not initialized
+ */
+esp_err_t i2c_bus_invalidate_device(uint8_t bus_num, uint8_t dev_addr);
+
+/**
+ * @brief Drop every cached handle of a bus (re-scan, bus reconfiguration)
+ *
+ * @param bus_num   Bus number
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if the bus is not initialized
+ */
+esp_err_t i2c_bus_invalidate_all(uint8_t bus_num);
+
+/**
+ * @brief Get the device-handle cache counters of a bus
+ *
+ * add_us_avg + rm_us_avg is what every hit saves against a per-transaction
+ * handle.
+ *
+ * @param bus_num   Bus number
+ * @param stats     Receives the counters
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE if the bus is
+ *         not initialized
+ */
+esp_err_t i2c_bus_get_cache_stats(uint8_t bus_num, i2c_bus_cache_stats_t* stats);
+
+/**
+ * @brief Add bus time spent outside the i2c_bus calls (e.g. one rbAmp fleet poll)
+ *
+ * @param bus_num   Bus number
+ * @param busy_us   Wall time the caller held the bus
+ */
+void i2c_bus_account_busy(uint8_t bus_num, uint32_t busy_us);
+
+/**
+ * @brief Get the utilisation of the last closed window
+ *
+ * @param bus_num   Bus number
+ * @param util      Receives the window
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE if the bus is
+ *         not initialized
+ */
+esp_err_t i2c_bus_get_utilisation(uint8_t bus_num, i2c_bus_util_t* util);
+
 /**
  * @brief Get the raw i2c_master bus handle for a bus
  *
@@ -0,0 +1,192 @@
+/**
+ * @file i2c_bus_async.h
+ * @brief Asynchronous I2C transaction queue with a per-bus worker
+ *
+ * The blocking i2c_bus_* calls run in the caller's task, so the 5 Hz control
+ * task writing a dimmer level waits behind whatever poll holds the bus. With the
+ * worker started (i2c_bus_async_start()), transactions are queued instead and a
+ * per-bus task executes them in priority order:
+ *
+ *   ACTUATION  (dimmer level, relay)  — always next on the bus
+ *   TELEMETRY  (DimmerLink poll)
+ *   BACKGROUND (config, discovery)
+ *
+ * FIFO within a class, so two writes to one device land in submission order.
+ * Actuation therefore waits for at most the transaction already on the wire.
+ * The last I2C_BUS_ASYNC_RESERVED queue slots are kept for actuation: a
+ * telemetry burst can never fill the queue against an output write.
+ *
+ * Completion is a callback (runs on the worker — keep it short) and/or a future
+ * the submitter waits on. Every transfer has a deadline: one still queued when
+ * it passes completes with ESP_ERR_TIMEOUT without touching the bus, so a stale
+ * level never lands after a newer decision has been made on it.
+ *
+ * Without a running worker every submission executes inline (the old blocking
+ * behaviour), so early-boot code and callers need no second path.
+ *
+ * Transactions from libraries that drive the bus handle themselves (rbAmp via
+ * i2c_bus_get_handle()) do not pass through the queue; the driver's bus lock
+ * interleaves them with the worker per transaction.
+ */
+
+#ifndef I2C_BUS_ASYNC_H
+#define I2C_BUS_ASYNC_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Queued transactions per bus (all classes) */
+#define I2C_BUS_ASYNC_DEPTH         16
+
+/** Queue slots only actuation may take */
+#define I2C_BUS_ASYNC_RESERVED      4
+
+/** Largest write payload (copied at submission; reads go to the caller's buffer) */
+#define I2C_BUS_ASYNC_MAX_WRITE     32
+
+/** Default deadline (submission → start of execution) when xfer->timeout_ms is 0 */
+#define I2C_BUS_ASYNC_TIMEOUT_MS    200
+
+/**
+ * @brief Priority class (lower value is served first)
+ */
+typedef enum {
+    I2C_BUS_PRIO_ACTUATION = 0,     ///< Output writes from the control path
+    I2C_BUS_PRIO_TELEMETRY,         ///< Periodic sensor reads
+    I2C_BUS_PRIO_BACKGROUND,        ///< Configuration, discovery
+    I2C_BUS_PRIO_COUNT
+} i2c_bus_prio_t;
+
+/**
+ * @brief Transaction shape (maps onto the blocking i2c_bus_* calls)
+ */
+typedef enum {
+    I2C_BUS_OP_WRITE = 0,           ///< i2c_bus_write_reg()
+    I2C_BUS_OP_READ,                ///< i2c_bus_read_reg() (repeated START)
+    I2C_BUS_OP_READ_STOP,           ///< i2c_bus_read_reg_stop() (STOP-latch slaves)
+} i2c_bus_op_t;
+
+/**
+ * @brief Completion callback
+ *
+ * Runs on the bus worker (or inline in the submitter without a worker). Must
+ * not block and must not wait on a future of the same bus.
+ */
+typedef void (*i2c_bus_done_cb_t)(esp_err_t result, void* ctx);
+
+/**
+ * @brief One transaction
+ */
+typedef struct {
+    i2c_bus_op_t    op;
+    i2c_bus_prio_t  prio;
+    uint8_t         addr;           ///< 7-bit device address
+    uint8_t         reg;            ///< Register address
+    const uint8_t*  tx;             ///< Write payload (copied; op WRITE)
+    uint8_t*        rx;             ///< Read buffer (must outlive the transfer)
+    size_t          len;            ///< Payload / read length
+    uint32_t        timeout_ms;     ///< Deadline to start; 0 = I2C_BUS_ASYNC_TIMEOUT_MS
+    i2c_bus_done_cb_t cb;           ///< Optional completion callback
+    void*           ctx;            ///< Callback argument
+} i2c_bus_xfer_t;
+
+/**
+ * @brief Completion handle the submitter can wait on
+ */
+typedef struct {
+    SemaphoreHandle_t done;
+    StaticSemaphore_t done_buf;
+    esp_err_t         result;
+} i2c_bus_future_t;
+
+/**
+ * @brief Queue counters of one bus (since i2c_bus_async_start)
+ */
+typedef struct {
+    uint32_t submitted[I2C_BUS_PRIO_COUNT];
+    uint32_t completed[I2C_BUS_PRIO_COUNT];
+    uint32_t failed;                ///< Executed with a bus error
+    uint32_t expired;               ///< Deadline passed in the queue (not executed)
+    uint32_t rejected;              ///< Queue (or non-reserved share) full
+    uint32_t wait_us_avg[I2C_BUS_PRIO_COUNT];  ///< Submission → start, EMA/8
+    uint32_t wait_us_max[I2C_BUS_PRIO_COUNT];  ///< Worst submission → start
+    uint8_t  queued;                ///< Transactions waiting now
+    uint8_t  queued_max;            ///< High-water mark
+    bool     running;               ///< Worker active
+} i2c_bus_async_stats_t;
+
+/**
+ * @brief Start the worker of an initialized bus
+ *
+ * @return ESP_OK (also when already running), ESP_ERR_INVALID_STATE if the bus
+ *         is not initialized, ESP_ERR_NO_MEM
+ */
+esp_err_t i2c_bus_async_start(uint8_t bus_num);
+
+/**
+ * @brief Stop the worker; queued transactions complete with ESP_ERR_INVALID_STATE
+ *
+ * Submissions while it stops are refused with ESP_ERR_INVALID_STATE; once it
+ * returns they execute inline again.
+ */
+esp_err_t i2c_bus_async_stop(uint8_t bus_num);
+
+/**
+ * @brief Whether the bus has a running worker
+ */
+bool i2c_bus_async_running(uint8_t bus_num);
+
+/**
+ * @brief Prepare a future (once per future; reusable after each wait)
+ */
+void i2c_bus_future_init(i2c_bus_future_t* future);
+
+/**
+ * @brief Submit a transaction
+ *
+ * On ESP_OK the callback runs and the future is signalled exactly once. On an
+ * error neither happens: the queue was full, the arguments were bad, the worker
+ * is stopping (ESP_ERR_INVALID_STATE), or — when no worker runs and the transfer
+ * executed inline — the bus error itself.
+ *
+ * @param bus_num  Bus number
+ * @param xfer     Transaction (copied)
+ * @param future   Optional; signalled with the result
+ * @return ESP_OK if queued (or executed inline successfully)
+ */
+esp_err_t i2c_bus_submit(uint8_t bus_num, const i2c_bus_xfer_t* xfer, i2c_bus_future_t* future);
+
+/**
+ * @brief Wait for a submitted transaction
+ *
+ * Bounded by the transaction's deadline plus one bus timeout.
+ *
+ * @return The transaction's result
+ */
+esp_err_t i2c_bus_future_wait(i2c_bus_future_t* future);
+
+/**
+ * @brief Submit and wait (blocking call that still honours the priority order)
+ */
+esp_err_t i2c_bus_transfer(uint8_t bus_num, const i2c_bus_xfer_t* xfer);
+
+/**
+ * @brief Get the queue counters of a bus
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG
+ */
+esp_err_t i2c_bus_async_get_stats(uint8_t bus_num, i2c_bus_async_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_BUS_ASYNC_H
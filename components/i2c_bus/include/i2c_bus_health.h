@@ -0,0 +1,151 @@
+/**
+ * @file i2c_bus_health.h
+ * @brief Per-device bus health, retry backoff and adaptive SCL clock
+ *
+ * Every i2c_bus transaction is recorded against its device address: successes,
+ * NACKs (no ACK on address or data), timeouts (clock stretched past the driver
+ * timeout, stuck bus) and other driver errors, plus a latency histogram of the
+ * transaction wall time (bus lock wait excluded).
+ *
+ * Retry policy: after I2C_BUS_BACKOFF_AFTER consecutive failures a device is
+ * backed off. i2c_bus refuses its reads with ESP_ERR_NOT_ALLOWED without
+ * touching the bus until the backoff expires; the next transaction is a probe
+ * with a short timeout. Writes are never refused — the backoff throttles
+ * polling, not outputs — they just run with the probe timeout meanwhile. A
+ * failed probe doubles the backoff (capped), a success clears it. A dead module
+ * thus costs one short probe every few seconds instead of a full timeout on
+ * every read of every poll cycle. i2c_bus_scan() and
+ * i2c_bus_invalidate_device() clear the backoff of the addresses they touch.
+ *
+ * Adaptive clock (opt-in, i2c_bus_set_adaptive_clock()): the configured clock
+ * is the floor. After clean windows of I2C_BUS_CLOCK_WINDOW transactions the
+ * clock doubles up to the ceiling; I2C_BUS_CLOCK_DOWN_ERRORS errors inside one
+ * window halve it at once, and each step down doubles the clean windows the next
+ * step up needs. Only errors of devices that have answered count — a module
+ * that was never there says nothing about the clock. The new clock applies to
+ * the i2c_bus device handles (the cache is flushed); libraries that add their
+ * own handles (rbAmp) keep theirs.
+ */
+
+#ifndef I2C_BUS_HEALTH_H
+#define I2C_BUS_HEALTH_H
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Devices tracked per bus (oldest idle entry is reused beyond that) */
+#define I2C_BUS_HEALTH_MAX_DEVICES  16
+
+/** Latency histogram buckets and their upper bounds (us; last bucket is open) */
+#define I2C_BUS_LAT_BUCKETS         7
+#define I2C_BUS_LAT_BOUNDS_US       { 250, 500, 1000, 2000, 5000, 10000 }
+
+/** Consecutive failures before a device is backed off */
+#define I2C_BUS_BACKOFF_AFTER       3
+
+/** First backoff (two 5 Hz poll cycles); doubles per failed probe */
+#define I2C_BUS_BACKOFF_BASE_MS     400
+
+/** Backoff cap: BASE << MAX_SHIFT (25.6 s) */
+#define I2C_BUS_BACKOFF_MAX_SHIFT   6
+
+/** Driver timeout of a backoff probe (ms) */
+#define I2C_BUS_PROBE_TIMEOUT_MS    20
+
+/** Transactions per adaptive-clock window */
+#define I2C_BUS_CLOCK_WINDOW        256
+
+/** Errors within one window that step the clock down */
+#define I2C_BUS_CLOCK_DOWN_ERRORS   5
+
+/** Highest clock the adaptive policy may reach (Fast Mode) */
+#define I2C_BUS_CLOCK_MAX_HZ        400000
+
+/**
+ * @brief Health of one device
+ */
+typedef struct {
+    uint8_t  addr;                  ///< 7-bit address
+    uint8_t  consec_fail;           ///< Failures since the last success
+    uint8_t  backoff_level;         ///< 0 = not backed off, else shift + 1
+    uint32_t backoff_left_ms;       ///< Time until the next probe (0 = due)
+    uint32_t ok;                    ///< Successful transactions
+    uint32_t nack;                  ///< Not acknowledged
+    uint32_t timeout;               ///< Driver timeout
+    uint32_t other;                 ///< Any other driver error
+    uint32_t skipped;               ///< Transactions refused during backoff
+    uint32_t lat_hist[I2C_BUS_LAT_BUCKETS];  ///< Transaction wall time
+    uint32_t lat_us_max;            ///< Slowest transaction
+} i2c_bus_dev_health_t;
+
+/**
+ * @brief Health summary of one bus
+ */
+typedef struct {
+    uint32_t freq_hz;               ///< Clock of the i2c_bus handles now
+    uint32_t base_hz;               ///< Configured clock (adaptive floor)
+    uint32_t max_hz;                ///< Adaptive ceiling (= base_hz when fixed)
+    bool     adaptive;              ///< Adaptive clock enabled
+    uint32_t steps_up;              ///< Clock raises since i2c_bus_init
+    uint32_t steps_down;            ///< Clock reductions since i2c_bus_init
+    uint16_t win_xfers;             ///< Transactions in the open clock window
+    uint16_t win_errors;            ///< Counted errors in the open clock window
+    uint8_t  clean_needed;          ///< Clean windows the next step up needs
+    uint8_t  devices;               ///< Tracked devices
+    uint8_t  backed_off;            ///< Devices in backoff now
+} i2c_bus_health_t;
+
+/**
+ * @brief Enable or disable the adaptive clock of an initialized bus
+ *
+ * Disabling returns the bus to its configured clock.
+ *
+ * @param bus_num  Bus number
+ * @param enable   Adapt between the configured clock and @p max_hz
+ * @param max_hz   Ceiling, clamped to I2C_BUS_CLOCK_MAX_HZ
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE if the bus is
+ *         not initialized
+ */
+esp_err_t i2c_bus_set_adaptive_clock(uint8_t bus_num, bool enable, uint32_t max_hz);
+
+/**
+ * @brief Whether a transaction to @p addr may use the bus now
+ *
+ * For pollers that would rather skip a backed-off device than queue work that
+ * i2c_bus refuses anyway. A refusal counts as skipped.
+ *
+ * @return false while the device is backed off
+ */
+bool i2c_bus_health_admit(uint8_t bus_num, uint8_t addr);
+
+/**
+ * @brief Forget a device's failures and backoff (it was just found or moved)
+ */
+void i2c_bus_health_clear(uint8_t bus_num, uint8_t addr);
+
+/**
+ * @brief Get the health summary of a bus
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_INVALID_STATE if the bus is
+ *         not initialized
+ */
+esp_err_t i2c_bus_get_health(uint8_t bus_num, i2c_bus_health_t* health);
+
+/**
+ * @brief Get the health of the @p index-th tracked device of a bus
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND past the last device, ESP_ERR_INVALID_ARG
+ */
+esp_err_t i2c_bus_get_device_health(uint8_t bus_num, uint8_t index,
+                                    i2c_bus_dev_health_t* dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_BUS_HEALTH_H
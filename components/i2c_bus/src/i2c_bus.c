@@ -4,11 +4,24 @@
  *
  * Uses ESP-IDF 5.x i2c_master new driver API.
  * The new driver provides internal bus locking for thread safety.
+ *
+ * Device handles are cached per (bus, addr) with LRU eviction instead of being
+ * added and removed around every transaction. A per-bus mutex guards the cache
+ * and is held for the whole transaction, so a handle is never evicted while
+ * another task is using it.
+ *
+ * Every executed transaction is recorded with the health module
+ * (i2c_bus_health.c), which also decides backoff refusals, the probe timeout and
+ * the adaptive clock; a clock change is applied here by flushing the cache.
  */
 
 #include "i2c_bus.h"
+#include "i2c_bus_health_priv.h"
 #include "driver/i2c_master.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include <string.h>
 
 static const char* TAG = "I2C_Bus";
@@ -23,6 +36,14 @@ static const char* TAG = "I2C_Bus";
 #define I2C_SCAN_PROBE_TIMEOUT_MS  10
 #define I2C_MAX_WRITE_LEN   32   /* max register-write payload; bounds the write buffer */
 
+/** One cached device handle */
+typedef struct {
+    i2c_master_dev_handle_t handle;
+    uint8_t addr;
+    bool valid;
+    uint32_t last_use;      /* LRU stamp (per-bus use counter) */
+} i2c_handle_slot_t;
+
 /** Bus state */
 typedef struct {
     i2c_master_bus_handle_t bus_handle;
@@ -30,6 +51,16 @@ typedef struct {
     int sda_pin;
     int scl_pin;
     uint32_t freq_hz;
+    SemaphoreHandle_t lock;                 /* guards cache[] across a transaction */
+    i2c_handle_slot_t cache[I2C_BUS_HANDLE_CACHE_SIZE];
+    uint32_t use_counter;
+    i2c_bus_cache_stats_t stats;
+    portMUX_TYPE util_mux;                  /* guards the utilisation window */
+    int64_t  win_start_us;
+    uint32_t win_busy_us;
+    uint32_t win_xfers;
+    int64_t  xfer_start_us;                 /* current transaction (lock held) */
+    i2c_bus_util_t util;                    /* last closed window */
 } i2c_bus_state_t;
 
 static i2c_bus_state_t s_buses[I2C_BUS_MAX] = {0};
@@ -37,8 +68,8 @@ static i2c_bus_state_t s_buses[I2C_BUS_MAX] = {0};
 /**
  * @brief Add a device to the bus (internal helper)
  *
- * Creates a temporary device handle for a single transaction.
- * The new i2c_master driver requires device registration.
+ * The new i2c_master driver requires device registration. Transactions get the
+ * handle through acquire_device() (cached); scan probes use a temporary one.
  */
 static esp_err_t add_device(uint8_t bus_num, uint8_t dev_addr,
                             i2c_master_dev_handle_t* dev_handle) {
@@ -50,6 +81,135 @@ static esp_err_t add_device(uint8_t bus_num, uint8_t dev_addr,
     return i2c_master_bus_add_device(s_buses[bus_num].bus_handle, &dev_cfg, dev_handle);
 }
 
+/* EMA/8, seeded by the first sample (same smoothing as the poll-cycle timers). */
+static void ema_us(uint32_t* avg, uint32_t sample) {
+    *avg = *avg ? (*avg * 7 + sample) / 8 : sample;
+}
+
+/**
+ * @brief Add busy time to the open window, closing it when it is full
+ */
+static void util_add(i2c_bus_state_t* b, uint32_t busy_us, uint32_t xfers) {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&b->util_mux);
+    b->win_busy_us += busy_us;
+    b->win_xfers   += xfers;
+    int64_t len = now - b->win_start_us;
+    if (len >= I2C_BUS_UTIL_WINDOW_US) {
+        uint32_t busy = b->win_busy_us < (uint32_t)len ? b->win_busy_us : (uint32_t)len;
+        b->util.window_us     = (uint32_t)len;
+        b->util.busy_us       = busy;
+        b->util.xfers         = b->win_xfers;
+        b->util.util_permille = (uint16_t)((uint64_t)busy * 1000 / (uint64_t)len);
+        if (b->util.util_permille > b->util.peak_permille) {
+            b->util.peak_permille = b->util.util_permille;
+        }
+        b->win_start_us = now;
+        b->win_busy_us  = 0;
+        b->win_xfers    = 0;
+    }
+    portEXIT_CRITICAL(&b->util_mux);
+}
+
+/** Drop one cached handle (lock held). */
+static void evict_slot(i2c_bus_state_t* b, i2c_handle_slot_t* slot) {
+    int64_t t0 = esp_timer_get_time();
+    i2c_master_bus_rm_device(slot->handle);
+    ema_us(&b->stats.rm_us_avg, (uint32_t)(esp_timer_get_time() - t0));
+    slot->handle = NULL;
+    slot->valid = false;
+    b->stats.cached--;
+}
+
+/**
+ * @brief Take the bus lock and return the cached handle for @p dev_addr
+ *
+ * Adds the device on a miss, evicting the least recently used handle when the
+ * cache is full. On ESP_OK the caller owns the lock until release_device().
+ */
+static esp_err_t acquire_device(uint8_t bus_num, uint8_t dev_addr,
+                                i2c_master_dev_handle_t* dev_handle) {
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    xSemaphoreTake(b->lock, portMAX_DELAY);
+    if (!b->initialized) {
+        xSemaphoreGive(b->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    i2c_handle_slot_t* lru = NULL;
+    i2c_handle_slot_t* free_slot = NULL;
+    for (int i = 0; i < I2C_BUS_HANDLE_CACHE_SIZE; i++) {
+        i2c_handle_slot_t* slot = &b->cache[i];
+        if (!slot->valid) {
+            if (!free_slot) free_slot = slot;
+            continue;
+        }
+        if (slot->addr == dev_addr) {
+            slot->last_use = ++b->use_counter;
+            b->stats.hits++;
+            *dev_handle = slot->handle;
+            b->xfer_start_us = esp_timer_get_time();
+            return ESP_OK;
+        }
+        if (!lru || (int32_t)(slot->last_use - lru->last_use) < 0) lru = slot;
+    }
+
+    b->stats.misses++;
+    if (!free_slot) {
+        free_slot = lru;
+        evict_slot(b, lru);
+        b->stats.evictions++;
+    }
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = add_device(bus_num, dev_addr, &free_slot->handle);
+    ema_us(&b->stats.add_us_avg, (uint32_t)(esp_timer_get_time() - t0));
+    if (err != ESP_OK) {
+        free_slot->handle = NULL;
+        xSemaphoreGive(b->lock);
+        return err;
+    }
+    free_slot->addr = dev_addr;
+    free_slot->valid = true;
+    free_slot->last_use = ++b->use_counter;
+    b->stats.cached++;
+    *dev_handle = free_slot->handle;
+    b->xfer_start_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+/** Remove every cached handle of a bus (lock held). */
+static void flush_cache(i2c_bus_state_t* b) {
+    for (int i = 0; i < I2C_BUS_HANDLE_CACHE_SIZE; i++) {
+        if (b->cache[i].valid) {
+            evict_slot(b, &b->cache[i]);
+            b->stats.invalidations++;
+        }
+    }
+}
+
+/**
+ * @brief Run the bus at @p freq_hz from the next transaction on (lock held)
+ *
+ * scl_speed_hz belongs to the device handle, so the cached handles go.
+ */
+static void apply_clock(uint8_t bus_num, uint32_t freq_hz) {
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    if (freq_hz == b->freq_hz) return;
+    ESP_LOGI(TAG, "Bus %d clock %lu -> %lu Hz", bus_num,
+             (unsigned long)b->freq_hz, (unsigned long)freq_hz);
+    b->freq_hz = freq_hz;
+    flush_cache(b);
+}
+
+/** Account and record the transaction, then give the lock back. */
+static void release_device(uint8_t bus_num, uint8_t dev_addr, esp_err_t err) {
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    uint32_t wall_us = (uint32_t)(esp_timer_get_time() - b->xfer_start_us);
+    util_add(b, wall_us, 1);
+    apply_clock(bus_num, i2c_bus_health_record(bus_num, dev_addr, err, wall_us));
+    xSemaphoreGive(b->lock);
+}
+
 // ================================================================
 // Lifecycle
 // ================================================================
@@ -76,6 +236,11 @@ esp_err_t i2c_bus_init(uint8_t bus_num, int sda_pin, int scl_pin, uint32_t freq_
         },
     };
 
+    if (!s_buses[bus_num].lock) {
+        s_buses[bus_num].lock = xSemaphoreCreateMutex();
+        if (!s_buses[bus_num].lock) return ESP_ERR_NO_MEM;
+    }
+
     esp_err_t err = i2c_new_master_bus(&bus_cfg, &s_buses[bus_num].bus_handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create I2C master bus %d: %s", bus_num, esp_err_to_name(err));
@@ -86,6 +251,15 @@ esp_err_t i2c_bus_init(uint8_t bus_num, int sda_pin, int scl_pin, uint32_t freq_
     s_buses[bus_num].sda_pin = sda_pin;
     s_buses[bus_num].scl_pin = scl_pin;
     s_buses[bus_num].freq_hz = freq_hz;
+    memset(s_buses[bus_num].cache, 0, sizeof(s_buses[bus_num].cache));
+    memset(&s_buses[bus_num].stats, 0, sizeof(s_buses[bus_num].stats));
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    s_buses[bus_num].util_mux = mux;
+    s_buses[bus_num].win_start_us = esp_timer_get_time();
+    s_buses[bus_num].win_busy_us = 0;
+    s_buses[bus_num].win_xfers = 0;
+    memset(&s_buses[bus_num].util, 0, sizeof(s_buses[bus_num].util));
+    i2c_bus_health_init(bus_num, freq_hz);
 
     ESP_LOGI(TAG, "I2C bus %d initialized: SDA=%d, SCL=%d, %lu Hz",
              bus_num, sda_pin, scl_pin, (unsigned long)freq_hz);
@@ -97,12 +271,17 @@ esp_err_t i2c_bus_deinit(uint8_t bus_num) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    esp_err_t err = i2c_del_master_bus(s_buses[bus_num].bus_handle);
+    // The driver refuses to delete a bus with devices still attached.
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    xSemaphoreTake(b->lock, portMAX_DELAY);
+    flush_cache(b);
+    esp_err_t err = i2c_del_master_bus(b->bus_handle);
     if (err == ESP_OK) {
-        s_buses[bus_num].initialized = false;
-        s_buses[bus_num].bus_handle = NULL;
+        b->initialized = false;
+        b->bus_handle = NULL;
         ESP_LOGI(TAG, "I2C bus %d deinitialized", bus_num);
     }
+    xSemaphoreGive(b->lock);
     return err;
 }
 
@@ -111,6 +290,41 @@ bool i2c_bus_is_initialized(uint8_t bus_num) {
     return s_buses[bus_num].initialized;
 }
 
+void i2c_bus_account_busy(uint8_t bus_num, uint32_t busy_us) {
+    if (bus_num >= I2C_BUS_MAX || !s_buses[bus_num].initialized) return;
+    util_add(&s_buses[bus_num], busy_us, 0);
+}
+
+esp_err_t i2c_bus_get_utilisation(uint8_t bus_num, i2c_bus_util_t* util) {
+    if (bus_num >= I2C_BUS_MAX || !util) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_buses[bus_num].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    util_add(b, 0, 0);      /* close a window an idle bus left open */
+    portENTER_CRITICAL(&b->util_mux);
+    *util = b->util;
+    portEXIT_CRITICAL(&b->util_mux);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_set_adaptive_clock(uint8_t bus_num, bool enable, uint32_t max_hz) {
+    if (bus_num >= I2C_BUS_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_buses[bus_num].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    xSemaphoreTake(b->lock, portMAX_DELAY);
+    apply_clock(bus_num, i2c_bus_health_set_ceiling(bus_num, enable ? max_hz : 0));
+    xSemaphoreGive(b->lock);
+    ESP_LOGI(TAG, "Bus %d adaptive clock %s", bus_num, enable ? "on" : "off");
+    return ESP_OK;
+}
+
 i2c_master_bus_handle_t i2c_bus_get_handle(uint8_t bus_num) {
     if (bus_num >= I2C_BUS_MAX || !s_buses[bus_num].initialized) {
         return NULL;
@@ -118,6 +332,52 @@ i2c_master_bus_handle_t i2c_bus_get_handle(uint8_t bus_num) {
     return s_buses[bus_num].bus_handle;
 }
 
+// ================================================================
+// Device-handle cache
+// ================================================================
+
+esp_err_t i2c_bus_invalidate_device(uint8_t bus_num, uint8_t dev_addr) {
+    if (bus_num >= I2C_BUS_MAX || !s_buses[bus_num].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    xSemaphoreTake(b->lock, portMAX_DELAY);
+    for (int i = 0; i < I2C_BUS_HANDLE_CACHE_SIZE; i++) {
+        if (b->cache[i].valid && b->cache[i].addr == dev_addr) {
+            evict_slot(b, &b->cache[i]);
+            b->stats.invalidations++;
+        }
+    }
+    xSemaphoreGive(b->lock);
+    i2c_bus_health_clear(bus_num, dev_addr);    /* moved: start its record over */
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_invalidate_all(uint8_t bus_num) {
+    if (bus_num >= I2C_BUS_MAX || !s_buses[bus_num].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    xSemaphoreTake(b->lock, portMAX_DELAY);
+    flush_cache(b);
+    xSemaphoreGive(b->lock);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_get_cache_stats(uint8_t bus_num, i2c_bus_cache_stats_t* stats) {
+    if (bus_num >= I2C_BUS_MAX || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_buses[bus_num].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    xSemaphoreTake(b->lock, portMAX_DELAY);
+    *stats = b->stats;
+    xSemaphoreGive(b->lock);
+    return ESP_OK;
+}
+
 // ================================================================
 // Read/Write Operations
 // ================================================================
@@ -130,15 +390,19 @@ esp_err_t i2c_bus_read_reg(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
     if (!data || len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (!i2c_bus_health_admit(bus_num, dev_addr)) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
 
     i2c_master_dev_handle_t dev;
-    esp_err_t err = add_device(bus_num, dev_addr, &dev);
+    esp_err_t err = acquire_device(bus_num, dev_addr, &dev);
     if (err != ESP_OK) return err;
+    int timeout_ms = (int)i2c_bus_health_timeout_ms(bus_num, dev_addr, I2C_TIMEOUT_MS);
 
     // Write register address, then read data (with repeated START)
-    err = i2c_master_transmit_receive(dev, &reg, 1, data, len, I2C_TIMEOUT_MS);
+    err = i2c_master_transmit_receive(dev, &reg, 1, data, len, timeout_ms);
 
-    i2c_master_bus_rm_device(dev);
+    release_device(bus_num, dev_addr, err);
     return err;
 }
 
@@ -150,21 +414,26 @@ esp_err_t i2c_bus_read_reg_stop(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
     if (!data || len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (!i2c_bus_health_admit(bus_num, dev_addr)) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
 
     i2c_master_dev_handle_t dev;
-    esp_err_t err = add_device(bus_num, dev_addr, &dev);
+    esp_err_t err = acquire_device(bus_num, dev_addr, &dev);
     if (err != ESP_OK) return err;
+    int timeout_ms = (int)i2c_bus_health_timeout_ms(bus_num, dev_addr, I2C_TIMEOUT_MS);
 
     // Separate transactions: write(reg)+STOP, then START+read. Some slave
     // firmwares (e.g. legacy DimmerLink) latch the register pointer only on a
     // full STOP, not on a repeated-START — a combined transmit_receive returns
-    // the previous/uninitialized register there. This reads correctly.
-    err = i2c_master_transmit(dev, &reg, 1, I2C_TIMEOUT_MS);
+    // the previous/uninitialized register there. This reads correctly. The bus
+    // lock spans both, so no other i2c_bus transfer lands between them.
+    err = i2c_master_transmit(dev, &reg, 1, timeout_ms);
     if (err == ESP_OK) {
-        err = i2c_master_receive(dev, data, len, I2C_TIMEOUT_MS);
+        err = i2c_master_receive(dev, data, len, timeout_ms);
     }
 
-    i2c_master_bus_rm_device(dev);
+    release_device(bus_num, dev_addr, err);
     return err;
 }
 
@@ -175,14 +444,18 @@ esp_err_t i2c_bus_write_reg(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
     }
     // Bound the payload before touching the bus — a caller-sized stack VLA with no
     // upper bound could overrun the (4 KB) poll-task stacks, and len==SIZE_MAX wraps
-    // to a 0-length buffer (D9). Checked before add_device so no device handle leaks.
+    // to a 0-length buffer (D9). Checked before taking the bus lock.
     if (len > I2C_MAX_WRITE_LEN || (len > 0 && !data)) {
         return ESP_ERR_INVALID_ARG;
     }
+    // No health admission: the backoff throttles polling, and refusing an output
+    // write would leave a load where the controller no longer thinks it is. A
+    // backed-off device still costs only the short probe timeout per write.
 
     i2c_master_dev_handle_t dev;
-    esp_err_t err = add_device(bus_num, dev_addr, &dev);
+    esp_err_t err = acquire_device(bus_num, dev_addr, &dev);
     if (err != ESP_OK) return err;
+    int timeout_ms = (int)i2c_bus_health_timeout_ms(bus_num, dev_addr, I2C_TIMEOUT_MS);
 
     // Combine register address + data into one write (fixed, bounded buffer)
     uint8_t buf[I2C_MAX_WRITE_LEN + 1];
@@ -191,9 +464,9 @@ esp_err_t i2c_bus_write_reg(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
         memcpy(&buf[1], data, len);
     }
 
-    err = i2c_master_transmit(dev, buf, len + 1, I2C_TIMEOUT_MS);
+    err = i2c_master_transmit(dev, buf, len + 1, timeout_ms);
 
-    i2c_master_bus_rm_device(dev);
+    release_device(bus_num, dev_addr, err);
     return err;
 }
 
@@ -211,6 +484,44 @@ esp_err_t i2c_bus_read_byte(uint8_t bus_num, uint8_t dev_addr, uint8_t reg,
 // Bus Scan
 // ================================================================
 
+/* One address: bare probe, then the register-pointer-write fallback. Takes the
+ * bus lock, like a transaction: the probe is bus traffic, and the fallback adds
+ * and removes a device on the bus handle. */
+static esp_err_t probe_addr(uint8_t bus_num, uint8_t addr) {
+    i2c_bus_state_t* b = &s_buses[bus_num];
+    xSemaphoreTake(b->lock, portMAX_DELAY);
+    if (!b->initialized) {
+        xSemaphoreGive(b->lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    const int64_t t0 = esp_timer_get_time();
+    esp_err_t err = i2c_master_probe(s_buses[bus_num].bus_handle, addr, I2C_SCAN_PROBE_TIMEOUT_MS);
+    if (err != ESP_OK) {
+        // Fallback: some legacy slaves (e.g. the DimmerLink firmware) do not
+        // ACK a bare zero-length probe cleanly on every SoC, yet ACK a real
+        // transaction. Retry with a 1-byte register-pointer write (harmless:
+        // just sets the read pointer to reg 0) and treat an ACK as present.
+        i2c_master_dev_handle_t dev;
+        if (add_device(bus_num, addr, &dev) == ESP_OK) {
+            uint8_t reg0 = 0x00;
+            err = i2c_master_transmit(dev, &reg0, 1, I2C_SCAN_PROBE_TIMEOUT_MS);
+            i2c_master_bus_rm_device(dev);
+        }
+    }
+    util_add(b, (uint32_t)(esp_timer_get_time() - t0), 1);
+    xSemaphoreGive(b->lock);
+    return err;
+}
+
+esp_err_t i2c_bus_probe(uint8_t bus_num, uint8_t dev_addr) {
+    if (bus_num >= I2C_BUS_MAX || !s_buses[bus_num].initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = probe_addr(bus_num, dev_addr);
+    if (err == ESP_OK) i2c_bus_health_clear(bus_num, dev_addr);
+    return err;
+}
+
 esp_err_t i2c_bus_scan(uint8_t bus_num, uint8_t* found_addrs, uint8_t max_addrs,
                        uint8_t* found_count) {
     if (bus_num >= I2C_BUS_MAX || !s_buses[bus_num].initialized) {
@@ -223,21 +534,14 @@ esp_err_t i2c_bus_scan(uint8_t bus_num, uint8_t* found_addrs, uint8_t max_addrs,
     *found_count = 0;
     ESP_LOGI(TAG, "Scanning I2C bus %d...", bus_num);
 
+    // A re-scan is where modules come and go (re-addressed, hot-swapped): start
+    // the handle cache over rather than keep handles for addresses now empty.
+    i2c_bus_invalidate_all(bus_num);
+
     for (uint8_t addr = 0x08; addr <= 0x77 && *found_count < max_addrs; addr++) {
-        esp_err_t err = i2c_master_probe(s_buses[bus_num].bus_handle, addr, I2C_SCAN_PROBE_TIMEOUT_MS);
-        if (err != ESP_OK) {
-            // Fallback: some legacy slaves (e.g. the DimmerLink firmware) do not
-            // ACK a bare zero-length probe cleanly on every SoC, yet ACK a real
-            // transaction. Retry with a 1-byte register-pointer write (harmless:
-            // just sets the read pointer to reg 0) and treat an ACK as present.
-            i2c_master_dev_handle_t dev;
-            if (add_device(bus_num, addr, &dev) == ESP_OK) {
-                uint8_t reg0 = 0x00;
-                err = i2c_master_transmit(dev, &reg0, 1, I2C_SCAN_PROBE_TIMEOUT_MS);
-                i2c_master_bus_rm_device(dev);
-            }
-        }
+        esp_err_t err = probe_addr(bus_num, addr);
         if (err == ESP_OK) {
+            i2c_bus_health_clear(bus_num, addr);
             found_addrs[*found_count] = addr;
             (*found_count)++;
             ESP_LOGI(TAG, "  Found device at 0x%02X", addr);
@@ -0,0 +1,329 @@
+/**
+ * @file i2c_bus_async.c
+ * @brief Asynchronous I2C transaction queue implementation
+ *
+ * Per bus: a fixed pool of request slots, one FIFO per priority class and a
+ * worker task that executes the head of the highest non-empty class through the
+ * blocking i2c_bus_* calls (handle cache and bus lock included). The lists are
+ * guarded by a spinlock — every critical section is a few pointer moves.
+ */
+
+#include "i2c_bus_async.h"
+#include "i2c_bus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* TAG = "I2C_Async";
+
+/* Worker: below the control task (10) so queuing a write never yields to it,
+ * above the poll tasks (5) so actuation overtakes a poll that is mid-cycle. */
+#define I2C_ASYNC_TASK_PRIO     9
+#define I2C_ASYNC_TASK_STACK    3072
+#if !CONFIG_FREERTOS_UNICORE
+#define I2C_ASYNC_TASK_CORE     1       /* control/sensor plane, like dl_poll / rbamp_poll */
+#else
+#define I2C_ASYNC_TASK_CORE     tskNO_AFFINITY
+#endif
+
+typedef struct i2c_async_req {
+    i2c_bus_xfer_t        x;
+    uint8_t               payload[I2C_BUS_ASYNC_MAX_WRITE];
+    i2c_bus_future_t*     future;
+    int64_t               submit_us;
+    int64_t               deadline_us;
+    struct i2c_async_req* next;
+} i2c_async_req_t;
+
+typedef struct {
+    i2c_async_req_t   pool[I2C_BUS_ASYNC_DEPTH];
+    i2c_async_req_t*  free_list;
+    uint8_t           free_count;
+    i2c_async_req_t*  head[I2C_BUS_PRIO_COUNT];
+    i2c_async_req_t*  tail[I2C_BUS_PRIO_COUNT];
+    portMUX_TYPE      mux;
+    SemaphoreHandle_t pending;          /* counts queued requests */
+    TaskHandle_t      task;
+    volatile bool     running;          /* written under mux: submit decides queue/inline on it */
+    volatile bool     stopping;         /* stop draining: submissions are refused */
+    volatile bool     exited;
+    i2c_bus_async_stats_t stats;
+} i2c_async_bus_t;
+
+static i2c_async_bus_t s_async[I2C_BUS_MAX] = {
+    [0] = { .mux = portMUX_INITIALIZER_UNLOCKED },
+    [1] = { .mux = portMUX_INITIALIZER_UNLOCKED },
+};
+
+/* EMA/8, seeded by the first sample (same smoothing as the poll-cycle timers). */
+static void ema_us(uint32_t* avg, uint32_t sample) {
+    *avg = *avg ? (*avg * 7 + sample) / 8 : sample;
+}
+
+static esp_err_t execute(uint8_t bus_num, const i2c_bus_xfer_t* x) {
+    switch (x->op) {
+        case I2C_BUS_OP_WRITE:
+            return i2c_bus_write_reg(bus_num, x->addr, x->reg, x->tx, x->len);
+        case I2C_BUS_OP_READ:
+            return i2c_bus_read_reg(bus_num, x->addr, x->reg, x->rx, x->len);
+        case I2C_BUS_OP_READ_STOP:
+            return i2c_bus_read_reg_stop(bus_num, x->addr, x->reg, x->rx, x->len);
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+static void complete(const i2c_bus_xfer_t* x, i2c_bus_future_t* future, esp_err_t err) {
+    if (x->cb) x->cb(err, x->ctx);
+    if (future) {
+        future->result = err;
+        xSemaphoreGive(future->done);
+    }
+}
+
+/** Pop the head of the highest non-empty class (spinlock held). */
+static i2c_async_req_t* pop_next(i2c_async_bus_t* a) {
+    for (int p = 0; p < I2C_BUS_PRIO_COUNT; p++) {
+        i2c_async_req_t* r = a->head[p];
+        if (!r) continue;
+        a->head[p] = r->next;
+        if (!a->head[p]) a->tail[p] = NULL;
+        a->stats.queued--;
+        return r;
+    }
+    return NULL;
+}
+
+static void release(i2c_async_bus_t* a, i2c_async_req_t* r) {
+    portENTER_CRITICAL(&a->mux);
+    r->next = a->free_list;
+    a->free_list = r;
+    a->free_count++;
+    portEXIT_CRITICAL(&a->mux);
+}
+
+static void i2c_async_task(void* arg) {
+    const uint8_t bus_num = (uint8_t)(uintptr_t)arg;
+    i2c_async_bus_t* a = &s_async[bus_num];
+    ESP_LOGI(TAG, "Bus %u worker started", bus_num);
+
+    while (a->running) {
+        if (xSemaphoreTake(a->pending, pdMS_TO_TICKS(100)) != pdTRUE) continue;
+
+        portENTER_CRITICAL(&a->mux);
+        i2c_async_req_t* r = pop_next(a);
+        portEXIT_CRITICAL(&a->mux);
+        if (!r) continue;
+
+        const i2c_bus_prio_t prio = r->x.prio;
+        const int64_t start = esp_timer_get_time();
+        esp_err_t err;
+        if (start > r->deadline_us) {
+            err = ESP_ERR_TIMEOUT;
+        } else {
+            err = execute(bus_num, &r->x);
+        }
+
+        const uint32_t wait = (uint32_t)(start - r->submit_us);
+        portENTER_CRITICAL(&a->mux);
+        if (start > r->deadline_us) a->stats.expired++;
+        else if (err != ESP_OK)     a->stats.failed++;
+        a->stats.completed[prio]++;
+        ema_us(&a->stats.wait_us_avg[prio], wait);
+        if (wait > a->stats.wait_us_max[prio]) a->stats.wait_us_max[prio] = wait;
+        portEXIT_CRITICAL(&a->mux);
+
+        /* Copy out first: the slot is reusable once released. */
+        i2c_bus_xfer_t x = r->x;
+        i2c_bus_future_t* future = r->future;
+        release(a, r);
+        complete(&x, future, err);
+    }
+
+    ESP_LOGI(TAG, "Bus %u worker stopped", bus_num);
+    a->exited = true;
+    vTaskDelete(NULL);
+}
+
+// ================================================================
+// Lifecycle
+// ================================================================
+
+/* Fail whatever is still queued so no submitter waits forever (worker gone). */
+static void fail_queued(i2c_async_bus_t* a) {
+    for (;;) {
+        portENTER_CRITICAL(&a->mux);
+        i2c_async_req_t* r = pop_next(a);
+        portEXIT_CRITICAL(&a->mux);
+        if (!r) break;
+        i2c_bus_xfer_t x = r->x;
+        i2c_bus_future_t* future = r->future;
+        release(a, r);
+        complete(&x, future, ESP_ERR_INVALID_STATE);
+    }
+}
+
+esp_err_t i2c_bus_async_start(uint8_t bus_num) {
+    if (bus_num >= I2C_BUS_MAX) return ESP_ERR_INVALID_ARG;
+    if (!i2c_bus_is_initialized(bus_num)) return ESP_ERR_INVALID_STATE;
+    i2c_async_bus_t* a = &s_async[bus_num];
+    if (a->running) return ESP_OK;
+    if (a->stopping) return ESP_ERR_INVALID_STATE;
+
+    if (!a->pending) {
+        a->pending = xSemaphoreCreateCounting(I2C_BUS_ASYNC_DEPTH, 0);
+        if (!a->pending) return ESP_ERR_NO_MEM;
+    }
+    while (xSemaphoreTake(a->pending, 0) == pdTRUE) {}  /* stale counts of a previous run */
+
+    a->free_list = NULL;
+    for (int i = I2C_BUS_ASYNC_DEPTH - 1; i >= 0; i--) {
+        a->pool[i].next = a->free_list;
+        a->free_list = &a->pool[i];
+    }
+    a->free_count = I2C_BUS_ASYNC_DEPTH;
+    memset(a->head, 0, sizeof(a->head));
+    memset(a->tail, 0, sizeof(a->tail));
+    memset(&a->stats, 0, sizeof(a->stats));
+
+    a->exited = false;
+    portENTER_CRITICAL(&a->mux);
+    a->running = true;
+    portEXIT_CRITICAL(&a->mux);
+    char name[12];
+    snprintf(name, sizeof(name), "i2c%u_q", bus_num);
+    BaseType_t ok = xTaskCreatePinnedToCore(i2c_async_task, name, I2C_ASYNC_TASK_STACK,
+                                            (void*)(uintptr_t)bus_num, I2C_ASYNC_TASK_PRIO,
+                                            &a->task, I2C_ASYNC_TASK_CORE);
+    if (ok != pdPASS) {
+        portENTER_CRITICAL(&a->mux);
+        a->running = false;
+        portEXIT_CRITICAL(&a->mux);
+        fail_queued(a);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_async_stop(uint8_t bus_num) {
+    if (bus_num >= I2C_BUS_MAX) return ESP_ERR_INVALID_ARG;
+    i2c_async_bus_t* a = &s_async[bus_num];
+    portENTER_CRITICAL(&a->mux);
+    const bool was_running = a->running;
+    if (was_running) {
+        a->running  = false;
+        a->stopping = true;
+    }
+    portEXIT_CRITICAL(&a->mux);
+    if (!was_running) return ESP_OK;
+
+    xSemaphoreGive(a->pending);
+    while (!a->exited) vTaskDelay(pdMS_TO_TICKS(10));
+    a->task = NULL;
+    fail_queued(a);
+    a->stopping = false;
+    return ESP_OK;
+}
+
+bool i2c_bus_async_running(uint8_t bus_num) {
+    return bus_num < I2C_BUS_MAX && s_async[bus_num].running;
+}
+
+// ================================================================
+// Submission
+// ================================================================
+
+void i2c_bus_future_init(i2c_bus_future_t* future) {
+    future->done   = xSemaphoreCreateBinaryStatic(&future->done_buf);
+    future->result = ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t i2c_bus_submit(uint8_t bus_num, const i2c_bus_xfer_t* xfer, i2c_bus_future_t* future) {
+    if (bus_num >= I2C_BUS_MAX || !xfer || xfer->prio >= I2C_BUS_PRIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (xfer->op == I2C_BUS_OP_WRITE) {
+        if (xfer->len > I2C_BUS_ASYNC_MAX_WRITE || (xfer->len > 0 && !xfer->tx)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    } else if (!xfer->rx || xfer->len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    i2c_async_bus_t* a = &s_async[bus_num];
+    const int64_t now = esp_timer_get_time();
+    const uint32_t timeout_ms = xfer->timeout_ms ? xfer->timeout_ms : I2C_BUS_ASYNC_TIMEOUT_MS;
+
+    /* Queue or inline is decided under the lock i2c_bus_async_stop() clears
+     * running under: a request queued here is one stop still drains, and nothing
+     * runs inline until the worker is gone. */
+    portENTER_CRITICAL(&a->mux);
+    if (!a->running) {
+        const bool stopping = a->stopping;
+        portEXIT_CRITICAL(&a->mux);
+        if (stopping) return ESP_ERR_INVALID_STATE;
+        /* No worker: the blocking path, same contract. */
+        esp_err_t err = execute(bus_num, xfer);
+        if (err == ESP_OK) complete(xfer, future, ESP_OK);
+        return err;
+    }
+    const uint8_t floor = (xfer->prio == I2C_BUS_PRIO_ACTUATION) ? 0 : I2C_BUS_ASYNC_RESERVED;
+    if (a->free_count <= floor) {
+        a->stats.rejected++;
+        portEXIT_CRITICAL(&a->mux);
+        return ESP_ERR_NO_MEM;
+    }
+    i2c_async_req_t* r = a->free_list;
+    a->free_list = r->next;
+    a->free_count--;
+
+    r->x = *xfer;
+    if (xfer->op == I2C_BUS_OP_WRITE && xfer->len > 0) {
+        memcpy(r->payload, xfer->tx, xfer->len);
+        r->x.tx = r->payload;
+    }
+    r->future      = future;
+    r->submit_us   = now;
+    r->deadline_us = now + (int64_t)timeout_ms * 1000;
+    r->next        = NULL;
+
+    const i2c_bus_prio_t p = xfer->prio;
+    if (a->tail[p]) a->tail[p]->next = r;
+    else            a->head[p] = r;
+    a->tail[p] = r;
+
+    a->stats.submitted[p]++;
+    a->stats.queued++;
+    if (a->stats.queued > a->stats.queued_max) a->stats.queued_max = a->stats.queued;
+    portEXIT_CRITICAL(&a->mux);
+
+    xSemaphoreGive(a->pending);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_future_wait(i2c_bus_future_t* future) {
+    xSemaphoreTake(future->done, portMAX_DELAY);
+    return future->result;
+}
+
+esp_err_t i2c_bus_transfer(uint8_t bus_num, const i2c_bus_xfer_t* xfer) {
+    i2c_bus_future_t future;
+    i2c_bus_future_init(&future);
+    esp_err_t err = i2c_bus_submit(bus_num, xfer, &future);
+    if (err != ESP_OK) return err;
+    return i2c_bus_future_wait(&future);
+}
+
+esp_err_t i2c_bus_async_get_stats(uint8_t bus_num, i2c_bus_async_stats_t* stats) {
+    if (bus_num >= I2C_BUS_MAX || !stats) return ESP_ERR_INVALID_ARG;
+    i2c_async_bus_t* a = &s_async[bus_num];
+    portENTER_CRITICAL(&a->mux);
+    *stats = a->stats;
+    portEXIT_CRITICAL(&a->mux);
+    stats->running = a->running;
+    return ESP_OK;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file i2c_bus_health.c
+ * @brief Per-device bus health, retry backoff and adaptive clock implementation
+ *
+ * Per bus: a small table of devices keyed by address and the adaptive-clock
+ * window. i2c_bus.c records every executed transaction with the bus lock held;
+ * pollers ask for admission without it, so the table is guarded by a spinlock —
+ * every critical section is a table walk of I2C_BUS_HEALTH_MAX_DEVICES entries.
+ */
+
+#include "i2c_bus_health_priv.h"
+#include "i2c_bus.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+/** Clean windows the first step up needs, and the ceiling after step-downs */
+#define I2C_CLOCK_CLEAN_FIRST   2
+#define I2C_CLOCK_CLEAN_MAX     32
+
+typedef struct {
+    i2c_bus_dev_health_t d;
+    bool    valid;
+    bool    answered;           /* acknowledged at least once */
+    int64_t backoff_until_us;
+    int64_t last_us;            /* last transaction (entry reuse) */
+} i2c_health_entry_t;
+
+typedef struct {
+    portMUX_TYPE       mux;
+    bool               active;
+    i2c_health_entry_t dev[I2C_BUS_HEALTH_MAX_DEVICES];
+    uint32_t           freq_hz;
+    uint32_t           base_hz;
+    uint32_t           max_hz;
+    uint32_t           steps_up;
+    uint32_t           steps_down;
+    uint16_t           win_xfers;
+    uint16_t           win_errors;
+    uint8_t            clean;
+    uint8_t            clean_needed;
+} i2c_health_bus_t;
+
+static i2c_health_bus_t s_health[I2C_BUS_MAX] = {
+    [0] = { .mux = portMUX_INITIALIZER_UNLOCKED },
+    [1] = { .mux = portMUX_INITIALIZER_UNLOCKED },
+};
+
+static const uint32_t s_lat_bounds_us[I2C_BUS_LAT_BUCKETS - 1] = I2C_BUS_LAT_BOUNDS_US;
+
+/* Entry of @p addr, or NULL (mux held). */
+static i2c_health_entry_t* find(i2c_health_bus_t* h, uint8_t addr) {
+    for (int i = 0; i < I2C_BUS_HEALTH_MAX_DEVICES; i++) {
+        if (h->dev[i].valid && h->dev[i].d.addr == addr) return &h->dev[i];
+    }
+    return NULL;
+}
+
+/* Entry of @p addr, created on first use; a full table reuses the entry idle
+ * longest that is not backed off (mux held). */
+static i2c_health_entry_t* find_or_add(i2c_health_bus_t* h, uint8_t addr) {
+    i2c_health_entry_t* e = find(h, addr);
+    if (e) return e;
+    i2c_health_entry_t* victim = NULL;
+    for (int i = 0; i < I2C_BUS_HEALTH_MAX_DEVICES; i++) {
+        i2c_health_entry_t* c = &h->dev[i];
+        if (!c->valid) { victim = c; break; }
+        if (c->d.backoff_level) continue;
+        if (!victim || c->last_us < victim->last_us) victim = c;
+    }
+    if (!victim) return NULL;
+    memset(victim, 0, sizeof(*victim));
+    victim->valid  = true;
+    victim->d.addr = addr;
+    return victim;
+}
+
+static bool is_nack(esp_err_t err) {
+    /* The i2c_master driver reports a missing ACK as INVALID_STATE (5.0-5.2)
+     * or INVALID_RESPONSE / NOT_FOUND (later releases). */
+    return err == ESP_ERR_INVALID_STATE || err == ESP_ERR_INVALID_RESPONSE ||
+           err == ESP_ERR_NOT_FOUND;
+}
+
+/* One clock step after a counted error or a closed window (mux held). */
+static void clock_update(i2c_health_bus_t* h) {
+    if (h->win_errors >= I2C_BUS_CLOCK_DOWN_ERRORS) {
+        if (h->freq_hz > h->base_hz) {
+            h->freq_hz = (h->freq_hz / 2 > h->base_hz) ? h->freq_hz / 2 : h->base_hz;
+            h->steps_down++;
+            if (h->clean_needed < I2C_CLOCK_CLEAN_MAX) h->clean_needed *= 2;
+        }
+        h->clean = 0;
+        h->win_xfers = h->win_errors = 0;
+        return;
+    }
+    if (h->win_xfers < I2C_BUS_CLOCK_WINDOW) return;
+
+    if (h->win_errors == 0) {
+        if (h->clean < UINT8_MAX) h->clean++;
+        if (h->clean >= h->clean_needed && h->freq_hz < h->max_hz) {
+            h->freq_hz = (h->freq_hz * 2 < h->max_hz) ? h->freq_hz * 2 : h->max_hz;
+            h->steps_up++;
+            h->clean = 0;
+        }
+    } else {
+        h->clean = 0;
+    }
+    h->win_xfers = h->win_errors = 0;
+}
+
+// ================================================================
+// Hooks (i2c_bus.c)
+// ================================================================
+
+void i2c_bus_health_init(uint8_t bus_num, uint32_t base_hz) {
+    if (bus_num >= I2C_BUS_MAX) return;
+    i2c_health_bus_t* h = &s_health[bus_num];
+    portENTER_CRITICAL(&h->mux);
+    memset(h->dev, 0, sizeof(h->dev));
+    h->freq_hz = h->base_hz = h->max_hz = base_hz;
+    h->steps_up = h->steps_down = 0;
+    h->win_xfers = h->win_errors = 0;
+    h->clean = 0;
+    h->clean_needed = I2C_CLOCK_CLEAN_FIRST;
+    h->active = true;
+    portEXIT_CRITICAL(&h->mux);
+}
+
+uint32_t i2c_bus_health_set_ceiling(uint8_t bus_num, uint32_t max_hz) {
+    i2c_health_bus_t* h = &s_health[bus_num];
+    portENTER_CRITICAL(&h->mux);
+    if (max_hz > I2C_BUS_CLOCK_MAX_HZ) max_hz = I2C_BUS_CLOCK_MAX_HZ;
+    h->max_hz = (max_hz > h->base_hz) ? max_hz : h->base_hz;
+    if (h->freq_hz > h->max_hz) h->freq_hz = h->max_hz;
+    h->clean = 0;
+    h->clean_needed = I2C_CLOCK_CLEAN_FIRST;
+    h->win_xfers = h->win_errors = 0;
+    uint32_t freq = h->freq_hz;
+    portEXIT_CRITICAL(&h->mux);
+    return freq;
+}
+
+uint32_t i2c_bus_health_timeout_ms(uint8_t bus_num, uint8_t addr, uint32_t normal_ms) {
+    i2c_health_bus_t* h = &s_health[bus_num];
+    uint32_t ms = normal_ms;
+    portENTER_CRITICAL(&h->mux);
+    i2c_health_entry_t* e = find(h, addr);
+    if (e && e->d.backoff_level && ms > I2C_BUS_PROBE_TIMEOUT_MS) ms = I2C_BUS_PROBE_TIMEOUT_MS;
+    portEXIT_CRITICAL(&h->mux);
+    return ms;
+}
+
+uint32_t i2c_bus_health_record(uint8_t bus_num, uint8_t addr, esp_err_t err,
+                               uint32_t wall_us) {
+    i2c_health_bus_t* h = &s_health[bus_num];
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&h->mux);
+    i2c_health_entry_t* e = find_or_add(h, addr);
+    bool counted = false;
+    if (e) {
+        i2c_bus_dev_health_t* d = &e->d;
+        int b = 0;
+        while (b < I2C_BUS_LAT_BUCKETS - 1 && wall_us >= s_lat_bounds_us[b]) b++;
+        d->lat_hist[b]++;
+        if (wall_us > d->lat_us_max) d->lat_us_max = wall_us;
+        e->last_us = now;
+
+        if (err == ESP_OK) {
+            d->ok++;
+            d->consec_fail   = 0;
+            d->backoff_level = 0;
+            e->backoff_until_us = 0;
+            e->answered = true;
+        } else {
+            if (err == ESP_ERR_TIMEOUT) d->timeout++;
+            else if (is_nack(err))      d->nack++;
+            else                        d->other++;
+            /* Only a device that was answering tells anything about the clock;
+             * its failed probes keep counting, so a module that cannot follow a
+             * raised clock still brings it down from backoff. */
+            counted = e->answered;
+            if (d->consec_fail < UINT8_MAX) d->consec_fail++;
+            if (d->consec_fail >= I2C_BUS_BACKOFF_AFTER) {
+                if (d->backoff_level <= I2C_BUS_BACKOFF_MAX_SHIFT) d->backoff_level++;
+                uint32_t ms = (uint32_t)I2C_BUS_BACKOFF_BASE_MS << (d->backoff_level - 1);
+                e->backoff_until_us = now + (int64_t)ms * 1000;
+            }
+        }
+    }
+
+    if (h->win_xfers < UINT16_MAX) h->win_xfers++;
+    if (counted) h->win_errors++;
+    clock_update(h);
+    uint32_t freq = h->freq_hz;
+    portEXIT_CRITICAL(&h->mux);
+    return freq;
+}
+
+// ================================================================
+// Public API
+// ================================================================
+
+bool i2c_bus_health_admit(uint8_t bus_num, uint8_t addr) {
+    if (bus_num >= I2C_BUS_MAX) return true;
+    i2c_health_bus_t* h = &s_health[bus_num];
+    bool admit = true;
+    portENTER_CRITICAL(&h->mux);
+    i2c_health_entry_t* e = find(h, addr);
+    if (e && e->d.backoff_level && esp_timer_get_time() < e->backoff_until_us) {
+        e->d.skipped++;
+        admit = false;
+    }
+    portEXIT_CRITICAL(&h->mux);
+    return admit;
+}
+
+void i2c_bus_health_clear(uint8_t bus_num, uint8_t addr) {
+    if (bus_num >= I2C_BUS_MAX) return;
+    i2c_health_bus_t* h = &s_health[bus_num];
+    portENTER_CRITICAL(&h->mux);
+    i2c_health_entry_t* e = find(h, addr);
+    if (e) {
+        e->d.consec_fail   = 0;
+        e->d.backoff_level = 0;
+        e->backoff_until_us = 0;
+    }
+    portEXIT_CRITICAL(&h->mux);
+}
+
+esp_err_t i2c_bus_get_health(uint8_t bus_num, i2c_bus_health_t* health) {
+    if (bus_num >= I2C_BUS_MAX || !health) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_health_bus_t* h = &s_health[bus_num];
+    if (!h->active || !i2c_bus_is_initialized(bus_num)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&h->mux);
+    health->freq_hz      = h->freq_hz;
+    health->base_hz      = h->base_hz;
+    health->max_hz       = h->max_hz;
+    health->adaptive     = h->max_hz > h->base_hz;
+    health->steps_up     = h->steps_up;
+    health->steps_down   = h->steps_down;
+    health->win_xfers    = h->win_xfers;
+    health->win_errors   = h->win_errors;
+    health->clean_needed = h->clean_needed;
+    health->devices      = 0;
+    health->backed_off   = 0;
+    for (int i = 0; i < I2C_BUS_HEALTH_MAX_DEVICES; i++) {
+        if (!h->dev[i].valid) continue;
+        health->devices++;
+        if (h->dev[i].d.backoff_level && now < h->dev[i].backoff_until_us) health->backed_off++;
+    }
+    portEXIT_CRITICAL(&h->mux);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_get_device_health(uint8_t bus_num, uint8_t index,
+                                    i2c_bus_dev_health_t* dev) {
+    if (bus_num >= I2C_BUS_MAX || !dev) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_health_bus_t* h = &s_health[bus_num];
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&h->mux);
+    uint8_t n = 0;
+    for (int i = 0; i < I2C_BUS_HEALTH_MAX_DEVICES; i++) {
+        const i2c_health_entry_t* e = &h->dev[i];
+        if (!e->valid || n++ != index) continue;
+        *dev = e->d;
+        dev->backoff_left_ms = (e->d.backoff_level && now < e->backoff_until_us)
+                             ? (uint32_t)((e->backoff_until_us - now) / 1000) : 0;
+        err = ESP_OK;
+        break;
+    }
+    portEXIT_CRITICAL(&h->mux);
+    return err;
+}
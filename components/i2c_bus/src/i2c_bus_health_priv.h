@@ -0,0 +1,30 @@
+/**
+ * @file i2c_bus_health_priv.h
+ * @brief Hooks i2c_bus.c drives the health module with (component-internal)
+ */
+
+#ifndef I2C_BUS_HEALTH_PRIV_H
+#define I2C_BUS_HEALTH_PRIV_H
+
+#include "i2c_bus_health.h"
+
+/** Start a bus over at its configured clock (fixed, no devices tracked). */
+void i2c_bus_health_init(uint8_t bus_num, uint32_t base_hz);
+
+/**
+ * @brief Set the adaptive ceiling (base_hz or below = fixed clock)
+ * @return The clock the bus should run at now
+ */
+uint32_t i2c_bus_health_set_ceiling(uint8_t bus_num, uint32_t max_hz);
+
+/** Driver timeout for a transaction to @p addr (short for a backoff probe). */
+uint32_t i2c_bus_health_timeout_ms(uint8_t bus_num, uint8_t addr, uint32_t normal_ms);
+
+/**
+ * @brief Record one executed transaction (bus lock held)
+ * @return The clock the bus should run at now
+ */
+uint32_t i2c_bus_health_record(uint8_t bus_num, uint8_t addr, esp_err_t err,
+                               uint32_t wall_us);
+
+#endif // I2C_BUS_HEALTH_PRIV_H
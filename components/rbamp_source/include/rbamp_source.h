@@ -7,9 +7,10 @@
  * (priority 0). This is the v2.0 replacement for local ADC sensing — rbAmp
  * modules do the current/voltage/power DSP on-device (5 Hz commit).
  *
- * Design mirrors dimmerlink_manager: each module maps to a measurement role
- * (grid / solar / load / voltage); the poll task builds an
- * acrouter_measurements_t per module and posts ACROUTER_EVENT_POWER_UPDATE.
+ * Design mirrors dimmerlink_manager: each module channel maps to a measurement
+ * role (grid / solar / load / voltage); the poll task builds one
+ * acrouter_measurements_t per module (all its channels, one sampling instant)
+ * and publishes it to the measurement ring.
  * RouterController/sensor_hub need no changes — they are source-agnostic.
  *
  * Lifecycle:
@@ -38,24 +39,35 @@ extern "C" {
  *  never hits its "cache full, dropping update" path. */
 #define RBAMP_SOURCE_MAX_MODULES 4
 
+/** Current channels of one module (UI3 / I3 variants). */
+#define RBAMP_SOURCE_MAX_CHANNELS 3
+
+/** Role table capacity: per-channel mappings across the fleet. The hub has
+ *  four sensing roles, so a fleet never needs more than a few — but one UI3
+ *  alone takes three entries. */
+#define RBAMP_SOURCE_MAX_ROLES 8
+
 /**
  * @brief Measurement role of a module's primary channel → Sensor Hub slot.
  *
- * RBAMP_ROLE_NONE modules are still polled and logged (diagnostic) but do not
- * feed the Sensor Hub until a role is assigned.
+ * Assigned per module channel: one UI3 module can carry grid, solar and load
+ * at once (one read, one sampling instant). RBAMP_ROLE_VOLTAGE on any channel
+ * forwards the module's voltage. RBAMP_ROLE_NONE modules are still polled and
+ * logged (diagnostic) but do not feed the Sensor Hub until a role is assigned.
  */
 typedef enum {
     RBAMP_ROLE_NONE    = 0,  ///< Polled/logged only, not mapped to a slot
-    RBAMP_ROLE_GRID    = 1,  ///< current[0]/power[0] -> ACROUTER_CH_GRID
-    RBAMP_ROLE_SOLAR   = 2,  ///< current[0]/power[0] -> ACROUTER_CH_SOLAR
-    RBAMP_ROLE_LOAD    = 3,  ///< current[0]/power[0] -> ACROUTER_CH_LOAD
+    RBAMP_ROLE_GRID    = 1,  ///< current[ch]/power[ch] -> ACROUTER_CH_GRID
+    RBAMP_ROLE_SOLAR   = 2,  ///< current[ch]/power[ch] -> ACROUTER_CH_SOLAR
+    RBAMP_ROLE_LOAD    = 3,  ///< current[ch]/power[ch] -> ACROUTER_CH_LOAD
     RBAMP_ROLE_VOLTAGE = 4,  ///< voltage -> voltage slot (voltage-only module)
 } rbamp_source_role_t;
 
-/** Per-module configuration (address + role). */
+/** Per-channel configuration (address + channel + role). */
 typedef struct {
     uint8_t              i2c_addr;  ///< 7-bit rbAmp module address
-    rbamp_source_role_t  role;      ///< Sensor Hub role for the primary channel
+    rbamp_source_role_t  role;      ///< Sensor Hub role of the channel
+    uint8_t              channel;   ///< Module channel (0 = primary)
 } rbamp_source_module_cfg_t;
 
 /**
@@ -65,8 +77,8 @@ typedef struct {
  * records the mapping for modules discovered later. Call before or after
  * rbamp_source_init(); takes effect on the next poll cycle.
  *
- * @param mods  Array of address→role mappings.
- * @param n     Number of entries (must be <= RBAMP_SOURCE_MAX_MODULES).
+ * @param mods  Array of (address, channel)→role mappings.
+ * @param n     Number of entries (must be <= RBAMP_SOURCE_MAX_ROLES).
  * @return ESP_OK, or ESP_ERR_INVALID_ARG on null/oversized input.
  */
 esp_err_t rbamp_source_configure(const rbamp_source_module_cfg_t *mods, size_t n);
@@ -74,7 +86,8 @@ esp_err_t rbamp_source_configure(const rbamp_source_module_cfg_t *mods, size_t n
 /**
  * @brief Assign/replace the role for a single module address (commissioning).
  *
- * Upserts one address→role mapping: updates the role if @p addr is already
+ * Upserts one address→role mapping of the module's primary channel (channel
+ * 0): updates the role if @p addr is already
  * configured, otherwise appends it. Takes effect on the next poll cycle.
  * Persist across reboot with rbamp_source_save_config().
  *
@@ -85,7 +98,19 @@ esp_err_t rbamp_source_configure(const rbamp_source_module_cfg_t *mods, size_t n
 esp_err_t rbamp_source_set_role(uint8_t addr, rbamp_source_role_t role);
 
 /**
- * @brief Read the current address→role table (for status / REST).
+ * @brief Assign/replace the role of one channel of a module (commissioning).
+ *
+ * As rbamp_source_set_role() for channel @p channel: every commissioned channel
+ * of a multi-channel module feeds its own Sensor Hub slot from the same read.
+ * Two channels of one module with the same role: the lower channel wins.
+ *
+ * @return ESP_OK; ESP_ERR_INVALID_ARG (channel >= RBAMP_SOURCE_MAX_CHANNELS);
+ *         ESP_ERR_NO_MEM (RBAMP_SOURCE_MAX_ROLES entries taken).
+ */
+esp_err_t rbamp_source_set_channel_role(uint8_t addr, uint8_t channel, rbamp_source_role_t role);
+
+/**
+ * @brief Read the current (address, channel)→role table (for status / REST).
  *
  * @param mods  Output buffer.
  * @param max   Capacity of @p mods.
@@ -99,8 +124,11 @@ typedef struct {
     uint8_t             i2c_addr;     ///< 7-bit address
     uint8_t             channels;     ///< valid current channels (1..3)
     bool                has_voltage;  ///< voltage hardware detected at begin
-    rbamp_source_role_t role;         ///< assigned Sensor Hub role (NONE if unconfigured)
+    rbamp_source_role_t role;         ///< assigned Sensor Hub role of channel 0 (NONE if unconfigured)
+    rbamp_source_role_t ch_role[RBAMP_SOURCE_MAX_CHANNELS];  ///< role per channel
     bool                online;       ///< read OK on the last poll cycle
+    uint8_t             fw_version;   ///< VERSION register (config cache; 0 = not read)
+    uint8_t             hw_variant;   ///< HW_VARIANT register (config cache)
     // Last snapshot (primary channel [0]); NaN where unavailable.
     float               voltage;      ///< RMS voltage, V
     float               current;      ///< RMS current, A
@@ -159,21 +187,46 @@ esp_err_t rbamp_source_init(uint8_t bus_num);
 esp_err_t rbamp_source_start(uint32_t interval_ms);
 
 /**
- * @brief Enable DRDY-driven polling on a GPIO (call BEFORE rbamp_source_start).
+ * @brief Enable DRDY-driven polling on a fleet-wide GPIO (call BEFORE rbamp_source_start).
  *
  * rbAmp DRDY (open-drain, active-low) asserts when a fresh measurement set is
  * ready. When wired, the poll task waits on a DRDY interrupt instead of a fixed
  * delay — reading exactly when data is ready (lowest latency, no double reads);
- * the poll interval then acts only as a fallback ceiling. Best for a SINGLE
- * critical module: a multi-module fleet has unsynchronised DRDY lines (one GPIO
- * cannot represent the whole fleet), so the fixed-cadence timer poll (gpio < 0,
- * the default) is the correct choice there.
+ * the poll interval then acts only as a fallback ceiling. Any edge on this line
+ * reads the whole fleet, so it suits a SINGLE critical module (or DRDY lines
+ * wired-OR onto one GPIO). For a multi-module fleet wire each module's DRDY to
+ * its own GPIO with rbamp_source_set_module_drdy() instead.
  *
  * @param gpio  DRDY input GPIO, or < 0 to disable (fixed-cadence timer poll).
  * @return ESP_OK, or ESP_ERR_INVALID_STATE if the poll task is already running.
  */
 esp_err_t rbamp_source_set_drdy_gpio(int gpio);
 
+/** Skew window of a per-module DRDY round (ms). The first module DRDY edge
+ *  opens a round; the fleet is read once every commissioned line has asserted,
+ *  or this long after the first edge. Well under the 200 ms commit period, so a
+ *  round never spans two data sets of the same module. */
+#define RBAMP_SOURCE_DRDY_SKEW_MS 60
+
+/**
+ * @brief Map a module's own DRDY line to a GPIO (call BEFORE rbamp_source_start).
+ *
+ * The modules' 5 Hz commits are unsynchronised. With per-module lines the poll
+ * task tracks which modules have fresh data: it reads as soon as every
+ * commissioned module on the bus has asserted (or at RBAMP_SOURCE_DRDY_SKEW_MS)
+ * and publishes only the modules whose line asserted in that round, so the
+ * Sensor Hub epoch receives each data set once, back to back. A module without
+ * a line (or whose line has been silent for two poll intervals) is published
+ * on every read, and the poll interval stays the fallback ceiling.
+ *
+ * @param addr  7-bit module address (0x08..0x77).
+ * @param gpio  DRDY input GPIO, or < 0 to remove the module's line.
+ * @return ESP_OK; ESP_ERR_INVALID_ARG (address out of range, or GPIO already
+ *         mapped to another module); ESP_ERR_NO_MEM (all
+ *         RBAMP_SOURCE_MAX_MODULES lines taken); ESP_ERR_INVALID_STATE (polling).
+ */
+esp_err_t rbamp_source_set_module_drdy(uint8_t addr, int gpio);
+
 /** @brief Stop the polling task (blocks until it exits). */
 void rbamp_source_stop(void);
 
@@ -224,11 +277,27 @@ const rbamp_ct_model_t *rbamp_source_ct_catalog(size_t *count);
 esp_err_t rbamp_source_request_ct_model(uint8_t addr, uint8_t code);
 
 /**
- * @brief Applied CT-model code for @p addr from the poll-task cache (0 = unset).
+ * @brief Applied CT-model code for @p addr from the module configuration cache (0 = unset).
  * @return ESP_OK (found), ESP_ERR_NOT_FOUND (addr not cached), ESP_ERR_INVALID_ARG.
  */
 esp_err_t rbamp_source_get_ct_model(uint8_t addr, uint8_t *code);
 
+/**
+ * @brief Re-read every module's configuration registers (CT model, firmware
+ *        version, HW variant) into the cache.
+ *
+ * The cache is filled at discovery and after a CT-model change, and the
+ * slow-register scheduler re-reads one module at a time (a full pass every
+ * CONFIG_ACROUTER_RBAMP_SLOW_REFRESH_S). Call this after changing a module
+ * out of band. Runs in the poll task between cycles when polling.
+ *
+ * @return ESP_OK (queued or done), ESP_ERR_INVALID_STATE if not initialized.
+ */
+esp_err_t rbamp_source_refresh_config(void);
+
+/** @brief Module configuration reads since boot (diagnostic: slow-path I2C load). */
+uint32_t rbamp_source_config_reads(void);
+
 /** @brief Number of modules that responded during init. */
 size_t rbamp_source_alive_count(void);
 
@@ -240,6 +309,31 @@ size_t rbamp_source_alive_count(void);
  */
 void rbamp_source_get_timing(uint32_t *last_us, uint32_t *avg_us, uint32_t *count);
 
+/** One per-module DRDY line (rbamp_source_get_drdy_stats). */
+typedef struct {
+    uint8_t  i2c_addr;      ///< Module the line belongs to
+    int8_t   gpio;          ///< DRDY input GPIO
+    bool     armed;         ///< Interrupt installed (false if setup failed / not polling)
+    uint32_t edges;         ///< DRDY assertions seen
+    uint32_t lat_avg_us;    ///< DRDY edge -> fleet read, EMA/8 (us)
+    uint32_t lat_max_us;    ///< Worst DRDY edge -> fleet read (us)
+} rbamp_source_drdy_line_t;
+
+/** Per-module DRDY round counters and line latencies. */
+typedef struct {
+    uint32_t rounds_complete;   ///< Read once every commissioned line had asserted
+    uint32_t rounds_skew;       ///< Read at the skew window with lines missing
+    uint32_t rounds_timer;      ///< No DRDY edge within the poll interval (fallback)
+    size_t   n_lines;
+    rbamp_source_drdy_line_t lines[RBAMP_SOURCE_MAX_MODULES];
+} rbamp_source_drdy_stats_t;
+
+/**
+ * @brief Per-module DRDY statistics (for the `timing` debug readout).
+ * @param out  Receives the counters; n_lines = 0 when no module line is mapped.
+ */
+void rbamp_source_get_drdy_stats(rbamp_source_drdy_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
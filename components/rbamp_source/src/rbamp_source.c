@@ -10,6 +10,7 @@
 #include "sdkconfig.h"
 #include "i2c_bus.h"
 #include "acrouter_events.h"
+#include "acrouter_meas_ring.h"
 #include "acrouter_measurements.h"
 
 #include "rbamp.h"
@@ -41,28 +42,74 @@ static rbamp_fleet_t s_fleet       = NULL;
 static bool          s_initialized = false;
 static size_t        s_alive       = 0;
 
-static rbamp_source_module_cfg_t s_role_cfg[RBAMP_SOURCE_MAX_MODULES];
+static rbamp_source_module_cfg_t s_role_cfg[RBAMP_SOURCE_MAX_ROLES];
 static size_t                    s_role_cfg_count = 0;
 /* Guards s_role_cfg[]/s_role_cfg_count: the web task mutates+compacts it while the
- * poll task reads it via role_for_addr() every cycle (D8). Pure memory ops — a
+ * poll task reads it via roles_for() every cycle (D8). Pure memory ops — a
  * short spinlock is enough (no blocking calls inside the critical sections). */
 static portMUX_TYPE              s_cfg_mux = portMUX_INITIALIZER_UNLOCKED;
 
 static TaskHandle_t  s_poll_task     = NULL;
 
-/* Optional DRDY-driven polling. rbAmp DRDY (open-drain, active-low) asserts when
- * a fresh measurement set is ready. When a DRDY GPIO is wired, the poll task
- * waits on an ISR notification instead of a fixed delay, so it reads exactly
- * when data is ready (lowest latency, no double/mid-update reads). The poll
- * interval then acts as a fallback ceiling if DRDY is silent. -1 = disabled
- * (fixed-cadence timer poll, the default / correct choice for a multi-module
- * fleet whose DRDY lines are NOT synchronised). */
-static int s_drdy_gpio = -1;
-static bool s_drdy_isr_installed = false;
+/* DRDY-driven polling. rbAmp DRDY (open-drain, active-low) asserts when a fresh
+ * measurement set is ready. Two wirings, both with the poll interval as the
+ * fallback ceiling if DRDY is silent:
+ *   - fleet line (set_drdy_gpio): any edge reads the fleet at once — a single
+ *     critical module, or lines wired-OR onto one GPIO;
+ *   - per-module lines (set_module_drdy): the modules' commits are NOT
+ *     synchronised, so the ISR records which modules have fresh data and when.
+ *     The first edge opens a round; the fleet is read once every commissioned
+ *     line has asserted or RBAMP_SOURCE_DRDY_SKEW_MS later, and only modules
+ *     whose line asserted are published — no double reads, no stale sets.
+ * Slots 0..s_drdy_mod_count-1 are module lines, DRDY_FLEET the fleet line; a
+ * line's pending bit is its slot index. */
+#define DRDY_FLEET RBAMP_SOURCE_MAX_MODULES
+
+typedef struct {
+    uint8_t  addr;          /* module (unused for the fleet line) */
+    int      gpio;          /* -1 = not wired */
+    bool     armed;         /* ISR handler installed */
+    int64_t  assert_us;     /* first edge of the pending data set (ISR) */
+    int64_t  last_us;       /* latest edge (ISR) */
+    uint32_t edges;
+    uint32_t lat_avg_us;    /* edge -> read, EMA/8 */
+    uint32_t lat_max_us;
+} drdy_line_t;
+
+static drdy_line_t s_drdy[RBAMP_SOURCE_MAX_MODULES + 1] = {
+    [DRDY_FLEET] = { .gpio = -1 },
+};
+static size_t            s_drdy_mod_count = 0;
+static volatile uint32_t s_drdy_pending   = 0;   /* bit per slot, set by the ISR */
+static portMUX_TYPE      s_drdy_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool              s_drdy_isr_service = false;
+
+static volatile uint32_t s_drdy_rounds_complete = 0;
+static volatile uint32_t s_drdy_rounds_skew     = 0;
+static volatile uint32_t s_drdy_rounds_timer    = 0;
+
+/* Why the poll task woke up. */
+typedef enum {
+    DRDY_WAKE_TIMER,        /* interval elapsed (no DRDY, or DRDY silent) */
+    DRDY_WAKE_FLEET,        /* fleet line asserted */
+    DRDY_WAKE_COMPLETE,     /* every commissioned module line asserted */
+    DRDY_WAKE_SKEW,         /* skew window closed with lines missing */
+} drdy_wake_t;
 
 static void IRAM_ATTR rbamp_drdy_isr(void *arg)
 {
-    (void)arg;
+    const uint32_t slot = (uint32_t)(uintptr_t)arg;
+    const uint32_t bit  = 1u << slot;
+    const int64_t  now  = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&s_drdy_mux);
+    if (!(s_drdy_pending & bit)) {
+        s_drdy[slot].assert_us = now;   /* keep the first edge of an unread set */
+    }
+    s_drdy_pending |= bit;
+    s_drdy[slot].last_us = now;
+    s_drdy[slot].edges++;
+    portEXIT_CRITICAL_ISR(&s_drdy_mux);
+
     TaskHandle_t t = s_poll_task;
     if (t) {
         BaseType_t hpw = pdFALSE;
@@ -117,10 +164,32 @@ static uint8_t            s_ct_code   = 0;
 static volatile bool      s_ct_done   = false;
 static volatile esp_err_t s_ct_result = ESP_OK;
 
-/* Applied CT-model code cache (addr-keyed), refreshed by the poll task; the REST
- * GET reads this instead of touching the handle. 0 = unset/unknown. */
-static uint8_t s_ct_cache_addr[RBAMP_SOURCE_MAX_MODULES];
-static uint8_t s_ct_cache_code[RBAMP_SOURCE_MAX_MODULES];
+/* Module configuration cache (addr-keyed): registers that only change when the
+ * module is commissioned. Read at discovery, after a CT-model change and on an
+ * explicit refresh — never from the 5 Hz poll path. The slow-register scheduler
+ * re-reads one module at a time so a full pass takes
+ * CONFIG_ACROUTER_RBAMP_SLOW_REFRESH_S, catching out-of-band changes (another
+ * master, a module swapped at the same address). Getters read this instead of
+ * touching the handle; guarded by s_cfg_mux like the role table. */
+#define RBAMP_REG_VERSION     0x03
+#define RBAMP_REG_HW_VARIANT  0x55
+
+typedef struct {
+    uint8_t addr;           /* 0 = free slot */
+    uint8_t ct_code;        /* applied CT model, ch0 (0 = unset/unknown) */
+    uint8_t fw_version;     /* VERSION register (0 = not read) */
+    uint8_t hw_variant;     /* HW_VARIANT register */
+} cfg_cache_t;
+
+static cfg_cache_t        s_cfg_cache[RBAMP_SOURCE_MAX_MODULES];
+static volatile bool      s_cfg_refresh_req = false;
+static volatile uint32_t  s_cfg_reads       = 0;   /* module config reads since boot */
+static size_t             s_slow_next       = 0;   /* round-robin fleet index */
+static int64_t            s_slow_due_us     = 0;
+
+/* Bus the fleet polls on. The library drives its own device handles, so its
+ * bus time is reported to i2c_bus for the utilisation window. */
+static uint8_t s_bus_num = 0;
 
 /* Timing instrumentation: I2C poll-cycle duration (rbamp_fleet_poll_all). */
 static volatile uint32_t s_poll_last_us = 0;   /* last cycle I2C time (us) */
@@ -129,18 +198,201 @@ static volatile uint32_t s_poll_count   = 0;   /* completed poll cycles */
 
 /* ---- helpers ---- */
 
-static rbamp_source_role_t role_for_addr(uint8_t addr)
+/* All channel roles of a module in one pass; returns true if any is set. */
+static bool roles_for(uint8_t addr, rbamp_source_role_t roles[RBAMP_SOURCE_MAX_CHANNELS])
 {
-    rbamp_source_role_t r = RBAMP_ROLE_NONE;
+    bool any = false;
+    for (size_t c = 0; c < RBAMP_SOURCE_MAX_CHANNELS; c++) {
+        roles[c] = RBAMP_ROLE_NONE;
+    }
     portENTER_CRITICAL(&s_cfg_mux);
     for (size_t i = 0; i < s_role_cfg_count; i++) {
-        if (s_role_cfg[i].i2c_addr == addr) {
-            r = s_role_cfg[i].role;
-            break;
+        if (s_role_cfg[i].i2c_addr == addr && s_role_cfg[i].channel < RBAMP_SOURCE_MAX_CHANNELS &&
+            s_role_cfg[i].role != RBAMP_ROLE_NONE) {
+            roles[s_role_cfg[i].channel] = s_role_cfg[i].role;
+            any = true;
         }
     }
     portEXIT_CRITICAL(&s_cfg_mux);
-    return r;
+    return any;
+}
+
+/* ---- DRDY rounds (poll task) ---- */
+
+static int64_t drdy_last_edge(size_t slot)
+{
+    portENTER_CRITICAL(&s_drdy_mux);
+    const int64_t t = s_drdy[slot].last_us;
+    portEXIT_CRITICAL(&s_drdy_mux);
+    return t;
+}
+
+/* Module lines the open round waits for: commissioned modules on the bus whose
+ * line asserted within the last two poll intervals. A silent (broken, unpowered)
+ * line drops out instead of stretching every round to the skew window, and
+ * rejoins on its next edge. */
+static uint32_t drdy_wanted_mask(int64_t now)
+{
+    const int64_t silent_us = (int64_t)s_poll_interval * 2000;
+    uint32_t want = 0;
+    for (size_t i = 0; i < s_drdy_mod_count; i++) {
+        const drdy_line_t *l = &s_drdy[i];
+        if (!l->armed || now - drdy_last_edge(i) > silent_us) {
+            continue;
+        }
+        rbamp_source_role_t roles[RBAMP_SOURCE_MAX_CHANNELS];
+        if (!roles_for(l->addr, roles) || rbamp_fleet_find(s_fleet, l->addr) == NULL) {
+            continue;
+        }
+        want |= 1u << i;
+    }
+    return want;
+}
+
+/* Wait for the next poll trigger. Wakes every <=100 ms to re-check the stop flag
+ * (so rbamp_source_stop() returns promptly even with a multi-second interval)
+ * and to feed the task WDT well under its timeout. */
+static drdy_wake_t wait_poll_trigger(bool wdt)
+{
+    uint32_t mod_mask = 0;
+    for (size_t i = 0; i < s_drdy_mod_count; i++) {
+        if (s_drdy[i].armed) {
+            mod_mask |= 1u << i;
+        }
+    }
+    const bool    drdy     = mod_mask || s_drdy[DRDY_FLEET].armed;
+    const int64_t until    = esp_timer_get_time() + (int64_t)s_poll_interval * 1000;
+    int64_t       round_end = 0;   /* skew deadline of the open round, 0 = none */
+
+    while (s_poll_running) {
+        const uint32_t pend = s_drdy_pending;
+        int64_t now = esp_timer_get_time();
+        if (pend & (1u << DRDY_FLEET)) {
+            return DRDY_WAKE_FLEET;
+        }
+        if (pend & mod_mask) {
+            const uint32_t want = drdy_wanted_mask(now);
+            if ((pend & want) == want) {
+                return DRDY_WAKE_COMPLETE;
+            }
+            if (round_end == 0 && (pend & want)) {
+                int64_t first = now;
+                portENTER_CRITICAL(&s_drdy_mux);
+                for (size_t i = 0; i < s_drdy_mod_count; i++) {
+                    if ((pend & want & (1u << i)) && s_drdy[i].assert_us < first) {
+                        first = s_drdy[i].assert_us;
+                    }
+                }
+                portEXIT_CRITICAL(&s_drdy_mux);
+                round_end = first + (int64_t)RBAMP_SOURCE_DRDY_SKEW_MS * 1000;
+            }
+            if (round_end != 0 && now >= round_end) {
+                return DRDY_WAKE_SKEW;
+            }
+        }
+        if (now >= until) {
+            break;
+        }
+        const int64_t stop = (round_end != 0 && round_end < until) ? round_end : until;
+        uint32_t chunk = (uint32_t)((stop - now + 999) / 1000);
+        if (chunk > 100) {
+            chunk = 100;
+        }
+        TickType_t ticks = pdMS_TO_TICKS(chunk);
+        if (ticks == 0) {
+            ticks = 1;
+        }
+        if (drdy) {
+            ulTaskNotifyTake(pdTRUE, ticks);
+        } else {
+            vTaskDelay(ticks);
+        }
+        if (wdt) {
+            esp_task_wdt_reset();
+        }
+    }
+    return DRDY_WAKE_TIMER;
+}
+
+/* Consume the pending DRDY edges at the start of a fleet read: every set that
+ * asserted so far is in this read. Records edge->read latency per line and the
+ * round outcome. Returns the consumed module-line bits. */
+static uint32_t drdy_take(drdy_wake_t wake, int64_t t_read)
+{
+    portENTER_CRITICAL(&s_drdy_mux);
+    const uint32_t taken = s_drdy_pending;
+    int64_t asserted[RBAMP_SOURCE_MAX_MODULES + 1];
+    for (size_t i = 0; i <= DRDY_FLEET; i++) {
+        asserted[i] = s_drdy[i].assert_us;
+    }
+    s_drdy_pending = 0;
+    portEXIT_CRITICAL(&s_drdy_mux);
+
+    for (size_t i = 0; i <= DRDY_FLEET; i++) {
+        if (!(taken & (1u << i))) {
+            continue;
+        }
+        drdy_line_t *l = &s_drdy[i];
+        const uint32_t lat = (uint32_t)(t_read - asserted[i]);
+        l->lat_avg_us = l->lat_avg_us ? (l->lat_avg_us * 7 + lat) / 8 : lat;  // EMA/8
+        if (lat > l->lat_max_us) {
+            l->lat_max_us = lat;
+        }
+    }
+    if (s_drdy_mod_count > 0) {
+        switch (wake) {
+            case DRDY_WAKE_COMPLETE: s_drdy_rounds_complete++; break;
+            case DRDY_WAKE_SKEW:     s_drdy_rounds_skew++;     break;
+            case DRDY_WAKE_TIMER:    s_drdy_rounds_timer++;    break;
+            default: break;
+        }
+    }
+    return taken & ~(1u << DRDY_FLEET);
+}
+
+/* Whether a module read in a DRDY round carries a set not yet published: its
+ * line asserted in the round, or it has no usable line of its own. Timer and
+ * fleet-line reads publish every module, as without per-module lines. */
+static bool drdy_is_fresh(uint8_t addr, drdy_wake_t wake, uint32_t taken, int64_t now)
+{
+    if (wake != DRDY_WAKE_COMPLETE && wake != DRDY_WAKE_SKEW) {
+        return true;
+    }
+    for (size_t i = 0; i < s_drdy_mod_count; i++) {
+        if (s_drdy[i].addr != addr) {
+            continue;
+        }
+        if (!s_drdy[i].armed || (taken & (1u << i))) {
+            return true;
+        }
+        return now - drdy_last_edge(i) > (int64_t)s_poll_interval * 2000;
+    }
+    return true;
+}
+
+static esp_err_t drdy_arm(size_t slot)
+{
+    drdy_line_t *l = &s_drdy[slot];
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << l->gpio,
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = GPIO_PULLUP_ENABLE,   /* DRDY is open-drain, idles high */
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type    = GPIO_INTR_NEGEDGE,    /* active-low: asserts on new data */
+    };
+    esp_err_t e = gpio_config(&io);
+    if (e == ESP_OK && !s_drdy_isr_service) {
+        e = gpio_install_isr_service(0);
+        if (e == ESP_ERR_INVALID_STATE) {     /* may be pre-installed */
+            e = ESP_OK;
+        }
+        s_drdy_isr_service = (e == ESP_OK);
+    }
+    if (e == ESP_OK) {
+        e = gpio_isr_handler_add((gpio_num_t)l->gpio, rbamp_drdy_isr, (void *)(uintptr_t)slot);
+    }
+    l->armed = (e == ESP_OK);
+    return e;
 }
 
 static int slot_channel_for_role(rbamp_source_role_t role)
@@ -156,20 +408,16 @@ static int slot_channel_for_role(rbamp_source_role_t role)
 /**
  * Build an acrouter_measurements_t from one module's snapshot and post it.
  *
- * Maps the module's primary channel (current[0]/power[0]) to its role's slot.
- * rbAmp provides signed real power directly, so direction is sign(power).
- * Voltage is forwarded whenever the module has voltage hardware.
+ * Every commissioned channel fills its role's slot from current[ch]/power[ch],
+ * so a multi-channel module (UI2/UI3/I3) delivers grid, solar and load from a
+ * single read, sampled at the same instant. rbAmp provides signed real power
+ * directly, so direction is sign(power). Voltage is forwarded whenever the
+ * module has voltage hardware and feeds the grid or a voltage role.
  */
 static void publish_snapshot(const rbamp_snapshot_t *s,
-                             rbamp_source_role_t role, uint8_t addr)
+                             const rbamp_source_role_t roles[RBAMP_SOURCE_MAX_CHANNELS],
+                             uint8_t addr)
 {
-    /* Uncommissioned modules (role NONE) are diagnostic-only per the header
-     * contract — they must NOT feed the Sensor Hub, or their voltage/current
-     * would override the ADC at priority 0. */
-    if (role == RBAMP_ROLE_NONE) {
-        return;
-    }
-
     acrouter_measurements_t meas;
     acrouter_measurements_init(&meas);
     meas.source       = ACROUTER_SOURCE_I2C;
@@ -179,14 +427,26 @@ static void publish_snapshot(const rbamp_snapshot_t *s,
     meas.timestamp_us = esp_timer_get_time();
 
     bool any = false;
+    bool wants_voltage = false;
+
+    const size_t nch = (s->channels < RBAMP_SOURCE_MAX_CHANNELS) ? s->channels
+                                                                 : RBAMP_SOURCE_MAX_CHANNELS;
+    for (size_t c = 0; c < nch; c++) {
+        /* Uncommissioned channels (role NONE) are diagnostic-only per the
+         * header contract — they must NOT feed the Sensor Hub, or their
+         * voltage/current would override the ADC at priority 0. */
+        if (roles[c] == RBAMP_ROLE_GRID || roles[c] == RBAMP_ROLE_VOLTAGE) {
+            wants_voltage = true;
+        }
+        const int ch = slot_channel_for_role(roles[c]);
+        if (ch < 0 || meas.has_current[ch] || meas.has_power[ch]) {
+            continue;   /* no current slot, or a lower channel already holds it */
+        }
+        const float i = s->current[c];
+        const float p = s->power[c];
 
-    const int ch = slot_channel_for_role(role);
-    if (ch >= 0 && s->channels >= 1) {
-        const float i0 = s->current[0];
-        const float p0 = s->power[0];
-
-        if (!isnan(i0)) {
-            meas.current_rms[ch]  = i0;
+        if (!isnan(i)) {
+            meas.current_rms[ch]  = i;
             meas.has_current[ch]  = true;
             any = true;
         }
@@ -194,26 +454,25 @@ static void publish_snapshot(const rbamp_snapshot_t *s,
          * current-only (I*) module has no real power even if the library
          * returns 0.0 rather than NaN. Gate has_power on the hardware flag so
          * a bogus 0 W never wins the slot over a real ADC power reading. */
-        if (s->has_voltage_hw && !isnan(p0)) {
-            meas.power_active[ch] = p0;          /* signed: + import, - export */
+        if (s->has_voltage_hw && !isnan(p)) {
+            meas.power_active[ch] = p;           /* signed: + import, - export */
             meas.has_power[ch]    = true;
-            meas.direction[ch]    = (p0 >  0.05f) ? ACROUTER_DIR_CONSUMING
-                                  : (p0 < -0.05f) ? ACROUTER_DIR_SUPPLYING
-                                                  : ACROUTER_DIR_ZERO;
+            meas.direction[ch]    = (p >  0.05f) ? ACROUTER_DIR_CONSUMING
+                                  : (p < -0.05f) ? ACROUTER_DIR_SUPPLYING
+                                                 : ACROUTER_DIR_ZERO;
             any = true;
-        } else if (!isnan(i0)) {
+        } else if (!isnan(i)) {
             /* Current without signed power: direction is genuinely unknown —
              * do not fabricate it from the role. */
             meas.direction[ch] = ACROUTER_DIR_UNKNOWN;
         }
     }
 
-    /* Voltage: forward only from the grid feed or a dedicated voltage module.
+    /* Voltage: forward only from the grid feed or a dedicated voltage role.
      * Every UI* module carries voltage; forwarding all of them would make the
      * equal-priority voltage slot flip-flop (tie broken by recency) between
      * slightly different readings. */
-    if ((role == RBAMP_ROLE_GRID || role == RBAMP_ROLE_VOLTAGE) &&
-        s->has_voltage_hw && !isnan(s->voltage) && s->voltage > 1.0f) {
+    if (wants_voltage && s->has_voltage_hw && !isnan(s->voltage) && s->voltage > 1.0f) {
         meas.voltage_rms = s->voltage;
         meas.has_voltage = true;
         any = true;
@@ -221,23 +480,119 @@ static void publish_snapshot(const rbamp_snapshot_t *s,
 
     meas.valid = any;
     if (any) {
-        esp_event_post(ACROUTER_EVENT, ACROUTER_EVENT_POWER_UPDATE,
-                       &meas, sizeof(meas), 0);
+        acrouter_meas_publish(&meas);
     }
 }
 
 static void log_snapshot(const rbamp_snapshot_t *s, uint8_t addr,
-                         rbamp_source_role_t role)
+                         const rbamp_source_role_t roles[RBAMP_SOURCE_MAX_CHANNELS])
 {
     ESP_LOGI(TAG,
-             "0x%02X role=%d ch=%u V=%.1f I0=%.3f P0=%.1f PF0=%.2f f=%.2f%s",
-             addr, (int)role, s->channels,
+             "0x%02X roles=%d/%d/%d ch=%u V=%.1f I0=%.3f P0=%.1f PF0=%.2f f=%.2f%s",
+             addr, (int)roles[0], (int)roles[1], (int)roles[2], s->channels,
              (double)s->voltage, (double)s->current[0],
              (double)s->power[0], (double)s->power_factor[0],
              (double)s->frequency,
              s->implausible ? " [implausible]" : "");
 }
 
+/* ---- module configuration cache (poll-task context, or before the task runs) ---- */
+
+static cfg_cache_t *cfg_cache_slot(uint8_t addr, bool alloc)
+{
+    cfg_cache_t *free_slot = NULL;
+    for (size_t i = 0; i < RBAMP_SOURCE_MAX_MODULES; i++) {
+        if (s_cfg_cache[i].addr == addr) {
+            return &s_cfg_cache[i];
+        }
+        if (s_cfg_cache[i].addr == 0 && free_slot == NULL) {
+            free_slot = &s_cfg_cache[i];
+        }
+    }
+    return alloc ? free_slot : NULL;
+}
+
+/* Read one module's slow registers into the cache. A failed read keeps the
+ * previous value (the module may just be busy). */
+static void cfg_cache_read(rbamp_handle_t dev)
+{
+    const uint8_t addr = rbamp_address(dev);
+    uint8_t ct = 0, ver = 0, variant = 0;
+    const bool ct_ok  = (rbamp_read_ct_model_ch(dev, 0, &ct) == ESP_OK);
+    const bool ver_ok = (i2c_bus_read_reg_stop(s_bus_num, addr, RBAMP_REG_VERSION, &ver, 1) == ESP_OK);
+    const bool var_ok = (i2c_bus_read_reg_stop(s_bus_num, addr, RBAMP_REG_HW_VARIANT, &variant, 1) == ESP_OK);
+    s_cfg_reads++;
+
+    portENTER_CRITICAL(&s_cfg_mux);
+    cfg_cache_t *c = cfg_cache_slot(addr, true);
+    if (c != NULL) {
+        if (c->addr != addr) {
+            memset(c, 0, sizeof(*c));
+            c->addr = addr;
+        }
+        if (ct_ok)  c->ct_code    = ct;
+        if (ver_ok) c->fw_version = ver;
+        if (var_ok) c->hw_variant = variant;
+    }
+    portEXIT_CRITICAL(&s_cfg_mux);
+}
+
+/* Match the cache to the fleet: drop modules that left, read the ones that
+ * joined (or every module when @p all). Called after discovery, a rescan, an
+ * address change and on an explicit refresh. */
+static void cfg_cache_sync(bool all)
+{
+    if (s_fleet == NULL) {
+        return;
+    }
+    /* Only this context writes addr, so it can be read unlocked here. */
+    for (size_t i = 0; i < RBAMP_SOURCE_MAX_MODULES; i++) {
+        const uint8_t addr = s_cfg_cache[i].addr;
+        if (addr && rbamp_fleet_find(s_fleet, addr) == NULL) {
+            portENTER_CRITICAL(&s_cfg_mux);
+            s_cfg_cache[i].addr = 0;
+            portEXIT_CRITICAL(&s_cfg_mux);
+        }
+    }
+
+    const size_t fc = rbamp_fleet_count(s_fleet);
+    for (size_t i = 0; i < fc; i++) {
+        rbamp_handle_t d = rbamp_fleet_get(s_fleet, i);
+        if (d == NULL) {
+            continue;
+        }
+        portENTER_CRITICAL(&s_cfg_mux);
+        const bool cached = (cfg_cache_slot(rbamp_address(d), false) != NULL);
+        portEXIT_CRITICAL(&s_cfg_mux);
+        if (all || !cached) {
+            cfg_cache_read(d);
+        }
+    }
+}
+
+/* Slow-register scheduler: one module per step, spaced so the whole fleet is
+ * re-read once per CONFIG_ACROUTER_RBAMP_SLOW_REFRESH_S (0 = off). Runs after
+ * a cycle's results are published, so it never delays a reading. */
+static void slow_refresh_step(int64_t now)
+{
+#if CONFIG_ACROUTER_RBAMP_SLOW_REFRESH_S > 0
+    const size_t fc = rbamp_fleet_count(s_fleet);
+    if (fc == 0 || now < s_slow_due_us) {
+        return;
+    }
+    s_slow_due_us = now + (int64_t)CONFIG_ACROUTER_RBAMP_SLOW_REFRESH_S * 1000000 / (int64_t)fc;
+    if (s_slow_next >= fc) {
+        s_slow_next = 0;
+    }
+    rbamp_handle_t d = rbamp_fleet_get(s_fleet, s_slow_next++);
+    if (d != NULL) {
+        cfg_cache_read(d);
+    }
+#else
+    (void)now;
+#endif
+}
+
 /* ---- poll task ---- */
 
 /* Re-scan the bus and adopt any newly-found modules. Must run in the poll-task
@@ -251,6 +606,7 @@ static esp_err_t do_fleet_rescan(void)
     size_t added = 0;
     esp_err_t err = rbamp_fleet_scan(s_fleet, /*match_product=*/true, &added);
     s_alive = rbamp_fleet_count(s_fleet);
+    cfg_cache_sync(false);
     ESP_LOGI(TAG, "Rescan: +%u module(s) (now %u)", (unsigned)added, (unsigned)s_alive);
     return err;
 }
@@ -275,7 +631,14 @@ static void do_address_change(void)
             }
         }
         portEXIT_CRITICAL(&s_cfg_mux);
+        /* The module keeps its DRDY wire across the change. */
+        for (size_t i = 0; i < s_drdy_mod_count; i++) {
+            if (s_drdy[i].addr == cur) {
+                s_drdy[i].addr = neu;
+            }
+        }
         rbamp_source_save_config();
+        cfg_cache_sync(false);
         ESP_LOGI(TAG, "address change 0x%02X -> 0x%02X ok", cur, neu);
     } else {
         ESP_LOGW(TAG, "address change 0x%02X -> 0x%02X failed: %s",
@@ -306,13 +669,9 @@ static void do_ct_model(void)
             if (err == ESP_OK) {
                 err = rbamp_set_ct_model_ch(dev, 0, code);
             }
-            if (err == ESP_OK) {
-                /* Refresh the cache so the GET reflects it immediately. */
-                for (size_t i = 0; i < RBAMP_SOURCE_MAX_MODULES; i++) {
-                    if (s_ct_cache_addr[i] == addr) { s_ct_cache_code[i] = code; break; }
-                }
-            }
         }
+        /* Read back what the module applied, so the GET reflects it immediately. */
+        cfg_cache_read(dev);
     }
     if (err == ESP_OK) {
         ESP_LOGI(TAG, "CT-model 0x%02X ch0 -> code %u ok", addr, code);
@@ -337,6 +696,7 @@ static void rbamp_poll_task(void *arg)
 #endif
 
     uint32_t cycle = 0;
+    drdy_wake_t wake = DRDY_WAKE_TIMER;
     while (s_poll_running) {
         if (s_rescan_requested) {
             s_rescan_requested = false;
@@ -361,15 +721,20 @@ static void rbamp_poll_task(void *arg)
             count = RBAMP_SOURCE_MAX_MODULES;
         }
 
+        /* Consumed even with an empty fleet, or a pending edge would re-trigger
+         * the wait at once. */
+        int64_t t0 = esp_timer_get_time();
+        const uint32_t fresh = drdy_take(wake, t0);
+
         if (count > 0) {
             size_t n_ok = 0;
-            int64_t t0 = esp_timer_get_time();
             esp_err_t err = rbamp_fleet_poll_all(s_fleet, s_snaps, s_status,
                                                  RBAMP_SOURCE_MAX_MODULES, &n_ok);
             uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
             s_poll_last_us = dt;
             s_poll_avg_us  = s_poll_avg_us ? (s_poll_avg_us * 7 + dt) / 8 : dt;  // EMA/8
             s_poll_count++;
+            i2c_bus_account_busy(s_bus_num, dt);
             if (wdt) {
                 esp_task_wdt_reset();
             }
@@ -379,14 +744,6 @@ static void rbamp_poll_task(void *arg)
                     s_last_ok[i] = s_status[i].ok;
                     if (s_status[i].ok) {
                         s_last_snap[i] = s_snaps[i];
-                        /* Cache the applied CT-model code so the REST GET reads
-                         * it here instead of racing the handle. */
-                        rbamp_handle_t d = rbamp_fleet_find(s_fleet, s_status[i].addr);
-                        uint8_t cm = 0;
-                        if (d && rbamp_read_ct_model_ch(d, 0, &cm) == ESP_OK) {
-                            s_ct_cache_addr[i] = s_status[i].addr;
-                            s_ct_cache_code[i] = cm;
-                        }
                     }
                 }
                 const bool do_log = (cycle % RBAMP_SRC_LOG_EVERY) == 0;
@@ -395,10 +752,13 @@ static void rbamp_poll_task(void *arg)
                         continue;
                     }
                     const uint8_t addr = s_status[i].addr;
-                    const rbamp_source_role_t role = role_for_addr(addr);
-                    publish_snapshot(&s_snaps[i], role, addr);
+                    rbamp_source_role_t roles[RBAMP_SOURCE_MAX_CHANNELS];
+                    const bool commissioned = roles_for(addr, roles);
+                    if (commissioned && drdy_is_fresh(addr, wake, fresh, t0)) {
+                        publish_snapshot(&s_snaps[i], roles, addr);
+                    }
                     if (do_log) {
-                        log_snapshot(&s_snaps[i], addr, role);
+                        log_snapshot(&s_snaps[i], addr, roles);
                     }
                 }
             } else {
@@ -408,32 +768,17 @@ static void rbamp_poll_task(void *arg)
             esp_task_wdt_reset();
         }
 
+        if (s_cfg_refresh_req) {
+            s_cfg_refresh_req = false;
+            cfg_cache_sync(true);
+        } else {
+            slow_refresh_step(esp_timer_get_time());
+        }
+
         cycle++;
 
-        /* Wait for the next poll trigger. Wake every <=100 ms to re-check the
-         * stop flag (so rbamp_source_stop() returns promptly even with a
-         * multi-second interval) and to feed the task WDT well under its timeout.
-         * When a DRDY GPIO is wired, a DRDY edge cuts the wait short and we poll
-         * immediately; the interval is then just a fallback ceiling. */
-        uint32_t slept = 0;
-        while (s_poll_running && slept < s_poll_interval) {
-            uint32_t remain = s_poll_interval - slept;
-            uint32_t chunk  = (remain > 100) ? 100 : remain;
-            if (s_drdy_gpio >= 0) {
-                if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(chunk)) > 0) {
-                    if (wdt) {
-                        esp_task_wdt_reset();
-                    }
-                    break;  /* DRDY asserted → fresh data ready, poll now */
-                }
-            } else {
-                vTaskDelay(pdMS_TO_TICKS(chunk));
-            }
-            if (wdt) {
-                esp_task_wdt_reset();
-            }
-            slept += chunk;
-        }
+        /* Next read: a DRDY round (see s_drdy) or the interval ceiling. */
+        wake = wait_poll_trigger(wdt);
     }
 
 #if CONFIG_ACROUTER_RBAMP_TASK_WDT
@@ -450,9 +795,14 @@ static void rbamp_poll_task(void *arg)
 
 esp_err_t rbamp_source_configure(const rbamp_source_module_cfg_t *mods, size_t n)
 {
-    if (!mods || n > RBAMP_SOURCE_MAX_MODULES) {
+    if (!mods || n > RBAMP_SOURCE_MAX_ROLES) {
         return ESP_ERR_INVALID_ARG;
     }
+    for (size_t i = 0; i < n; i++) {
+        if (mods[i].channel >= RBAMP_SOURCE_MAX_CHANNELS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
     portENTER_CRITICAL(&s_cfg_mux);
     memcpy(s_role_cfg, mods, n * sizeof(s_role_cfg[0]));
     s_role_cfg_count = n;
@@ -463,11 +813,19 @@ esp_err_t rbamp_source_configure(const rbamp_source_module_cfg_t *mods, size_t n
 
 esp_err_t rbamp_source_set_role(uint8_t addr, rbamp_source_role_t role)
 {
+    return rbamp_source_set_channel_role(addr, 0, role);
+}
+
+esp_err_t rbamp_source_set_channel_role(uint8_t addr, uint8_t channel, rbamp_source_role_t role)
+{
+    if (channel >= RBAMP_SOURCE_MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
     esp_err_t rc = ESP_OK;
     portENTER_CRITICAL(&s_cfg_mux);
     /* Update existing entry (or remove it if role == NONE). */
     for (size_t i = 0; i < s_role_cfg_count; i++) {
-        if (s_role_cfg[i].i2c_addr == addr) {
+        if (s_role_cfg[i].i2c_addr == addr && s_role_cfg[i].channel == channel) {
             if (role == RBAMP_ROLE_NONE) {
                 for (size_t j = i + 1; j < s_role_cfg_count; j++) {
                     s_role_cfg[j - 1] = s_role_cfg[j];
@@ -482,11 +840,12 @@ esp_err_t rbamp_source_set_role(uint8_t addr, rbamp_source_role_t role)
     if (role == RBAMP_ROLE_NONE) {
         goto done; /* nothing to remove */
     }
-    if (s_role_cfg_count >= RBAMP_SOURCE_MAX_MODULES) {
+    if (s_role_cfg_count >= RBAMP_SOURCE_MAX_ROLES) {
         rc = ESP_ERR_NO_MEM;
         goto done;
     }
     s_role_cfg[s_role_cfg_count].i2c_addr = addr;
+    s_role_cfg[s_role_cfg_count].channel  = channel;
     s_role_cfg[s_role_cfg_count].role     = role;
     s_role_cfg_count++;
 done:
@@ -524,8 +883,14 @@ esp_err_t rbamp_source_get_modules(rbamp_source_module_info_t *out, size_t max,
             out[cnt].i2c_addr    = addr;
             out[cnt].channels    = rbamp_channels(d);
             out[cnt].has_voltage = rbamp_has_voltage_hw(d);
-            out[cnt].role        = role_for_addr(addr);
+            roles_for(addr, out[cnt].ch_role);
+            out[cnt].role        = out[cnt].ch_role[0];
             out[cnt].online      = s_last_ok[i];
+            portENTER_CRITICAL(&s_cfg_mux);
+            const cfg_cache_t *c = cfg_cache_slot(addr, false);
+            out[cnt].fw_version  = c ? c->fw_version : 0;
+            out[cnt].hw_variant  = c ? c->hw_variant : 0;
+            portEXIT_CRITICAL(&s_cfg_mux);
             out[cnt].voltage      = s_last_snap[i].voltage;
             out[cnt].current      = s_last_snap[i].current[0];
             out[cnt].power        = s_last_snap[i].power[0];
@@ -553,6 +918,8 @@ esp_err_t rbamp_source_save_config(void)
         nvs_set_u8(nvs, key, s_role_cfg[i].i2c_addr);
         snprintf(key, sizeof(key), "r%u", (unsigned)i);
         nvs_set_u8(nvs, key, (uint8_t)s_role_cfg[i].role);
+        snprintf(key, sizeof(key), "c%u", (unsigned)i);
+        nvs_set_u8(nvs, key, s_role_cfg[i].channel);
     }
     err = nvs_commit(nvs);
     nvs_close(nvs);
@@ -572,20 +939,26 @@ esp_err_t rbamp_source_load_config(void)
         nvs_close(nvs);
         return ESP_ERR_NVS_NOT_FOUND;
     }
-    if (cnt > RBAMP_SOURCE_MAX_MODULES) {
-        cnt = RBAMP_SOURCE_MAX_MODULES;
+    if (cnt > RBAMP_SOURCE_MAX_ROLES) {
+        cnt = RBAMP_SOURCE_MAX_ROLES;
     }
     size_t loaded = 0;
     char key[8];
     for (uint8_t i = 0; i < cnt; i++) {
-        uint8_t a = 0, r = 0;
+        uint8_t a = 0, r = 0, c = 0;
         snprintf(key, sizeof(key), "a%u", (unsigned)i);
         if (nvs_get_u8(nvs, key, &a) != ESP_OK) {
             continue;
         }
         snprintf(key, sizeof(key), "r%u", (unsigned)i);
         nvs_get_u8(nvs, key, &r);
+        snprintf(key, sizeof(key), "c%u", (unsigned)i);
+        nvs_get_u8(nvs, key, &c);     /* absent before per-channel roles: 0 */
+        if (c >= RBAMP_SOURCE_MAX_CHANNELS) {
+            continue;
+        }
         s_role_cfg[loaded].i2c_addr = a;
+        s_role_cfg[loaded].channel  = c;
         s_role_cfg[loaded].role     = (rbamp_source_role_t)r;
         loaded++;
     }
@@ -607,6 +980,7 @@ esp_err_t rbamp_source_init(uint8_t bus_num)
         return ESP_ERR_INVALID_STATE;
     }
 
+    s_bus_num = bus_num;
     esp_err_t err = rbamp_fleet_create(bus, &s_fleet);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "fleet create: %s", esp_err_to_name(err));
@@ -645,6 +1019,7 @@ esp_err_t rbamp_source_init(uint8_t bus_num)
 #endif
 
     s_alive = rbamp_fleet_count(s_fleet);
+    cfg_cache_sync(true);
     s_initialized = true;
     ESP_LOGI(TAG, "Initialized on bus %u: %u rbAmp module(s)",
              bus_num, (unsigned)s_alive);
@@ -677,30 +1052,24 @@ esp_err_t rbamp_source_start(uint32_t interval_ms)
         return ESP_ERR_NO_MEM;
     }
 
-    /* Arm the DRDY interrupt now that the poll task exists (the ISR notifies it). */
-    if (s_drdy_gpio >= 0) {
-        gpio_config_t io = {
-            .pin_bit_mask = 1ULL << s_drdy_gpio,
-            .mode         = GPIO_MODE_INPUT,
-            .pull_up_en   = GPIO_PULLUP_ENABLE,   /* DRDY is open-drain, idles high */
-            .pull_down_en = GPIO_PULLDOWN_DISABLE,
-            .intr_type    = GPIO_INTR_NEGEDGE,    /* active-low: asserts on new data */
-        };
-        esp_err_t e = gpio_config(&io);
-        if (e == ESP_OK) {
-            e = gpio_install_isr_service(0);
-            if (e == ESP_OK || e == ESP_ERR_INVALID_STATE) {   /* may be pre-installed */
-                e = gpio_isr_handler_add((gpio_num_t)s_drdy_gpio, rbamp_drdy_isr, NULL);
-            }
+    /* Arm the DRDY interrupts now that the poll task exists (the ISR notifies
+     * it). A line that fails to arm is left out: its module is then published on
+     * every read, and the interval keeps the poll going. */
+    for (size_t i = 0; i <= DRDY_FLEET; i++) {
+        if ((i >= s_drdy_mod_count && i != DRDY_FLEET) || s_drdy[i].gpio < 0) {
+            continue;
         }
-        if (e == ESP_OK) {
-            s_drdy_isr_installed = true;
+        esp_err_t e = drdy_arm(i);
+        if (e != ESP_OK) {
+            ESP_LOGW(TAG, "DRDY GPIO%d setup failed (%s); using timer poll",
+                     s_drdy[i].gpio, esp_err_to_name(e));
+        } else if (i == DRDY_FLEET) {
             ESP_LOGI(TAG, "DRDY-driven polling on GPIO%d (interval %ums = fallback)",
-                     s_drdy_gpio, (unsigned)s_poll_interval);
+                     s_drdy[i].gpio, (unsigned)s_poll_interval);
         } else {
-            ESP_LOGW(TAG, "DRDY GPIO%d setup failed (%s); using timer poll",
-                     s_drdy_gpio, esp_err_to_name(e));
-            s_drdy_gpio = -1;
+            ESP_LOGI(TAG, "DRDY of 0x%02X on GPIO%d (skew %dms, interval %ums = fallback)",
+                     s_drdy[i].addr, s_drdy[i].gpio, RBAMP_SOURCE_DRDY_SKEW_MS,
+                     (unsigned)s_poll_interval);
         }
     }
     return ESP_OK;
@@ -712,7 +1081,41 @@ esp_err_t rbamp_source_set_drdy_gpio(int gpio)
         /* Changing DRDY wiring while polling is not supported; stop first. */
         return ESP_ERR_INVALID_STATE;
     }
-    s_drdy_gpio = (gpio < 0) ? -1 : gpio;
+    s_drdy[DRDY_FLEET].gpio = (gpio < 0) ? -1 : gpio;
+    return ESP_OK;
+}
+
+esp_err_t rbamp_source_set_module_drdy(uint8_t addr, int gpio)
+{
+    if (addr < 0x08 || addr > 0x77) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_poll_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    size_t slot = s_drdy_mod_count;
+    for (size_t i = 0; i < s_drdy_mod_count; i++) {
+        if (s_drdy[i].addr == addr) {
+            slot = i;
+        } else if (gpio >= 0 && s_drdy[i].gpio == gpio) {
+            return ESP_ERR_INVALID_ARG;     /* one line per module */
+        }
+    }
+    if (gpio < 0) {
+        if (slot < s_drdy_mod_count) {
+            s_drdy[slot] = s_drdy[--s_drdy_mod_count];
+        }
+        return ESP_OK;
+    }
+    if (slot == RBAMP_SOURCE_MAX_MODULES) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(&s_drdy[slot], 0, sizeof(s_drdy[slot]));
+    s_drdy[slot].addr = addr;
+    s_drdy[slot].gpio = gpio;
+    if (slot == s_drdy_mod_count) {
+        s_drdy_mod_count++;
+    }
     return ESP_OK;
 }
 
@@ -726,10 +1129,15 @@ void rbamp_source_stop(void)
     for (int i = 0; i < 50 && s_poll_task != NULL; i++) {
         vTaskDelay(pdMS_TO_TICKS(20));
     }
-    if (s_drdy_isr_installed) {
-        gpio_isr_handler_remove((gpio_num_t)s_drdy_gpio);
-        s_drdy_isr_installed = false;
+    for (size_t i = 0; i <= DRDY_FLEET; i++) {
+        if (s_drdy[i].armed) {
+            gpio_isr_handler_remove((gpio_num_t)s_drdy[i].gpio);
+            s_drdy[i].armed = false;
+        }
     }
+    portENTER_CRITICAL(&s_drdy_mux);
+    s_drdy_pending = 0;
+    portEXIT_CRITICAL(&s_drdy_mux);
 }
 
 size_t rbamp_source_alive_count(void)
@@ -744,6 +1152,27 @@ void rbamp_source_get_timing(uint32_t *last_us, uint32_t *avg_us, uint32_t *coun
     if (count)   *count   = s_poll_count;
 }
 
+void rbamp_source_get_drdy_stats(rbamp_source_drdy_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    out->rounds_complete = s_drdy_rounds_complete;
+    out->rounds_skew     = s_drdy_rounds_skew;
+    out->rounds_timer    = s_drdy_rounds_timer;
+    out->n_lines         = s_drdy_mod_count;
+    for (size_t i = 0; i < s_drdy_mod_count; i++) {
+        rbamp_source_drdy_line_t *o = &out->lines[i];
+        o->i2c_addr   = s_drdy[i].addr;
+        o->gpio       = (int8_t)s_drdy[i].gpio;
+        o->armed      = s_drdy[i].armed;
+        o->edges      = s_drdy[i].edges;
+        o->lat_avg_us = s_drdy[i].lat_avg_us;
+        o->lat_max_us = s_drdy[i].lat_max_us;
+    }
+}
+
 esp_err_t rbamp_source_rescan(void)
 {
 #if !CONFIG_ACROUTER_I2C_AUTODISCOVERY
@@ -841,12 +1270,27 @@ esp_err_t rbamp_source_get_ct_model(uint8_t addr, uint8_t *code)
     if (!code) {
         return ESP_ERR_INVALID_ARG;
     }
-    for (size_t i = 0; i < RBAMP_SOURCE_MAX_MODULES; i++) {
-        if (s_ct_cache_addr[i] == addr) {
-            *code = s_ct_cache_code[i];
-            return ESP_OK;
-        }
+    portENTER_CRITICAL(&s_cfg_mux);
+    const cfg_cache_t *c = cfg_cache_slot(addr, false);
+    *code = c ? c->ct_code : 0;
+    portEXIT_CRITICAL(&s_cfg_mux);
+    return c ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t rbamp_source_refresh_config(void)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
     }
-    *code = 0;
-    return ESP_ERR_NOT_FOUND;
+    if (s_poll_task != NULL) {
+        s_cfg_refresh_req = true;       /* poll task runs it between cycles */
+        return ESP_OK;
+    }
+    cfg_cache_sync(true);
+    return ESP_OK;
+}
+
+uint32_t rbamp_source_config_reads(void)
+{
+    return s_cfg_reads;
 }
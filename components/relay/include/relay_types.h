@@ -145,6 +145,8 @@ typedef struct {
     uint32_t last_switch_ms;    ///< [RUNTIME] Timestamp of last switch
     bool pending_on;            ///< [RUNTIME] Pending turn ON after debounce
     bool pending_off;           ///< [RUNTIME] Pending turn OFF after debounce
+    volatile bool lost_on;      ///< [RUNTIME] Queued ON write failed (set by the backend)
+    volatile bool lost_off;     ///< [RUNTIME] Queued OFF write failed (set by the backend)
 } relay_t;
 
 // ============================================================
@@ -32,23 +32,48 @@ esp_err_t relay_i2c_begin(relay_t* r) {
     /* Ensure relay starts OFF */
     dl_device_set_dimmer_level(0, r->i2c_addr, 0);
     r->is_on = false;
+    r->lost_on = false;
+    r->lost_off = false;
+    r->initialized = true;
 
     ESP_LOGI(TAG, "Relay %d I2C initialized (addr=0x%02X)", r->id, r->i2c_addr);
     return ESP_OK;
 }
 
-esp_err_t relay_i2c_turn_on(relay_t* r) {
+/* Completion of a queued switch (I2C worker). is_on already holds the
+ * commanded state; a lost write is flagged for relay_update(), which restores
+ * is_on to what the module still has and re-issues the switch. */
+static void switch_on_done(esp_err_t result, void* ctx) {
+    relay_t* r = (relay_t*)ctx;
+    if (result == ESP_OK) return;
+    ESP_LOGW(TAG, "Relay %d: ON at 0x%02X failed: %s",
+             r->id, r->i2c_addr, esp_err_to_name(result));
+    r->lost_on = true;
+}
+
+static void switch_off_done(esp_err_t result, void* ctx) {
+    relay_t* r = (relay_t*)ctx;
+    if (result == ESP_OK) return;
+    ESP_LOGW(TAG, "Relay %d: OFF at 0x%02X failed: %s",
+             r->id, r->i2c_addr, esp_err_to_name(result));
+    r->lost_off = true;
+}
+
+/* Switching is queued as an actuation transaction (see dimmer_i2c_set_level). */
+static esp_err_t relay_i2c_switch(relay_t* r, bool on) {
     if (!r) return ESP_ERR_INVALID_ARG;
-    esp_err_t err = dl_device_set_dimmer_level(0, r->i2c_addr, 100);
-    if (err == ESP_OK) r->is_on = true;
+    esp_err_t err = dl_device_set_dimmer_level_async(0, r->i2c_addr, on ? 100 : 0,
+                                                     on ? switch_on_done : switch_off_done, r);
+    if (err == ESP_OK) r->is_on = on;
     return err;
 }
 
+esp_err_t relay_i2c_turn_on(relay_t* r) {
+    return relay_i2c_switch(r, true);
+}
+
 esp_err_t relay_i2c_turn_off(relay_t* r) {
-    if (!r) return ESP_ERR_INVALID_ARG;
-    esp_err_t err = dl_device_set_dimmer_level(0, r->i2c_addr, 0);
-    if (err == ESP_OK) r->is_on = false;
-    return err;
+    return relay_i2c_switch(r, false);
 }
 
 bool relay_i2c_get_state(const relay_t* r) {
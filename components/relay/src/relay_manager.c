@@ -242,6 +242,26 @@ static bool relay_can_switch(const relay_t* r) {
 static void relay_apply_pending_changes(relay_t* r) {
     if (!r || !r->initialized) return;
 
+    // A queued switch the backend reported lost never happened: put the cached
+    // state back and re-issue it now (no debounce — the load did not switch).
+    // Skipped if a newer command has already reversed it.
+    if (__atomic_exchange_n(&r->lost_on, false, __ATOMIC_ACQ_REL) && r->is_on) {
+        ESP_LOGW(TAG, "Relay %d: ON write lost, retrying", r->id);
+        r->is_on = false;
+        if (relay_backend_turn_on(r) != ESP_OK) {
+            r->pending_on = true;
+            r->pending_off = false;
+        }
+    }
+    if (__atomic_exchange_n(&r->lost_off, false, __ATOMIC_ACQ_REL) && !r->is_on) {
+        ESP_LOGW(TAG, "Relay %d: OFF write lost, retrying", r->id);
+        r->is_on = true;
+        if (relay_backend_turn_off(r) != ESP_OK) {
+            r->pending_off = true;
+            r->pending_on = false;
+        }
+    }
+
     if (!relay_can_switch(r)) {
         return; // Still in debounce period
     }
@@ -18,7 +18,26 @@
  * Staleness threshold: if a source has no update for SENSOR_HUB_STALE_MS,
  * it is ignored and the next priority source is used.
  *
- * RouterController subscribes to ACROUTER_EVENT_MERGED_UPDATE.
+ * Hot path: sources publish into acrouter_meas_ring and RouterController's
+ * control task drains it through sensor_hub_pump(); MERGED_UPDATE is still
+ * posted after every merge as a fan-out for telemetry. Without a ring consumer
+ * the hub falls back to POWER_UPDATE in / MERGED_UPDATE out on the event loop.
+ * Source frames are cached, and MERGED_UPDATE is posted, in the compact
+ * acrouter_meas_packed_t form; sensor_hub_pump() hands the controller the
+ * unpacked working struct. A merged frame's timestamp_us is the merge time; the
+ * acquisition time of each channel's winning source frame travels alongside in
+ * acquired_us[] (pump path only — MERGED_UPDATE carries the merge time alone).
+ *
+ * Merge scheduling (SH_MERGE_EPOCH, default): frames arriving within one
+ * acquisition epoch are folded into a single merge. The epoch opens on the
+ * first frame after the previous merge and closes when every expected role
+ * has reported, or at the epoch deadline, whichever comes first — one
+ * MERGED_UPDATE per 200 ms cycle instead of one per source frame.
+ * SH_MERGE_PER_FRAME keeps the legacy merge-on-every-frame behaviour.
+ *
+ * Readers (sensor_hub_get_state/get_stats/get_slot_source, has_i2c_source,
+ * is_adc_active) copy a seqlock-published snapshot and never take the hub
+ * mutex: they cannot delay a merge, and a merge never waits for them.
  */
 
 #ifndef SENSOR_HUB_H
@@ -44,6 +63,10 @@ extern "C" {
 /** Number of tracked measurement slots */
 #define SENSOR_HUB_SLOTS    4   /* voltage, grid, solar, load */
 
+/** Epoch deadline bounds (ms); must stay below the 200 ms source period */
+#define SENSOR_HUB_EPOCH_MIN_MS 10
+#define SENSOR_HUB_EPOCH_MAX_MS 190
+
 /**
  * @brief Slot indices (match acrouter_current_ch_t + voltage)
  */
@@ -54,6 +77,34 @@ typedef enum {
     SH_SLOT_LOAD     = 3,
 } sh_slot_t;
 
+/** Slot bit for sensor_hub_set_expected_slots() */
+#define SH_SLOT_BIT(slot)   ((uint8_t)(1u << (slot)))
+
+/**
+ * @brief Merge scheduling mode
+ */
+typedef enum {
+    SH_MERGE_PER_FRAME = 0,     ///< Merge + publish on every source frame (legacy)
+    SH_MERGE_EPOCH     = 1,     ///< Coalesce one acquisition epoch into one merge
+} sh_merge_mode_t;
+
+/**
+ * @brief Merge scheduler counters (since boot)
+ */
+typedef struct {
+    uint32_t        frames_in;          ///< POWER_UPDATE frames accepted
+    uint32_t        merges;             ///< MERGED_UPDATE frames published
+    uint32_t        frames_suppressed;  ///< Frames folded into another frame's merge
+    uint32_t        epochs_complete;    ///< Epochs closed because every expected role reported
+    uint32_t        epochs_deadline;    ///< Epochs closed by the deadline
+    float           frames_per_s;       ///< Input rate over the last ~1 s window
+    float           merges_per_s;       ///< Publish rate over the last ~1 s window
+    sh_merge_mode_t mode;               ///< Active merge mode
+    uint32_t        epoch_ms;           ///< Active epoch deadline
+    uint8_t         expected_mask;      ///< Configured role mask (0 = auto: live roles)
+    uint32_t        snapshot_retries;   ///< Reader copies retried on a concurrent publish
+} sensor_hub_stats_t;
+
 /**
  * @brief Per-slot source tracking
  */
@@ -61,7 +112,8 @@ typedef struct {
     float               value;          ///< Last known value (A or V)
     float               power;          ///< Active power (W), if available
     acrouter_direction_t direction;     ///< Direction
-    uint64_t            timestamp_us;   ///< When this slot was last updated
+    uint64_t            timestamp_us;   ///< When this slot was last updated (merge time)
+    uint64_t            acquired_us;    ///< When the source acquired the value (its timestamp_us; arrival if 0)
     acrouter_source_t   source;         ///< Which source provided this value
     uint8_t             source_id;      ///< Source instance ID
     uint8_t             priority;       ///< Priority of current source
@@ -95,12 +147,26 @@ bool sensor_hub_is_initialized(void);
 /**
  * @brief Get current hub state (read-only snapshot)
  *
- * Thread-safe: copies state under mutex.
+ * Lock-free: copies the last published snapshot (retries if a merge is
+ * publishing at that instant). Never blocks the merge path.
  *
  * @param state Output state structure
  */
 void sensor_hub_get_state(sensor_hub_state_t* state);
 
+/**
+ * @brief Consume the measurement ring and return the next merged frame
+ *
+ * For the (single) acrouter_meas_ring consumer — RouterController's control
+ * task. Ingests ring frames in order and handles an epoch deadline flagged by
+ * the timer; each merge is also posted as MERGED_UPDATE for telemetry
+ * listeners. Call until it returns false after every wake-up.
+ *
+ * @param merged  Output merged frame
+ * @return true if *merged holds a new merge
+ */
+bool sensor_hub_pump(acrouter_measurements_t* merged);
+
 /**
  * @brief Get the active source for a measurement slot
  *
@@ -119,6 +185,31 @@ bool sensor_hub_has_i2c_source(void);
  */
 bool sensor_hub_is_adc_active(void);
 
+/**
+ * @brief Select the merge scheduling mode
+ *
+ * Switching to SH_MERGE_PER_FRAME closes (and publishes) any open epoch.
+ */
+void sensor_hub_set_merge_mode(sh_merge_mode_t mode);
+
+/**
+ * @brief Set the epoch deadline (ms, clamped SENSOR_HUB_EPOCH_MIN_MS..MAX_MS)
+ */
+void sensor_hub_set_epoch_ms(uint32_t ms);
+
+/**
+ * @brief Set the roles an epoch waits for before closing early
+ *
+ * @param mask  OR of SH_SLOT_BIT(SH_SLOT_*). 0 (default) = auto: every slot
+ *              currently fed by a fresh source.
+ */
+void sensor_hub_set_expected_slots(uint8_t mask);
+
+/**
+ * @brief Get merge scheduler counters
+ */
+void sensor_hub_get_stats(sensor_hub_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
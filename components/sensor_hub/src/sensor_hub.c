@@ -4,16 +4,18 @@
  *
  * Merges measurements from multiple sources (ADC, I2C, ESP-NOW) with
  * priority-based selection and staleness detection.
- * Publishes ACROUTER_EVENT_MERGED_UPDATE after each merge.
+ * Publishes ACROUTER_EVENT_MERGED_UPDATE after each merge — once per frame
+ * (SH_MERGE_PER_FRAME) or once per acquisition epoch (SH_MERGE_EPOCH).
  */
 
 #include "sensor_hub.h"
 #include "acrouter_events.h"
-#include <math.h>          // isfinite() — drop NaN/Inf from a glitching source
+#include "acrouter_meas_ring.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "sdkconfig.h"
 #include <string.h>
 
 static const char* TAG = "SensorHub";
@@ -29,8 +31,10 @@ static const char* TAG = "SensorHub";
  * permanently occupies a slot and exhausts the cache (D10). */
 #define SENSOR_HUB_REAP_FACTOR 10
 
+/* Frames are cached packed (24 B): non-finite values were already dropped at
+ * pack time, so the merge never sees NaN/Inf from a glitching source (MAJOR-7). */
 typedef struct {
-    acrouter_measurements_t meas;
+    acrouter_meas_packed_t meas;
     uint64_t    received_us;
     bool        in_use;
 } source_cache_t;
@@ -40,6 +44,64 @@ static sensor_hub_state_t s_state;
 static SemaphoreHandle_t s_mutex = NULL;
 static bool s_initialized = false;
 
+/* ================================================================
+ * Merge scheduler state (all under s_mutex)
+ * ================================================================ */
+
+#ifndef CONFIG_ACROUTER_SENSOR_HUB_EPOCH_MS
+#define CONFIG_ACROUTER_SENSOR_HUB_EPOCH_MS 150
+#endif
+
+#if CONFIG_ACROUTER_SENSOR_HUB_COALESCE
+#define SENSOR_HUB_DEFAULT_MODE SH_MERGE_EPOCH
+#else
+#define SENSOR_HUB_DEFAULT_MODE SH_MERGE_PER_FRAME
+#endif
+
+typedef struct {
+    bool     open;
+    uint64_t opened_us;
+    uint8_t  seen_mask;     ///< SH_SLOT_BIT of every role reported this epoch
+    uint32_t frames;        ///< frames folded into this epoch
+    bool     due;           ///< deadline hit, close left to the ring consumer
+} merge_epoch_t;
+
+static merge_epoch_t      s_epoch;
+static esp_timer_handle_t s_epoch_timer = NULL;
+static sh_merge_mode_t    s_merge_mode = SENSOR_HUB_DEFAULT_MODE;
+static uint32_t           s_epoch_ms = CONFIG_ACROUTER_SENSOR_HUB_EPOCH_MS;
+static uint8_t            s_expected_mask = 0;     /* 0 = auto (live roles) */
+static sensor_hub_stats_t s_stats;
+static uint64_t           s_rate_start_us;
+static uint32_t           s_rate_frames0;
+static uint32_t           s_rate_merges0;
+
+/* ================================================================
+ * Published snapshot (seqlock)
+ *
+ * Writers — the event-loop task and the epoch timer task — are serialised by
+ * s_mutex and copy their result into s_snap between two s_snap_seq increments.
+ * Readers (MQTT, web, console) never touch s_mutex: they copy s_snap and retry
+ * if the sequence was odd or moved under them, so a slow reader can no longer
+ * hold up a merge. The copy runs in a writer-only critical section, so a
+ * reader on the writer's core can never preempt a half-written snapshot and
+ * spin against it.
+ * ================================================================ */
+
+#define SH_SOURCE_TYPES 5   /* acrouter_source_t NONE..MQTT */
+
+typedef struct {
+    sensor_hub_state_t state;
+    sensor_hub_stats_t stats;
+    uint64_t           source_last_us[SH_SOURCE_TYPES];  ///< Last frame per source type (0 = never)
+} hub_snapshot_t;
+
+static hub_snapshot_t s_snap;
+static uint32_t       s_snap_seq;                          /* odd = publish in progress */
+static uint32_t       s_snap_retries;                      /* reader retries (atomic) */
+static portMUX_TYPE   s_pub_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t       s_source_last_us[SH_SOURCE_TYPES];   /* writer copy, under s_mutex */
+
 /* ================================================================
  * Priority helper
  * ================================================================ */
@@ -63,25 +125,71 @@ static uint8_t source_priority(acrouter_source_t src) {
  * most recent timestamp.
  * ================================================================ */
 
-static void do_merge(void) {
+/* Copy the writer state into s_snap. Call with s_mutex held (one writer at a time). */
+static void publish_snapshot_locked(void) {
+    portENTER_CRITICAL(&s_pub_mux);
+    __atomic_fetch_add(&s_snap_seq, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s_snap.state = s_state;
+    s_snap.stats = s_stats;
+    s_snap.stats.mode          = (s_epoch_timer != NULL) ? s_merge_mode : SH_MERGE_PER_FRAME;
+    s_snap.stats.epoch_ms      = s_epoch_ms;
+    s_snap.stats.expected_mask = s_expected_mask;
+    memcpy(s_snap.source_last_us, s_source_last_us, sizeof(s_snap.source_last_us));
+    __atomic_fetch_add(&s_snap_seq, 1, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&s_pub_mux);
+}
+
+/* Lock-free copy of the last published snapshot. */
+static void read_snapshot(hub_snapshot_t* out) {
+    for (;;) {
+        uint32_t seq0 = __atomic_load_n(&s_snap_seq, __ATOMIC_ACQUIRE);
+        if ((seq0 & 1u) == 0) {
+            memcpy(out, &s_snap, sizeof(*out));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&s_snap_seq, __ATOMIC_RELAXED) == seq0) return;
+        }
+        __atomic_fetch_add(&s_snap_retries, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/* Latch frames/s and merges/s once per >=1 s window. Call with s_mutex held. */
+static void update_rates_locked(uint64_t now_us) {
+    uint64_t dt = now_us - s_rate_start_us;
+    if (dt < 1000000ULL) return;
+    s_stats.frames_per_s = (float)(s_stats.frames_in - s_rate_frames0) * 1e6f / (float)dt;
+    s_stats.merges_per_s = (float)(s_stats.merges - s_rate_merges0) * 1e6f / (float)dt;
+    s_rate_start_us = now_us;
+    s_rate_frames0  = s_stats.frames_in;
+    s_rate_merges0  = s_stats.merges;
+}
+
+/* Merge all cached sources into *merged and update the slot state.
+ * Returns false (nothing to publish) when no source contributed. The merge can
+ * run on the ring consumer, the event loop or the epoch timer task, so it holds
+ * s_mutex throughout; callers post/consume *merged after it returns. */
+static bool merge_sources(acrouter_measurements_t* merged) {
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
     uint64_t now_us = esp_timer_get_time();
     uint64_t stale_threshold_us = (uint64_t)SENSOR_HUB_STALE_MS * 1000;
 
     /* Build merged measurement */
-    acrouter_measurements_t merged;
-    acrouter_measurements_init(&merged);
-    merged.timestamp_us = now_us;
-    merged.source = ACROUTER_SOURCE_NONE;
-    merged.valid = false;
+    acrouter_measurements_init(merged);
+    merged->timestamp_us = now_us;
+    merged->source = ACROUTER_SOURCE_NONE;
+    merged->valid = false;
 
     /* Track which source wins each slot */
     uint8_t           slot_best_prio[SENSOR_HUB_SLOTS];
     uint64_t          slot_best_ts[SENSOR_HUB_SLOTS];
+    uint64_t          slot_best_acq[SENSOR_HUB_SLOTS];
     acrouter_source_t slot_best_source[SENSOR_HUB_SLOTS];
     uint8_t           slot_best_source_id[SENSOR_HUB_SLOTS];
     for (int s = 0; s < SENSOR_HUB_SLOTS; s++) {
         slot_best_prio[s] = 255;
         slot_best_ts[s] = 0;
+        slot_best_acq[s] = 0;
         slot_best_source[s] = ACROUTER_SOURCE_NONE;
         slot_best_source_id[s] = 0;
     }
@@ -93,22 +201,24 @@ static void do_merge(void) {
         /* Check staleness */
         if ((now_us - s_sources[i].received_us) > stale_threshold_us) continue;
 
-        const acrouter_measurements_t* m = &s_sources[i].meas;
-        if (!m->valid) continue;
+        const acrouter_meas_packed_t* m = &s_sources[i].meas;
+        if (!(m->flags & ACROUTER_PK_VALID)) continue;
 
-        uint8_t prio = source_priority(m->source);
+        acrouter_source_t src = (acrouter_source_t)m->source;
+        uint8_t prio = source_priority(src);
+        uint64_t acq_us = acrouter_pk_timestamp(m, now_us);
 
-        /* Voltage slot — drop non-finite (NaN/Inf from a driver glitch) so it never
-         * reaches the merged state / control loop / telemetry (MAJOR-7). */
-        if (m->has_voltage && isfinite(m->voltage_rms)) {
+        /* Voltage slot */
+        if (acrouter_pk_has_voltage(m)) {
             if (prio < slot_best_prio[SH_SLOT_VOLTAGE] ||
                 (prio == slot_best_prio[SH_SLOT_VOLTAGE] && s_sources[i].received_us > slot_best_ts[SH_SLOT_VOLTAGE])) {
                 slot_best_prio[SH_SLOT_VOLTAGE] = prio;
                 slot_best_ts[SH_SLOT_VOLTAGE] = s_sources[i].received_us;
-                slot_best_source[SH_SLOT_VOLTAGE] = m->source;
+                slot_best_source[SH_SLOT_VOLTAGE] = src;
                 slot_best_source_id[SH_SLOT_VOLTAGE] = m->source_id;
-                merged.voltage_rms = m->voltage_rms;
-                merged.has_voltage = true;
+                slot_best_acq[SH_SLOT_VOLTAGE] = acq_us;
+                merged->voltage_rms = acrouter_pk_voltage(m);
+                merged->has_voltage = true;
             }
         }
 
@@ -122,55 +232,61 @@ static void do_merge(void) {
         for (int k = 0; k < 3; k++) {
             int ch = ch_map[k].ch;
             sh_slot_t sl = ch_map[k].slot;
-            if (!m->has_current[ch] || !isfinite(m->current_rms[ch])) continue;  /* drop NaN/Inf */
+            if (!acrouter_pk_has_current(m, ch)) continue;
 
             if (prio < slot_best_prio[sl] ||
                 (prio == slot_best_prio[sl] && s_sources[i].received_us > slot_best_ts[sl])) {
                 slot_best_prio[sl] = prio;
                 slot_best_ts[sl] = s_sources[i].received_us;
-                slot_best_source[sl] = m->source;
+                slot_best_source[sl] = src;
                 slot_best_source_id[sl] = m->source_id;
-                merged.current_rms[ch]  = m->current_rms[ch];
-                merged.direction[ch]    = m->direction[ch];
-                merged.has_current[ch]  = true;
-                if (m->has_power[ch] && isfinite(m->power_active[ch])) {
-                    merged.power_active[ch] = m->power_active[ch];
-                    merged.has_power[ch] = true;
+                slot_best_acq[sl] = acq_us;
+                merged->acquired_us[ch]  = acq_us;
+                merged->current_rms[ch]  = acrouter_pk_current(m, ch);
+                merged->direction[ch]    = acrouter_pk_direction(m, ch);
+                merged->has_current[ch]  = true;
+                if (acrouter_pk_has_power(m, ch)) {
+                    merged->power_active[ch] = acrouter_pk_power(m, ch);
+                    merged->has_power[ch] = true;
                 }
             }
         }
     }
 
     /* merged is valid if at least one slot has data */
-    merged.valid = merged.has_voltage ||
-                   merged.has_current[ACROUTER_CH_GRID] ||
-                   merged.has_current[ACROUTER_CH_SOLAR] ||
-                   merged.has_current[ACROUTER_CH_LOAD];
-
-    if (!merged.valid) return;
+    merged->valid = merged->has_voltage ||
+                    merged->has_current[ACROUTER_CH_GRID] ||
+                    merged->has_current[ACROUTER_CH_SOLAR] ||
+                    merged->has_current[ACROUTER_CH_LOAD];
+
+    if (!merged->valid) {
+        publish_snapshot_locked();
+        xSemaphoreGive(s_mutex);
+        return false;
+    }
 
     /* Mark source as mixed (multiple sources possible) */
-    merged.source = ACROUTER_SOURCE_ADC;  /* will be overwritten below */
+    merged->source = ACROUTER_SOURCE_ADC;  /* will be overwritten below */
     /* Use highest-priority source that contributed */
     for (int s = 0; s < MAX_SOURCES; s++) {
         if (!s_sources[s].in_use) continue;
         if ((now_us - s_sources[s].received_us) > stale_threshold_us) continue;
-        if (source_priority(s_sources[s].meas.source) < source_priority(merged.source)) {
-            merged.source = s_sources[s].meas.source;
+        acrouter_source_t src = (acrouter_source_t)s_sources[s].meas.source;
+        if (source_priority(src) < source_priority(merged->source)) {
+            merged->source = src;
         }
     }
 
-    /* Update slot state under mutex */
-    xSemaphoreTake(s_mutex, portMAX_DELAY);
-
+    /* Update slot state (s_mutex held since the top) */
     for (int s = 0; s < SENSOR_HUB_SLOTS; s++) {
         s_state.slots[s].valid = false;
     }
 
-    if (merged.has_voltage) {
-        s_state.slots[SH_SLOT_VOLTAGE].value        = merged.voltage_rms;
+    if (merged->has_voltage) {
+        s_state.slots[SH_SLOT_VOLTAGE].value        = merged->voltage_rms;
         s_state.slots[SH_SLOT_VOLTAGE].valid        = true;
         s_state.slots[SH_SLOT_VOLTAGE].timestamp_us = now_us;
+        s_state.slots[SH_SLOT_VOLTAGE].acquired_us  = slot_best_acq[SH_SLOT_VOLTAGE];
         s_state.slots[SH_SLOT_VOLTAGE].priority     = slot_best_prio[SH_SLOT_VOLTAGE];
         s_state.slots[SH_SLOT_VOLTAGE].source       = slot_best_source[SH_SLOT_VOLTAGE];
         s_state.slots[SH_SLOT_VOLTAGE].source_id    = slot_best_source_id[SH_SLOT_VOLTAGE];
@@ -184,48 +300,152 @@ static void do_merge(void) {
     for (int k = 0; k < 3; k++) {
         int ch = ch_map2[k].ch;
         sh_slot_t sl = ch_map2[k].sl;
-        if (!merged.has_current[ch]) continue;
-        s_state.slots[sl].value        = merged.current_rms[ch];
-        s_state.slots[sl].direction    = merged.direction[ch];
+        if (!merged->has_current[ch]) continue;
+        s_state.slots[sl].value        = merged->current_rms[ch];
+        s_state.slots[sl].direction    = merged->direction[ch];
         s_state.slots[sl].valid        = true;
         s_state.slots[sl].timestamp_us = now_us;
+        s_state.slots[sl].acquired_us  = slot_best_acq[sl];
         s_state.slots[sl].priority     = slot_best_prio[sl];
         s_state.slots[sl].source       = slot_best_source[sl];
         s_state.slots[sl].source_id    = slot_best_source_id[sl];
-        if (merged.has_power[ch]) {
-            s_state.slots[sl].power     = merged.power_active[ch];
+        if (merged->has_power[ch]) {
+            s_state.slots[sl].power     = merged->power_active[ch];
             s_state.slots[sl].has_power = true;
         }
     }
 
     s_state.last_merge_us = now_us;
     s_state.merge_count++;
+    s_stats.merges++;
+    update_rates_locked(now_us);
+    publish_snapshot_locked();
 
     xSemaphoreGive(s_mutex);
+    return true;
+}
+
+/* MERGED_UPDATE carries the packed frame (24 B instead of the working struct). */
+static void post_merged(const acrouter_measurements_t* merged) {
+    acrouter_meas_packed_t pk;
+    acrouter_meas_pack(merged, &pk);
+    esp_event_post(ACROUTER_EVENT, ACROUTER_EVENT_MERGED_UPDATE, &pk, sizeof(pk), 0);
+}
 
-    /* Post merged event */
-    esp_event_post(ACROUTER_EVENT, ACROUTER_EVENT_MERGED_UPDATE,
-                   &merged, sizeof(merged), 0);
+/* Merge and publish on the event bus (legacy path: no ring consumer). */
+static void do_merge(void) {
+    acrouter_measurements_t merged;
+    if (merge_sources(&merged)) post_merged(&merged);
 }
 
 /* ================================================================
- * Event handler - called from ESP-IDF event loop task
+ * Epoch scheduler
+ *
+ * An epoch opens on the first frame after the previous merge and arms a
+ * one-shot deadline. It closes early once every expected role has reported;
+ * frames beyond the first only refresh the source cache (suppressed merges).
  * ================================================================ */
 
-static void on_power_update(void* arg, esp_event_base_t base,
-                            int32_t id, void* event_data) {
-    const acrouter_measurements_t* m = (const acrouter_measurements_t*)event_data;
-    if (!m || !m->valid) return;
+static uint8_t frame_slot_mask(const acrouter_meas_packed_t* m) {
+    uint8_t mask = 0;
+    if (acrouter_pk_has_voltage(m))                     mask |= SH_SLOT_BIT(SH_SLOT_VOLTAGE);
+    if (acrouter_pk_has_current(m, ACROUTER_CH_GRID))   mask |= SH_SLOT_BIT(SH_SLOT_GRID);
+    if (acrouter_pk_has_current(m, ACROUTER_CH_SOLAR))  mask |= SH_SLOT_BIT(SH_SLOT_SOLAR);
+    if (acrouter_pk_has_current(m, ACROUTER_CH_LOAD))   mask |= SH_SLOT_BIT(SH_SLOT_LOAD);
+    return mask;
+}
+
+/* Auto expected set: every role a fresh source is currently feeding. */
+static uint8_t live_slot_mask_locked(uint64_t now_us) {
+    uint64_t stale_threshold_us = (uint64_t)SENSOR_HUB_STALE_MS * 1000;
+    uint8_t mask = 0;
+    for (int i = 0; i < MAX_SOURCES; i++) {
+        if (!s_sources[i].in_use || !(s_sources[i].meas.flags & ACROUTER_PK_VALID)) continue;
+        if ((now_us - s_sources[i].received_us) > stale_threshold_us) continue;
+        mask |= frame_slot_mask(&s_sources[i].meas);
+    }
+    return mask;
+}
+
+static void epoch_close_locked(bool complete) {
+    if (!s_epoch.open) return;
+    s_epoch.open = false;
+    if (s_epoch.frames > 1) s_stats.frames_suppressed += s_epoch.frames - 1;
+    if (complete) {
+        s_stats.epochs_complete++;
+    } else {
+        s_stats.epochs_deadline++;
+    }
+}
+
+/* Account one cached frame. Returns true when the caller must merge now. */
+static bool epoch_account_locked(const acrouter_meas_packed_t* m, uint64_t now_us) {
+    if (s_merge_mode == SH_MERGE_PER_FRAME || !s_epoch_timer) return true;
+
+    if (!s_epoch.open) {
+        s_epoch.open      = true;
+        s_epoch.opened_us = now_us;
+        s_epoch.seen_mask = 0;
+        s_epoch.frames    = 0;
+        s_epoch.due       = false;
+        esp_timer_start_once(s_epoch_timer, (uint64_t)s_epoch_ms * 1000ULL);
+    }
+    s_epoch.seen_mask |= frame_slot_mask(m);
+    s_epoch.frames++;
+
+    uint8_t want = s_expected_mask ? s_expected_mask : live_slot_mask_locked(now_us);
+    if ((s_epoch.seen_mask & want) == want) {
+        esp_timer_stop(s_epoch_timer);
+        epoch_close_locked(true);
+        return true;
+    }
+    return false;
+}
+
+/* esp_timer task: epoch deadline reached with roles still missing.
+ * With a ring consumer attached the merge belongs to the consumer (it feeds the
+ * control loop directly): flag the epoch and wake it. Otherwise merge here and
+ * post MERGED_UPDATE. */
+static void epoch_deadline_cb(void* arg) {
+    (void)arg;
+    bool publish = false;
+    bool kick = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    /* A callback already in flight when the epoch closed early may land in the
+     * NEXT epoch; only close an epoch that has actually reached its deadline. */
+    uint64_t now_us = esp_timer_get_time();
+    if (s_epoch.open && (now_us - s_epoch.opened_us) + 1000ULL >= (uint64_t)s_epoch_ms * 1000ULL) {
+        if (acrouter_meas_ring_attached()) {
+            s_epoch.due = true;
+            kick = true;
+        } else {
+            epoch_close_locked(false);
+            publish = true;
+        }
+    }
+    if (!publish) publish_snapshot_locked();
+    xSemaphoreGive(s_mutex);
+    if (kick) acrouter_meas_ring_kick();
+    if (publish) do_merge();
+}
+
+/* ================================================================
+ * Frame ingest - ring consumer task or ESP-IDF event loop task
+ * ================================================================ */
+
+/* Cache one source frame. Returns true when a merge is due now. */
+static bool ingest_frame(const acrouter_meas_packed_t* m) {
+    if (!m || m->version != ACROUTER_MEAS_PACKED_VERSION || !(m->flags & ACROUTER_PK_VALID)) return false;
 
     const uint64_t now_us = esp_timer_get_time();
     const uint64_t reap_us = (uint64_t)SENSOR_HUB_STALE_MS * 1000ULL * SENSOR_HUB_REAP_FACTOR;
 
-    /* Find/allocate the slot under s_mutex so the cross-task readers
-     * (sensor_hub_has_i2c_source/is_adc_active) never see a torn write (D6).
-     * do_merge() runs after the unlock — it is on this same task, so the s_sources[]
-     * it then reads cannot be mid-written, and it takes s_mutex itself for s_state. */
+    /* Find/allocate the slot under s_mutex: the epoch timer task also reads
+     * s_sources[] (D6). Readers see it only through the published snapshot.
+     * do_merge() runs after the unlock and re-takes s_mutex for its own read. */
     int free_slot = -1;
     int found_slot = -1;
+    bool publish = false;
 
     xSemaphoreTake(s_mutex, portMAX_DELAY);
     for (int i = 0; i < MAX_SOURCES; i++) {
@@ -245,18 +465,46 @@ static void on_power_update(void* arg, esp_event_base_t base,
     int slot = (found_slot >= 0) ? found_slot : free_slot;
     if (slot >= 0) {
         s_sources[slot].meas = *m;
+        /* timestamp_us 0 = the source did not stamp the frame (console/web
+         * injection): re-extending 0 would date it up to ~71 min back, so it is
+         * acquired when it arrives. */
+        if (m->timestamp_us32 == 0) s_sources[slot].meas.timestamp_us32 = (uint32_t)now_us;
         s_sources[slot].received_us = now_us;
         s_sources[slot].in_use = true;
+        if (m->source < SH_SOURCE_TYPES) s_source_last_us[m->source] = now_us;
+        s_stats.frames_in++;
+        update_rates_locked(now_us);
+        publish = epoch_account_locked(m, now_us);
+        /* A merge publishes anyway; otherwise make the new frame visible now. */
+        if (!publish) publish_snapshot_locked();
     }
     xSemaphoreGive(s_mutex);
 
     if (slot < 0) {
         ESP_LOGW(TAG, "Source cache full, dropping update");
+        return false;
+    }
+    return publish;
+}
+
+/* POWER_UPDATE from a source that still posts on the event bus (console/web
+ * injection, or any source before the ring consumer attached). */
+static void on_power_update(void* arg, esp_event_base_t base,
+                            int32_t id, void* event_data) {
+    const acrouter_measurements_t* m = (const acrouter_measurements_t*)event_data;
+    if (!m || !m->valid) return;
+
+    /* The control task consumes the ring — route the frame there so its merge
+     * reaches the controller like any other source's. */
+    if (acrouter_meas_ring_attached()) {
+        acrouter_meas_publish(m);
         return;
     }
 
-    /* Merge all sources and publish */
-    do_merge();
+    /* Merge all sources and publish (per frame, or when the epoch completes) */
+    acrouter_meas_packed_t pk;
+    acrouter_meas_pack(m, &pk);
+    if (ingest_frame(&pk)) do_merge();
 }
 
 /* ================================================================
@@ -268,6 +516,7 @@ esp_err_t sensor_hub_init(void) {
 
     memset(s_sources, 0, sizeof(s_sources));
     memset(&s_state, 0, sizeof(s_state));
+    memset(s_source_last_us, 0, sizeof(s_source_last_us));
 
     s_mutex = xSemaphoreCreateMutex();
     if (!s_mutex) {
@@ -275,6 +524,24 @@ esp_err_t sensor_hub_init(void) {
         return ESP_ERR_NO_MEM;
     }
 
+    memset(&s_epoch, 0, sizeof(s_epoch));
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_rate_start_us = esp_timer_get_time();
+    const esp_timer_create_args_t targs = {
+        .callback = &epoch_deadline_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "sh_epoch",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&targs, &s_epoch_timer) != ESP_OK) {
+        /* No deadline → an epoch with a silent role would never close. Fall back
+         * to merging every frame rather than risk stalling the control loop. */
+        s_epoch_timer = NULL;
+        ESP_LOGW(TAG, "Epoch timer unavailable — merging per frame");
+    }
+    publish_snapshot_locked();   /* no other writer exists yet */
+
     /* Subscribe to raw power updates from all sources */
     esp_err_t err = esp_event_handler_register(
         ACROUTER_EVENT, ACROUTER_EVENT_POWER_UPDATE,
@@ -286,8 +553,10 @@ esp_err_t sensor_hub_init(void) {
     }
 
     s_initialized = true;
-    ESP_LOGI(TAG, "Sensor Hub initialized (stale=%dms, sources=%d)",
-             SENSOR_HUB_STALE_MS, MAX_SOURCES);
+    ESP_LOGI(TAG, "Sensor Hub initialized (stale=%dms, sources=%d, merge=%s/%lums)",
+             SENSOR_HUB_STALE_MS, MAX_SOURCES,
+             (s_merge_mode == SH_MERGE_EPOCH && s_epoch_timer) ? "epoch" : "per-frame",
+             (unsigned long)s_epoch_ms);
     return ESP_OK;
 }
 
@@ -295,54 +564,123 @@ bool sensor_hub_is_initialized(void) {
     return s_initialized;
 }
 
-void sensor_hub_get_state(sensor_hub_state_t* out) {
-    if (!out) return;
+bool sensor_hub_pump(acrouter_measurements_t* merged) {
+    if (!merged || !s_initialized) return false;
+
+    /* Frames are read in place from the ring slot; ingest copies them (packed)
+     * into the source cache, which is the only copy on the way to the controller. */
+    const acrouter_meas_packed_t* f;
+    while ((f = acrouter_meas_ring_peek()) != NULL) {
+        bool due = ingest_frame(f);
+        acrouter_meas_ring_release();
+        if (due && merge_sources(merged)) {
+            post_merged(merged);   /* telemetry fan-out */
+            return true;
+        }
+    }
+
+    /* Epoch deadline flagged by the timer task. */
+    bool due = false;
     xSemaphoreTake(s_mutex, portMAX_DELAY);
-    memcpy(out, &s_state, sizeof(sensor_hub_state_t));
+    if (s_epoch.open && s_epoch.due) {
+        epoch_close_locked(false);
+        due = true;
+    }
     xSemaphoreGive(s_mutex);
+    if (due && merge_sources(merged)) {
+        post_merged(merged);
+        return true;
+    }
+    return false;
+}
+
+void sensor_hub_get_state(sensor_hub_state_t* out) {
+    if (!out) return;
+    hub_snapshot_t snap;
+    read_snapshot(&snap);
+    memcpy(out, &snap.state, sizeof(sensor_hub_state_t));
 }
 
 acrouter_source_t sensor_hub_get_slot_source(sh_slot_t slot) {
     if (slot >= SENSOR_HUB_SLOTS) return ACROUTER_SOURCE_NONE;
-    acrouter_source_t src = ACROUTER_SOURCE_NONE;
-    xSemaphoreTake(s_mutex, portMAX_DELAY);
-    if (s_state.slots[slot].valid) {
-        src = s_state.slots[slot].source;
-    }
-    xSemaphoreGive(s_mutex);
-    return src;
+    hub_snapshot_t snap;
+    read_snapshot(&snap);
+    return snap.state.slots[slot].valid ? snap.state.slots[slot].source : ACROUTER_SOURCE_NONE;
+}
+
+/* True if a frame of this source type arrived within SENSOR_HUB_STALE_MS. */
+static bool source_fresh(const hub_snapshot_t* snap, acrouter_source_t src, uint64_t now_us) {
+    uint64_t last_us = snap->source_last_us[src];
+    return last_us != 0 && (now_us - last_us) <= (uint64_t)SENSOR_HUB_STALE_MS * 1000;
 }
 
 bool sensor_hub_has_i2c_source(void) {
-    if (!s_mutex) return false;
+    hub_snapshot_t snap;
+    read_snapshot(&snap);
     uint64_t now_us = esp_timer_get_time();
-    uint64_t threshold_us = (uint64_t)SENSOR_HUB_STALE_MS * 1000;
-    bool found = false;
-    xSemaphoreTake(s_mutex, portMAX_DELAY);   /* mutually exclusive with the s_sources[] write (D6) */
-    for (int i = 0; i < MAX_SOURCES; i++) {
-        if (!s_sources[i].in_use) continue;
-        if ((now_us - s_sources[i].received_us) > threshold_us) continue;
-        if (s_sources[i].meas.source == ACROUTER_SOURCE_I2C ||
-            s_sources[i].meas.source == ACROUTER_SOURCE_ESPNOW) {
-            found = true;
-            break;
+    return source_fresh(&snap, ACROUTER_SOURCE_I2C, now_us) ||
+           source_fresh(&snap, ACROUTER_SOURCE_ESPNOW, now_us);
+}
+
+bool sensor_hub_is_adc_active(void) {
+    hub_snapshot_t snap;
+    read_snapshot(&snap);
+    return source_fresh(&snap, ACROUTER_SOURCE_ADC, esp_timer_get_time());
+}
+
+void sensor_hub_set_merge_mode(sh_merge_mode_t mode) {
+    if (!s_mutex) {
+        s_merge_mode = mode;   /* before init: just the boot default */
+        return;
+    }
+    bool publish = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_merge_mode = mode;
+    if (mode == SH_MERGE_PER_FRAME && s_epoch.open) {
+        if (s_epoch_timer) esp_timer_stop(s_epoch_timer);
+        if (acrouter_meas_ring_attached()) {
+            s_epoch.due = true;    /* the consumer closes + merges it */
+        } else {
+            epoch_close_locked(false);
+            publish = true;
         }
     }
+    publish_snapshot_locked();
     xSemaphoreGive(s_mutex);
-    return found;
+    if (publish) do_merge();
+    acrouter_meas_ring_kick();
+    ESP_LOGI(TAG, "Merge mode: %s", mode == SH_MERGE_EPOCH ? "epoch" : "per-frame");
 }
 
-bool sensor_hub_is_adc_active(void) {
-    if (!s_mutex) return false;
-    uint64_t now_us = esp_timer_get_time();
-    uint64_t threshold_us = (uint64_t)SENSOR_HUB_STALE_MS * 1000;
-    bool found = false;
-    xSemaphoreTake(s_mutex, portMAX_DELAY);   /* mutually exclusive with the s_sources[] write (D6) */
-    for (int i = 0; i < MAX_SOURCES; i++) {
-        if (!s_sources[i].in_use) continue;
-        if ((now_us - s_sources[i].received_us) > threshold_us) continue;
-        if (s_sources[i].meas.source == ACROUTER_SOURCE_ADC) { found = true; break; }
+void sensor_hub_set_epoch_ms(uint32_t ms) {
+    if (ms < SENSOR_HUB_EPOCH_MIN_MS) ms = SENSOR_HUB_EPOCH_MIN_MS;
+    if (ms > SENSOR_HUB_EPOCH_MAX_MS) ms = SENSOR_HUB_EPOCH_MAX_MS;
+    if (!s_mutex) {
+        s_epoch_ms = ms;
+        return;
     }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_epoch_ms = ms;   /* takes effect from the next epoch */
+    publish_snapshot_locked();
     xSemaphoreGive(s_mutex);
-    return found;
+}
+
+void sensor_hub_set_expected_slots(uint8_t mask) {
+    mask &= (uint8_t)((1u << SENSOR_HUB_SLOTS) - 1);
+    if (!s_mutex) {
+        s_expected_mask = mask;
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_expected_mask = mask;
+    publish_snapshot_locked();
+    xSemaphoreGive(s_mutex);
+}
+
+void sensor_hub_get_stats(sensor_hub_stats_t* out) {
+    if (!out) return;
+    hub_snapshot_t snap;
+    read_snapshot(&snap);
+    *out = snap.stats;
+    out->snapshot_retries = __atomic_load_n(&s_snap_retries, __ATOMIC_RELAXED);
 }
@@ -26,6 +26,15 @@ namespace ConfigKeys {
     constexpr const char* MANUAL_LEVEL      = "manual_lvl";
     constexpr const char* GRID_CURRENT_LIMIT = "grid_lim_a";
 
+    // Controller engine + gains per regulating mode (index = PidLoop: auto, eco, grid_limit)
+    constexpr const char* PID_ENGINE[3] = { "pid_a_eng", "pid_e_eng", "pid_g_eng" };
+    constexpr const char* PID_KP[3]     = { "pid_a_kp",  "pid_e_kp",  "pid_g_kp"  };
+    constexpr const char* PID_KI[3]     = { "pid_a_ki",  "pid_e_ki",  "pid_g_ki"  };
+    constexpr const char* PID_KD[3]     = { "pid_a_kd",  "pid_e_kd",  "pid_g_kd"  };
+    constexpr const char* AUTO_FF       = "auto_ff";
+    constexpr const char* PLANT_TUNE    = "plant_tune";
+    constexpr const char* AUTO_DTC      = "auto_dtc";
+
     // Sensor calibration
     constexpr const char* CURRENT_THRESHOLD = "curr_thresh";
     constexpr const char* POWER_THRESHOLD   = "pwr_thresh";
@@ -45,6 +54,17 @@ namespace ConfigDefaults {
     constexpr float GRID_CURRENT_LIMIT      = 16.0f;    // Amps (GRID_LIMIT mode cap)
     constexpr uint8_t MANUAL_LEVEL          = 0;        // 0%
 
+    // Per-mode controller (auto, eco, grid_limit) — mirrors RouterConfig::*_KP/KI/KD
+    constexpr uint8_t PID_LOOPS             = 3;
+    constexpr uint8_t PID_ENGINE[PID_LOOPS] = { 0, 0, 0 };              // 0=P (legacy), 1=PI, 2=PID
+    constexpr float PID_KP[PID_LOOPS]       = { 0.05f, 0.01f, 2.0f };   // W/W, %/W, %/A
+    constexpr float PID_KI[PID_LOOPS]       = { 5.0f, 0.06f, 10.0f };   // per second
+    constexpr float PID_KD[PID_LOOPS]       = { 0.02f, 0.002f, 0.1f };  // seconds
+    constexpr float PID_MAX_GAIN            = 10.0f;
+    constexpr uint8_t AUTO_FF               = 0;        // AUTO load/solar feed-forward off
+    constexpr uint8_t PLANT_TUNE            = 0;        // AUTO plant-gain tuning off (0=off, 1=learn, 2=adapt)
+    constexpr uint8_t AUTO_DTC              = 1;        // AUTO dead-time compensation on
+
     constexpr float CURRENT_THRESHOLD       = 1.0f;     // Minimum current (A)
     constexpr float POWER_THRESHOLD         = 5.0f;     // Minimum power (W)
 }
@@ -63,6 +83,13 @@ struct SystemConfig {
     float balance_threshold;    ///< Balance threshold in Watts
     uint8_t manual_level;       ///< Manual dimmer level (0-100%)
     float grid_current_limit;   ///< GRID_LIMIT mode cap (Amps)
+    uint8_t pid_engine[ConfigDefaults::PID_LOOPS]; ///< ControlEngine per loop (auto, eco, grid_limit)
+    float pid_kp[ConfigDefaults::PID_LOOPS];       ///< Proportional gain per loop
+    float pid_ki[ConfigDefaults::PID_LOOPS];       ///< Integral gain per loop
+    float pid_kd[ConfigDefaults::PID_LOOPS];       ///< Derivative gain per loop
+    uint8_t auto_ff;            ///< AUTO feed-forward from load/solar channels (0/1)
+    uint8_t plant_tune;         ///< AUTO plant-gain tuning (0=off, 1=learn, 2=adapt)
+    uint8_t auto_dtc;           ///< AUTO dead-time compensation (0/1)
 
     // Sensor calibration
     float current_threshold;    ///< Minimum current threshold (A)
@@ -77,6 +104,15 @@ struct SystemConfig {
         balance_threshold = ConfigDefaults::BALANCE_THRESHOLD;
         manual_level = ConfigDefaults::MANUAL_LEVEL;
         grid_current_limit = ConfigDefaults::GRID_CURRENT_LIMIT;
+        for (uint8_t i = 0; i < ConfigDefaults::PID_LOOPS; i++) {
+            pid_engine[i] = ConfigDefaults::PID_ENGINE[i];
+            pid_kp[i] = ConfigDefaults::PID_KP[i];
+            pid_ki[i] = ConfigDefaults::PID_KI[i];
+            pid_kd[i] = ConfigDefaults::PID_KD[i];
+        }
+        auto_ff = ConfigDefaults::AUTO_FF;
+        plant_tune = ConfigDefaults::PLANT_TUNE;
+        auto_dtc = ConfigDefaults::AUTO_DTC;
 
         current_threshold = ConfigDefaults::CURRENT_THRESHOLD;
         power_threshold = ConfigDefaults::POWER_THRESHOLD;
@@ -130,6 +166,9 @@ public:
     float getGridCurrentLimit() const { return m_config.grid_current_limit; }
     float getBalanceThreshold() const { return m_config.balance_threshold; }
     uint8_t getManualLevel() const { return m_config.manual_level; }
+    bool isFeedForwardEnabled() const { return m_config.auto_ff != 0; }
+    uint8_t getPlantTuning() const { return m_config.plant_tune; }
+    bool isDeadTimeCompensationEnabled() const { return m_config.auto_dtc != 0; }
     float getCurrentThreshold() const { return m_config.current_threshold; }
     float getPowerThreshold() const { return m_config.power_threshold; }
 
@@ -145,6 +184,29 @@ public:
     bool setCurrentThreshold(float threshold);
     bool setPowerThreshold(float threshold);
 
+    /**
+     * @brief Set the controller engine and gains of one regulating mode
+     * @param loop   0=AUTO, 1=ECO, 2=GRID_LIMIT
+     * @param engine 0=P (legacy step), 1=PI, 2=PID
+     * @param kp, ki, kd Gains, clamped to 0..PID_MAX_GAIN
+     */
+    bool setPidGains(uint8_t loop, uint8_t engine, float kp, float ki, float kd);
+
+    /**
+     * @brief Enable/disable the AUTO load/solar feed-forward
+     */
+    bool setFeedForward(bool enabled);
+
+    /**
+     * @brief Set AUTO plant-gain tuning (0=off, 1=learn, 2=adapt)
+     */
+    bool setPlantTuning(uint8_t mode);
+
+    /**
+     * @brief Enable/disable AUTO dead-time compensation
+     */
+    bool setDeadTimeCompensation(bool enabled);
+
     // ============================================================
     // Bulk Operations
     // ============================================================
@@ -34,6 +34,9 @@
 //   2: Added voltage_driver and nominal_vdc fields to ADCChannelConfig
 constexpr uint16_t HW_CONFIG_VERSION = 2;
 
+/** Per-module rbAmp DRDY lines (= RBAMP_SOURCE_MAX_MODULES) */
+constexpr uint8_t HW_RBAMP_DRDY_LINES = 4;
+
 // ============================================================
 // Configuration Keys (NVS keys, max 15 chars)
 // ============================================================
@@ -110,8 +113,11 @@ namespace HardwareConfigKeys {
     constexpr const char* I2C1_SCL_GPIO     = "i2c1_scl";
     constexpr const char* I2C1_FREQ         = "i2c1_freq";     // stored as uint16 in kHz
     constexpr const char* I2C1_ENABLED      = "i2c1_en";
+    constexpr const char* I2C_MAX_FREQ      = "i2c_maxf";      // adaptive ceiling, uint16 kHz (0=fixed)
     constexpr const char* RBAMP_BUS         = "rbamp_bus";     // rbAmp fleet bus (0/1)
     constexpr const char* RBAMP_DRDY        = "rbamp_drdy";    // rbAmp DRDY GPIO (0xFF=off)
+    constexpr const char* RBAMP_DRDY_MOD[]  = {               // per-module DRDY, uint16 addr<<8|gpio (0=unused)
+        "rbamp_drdy0", "rbamp_drdy1", "rbamp_drdy2", "rbamp_drdy3" };
     constexpr const char* ESPNOW_CHANNEL    = "espnow_ch";     // ESP-NOW WiFi channel (1-13)
     constexpr const char* ESPNOW_ENABLED    = "espnow_en";     // ESP-NOW transport enable
 
@@ -187,8 +193,12 @@ struct HardwareConfig {
     uint8_t i2c1_scl_gpio;      ///< I2C bus-1 SCL pin (default: 23)
     uint32_t i2c1_freq_hz;      ///< I2C bus-1 clock frequency (default: 100000)
     bool i2c1_enabled;          ///< I2C bus-1 enabled (default: false)
+    uint32_t i2c_max_freq_hz;   ///< Adaptive-clock ceiling of both buses (0 = fixed clock, default)
     uint8_t rbamp_i2c_bus;      ///< Bus the rbAmp fleet polls on (0 or 1, default 0)
     int8_t rbamp_drdy_gpio;     ///< rbAmp DRDY GPIO for interrupt-driven poll (-1 = timer poll)
+    // Per-module rbAmp DRDY lines (one GPIO per module, unsynchronised commits)
+    uint8_t rbamp_drdy_addr[HW_RBAMP_DRDY_LINES];   ///< Module address (0 = unused)
+    int8_t rbamp_drdy_line[HW_RBAMP_DRDY_LINES];    ///< Module's DRDY GPIO
 
     // ESP-NOW transport (wireless module bus) — groundwork; nodes come later
     uint8_t espnow_channel;     ///< ESP-NOW WiFi channel (1-13, must match nodes; default 1)
@@ -329,6 +339,13 @@ public:
      */
     bool setI2CBus1(uint8_t sda, uint8_t scl, uint32_t freq_hz, bool enabled);
 
+    /**
+     * @brief Set the adaptive-clock ceiling of both I2C buses and persist it.
+     * @param max_hz ceiling in Hz (up to 400000), or 0 to keep the configured clock
+     * @return true if saved (false above 400 kHz)
+     */
+    bool setI2CMaxFreq(uint32_t max_hz);
+
     /**
      * @brief Assign the rbAmp fleet to an I2C bus (0 or 1) and persist it.
      * @param bus bus number (0 or 1)
@@ -343,6 +360,15 @@ public:
      */
     bool setRbAmpDrdy(int gpio);
 
+    /**
+     * @brief Map an rbAmp module's own DRDY line to a GPIO and persist it.
+     * @param addr module I2C address (0x08..0x77)
+     * @param gpio DRDY input GPIO, or < 0 to remove the module's line
+     * @return true if saved (false on invalid address, GPIO already mapped to
+     *         another module, or all lines taken)
+     */
+    bool setRbAmpModuleDrdy(uint8_t addr, int gpio);
+
     // ============================================================
     // Relay Configuration
     // ============================================================
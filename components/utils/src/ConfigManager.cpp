@@ -207,6 +207,41 @@ bool ConfigManager::setManualLevel(uint8_t level) {
     return saveU8(ConfigKeys::MANUAL_LEVEL, level);
 }
 
+bool ConfigManager::setPidGains(uint8_t loop, uint8_t engine, float kp, float ki, float kd) {
+    if (loop >= ConfigDefaults::PID_LOOPS) return false;
+    auto clampGain = [](float g) {
+        if (!(g >= 0.0f)) return 0.0f;   // also rejects NaN
+        return (g > ConfigDefaults::PID_MAX_GAIN) ? ConfigDefaults::PID_MAX_GAIN : g;
+    };
+    if (engine > 2) engine = 0;
+    m_config.pid_engine[loop] = engine;
+    m_config.pid_kp[loop] = clampGain(kp);
+    m_config.pid_ki[loop] = clampGain(ki);
+    m_config.pid_kd[loop] = clampGain(kd);
+
+    bool ok = saveU8(ConfigKeys::PID_ENGINE[loop], engine);
+    ok &= saveFloat(ConfigKeys::PID_KP[loop], m_config.pid_kp[loop]);
+    ok &= saveFloat(ConfigKeys::PID_KI[loop], m_config.pid_ki[loop]);
+    ok &= saveFloat(ConfigKeys::PID_KD[loop], m_config.pid_kd[loop]);
+    return ok;
+}
+
+bool ConfigManager::setFeedForward(bool enabled) {
+    m_config.auto_ff = enabled ? 1 : 0;
+    return saveU8(ConfigKeys::AUTO_FF, m_config.auto_ff);
+}
+
+bool ConfigManager::setPlantTuning(uint8_t mode) {
+    if (mode > 2) mode = 2;
+    m_config.plant_tune = mode;
+    return saveU8(ConfigKeys::PLANT_TUNE, m_config.plant_tune);
+}
+
+bool ConfigManager::setDeadTimeCompensation(bool enabled) {
+    m_config.auto_dtc = enabled ? 1 : 0;
+    return saveU8(ConfigKeys::AUTO_DTC, m_config.auto_dtc);
+}
+
 bool ConfigManager::setCurrentThreshold(float threshold) {
     if (threshold < 0.0f) threshold = 0.0f;
     if (threshold > 10.0f) threshold = 10.0f;
@@ -243,6 +278,16 @@ bool ConfigManager::loadAll() {
     success &= loadFloat(ConfigKeys::BALANCE_THRESHOLD, m_config.balance_threshold, ConfigDefaults::BALANCE_THRESHOLD);
     success &= loadU8(ConfigKeys::MANUAL_LEVEL, m_config.manual_level, ConfigDefaults::MANUAL_LEVEL);
     success &= loadFloat(ConfigKeys::GRID_CURRENT_LIMIT, m_config.grid_current_limit, ConfigDefaults::GRID_CURRENT_LIMIT);
+    for (uint8_t i = 0; i < ConfigDefaults::PID_LOOPS; i++) {
+        success &= loadU8(ConfigKeys::PID_ENGINE[i], m_config.pid_engine[i], ConfigDefaults::PID_ENGINE[i]);
+        success &= loadFloat(ConfigKeys::PID_KP[i], m_config.pid_kp[i], ConfigDefaults::PID_KP[i]);
+        success &= loadFloat(ConfigKeys::PID_KI[i], m_config.pid_ki[i], ConfigDefaults::PID_KI[i]);
+        success &= loadFloat(ConfigKeys::PID_KD[i], m_config.pid_kd[i], ConfigDefaults::PID_KD[i]);
+    }
+    success &= loadU8(ConfigKeys::AUTO_FF, m_config.auto_ff, ConfigDefaults::AUTO_FF);
+    success &= loadU8(ConfigKeys::PLANT_TUNE, m_config.plant_tune, ConfigDefaults::PLANT_TUNE);
+    if (m_config.plant_tune > 2) m_config.plant_tune = ConfigDefaults::PLANT_TUNE;
+    success &= loadU8(ConfigKeys::AUTO_DTC, m_config.auto_dtc, ConfigDefaults::AUTO_DTC);
 
     // Sensor calibration
     success &= loadFloat(ConfigKeys::CURRENT_THRESHOLD, m_config.current_threshold, ConfigDefaults::CURRENT_THRESHOLD);
@@ -262,6 +307,15 @@ bool ConfigManager::saveAll() {
     success &= saveFloat(ConfigKeys::BALANCE_THRESHOLD, m_config.balance_threshold);
     success &= saveU8(ConfigKeys::MANUAL_LEVEL, m_config.manual_level);
     success &= saveFloat(ConfigKeys::GRID_CURRENT_LIMIT, m_config.grid_current_limit);
+    for (uint8_t i = 0; i < ConfigDefaults::PID_LOOPS; i++) {
+        success &= saveU8(ConfigKeys::PID_ENGINE[i], m_config.pid_engine[i]);
+        success &= saveFloat(ConfigKeys::PID_KP[i], m_config.pid_kp[i]);
+        success &= saveFloat(ConfigKeys::PID_KI[i], m_config.pid_ki[i]);
+        success &= saveFloat(ConfigKeys::PID_KD[i], m_config.pid_kd[i]);
+    }
+    success &= saveU8(ConfigKeys::AUTO_FF, m_config.auto_ff);
+    success &= saveU8(ConfigKeys::PLANT_TUNE, m_config.plant_tune);
+    success &= saveU8(ConfigKeys::AUTO_DTC, m_config.auto_dtc);
 
     success &= saveFloat(ConfigKeys::CURRENT_THRESHOLD, m_config.current_threshold);
     success &= saveFloat(ConfigKeys::POWER_THRESHOLD, m_config.power_threshold);
@@ -288,6 +342,17 @@ void ConfigManager::printConfig() const {
     ESP_LOGI(TAG, "  control_gain:     %.1f", m_config.control_gain);
     ESP_LOGI(TAG, "  balance_threshold: %.1f W", m_config.balance_threshold);
     ESP_LOGI(TAG, "  manual_level:     %u%%", m_config.manual_level);
+    const char* loop_names[] = {"auto", "eco", "grid_limit"};
+    const char* engine_names[] = {"P", "PI", "PID"};
+    for (uint8_t i = 0; i < ConfigDefaults::PID_LOOPS; i++) {
+        ESP_LOGI(TAG, "  pid %-10s   %s kp=%.4f ki=%.4f kd=%.4f", loop_names[i],
+                 engine_names[m_config.pid_engine[i] <= 2 ? m_config.pid_engine[i] : 0],
+                 m_config.pid_kp[i], m_config.pid_ki[i], m_config.pid_kd[i]);
+    }
+    ESP_LOGI(TAG, "  auto_ff:          %s", m_config.auto_ff ? "on" : "off");
+    static const char* tune_names[] = { "off", "learn", "adapt" };
+    ESP_LOGI(TAG, "  plant_tune:       %s", tune_names[m_config.plant_tune <= 2 ? m_config.plant_tune : 0]);
+    ESP_LOGI(TAG, "  auto_dtc:         %s", m_config.auto_dtc ? "on" : "off");
     ESP_LOGI(TAG, "Sensors:");
     ESP_LOGI(TAG, "  current_threshold: %.2f A", m_config.current_threshold);
     ESP_LOGI(TAG, "  power_threshold:  %.1f W", m_config.power_threshold);
@@ -97,8 +97,13 @@ void HardwareConfig::setDefaults() {
     i2c1_scl_gpio = 23;
     i2c1_freq_hz = 100000;
     i2c1_enabled = false;
+    i2c_max_freq_hz = 0;    // adaptive clock off: DimmerLink is specified at 100 kHz
     rbamp_i2c_bus = 0;
     rbamp_drdy_gpio = -1;   // DRDY interrupt-driven poll off by default (timer poll)
+    for (uint8_t i = 0; i < HW_RBAMP_DRDY_LINES; i++) {
+        rbamp_drdy_addr[i] = 0;
+        rbamp_drdy_line[i] = -1;
+    }
 
     // ESP-NOW transport — off by default; channel must match wireless nodes.
     espnow_channel = 1;
@@ -724,6 +729,12 @@ bool HardwareConfigManager::setI2CBus1(uint8_t sda, uint8_t scl, uint32_t freq_h
     return ok;
 }
 
+bool HardwareConfigManager::setI2CMaxFreq(uint32_t max_hz) {
+    if (max_hz > 400000) return false;
+    m_config.i2c_max_freq_hz = max_hz;
+    return saveU16(HardwareConfigKeys::I2C_MAX_FREQ, (uint16_t)(max_hz / 1000));
+}
+
 bool HardwareConfigManager::setRbAmpBus(uint8_t bus) {
     if (bus >= 2) return false;
     m_config.rbamp_i2c_bus = bus;
@@ -736,6 +747,33 @@ bool HardwareConfigManager::setRbAmpDrdy(int gpio) {
     return saveU8(HardwareConfigKeys::RBAMP_DRDY, (uint8_t)v);
 }
 
+bool HardwareConfigManager::setRbAmpModuleDrdy(uint8_t addr, int gpio) {
+    if (addr < 0x08 || addr > 0x77) return false;
+    int slot = -1;
+    int free_slot = -1;
+    for (uint8_t i = 0; i < HW_RBAMP_DRDY_LINES; i++) {
+        if (m_config.rbamp_drdy_addr[i] == addr) {
+            slot = i;
+        } else if (m_config.rbamp_drdy_addr[i] == 0) {
+            if (free_slot < 0) free_slot = i;
+        } else if (gpio >= 0 && m_config.rbamp_drdy_line[i] == gpio) {
+            return false;   // one line per module
+        }
+    }
+    if (gpio < 0) {
+        if (slot < 0) return true;
+        m_config.rbamp_drdy_addr[slot] = 0;
+        m_config.rbamp_drdy_line[slot] = -1;
+        return saveU16(HardwareConfigKeys::RBAMP_DRDY_MOD[slot], 0);
+    }
+    if (slot < 0) slot = free_slot;
+    if (slot < 0) return false;
+    m_config.rbamp_drdy_addr[slot] = addr;
+    m_config.rbamp_drdy_line[slot] = (int8_t)gpio;
+    return saveU16(HardwareConfigKeys::RBAMP_DRDY_MOD[slot],
+                   (uint16_t)((addr << 8) | (uint8_t)gpio));
+}
+
 // ============================================================
 // Relay Configuration
 // ============================================================
@@ -828,8 +866,15 @@ bool HardwareConfigManager::saveAll() {
     success &= saveU8(HardwareConfigKeys::I2C1_SCL_GPIO, m_config.i2c1_scl_gpio);
     success &= saveU16(HardwareConfigKeys::I2C1_FREQ, (uint16_t)(m_config.i2c1_freq_hz / 1000));
     success &= saveBool(HardwareConfigKeys::I2C1_ENABLED, m_config.i2c1_enabled);
+    success &= saveU16(HardwareConfigKeys::I2C_MAX_FREQ, (uint16_t)(m_config.i2c_max_freq_hz / 1000));
     success &= saveU8(HardwareConfigKeys::RBAMP_BUS, m_config.rbamp_i2c_bus);
     success &= saveU8(HardwareConfigKeys::RBAMP_DRDY, (uint8_t)m_config.rbamp_drdy_gpio);
+    for (uint8_t i = 0; i < HW_RBAMP_DRDY_LINES; i++) {
+        const uint16_t packed = m_config.rbamp_drdy_addr[i]
+            ? (uint16_t)((m_config.rbamp_drdy_addr[i] << 8) | (uint8_t)m_config.rbamp_drdy_line[i])
+            : 0;
+        success &= saveU16(HardwareConfigKeys::RBAMP_DRDY_MOD[i], packed);
+    }
     success &= saveU8(HardwareConfigKeys::ESPNOW_CHANNEL, m_config.espnow_channel);
     success &= saveBool(HardwareConfigKeys::ESPNOW_ENABLED, m_config.espnow_enabled);
 
@@ -892,12 +937,23 @@ bool HardwareConfigManager::loadAll() {
         m_config.i2c1_freq_hz = (uint32_t)freq1_khz * 1000;
     }
     loadBool(HardwareConfigKeys::I2C1_ENABLED, m_config.i2c1_enabled, false);
+    {
+        uint16_t max_khz = 0;
+        loadU16(HardwareConfigKeys::I2C_MAX_FREQ, max_khz, 0);
+        m_config.i2c_max_freq_hz = (uint32_t)max_khz * 1000;
+    }
     loadU8(HardwareConfigKeys::RBAMP_BUS, m_config.rbamp_i2c_bus, 0);
     {
         uint8_t drdy = 0xFF;   // 0xFF sentinel = disabled (-1)
         loadU8(HardwareConfigKeys::RBAMP_DRDY, drdy, 0xFF);
         m_config.rbamp_drdy_gpio = (int8_t)drdy;
     }
+    for (uint8_t i = 0; i < HW_RBAMP_DRDY_LINES; i++) {
+        uint16_t packed = 0;   // addr<<8 | gpio, 0 = unused
+        loadU16(HardwareConfigKeys::RBAMP_DRDY_MOD[i], packed, 0);
+        m_config.rbamp_drdy_addr[i] = (uint8_t)(packed >> 8);
+        m_config.rbamp_drdy_line[i] = packed ? (int8_t)(packed & 0xFF) : -1;
+    }
     loadU8(HardwareConfigKeys::ESPNOW_CHANNEL, m_config.espnow_channel, 1);
     loadBool(HardwareConfigKeys::ESPNOW_ENABLED, m_config.espnow_enabled, false);
 
@@ -965,6 +1021,16 @@ void HardwareConfigManager::printConfig() const {
              m_config.i2c_sda_gpio, m_config.i2c_scl_gpio,
              (unsigned long)m_config.i2c_freq_hz,
              m_config.i2c_enabled ? "ENABLED" : "DISABLED");
+    if (m_config.i2c_max_freq_hz) {
+        ESP_LOGI(TAG, "  Adaptive clock up to %lu Hz",
+                 (unsigned long)m_config.i2c_max_freq_hz);
+    }
+    for (uint8_t i = 0; i < HW_RBAMP_DRDY_LINES; i++) {
+        if (m_config.rbamp_drdy_addr[i]) {
+            ESP_LOGI(TAG, "  rbAmp 0x%02X DRDY: GPIO%d",
+                     m_config.rbamp_drdy_addr[i], m_config.rbamp_drdy_line[i]);
+        }
+    }
 
     // Internal ADC
     ESP_LOGI(TAG, "Internal ADC: %s", m_config.adc_enabled ? "ENABLED" : "DISABLED");
@@ -18,13 +18,17 @@ extern "C" {
 #include "relay_manager.h"
 #include "relay_gpio.h"
 #include "i2c_bus.h"
+#include "i2c_bus_async.h"
+#include "i2c_bus_health.h"
 #include "dimmerlink_manager.h"
 #include "device_registry.h"
 #include "sensor_hub.h"
 #include "rbamp_source.h"
 #include "esp_now_source.h"
+#include "esp_now_energy.h"
 #include "espnow_proto.h"
 #include "acrouter_events.h"
+#include "acrouter_meas_ring.h"
 #include "acrouter_measurements.h"
 #include "esp_event.h"
 #include "esp_timer.h"
@@ -1331,13 +1335,23 @@ void SerialCommand::executeCommand(const char* line) {
         return;
     }
 
-    // dev-scan [bus] - on-demand quiescent scan + non-destructive reconcile.
+    // dev-scan [bus] - on-demand incremental scan + non-destructive reconcile
+    // (known addresses first, then a sliced sweep; polling keeps running).
     if (strcmp(cmd, "dev-scan") == 0) {
         unsigned bus = 0;
         if (arg[0]) sscanf(arg, "%u", &bus);
         esp_err_t err = devreg_scan_i2c((uint8_t)bus);
         ESP_LOGI(TAG, "dev-scan bus %u: %s (registry now %u entries)",
                  bus, esp_err_to_name(err), (unsigned)devreg_count());
+        if (err == ESP_OK) {
+            devreg_scan_stats_t ss;
+            devreg_get_scan_stats(&ss);
+            ESP_LOGI(TAG, "  known %u/%u online in %lums, swept %u (+%u new) in %lums, "
+                          "polling paused %lums, %u identify reads (%u UID-cache hits)%s",
+                     ss.known_online, ss.known, (unsigned long)ss.known_ms, ss.swept,
+                     ss.found_new, (unsigned long)ss.total_ms, (unsigned long)ss.quiesce_ms,
+                     ss.reads, ss.uid_hits, ss.rbamp_rescan ? ", rbAmp rescan requested" : "");
+        }
         return;
     }
 
@@ -1400,6 +1414,20 @@ void SerialCommand::executeCommand(const char* line) {
         return;
     }
 
+    // hw-i2c-maxf <khz|0> - adaptive I2C clock ceiling of both buses (persisted).
+    // The configured clock stays the floor; 0 keeps the bus at it.
+    if (strcmp(cmd, "hw-i2c-maxf") == 0) {
+        unsigned khz = 0;
+        if (!arg[0] || sscanf(arg, "%u", &khz) != 1) {
+            ESP_LOGI(TAG, "Usage: hw-i2c-maxf <khz|0>  (e.g. hw-i2c-maxf 400)");
+            return;
+        }
+        bool ok = HardwareConfigManager::getInstance().setI2CMaxFreq((uint32_t)khz * 1000);
+        ESP_LOGI(TAG, "hw-i2c-maxf %u -> %s (reboot to apply)",
+                 khz, ok ? "saved" : "FAILED (max 400 kHz)");
+        return;
+    }
+
     // hw-rbamp-bus <0|1> - assign the rbAmp fleet to an I2C bus (persisted).
     if (strcmp(cmd, "hw-rbamp-bus") == 0) {
         int bus = -1;
@@ -1413,18 +1441,27 @@ void SerialCommand::executeCommand(const char* line) {
         return;
     }
 
-    // hw-rbamp-drdy <gpio|-1> - enable rbAmp DRDY interrupt-driven polling on a
-    // GPIO (persisted). -1 = fixed-cadence timer poll. Single critical module;
-    // a multi-module fleet has unsynchronised DRDY, use the timer poll there.
+    // hw-rbamp-drdy <gpio|-1> [addr] - rbAmp DRDY interrupt-driven polling
+    // (persisted). Without addr: fleet-wide line, any edge reads the fleet (single
+    // critical module). With addr: that module's own DRDY line; the fleet is read
+    // once every commissioned module has fresh data. -1 removes the line.
     if (strcmp(cmd, "hw-rbamp-drdy") == 0) {
         int gpio = -2;
-        if (!arg[0] || sscanf(arg, "%d", &gpio) != 1) {
-            ESP_LOGI(TAG, "Usage: hw-rbamp-drdy <gpio|-1>  (e.g. hw-rbamp-drdy 33)");
+        unsigned addr = 0;
+        int n = arg[0] ? sscanf(arg, "%d %i", &gpio, &addr) : 0;
+        if (n < 1) {
+            ESP_LOGI(TAG, "Usage: hw-rbamp-drdy <gpio|-1> [addr]  (e.g. hw-rbamp-drdy 33 0x40)");
             return;
         }
-        bool ok = HardwareConfigManager::getInstance().setRbAmpDrdy(gpio);
-        ESP_LOGI(TAG, "hw-rbamp-drdy %d -> %s (reboot to apply)",
-                 gpio, ok ? "saved" : "FAILED");
+        if (n == 1) {
+            bool ok = HardwareConfigManager::getInstance().setRbAmpDrdy(gpio);
+            ESP_LOGI(TAG, "hw-rbamp-drdy %d -> %s (reboot to apply)",
+                     gpio, ok ? "saved" : "FAILED");
+            return;
+        }
+        bool ok = HardwareConfigManager::getInstance().setRbAmpModuleDrdy((uint8_t)addr, gpio);
+        ESP_LOGI(TAG, "hw-rbamp-drdy %d 0x%02X -> %s (reboot to apply)", gpio, addr,
+                 ok ? "saved" : "FAILED (addr 0x08..0x77, GPIO free, max 4 lines)");
         return;
     }
 
@@ -1572,18 +1609,37 @@ void SerialCommand::executeCommand(const char* line) {
     // v2.0: rbamp-status | rbamp-config <addr_hex> <role>
     // ================================================================
     if (strcmp(cmd, "rbamp-status") == 0) {
-        rbamp_source_module_cfg_t roles[4];
+        rbamp_source_module_cfg_t roles[RBAMP_SOURCE_MAX_ROLES];
         size_t n = 0;
-        rbamp_source_get_roles(roles, 4, &n);
+        rbamp_source_get_roles(roles, RBAMP_SOURCE_MAX_ROLES, &n);
         const char* role_names[] = {"none", "grid", "solar", "load", "voltage"};
         ESP_LOGI(TAG, "=== rbAmp Source ===");
         ESP_LOGI(TAG, "  alive modules: %u", (unsigned)rbamp_source_alive_count());
         ESP_LOGI(TAG, "  configured roles: %u", (unsigned)n);
         for (size_t i = 0; i < n; i++) {
             uint8_t r = (uint8_t)roles[i].role;
-            ESP_LOGI(TAG, "  [%u] 0x%02X -> %s", (unsigned)i, roles[i].i2c_addr,
-                     r < 5 ? role_names[r] : "?");
+            ESP_LOGI(TAG, "  [%u] 0x%02X ch%u -> %s", (unsigned)i, roles[i].i2c_addr,
+                     roles[i].channel, r < 5 ? role_names[r] : "?");
         }
+        rbamp_source_module_info_t mods[4];
+        size_t nm = 0;
+        rbamp_source_get_modules(mods, 4, &nm);
+        for (size_t i = 0; i < nm; i++) {
+            uint8_t ct = 0;
+            rbamp_source_get_ct_model(mods[i].i2c_addr, &ct);
+            ESP_LOGI(TAG, "  0x%02X fw=0x%02X variant=0x%02X ct=%u %s", mods[i].i2c_addr,
+                     mods[i].fw_version, mods[i].hw_variant, ct,
+                     mods[i].online ? "online" : "offline");
+        }
+        ESP_LOGI(TAG, "  config reads: %lu (cached; rbamp-refresh to re-read)",
+                 (unsigned long)rbamp_source_config_reads());
+        return;
+    }
+
+    if (strcmp(cmd, "rbamp-refresh") == 0) {
+        esp_err_t rr = rbamp_source_refresh_config();
+        ESP_LOGI(TAG, "rbamp-refresh: %s", rr == ESP_OK ? "module config re-read requested"
+                                                        : "rbAmp source not initialized");
         return;
     }
 
@@ -1643,8 +1699,9 @@ void SerialCommand::executeCommand(const char* line) {
 
     if (strcmp(cmd, "rbamp-config") == 0) {
         char addr_str[8] = {}, role_str[16] = {};
-        if (!arg[0] || sscanf(arg, "%7s %15s", addr_str, role_str) < 2) {
-            ESP_LOGI(TAG, "Usage: rbamp-config <addr_hex> <role>");
+        unsigned ch = 0;
+        if (!arg[0] || sscanf(arg, "%7s %15s %u", addr_str, role_str, &ch) < 2) {
+            ESP_LOGI(TAG, "Usage: rbamp-config <addr_hex> <role> [channel]");
             ESP_LOGI(TAG, "  roles: grid solar load voltage none");
             return;
         }
@@ -1656,11 +1713,11 @@ void SerialCommand::executeCommand(const char* line) {
         else if (strcmp(role_str, "voltage") == 0) role = RBAMP_ROLE_VOLTAGE;
         else if (strcmp(role_str, "none") == 0)    role = RBAMP_ROLE_NONE;
         else { ESP_LOGE(TAG, "Unknown role: %s (grid|solar|load|voltage|none)", role_str); return; }
-        if (rbamp_source_set_role(addr, role) == ESP_OK) {
+        if (rbamp_source_set_channel_role(addr, (uint8_t)ch, role) == ESP_OK) {
             rbamp_source_save_config();
-            ESP_LOGI(TAG, "rbAmp 0x%02X -> %s (saved to NVS)", addr, role_str);
+            ESP_LOGI(TAG, "rbAmp 0x%02X ch%u -> %s (saved to NVS)", addr, ch, role_str);
         } else {
-            ESP_LOGE(TAG, "Failed to set role (table full?)");
+            ESP_LOGE(TAG, "Failed to set role (channel 0-2; table full?)");
         }
         return;
     }
@@ -1668,7 +1725,7 @@ void SerialCommand::executeCommand(const char* line) {
 
 #if CONFIG_ACROUTER_ESPNOW_SOURCE
     // ================================================================
-    // v2.0: espnow-status | espnow-config <mac> <role>
+    // v2.0: espnow-status | espnow-config <mac> <role> [channel]
     // ================================================================
     if (strcmp(cmd, "espnow-status") == 0) {
         esp_now_source_node_info_t nodes[4];
@@ -1677,6 +1734,14 @@ void SerialCommand::executeCommand(const char* line) {
         const char* role_names[] = {"none", "grid", "solar", "load", "voltage"};
         ESP_LOGI(TAG, "=== ESP-NOW Source ===");
         ESP_LOGI(TAG, "  seen nodes: %u", (unsigned)esp_now_source_seen_count());
+        esp_now_source_rx_stats_t rx;
+        esp_now_source_get_rx_stats(&rx);
+        ESP_LOGI(TAG, "  rx: frames=%lu posts=%lu coalesced=%lu wakeups=%lu",
+                 (unsigned long)rx.frames, (unsigned long)rx.posts,
+                 (unsigned long)rx.coalesced, (unsigned long)rx.wakeups);
+        ESP_LOGI(TAG, "  rx->hub latency: p50=%luus p99=%luus max=%luus (n=%lu)",
+                 (unsigned long)rx.p50_us, (unsigned long)rx.p99_us,
+                 (unsigned long)rx.max_us, (unsigned long)rx.samples);
         for (size_t i = 0; i < n; i++) {
             const uint8_t* m = nodes[i].mac;
             uint8_t r = (uint8_t)nodes[i].role;
@@ -1685,6 +1750,13 @@ void SerialCommand::executeCommand(const char* line) {
                      nodes[i].online ? "online" : "offline",
                      (double)nodes[i].voltage, (double)nodes[i].current,
                      (double)nodes[i].power, (double)nodes[i].frequency);
+            for (uint8_t c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+                if (!(nodes[i].ch_mask & (1u << c)) && nodes[i].ch_role[c] == ESPNOW_ROLE_NONE) continue;
+                uint8_t cr = (uint8_t)nodes[i].ch_role[c];
+                ESP_LOGI(TAG, "    ch%u %s I=%.3f P=%.1f%s", c, cr < 5 ? role_names[cr] : "?",
+                         (double)nodes[i].ch_current[c], (double)nodes[i].ch_power[c],
+                         (nodes[i].ch_mask & (1u << c)) ? "" : " (not in last frame)");
+            }
         }
         return;
     }
@@ -1692,9 +1764,10 @@ void SerialCommand::executeCommand(const char* line) {
     if (strcmp(cmd, "espnow-config") == 0) {
         unsigned mac[6];
         char role_str[16] = {};
-        if (!arg[0] || sscanf(arg, "%x:%x:%x:%x:%x:%x %15s",
-                              &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5], role_str) < 7) {
-            ESP_LOGI(TAG, "Usage: espnow-config <AA:BB:CC:DD:EE:FF> <role>");
+        unsigned ch = 0;
+        if (!arg[0] || sscanf(arg, "%x:%x:%x:%x:%x:%x %15s %u",
+                              &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5], role_str, &ch) < 7) {
+            ESP_LOGI(TAG, "Usage: espnow-config <AA:BB:CC:DD:EE:FF> <role> [channel]");
             ESP_LOGI(TAG, "  roles: grid solar load voltage none");
             return;
         }
@@ -1707,30 +1780,124 @@ void SerialCommand::executeCommand(const char* line) {
         else if (strcmp(role_str, "voltage") == 0) role = ESPNOW_ROLE_VOLTAGE;
         else if (strcmp(role_str, "none") == 0)    role = ESPNOW_ROLE_NONE;
         else { ESP_LOGE(TAG, "Unknown role: %s (grid|solar|load|voltage|none)", role_str); return; }
-        if (esp_now_source_set_role(m, role) == ESP_OK) {
+        if (ch < ESP_NOW_SOURCE_MAX_NODE_CH &&
+            esp_now_source_set_channel_role(m, (uint8_t)ch, role) == ESP_OK) {
             esp_now_source_save_config();
-            ESP_LOGI(TAG, "ESP-NOW %02X:%02X:%02X:%02X:%02X:%02X -> %s (saved to NVS)",
-                     m[0], m[1], m[2], m[3], m[4], m[5], role_str);
+            ESP_LOGI(TAG, "ESP-NOW %02X:%02X:%02X:%02X:%02X:%02X ch%u -> %s (saved to NVS)",
+                     m[0], m[1], m[2], m[3], m[4], m[5], ch, role_str);
+        } else {
+            ESP_LOGE(TAG, "Failed to set role (channel 0-%d; table full?)", ESP_NOW_SOURCE_MAX_NODE_CH - 1);
+        }
+        return;
+    }
+
+    // espnow-energy [flush | reset [mac]] - PERIOD energy totals per node/channel
+    if (strcmp(cmd, "espnow-energy") == 0) {
+        if (strncmp(arg, "flush", 5) == 0) {
+            ESP_LOGI(TAG, "Energy flush: %s", esp_err_to_name(esp_now_energy_flush()));
+            return;
+        }
+        if (strncmp(arg, "reset", 5) == 0) {
+            unsigned mac[6];
+            if (sscanf(arg + 5, " %x:%x:%x:%x:%x:%x",
+                       &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) == 6) {
+                uint8_t m[6];
+                for (int i = 0; i < 6; i++) m[i] = (uint8_t)mac[i];
+                ESP_LOGI(TAG, "Energy reset: %s", esp_err_to_name(esp_now_energy_reset(m)));
+            } else {
+                ESP_LOGI(TAG, "Energy reset (all nodes): %s", esp_err_to_name(esp_now_energy_reset(NULL)));
+            }
+            return;
+        }
+        esp_now_energy_node_t nodes[ESP_NOW_ENERGY_NODES];
+        size_t n = 0;
+        esp_now_energy_get(nodes, ESP_NOW_ENERGY_NODES, &n);
+        esp_now_energy_stats_t st;
+        esp_now_energy_get_stats(&st);
+        ESP_LOGI(TAG, "=== ESP-NOW Energy (%u node(s)) ===", (unsigned)n);
+        ESP_LOGI(TAG, "  commits=%lu (every %ds) %s full-rejects=%lu",
+                 (unsigned long)st.commits, (int)st.commit_interval_s,
+                 st.dirty ? "pending" : "clean", (unsigned long)st.rejected_full);
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t* m = nodes[i].mac;
+            ESP_LOGI(TAG, "  %02X:%02X:%02X:%02X:%02X:%02X frames=%lu dup=%lu skipped=%lu restarts=%lu",
+                     m[0], m[1], m[2], m[3], m[4], m[5], (unsigned long)nodes[i].frames,
+                     (unsigned long)nodes[i].duplicates, (unsigned long)nodes[i].skipped,
+                     (unsigned long)nodes[i].restarts);
+            for (uint8_t c = 0; c < ESP_NOW_SOURCE_MAX_NODE_CH; c++) {
+                if (!(nodes[i].ch_mask & (1u << c))) continue;
+                const esp_now_energy_channel_t* e = &nodes[i].ch[c];
+                ESP_LOGI(TAG, "    ch%u import=%.3fkWh export=%.3fkWh periods=%lu type=%u", c,
+                         e->import_wh / 1000.0, e->export_wh / 1000.0,
+                         (unsigned long)e->periods, e->period_type);
+            }
+        }
+        return;
+    }
+
+    // espnow-sync - time-master counters + per-node offset/jitter (from NODE_STATS)
+    if (strcmp(cmd, "espnow-sync") == 0) {
+        esp_now_source_sync_stats_t st;
+        esp_now_source_sync_node_t nodes[ESP_NOW_SOURCE_MAX_NODES];
+        size_t n = 0;
+        esp_now_source_get_sync(&st, nodes, ESP_NOW_SOURCE_MAX_NODES, &n);
+        ESP_LOGI(TAG, "=== ESP-NOW Time Master ===");
+        if (st.enabled) {
+            ESP_LOGI(TAG, "  beacon every %lums, epoch %08lx, id %lu: beacons=%lu followups=%lu tx_fail=%lu",
+                     (unsigned long)st.interval_ms, (unsigned long)st.epoch, (unsigned long)st.beacon_id,
+                     (unsigned long)st.beacons, (unsigned long)st.followups, (unsigned long)st.tx_fail);
         } else {
-            ESP_LOGE(TAG, "Failed to set role (table full?)");
+            ESP_LOGI(TAG, "  beacons off (CONFIG_ACROUTER_ESPNOW_SYNC_BEACON_MS=0)");
+        }
+        ESP_LOGI(TAG, "  time_resp=%lu unanswered(no NTP)=%lu latches=%lu",
+                 (unsigned long)st.time_resps, (unsigned long)st.time_unset, (unsigned long)st.latches);
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t* m = nodes[i].mac;
+            if (nodes[i].age_ms == UINT32_MAX) {
+                ESP_LOGI(TAG, "  %02X:%02X:%02X:%02X:%02X:%02X no NODE_STATS yet (time_req=%lu)",
+                         m[0], m[1], m[2], m[3], m[4], m[5], (unsigned long)nodes[i].time_reqs);
+                continue;
+            }
+            ESP_LOGI(TAG, "  %02X:%02X:%02X:%02X:%02X:%02X %s offset=%.1fus jitter=%.1fus max=%.1fus "
+                     "skew=%.2fppm beacons=%lu missed=%lu fits=%lu",
+                     m[0], m[1], m[2], m[3], m[4], m[5], nodes[i].online ? "online" : "stale",
+                     (double)nodes[i].offset_us, (double)nodes[i].jitter_us,
+                     (double)nodes[i].max_abs_us, (double)nodes[i].skew_ppm,
+                     (unsigned long)nodes[i].beacons_recv, (unsigned long)nodes[i].beacons_missed,
+                     (unsigned long)nodes[i].fits);
         }
         return;
     }
 
+    // espnow-latch - LATCH_NOW to every sensor node (all close their period at once)
+    if (strcmp(cmd, "espnow-latch") == 0) {
+        size_t sent = 0;
+        esp_err_t err = esp_now_source_latch_now(RBN_LATCH_REASON_MANUAL, &sent);
+        ESP_LOGI(TAG, "LATCH_NOW: %s (%u node(s))", esp_err_to_name(err), (unsigned)sent);
+        return;
+    }
+
     // espnow-out - list discovered ESP-NOW output nodes (dimmer/relay) + per-output state
     if (strcmp(cmd, "espnow-out") == 0) {
         esp_now_source_output_node_info_t nodes[ESP_NOW_SOURCE_OUT_NODES_MAX];
         size_t n = 0;
         esp_now_source_get_output_nodes(nodes, ESP_NOW_SOURCE_OUT_NODES_MAX, &n);
         ESP_LOGI(TAG, "=== ESP-NOW Output Nodes (%u) ===", (unsigned)n);
+        esp_now_source_out_stats_t tx;
+        esp_now_source_get_out_stats(&tx);
+        ESP_LOGI(TAG, "  tx: frames=%lu (batched %lu) values=%lu digests=%lu resyncs=%lu unchanged=%lu fail=%lu",
+                 (unsigned long)tx.frames, (unsigned long)tx.batched, (unsigned long)tx.items,
+                 (unsigned long)tx.digests, (unsigned long)tx.resyncs,
+                 (unsigned long)tx.unchanged, (unsigned long)tx.send_fail);
         for (size_t i = 0; i < n; i++) {
             const uint8_t* m = nodes[i].mac;
             const char* fam = nodes[i].family == RBN_FAMILY_DIMMER ? "dimmer"
                             : nodes[i].family == RBN_FAMILY_RELAY  ? "relay" : "?";
-            ESP_LOGI(TAG, "  %02X:%02X:%02X:%02X:%02X:%02X %s %s%s outs=%u",
+            ESP_LOGI(TAG, "  %02X:%02X:%02X:%02X:%02X:%02X %s %s%s outs=%u%s",
                      m[0], m[1], m[2], m[3], m[4], m[5], fam,
                      nodes[i].online ? "online" : "offline",
-                     nodes[i].failsafe ? " FAILSAFE" : "", nodes[i].out_count);
+                     nodes[i].failsafe ? " FAILSAFE" : "", nodes[i].out_count,
+                     nodes[i].batch ? " batch" : "");
             for (uint8_t k = 0; k < nodes[i].out_count && k < ESP_NOW_SOURCE_OUT_PER_NODE; k++) {
                 const esp_now_source_output_info_t* o = &nodes[i].outputs[k];
                 ESP_LOGI(TAG, "    out[%u] kind=%u range %u..%u desired=%u%s applied=%u result=%u",
@@ -1822,6 +1989,34 @@ void SerialCommand::executeCommand(const char* line) {
                          slot_names[i], s->value, src, s->priority);
             }
         }
+        sensor_hub_stats_t hs;
+        sensor_hub_get_stats(&hs);
+        ESP_LOGI(TAG, "  Merge: %s epoch=%lums expect=%s  frames/s=%.1f merges/s=%.1f",
+                 hs.mode == SH_MERGE_EPOCH ? "epoch" : "per-frame",
+                 (unsigned long)hs.epoch_ms,
+                 hs.expected_mask ? "mask" : "auto",
+                 hs.frames_per_s, hs.merges_per_s);
+        ESP_LOGI(TAG, "         frames=%lu merges=%lu suppressed=%lu complete=%lu deadline=%lu",
+                 (unsigned long)hs.frames_in, (unsigned long)hs.merges,
+                 (unsigned long)hs.frames_suppressed,
+                 (unsigned long)hs.epochs_complete, (unsigned long)hs.epochs_deadline);
+        ESP_LOGI(TAG, "         snapshot reader retries=%lu", (unsigned long)hs.snapshot_retries);
+        return;
+    }
+
+    // sensor-hub-merge <epoch|frame> [ms] - select merge scheduling
+    if (strcmp(cmd, "sensor-hub-merge") == 0) {
+        char mode_str[8] = {};
+        unsigned ms = 0;
+        int n = arg[0] ? sscanf(arg, "%7s %u", mode_str, &ms) : 0;
+        if (n < 1 || (strcmp(mode_str, "epoch") != 0 && strcmp(mode_str, "frame") != 0)) {
+            ESP_LOGI(TAG, "Usage: sensor-hub-merge <epoch|frame> [epoch_ms %d..%d]",
+                     SENSOR_HUB_EPOCH_MIN_MS, SENSOR_HUB_EPOCH_MAX_MS);
+            return;
+        }
+        if (n >= 2) sensor_hub_set_epoch_ms(ms);
+        sensor_hub_set_merge_mode(strcmp(mode_str, "epoch") == 0 ? SH_MERGE_EPOCH
+                                                                 : SH_MERGE_PER_FRAME);
         return;
     }
 
@@ -1836,10 +2031,139 @@ void SerialCommand::executeCommand(const char* line) {
         ESP_LOGI(TAG, "=== Timing / I2C poll cadence ===");
         ESP_LOGI(TAG, "  rbAmp poll:  last=%luus avg=%luus cycles=%lu",
                  (unsigned long)rb_last, (unsigned long)rb_avg, (unsigned long)rb_cnt);
+        rbamp_source_drdy_stats_t drdy;
+        rbamp_source_get_drdy_stats(&drdy);
+        if (drdy.n_lines > 0) {
+            ESP_LOGI(TAG, "               DRDY rounds complete=%lu skew=%lu timer=%lu",
+                     (unsigned long)drdy.rounds_complete, (unsigned long)drdy.rounds_skew,
+                     (unsigned long)drdy.rounds_timer);
+            for (size_t i = 0; i < drdy.n_lines; i++) {
+                const rbamp_source_drdy_line_t& l = drdy.lines[i];
+                ESP_LOGI(TAG, "               0x%02X GPIO%d%s edges=%lu lat avg=%luus max=%luus",
+                         l.i2c_addr, l.gpio, l.armed ? "" : " (off)",
+                         (unsigned long)l.edges, (unsigned long)l.lat_avg_us,
+                         (unsigned long)l.lat_max_us);
+            }
+        }
         ESP_LOGI(TAG, "  DimmerLink:  last=%luus avg=%luus cycles=%lu",
                  (unsigned long)dl_last, (unsigned long)dl_avg, (unsigned long)dl_cnt);
+        uint16_t dl_reads = 0, dl_unplanned = 0;
+        dl_manager_get_poll_reads(&dl_reads, &dl_unplanned);
+        ESP_LOGI(TAG, "               reads/cycle=%u (burst-planned; %u unplanned)",
+                 dl_reads, dl_unplanned);
+        const HardwareConfig& hw = HardwareConfigManager::getInstance().getConfig();
+        int util_pm[I2C_BUS_MAX] = { -1, -1 };
+        for (uint8_t b = 0; b < I2C_BUS_MAX; b++) {
+            i2c_bus_cache_stats_t cs;
+            if (i2c_bus_get_cache_stats(b, &cs) != ESP_OK) continue;
+            uint32_t lookups = cs.hits + cs.misses;
+            ESP_LOGI(TAG, "  I2C%u handles: %u/%d cached hit=%lu%% (%lu/%lu) evict=%lu inval=%lu",
+                     b, cs.cached, I2C_BUS_HANDLE_CACHE_SIZE,
+                     (unsigned long)(lookups ? (uint64_t)cs.hits * 100 / lookups : 0),
+                     (unsigned long)cs.hits, (unsigned long)lookups,
+                     (unsigned long)cs.evictions, (unsigned long)cs.invalidations);
+            // Every hit skips one add+rm pair; spread over the DimmerLink cycles
+            // that issue nearly all of them.
+            uint32_t per_xfer = cs.add_us_avg + cs.rm_us_avg;
+            ESP_LOGI(TAG, "               add=%luus rm=%luus -> saved ~%luus per DimmerLink cycle",
+                     (unsigned long)cs.add_us_avg, (unsigned long)cs.rm_us_avg,
+                     (unsigned long)(dl_cnt ? (uint64_t)cs.hits * per_xfer / dl_cnt : 0));
+            i2c_bus_async_stats_t qs;
+            if (i2c_bus_async_get_stats(b, &qs) == ESP_OK && qs.running) {
+                ESP_LOGI(TAG, "               queue: %u/%d (max %u) wait act=%lu/%luus tlm=%lu/%luus (avg/max)",
+                         qs.queued, I2C_BUS_ASYNC_DEPTH, qs.queued_max,
+                         (unsigned long)qs.wait_us_avg[I2C_BUS_PRIO_ACTUATION],
+                         (unsigned long)qs.wait_us_max[I2C_BUS_PRIO_ACTUATION],
+                         (unsigned long)qs.wait_us_avg[I2C_BUS_PRIO_TELEMETRY],
+                         (unsigned long)qs.wait_us_max[I2C_BUS_PRIO_TELEMETRY]);
+                ESP_LOGI(TAG, "               act=%lu tlm=%lu bg=%lu failed=%lu expired=%lu rejected=%lu",
+                         (unsigned long)qs.completed[I2C_BUS_PRIO_ACTUATION],
+                         (unsigned long)qs.completed[I2C_BUS_PRIO_TELEMETRY],
+                         (unsigned long)qs.completed[I2C_BUS_PRIO_BACKGROUND],
+                         (unsigned long)qs.failed, (unsigned long)qs.expired,
+                         (unsigned long)qs.rejected);
+            }
+            i2c_bus_util_t ut;
+            if (i2c_bus_get_utilisation(b, &ut) == ESP_OK) {
+                unsigned mods = dl_manager_get_bus_count(b);
+                if (hw.rbamp_i2c_bus == b) mods += (unsigned)rbamp_source_alive_count();
+                // Bus time per 5 Hz cycle, and how many more modules of the current
+                // mix fit under an 80 % ceiling (the rest is actuation slack).
+                const uint32_t cycle_us = DL_DEFAULT_POLL_MS * 1000;
+                uint32_t cycles   = ut.window_us / cycle_us;
+                uint32_t per_cyc  = cycles ? ut.busy_us / cycles : ut.busy_us;
+                uint32_t per_mod  = mods ? per_cyc / mods : 0;
+                int32_t  room     = (int32_t)(cycle_us * 8 / 10) - (int32_t)per_cyc;
+                util_pm[b] = ut.util_permille;
+                ESP_LOGI(TAG, "               util=%u.%u%% (peak %u.%u%%) busy=%luus/cycle modules=%u headroom=%ld module(s)",
+                         ut.util_permille / 10, ut.util_permille % 10,
+                         ut.peak_permille / 10, ut.peak_permille % 10,
+                         (unsigned long)per_cyc, mods,
+                         (long)(per_mod ? (room > 0 ? room / (int32_t)per_mod : 0) : -1));
+            }
+            i2c_bus_health_t hl;
+            if (i2c_bus_get_health(b, &hl) == ESP_OK) {
+                ESP_LOGI(TAG, "               clock=%lukHz%s (up %lu / down %lu) backed-off=%u",
+                         (unsigned long)(hl.freq_hz / 1000),
+                         hl.adaptive ? " adaptive" : " fixed",
+                         (unsigned long)hl.steps_up, (unsigned long)hl.steps_down,
+                         hl.backed_off);
+                static const uint32_t bounds[I2C_BUS_LAT_BUCKETS - 1] = I2C_BUS_LAT_BOUNDS_US;
+                i2c_bus_dev_health_t dh;
+                for (uint8_t i = 0; i2c_bus_get_device_health(b, i, &dh) == ESP_OK; i++) {
+                    // p99 as the upper bound of the bucket that holds it
+                    uint32_t total = 0, acc = 0;
+                    for (int k = 0; k < I2C_BUS_LAT_BUCKETS; k++) total += dh.lat_hist[k];
+                    int k99 = 0;
+                    while (k99 < I2C_BUS_LAT_BUCKETS - 1 &&
+                           (acc += dh.lat_hist[k99]) * 100 < total * 99) k99++;
+                    char p99[12];
+                    if (k99 < I2C_BUS_LAT_BUCKETS - 1) snprintf(p99, sizeof(p99), "<%luus", (unsigned long)bounds[k99]);
+                    else snprintf(p99, sizeof(p99), ">=%luus", (unsigned long)bounds[k99 - 1]);
+                    ESP_LOGI(TAG, "               0x%02X ok=%lu nack=%lu timeout=%lu other=%lu p99%s max=%luus%s",
+                             dh.addr, (unsigned long)dh.ok, (unsigned long)dh.nack,
+                             (unsigned long)dh.timeout, (unsigned long)dh.other, p99,
+                             (unsigned long)dh.lat_us_max,
+                             dh.backoff_level ? " BACKOFF" : "");
+                    if (dh.backoff_level) {
+                        ESP_LOGI(TAG, "                    next probe in %lums, %lu skipped",
+                                 (unsigned long)dh.backoff_left_ms, (unsigned long)dh.skipped);
+                    }
+                }
+            }
+        }
+        if (util_pm[0] >= 0 && util_pm[1] >= 0) {
+            // Placement: modules are wired to a bus, so this is advice — rbAmp
+            // follows `rbamp_bus`, a DimmerLink module its registered bus.
+            int hi = util_pm[0] >= util_pm[1] ? 0 : 1;
+            if (util_pm[hi] >= 400 && util_pm[hi] > 2 * util_pm[1 - hi]) {
+                ESP_LOGI(TAG, "  Placement:   bus %d carries %d.%d%% vs %d.%d%% on bus %d — move modules to bus %d",
+                         hi, util_pm[hi] / 10, util_pm[hi] % 10,
+                         util_pm[1 - hi] / 10, util_pm[1 - hi] % 10, 1 - hi, 1 - hi);
+            }
+        }
+        sensor_hub_stats_t hs;
+        sensor_hub_get_stats(&hs);
         ESP_LOGI(TAG, "  SensorHub:   merges=%lu (control loop runs 1:1 per merge)",
                  (unsigned long)st.merge_count);
+        ESP_LOGI(TAG, "               %s: frames/s=%.1f merges/s=%.1f suppressed=%lu",
+                 hs.mode == SH_MERGE_EPOCH ? "epoch" : "per-frame",
+                 hs.frames_per_s, hs.merges_per_s, (unsigned long)hs.frames_suppressed);
+        acrouter_meas_ring_stats_t rs;
+        acrouter_meas_ring_get_stats(&rs);
+        ESP_LOGI(TAG, "  MeasRing:    %s pub=%lu cons=%lu drop=%lu evt-fallback=%lu hwm=%lu/%d",
+                 acrouter_meas_ring_attached() ? "ctrl-task" : "detached",
+                 (unsigned long)rs.published, (unsigned long)rs.consumed,
+                 (unsigned long)rs.dropped, (unsigned long)rs.fallback,
+                 (unsigned long)rs.high_water, ACROUTER_MEAS_RING_DEPTH);
+        if (m_router) {
+            ControlLatency lat;
+            m_router->getControlLatency(lat);
+            ESP_LOGI(TAG, "  Control:     acq->output p50=%.0fms p99=%.0fms max=%.0fms (n=%lu) age=%.0fms",
+                     lat.p50_ms, lat.p99_ms, lat.max_ms, (unsigned long)lat.samples, lat.age_ms);
+            ESP_LOGI(TAG, "               dead-time comp=%s pending=%+.0fW",
+                     lat.deadtime_comp ? "on" : "off", lat.pending_w);
+        }
         ESP_LOGI(TAG, "  I2C source active: %s", sensor_hub_has_i2c_source() ? "Y" : "N");
         ESP_LOGI(TAG, "  (poll interval target 200ms/5Hz; last/avg = I2C bus time per cycle)");
         return;
@@ -1871,6 +2195,14 @@ bool SerialCommand::handleConfigCommand(const char* cmd, const char* arg) {
             m_router->setControlGain(cfg.control_gain);
             m_router->setBalanceThreshold(cfg.balance_threshold);
             m_router->setGridCurrentLimit(cfg.grid_current_limit);
+            for (uint8_t i = 0; i < ConfigDefaults::PID_LOOPS; i++) {
+                m_router->setPidGains(static_cast<PidLoop>(i),
+                                      PidGains(static_cast<ControlEngine>(cfg.pid_engine[i]),
+                                               cfg.pid_kp[i], cfg.pid_ki[i], cfg.pid_kd[i]));
+            }
+            m_router->setFeedForward(cfg.auto_ff != 0);
+            m_router->setPlantTuning(static_cast<PlantTuning>(cfg.plant_tune));
+            m_router->setDeadTimeCompensation(cfg.auto_dtc != 0);
             m_router->setMode(static_cast<RouterMode>(cfg.router_mode));
         }
         return true;
@@ -2518,6 +2850,132 @@ bool SerialCommand::handleConfigCommand(const char* cmd, const char* arg) {
         return true;
     }
 
+    // config-pid [auto|eco|grid] [p|pi|pid] [kp ki kd] - controller engine per mode
+    if (strcmp(cmd, "config-pid") == 0) {
+        static const char* loop_names[] = {"auto", "eco", "grid"};
+        static const char* engine_names[] = {"p", "pi", "pid"};
+        const SystemConfig& cfg = m_config->getConfig();
+
+        char loop_str[8] = {0};
+        char engine_str[8] = {0};
+        float kp = 0, ki = 0, kd = 0;
+        int parsed = arg ? sscanf(arg, "%7s %7s %f %f %f", loop_str, engine_str, &kp, &ki, &kd) : 0;
+
+        int loop = -1;
+        for (int i = 0; parsed >= 1 && i < ConfigDefaults::PID_LOOPS; i++) {
+            if (strcmp(loop_str, loop_names[i]) == 0) loop = i;
+        }
+        if (parsed <= 0 || parsed == 1) {
+            for (int i = 0; i < ConfigDefaults::PID_LOOPS; i++) {
+                if (loop >= 0 && i != loop) continue;
+                ESP_LOGI(TAG, "pid %-4s = %-3s kp=%.4f ki=%.4f kd=%.4f", loop_names[i],
+                         engine_names[cfg.pid_engine[i] <= 2 ? cfg.pid_engine[i] : 0],
+                         cfg.pid_kp[i], cfg.pid_ki[i], cfg.pid_kd[i]);
+            }
+            if (parsed == 1 && loop < 0) ESP_LOGE(TAG, "Unknown loop: %s (auto|eco|grid)", loop_str);
+            return true;
+        }
+
+        int engine = -1;
+        for (int i = 0; i < 3; i++) {
+            if (strcmp(engine_str, engine_names[i]) == 0) engine = i;
+        }
+        if (loop < 0 || engine < 0 || (parsed != 2 && parsed != 5)) {
+            ESP_LOGE(TAG, "Usage: config-pid [auto|eco|grid] [p|pi|pid] [kp ki kd]");
+            return true;
+        }
+        if (parsed == 2) {
+            // Engine only: keep the stored gains
+            kp = cfg.pid_kp[loop];
+            ki = cfg.pid_ki[loop];
+            kd = cfg.pid_kd[loop];
+        }
+
+        if (m_config->setPidGains(loop, engine, kp, ki, kd)) {
+            ESP_LOGI(TAG, "pid %s = %s kp=%.4f ki=%.4f kd=%.4f (saved)", loop_names[loop],
+                     engine_names[engine], cfg.pid_kp[loop], cfg.pid_ki[loop], cfg.pid_kd[loop]);
+            if (m_router) {
+                m_router->setPidGains(static_cast<PidLoop>(loop),
+                                      PidGains(static_cast<ControlEngine>(engine),
+                                               cfg.pid_kp[loop], cfg.pid_ki[loop], cfg.pid_kd[loop]));
+            }
+        } else {
+            ESP_LOGE(TAG, "Failed to save PID gains");
+        }
+        return true;
+    }
+
+    // config-ff [on|off] - AUTO feed-forward from the load/solar channels
+    if (strcmp(cmd, "config-ff") == 0) {
+        if (!arg) {
+            ESP_LOGI(TAG, "feed-forward = %s", m_config->isFeedForwardEnabled() ? "on" : "off");
+        } else if (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0) {
+            bool enabled = (strcmp(arg, "on") == 0);
+            if (m_config->setFeedForward(enabled)) {
+                ESP_LOGI(TAG, "feed-forward = %s (saved)", enabled ? "on" : "off");
+                if (m_router) m_router->setFeedForward(enabled);
+            } else {
+                ESP_LOGE(TAG, "Failed to save feed-forward");
+            }
+        } else {
+            ESP_LOGE(TAG, "Usage: config-ff [on|off]");
+        }
+        return true;
+    }
+
+    // config-deadtime [on|off] - AUTO dead-time compensation
+    if (strcmp(cmd, "config-deadtime") == 0) {
+        if (!arg) {
+            ESP_LOGI(TAG, "dead-time compensation = %s",
+                     m_config->isDeadTimeCompensationEnabled() ? "on" : "off");
+        } else if (strcmp(arg, "on") == 0 || strcmp(arg, "off") == 0) {
+            bool enabled = (strcmp(arg, "on") == 0);
+            if (m_config->setDeadTimeCompensation(enabled)) {
+                ESP_LOGI(TAG, "dead-time compensation = %s (saved)", enabled ? "on" : "off");
+                if (m_router) m_router->setDeadTimeCompensation(enabled);
+            } else {
+                ESP_LOGE(TAG, "Failed to save dead-time compensation");
+            }
+        } else {
+            ESP_LOGE(TAG, "Usage: config-deadtime [on|off]");
+        }
+        return true;
+    }
+
+    // config-tune [off|learn|adapt|reset] - AUTO plant-gain tuning
+    if (strcmp(cmd, "config-tune") == 0) {
+        static const char* tune_names[] = { "off", "learn", "adapt" };
+        if (!arg) {
+            ESP_LOGI(TAG, "plant tuning = %s", tune_names[m_config->getPlantTuning() <= 2 ? m_config->getPlantTuning() : 0]);
+            if (m_router) {
+                PlantGainInfo est[8];
+                uint8_t n = m_router->getPlantEstimates(est, 8);
+                for (uint8_t i = 0; i < n; i++) {
+                    ESP_LOGI(TAG, "  prio %u: %u W nominal, gain %.2f (%.1f W/%%), applied %.2f, %u updates",
+                             est[i].priority, (unsigned)est[i].nominal_w, est[i].gain, est[i].w_per_pct,
+                             est[i].applied_gain, est[i].samples);
+                }
+            }
+        } else if (strcmp(arg, "reset") == 0) {
+            if (m_router) m_router->resetPlantEstimates();
+            ESP_LOGI(TAG, "Plant-gain estimates cleared");
+        } else {
+            int mode = -1;
+            for (int i = 0; i < 3; i++) {
+                if (strcmp(arg, tune_names[i]) == 0) mode = i;
+            }
+            if (mode < 0) {
+                ESP_LOGE(TAG, "Usage: config-tune [off|learn|adapt|reset]");
+            } else if (m_config->setPlantTuning((uint8_t)mode)) {
+                ESP_LOGI(TAG, "plant tuning = %s (saved)", tune_names[mode]);
+                if (m_router) m_router->setPlantTuning(static_cast<PlantTuning>(mode));
+            } else {
+                ESP_LOGE(TAG, "Failed to save plant tuning");
+            }
+        }
+        return true;
+    }
+
     // config-threshold <value> - set balance threshold
     if (strcmp(cmd, "config-threshold") == 0) {
         if (!arg) {
@@ -2823,6 +3281,8 @@ bool SerialCommand::handleRouterCommand(const char* cmd, const char* arg) {
             dimmer_set_curve(dimmer_id, curve);
             ESP_LOGI(TAG, "Dimmer %d curve = %s", dimmer_id, curve_name);
         }
+        // The AUTO cascade converts watts to levels through each dimmer's curve
+        if (m_router) m_router->refreshPriorityMap();
 
         return true;
     }
@@ -2999,6 +3459,7 @@ bool SerialCommand::handleRouterCommand(const char* cmd, const char* arg) {
 
         if (dimmer_set_nominal_power(dimmer_id, power) == ESP_OK) {
             ESP_LOGI(TAG, "Dimmer %d power = %d W", dimmer_id, power);
+            if (m_router) m_router->refreshPriorityMap();   // AUTO cascade shares by nominal power
         } else {
             ESP_LOGE(TAG, "Failed to set power for dimmer %d", dimmer_id);
         }
@@ -3067,7 +3528,7 @@ void SerialCommand::printHelp() {
     ESP_LOGI(TAG, "  router-status        - Show detailed status");
     ESP_LOGI(TAG, "  sim-inject <role> <A> [V] [W]");
     ESP_LOGI(TAG, "                       - TEST: inject synthetic measurement (no HW)");
-    ESP_LOGI(TAG, "  timing               - I2C poll cadence / CPU-time per module");
+    ESP_LOGI(TAG, "  timing               - I2C poll cadence / CPU-time / control latency");
     ESP_LOGI(TAG, "");
     ESP_LOGI(TAG, "DIMMER CONTROL (0-based IDs: 0,1,2,3)");
     ESP_LOGI(TAG, "  dimmer <ID|all> <0-100>");
@@ -3094,6 +3555,13 @@ void SerialCommand::printHelp() {
     ESP_LOGI(TAG, "  config-reset         - Reset to defaults");
     ESP_LOGI(TAG, "  hardware-reset       - Reset hardware config (ADC pins, etc.)");
     ESP_LOGI(TAG, "  config-gain [value]  - Control gain (10-1000)");
+    ESP_LOGI(TAG, "  config-pid [auto|eco|grid] [p|pi|pid] [kp ki kd]");
+    ESP_LOGI(TAG, "                       - Controller engine/gains per mode");
+    ESP_LOGI(TAG, "  config-ff [on|off]   - AUTO load/solar feed-forward");
+    ESP_LOGI(TAG, "  config-tune [off|learn|adapt|reset]");
+    ESP_LOGI(TAG, "                       - AUTO plant-gain tuning");
+    ESP_LOGI(TAG, "  config-deadtime [on|off]");
+    ESP_LOGI(TAG, "                       - AUTO dead-time compensation");
     ESP_LOGI(TAG, "  config-threshold [value]");
     ESP_LOGI(TAG, "                       - Balance threshold (W)");
     ESP_LOGI(TAG, "  config-manual [value]");
@@ -3209,6 +3677,8 @@ void SerialCommand::printHelp() {
     ESP_LOGI(TAG, "    e.g.: dl-config 0 0x50 current_grid");
     ESP_LOGI(TAG, "  sensor-hub           - Show merged sensor hub state");
     ESP_LOGI(TAG, "    (shows which source provides each measurement)");
+    ESP_LOGI(TAG, "  sensor-hub-merge <epoch|frame> [ms]");
+    ESP_LOGI(TAG, "                       - One merge per epoch, or per frame");
 #if CONFIG_ACROUTER_RBAMP_SOURCE
     ESP_LOGI(TAG, "  rbamp-status         - Show rbAmp modules + roles");
     ESP_LOGI(TAG, "  rbamp-rescan         - Re-scan bus for new rbAmp modules");
@@ -3219,9 +3689,13 @@ void SerialCommand::printHelp() {
 #endif
 #if CONFIG_ACROUTER_ESPNOW_SOURCE
     ESP_LOGI(TAG, "  espnow-status        - Show ESP-NOW nodes + roles");
-    ESP_LOGI(TAG, "  espnow-config <mac> <role>");
-    ESP_LOGI(TAG, "                       - Assign ESP-NOW node role (saved to NVS)");
+    ESP_LOGI(TAG, "  espnow-config <mac> <role> [channel]");
+    ESP_LOGI(TAG, "                       - Assign ESP-NOW node channel role (saved to NVS)");
     ESP_LOGI(TAG, "    e.g.: espnow-config AA:BB:CC:DD:EE:FF grid");
+    ESP_LOGI(TAG, "  espnow-energy [flush|reset [mac]]");
+    ESP_LOGI(TAG, "                       - PERIOD energy totals (import/export per channel)");
+    ESP_LOGI(TAG, "  espnow-sync          - Time master: beacons + per-node offset/jitter");
+    ESP_LOGI(TAG, "  espnow-latch         - LATCH_NOW: every sensor node closes its period now");
     ESP_LOGI(TAG, "  espnow-out           - List ESP-NOW output nodes (dimmer/relay)");
     ESP_LOGI(TAG, "  espnow-bind <mac>    - Bind an output node to a dimmer (RouterController drives it)");
     ESP_LOGI(TAG, "  espnow-set <mac> <pct> - Drive an output directly (wire-path test)");
@@ -3248,6 +3722,18 @@ void SerialCommand::printStatus() {
         ESP_LOGI(TAG, "State:   %s", (si >= 0 && si < 6) ? states[si] : "?");
         ESP_LOGI(TAG, "Dimmer:  %d%%", st.dimmer_percent);
         ESP_LOGI(TAG, "Power:   %.1f W", st.power_grid);
+        if (m_router->isFeedForwardEnabled()) {
+            ESP_LOGI(TAG, "FF:      %s, pred err %.1f W, last step %+.1f W",
+                     st.ff_active ? "active" : "held", st.ff_error_w, st.ff_power_w);
+        }
+        if (m_router->getPlantTuning() != PlantTuning::OFF) {
+            PlantGainInfo est[8];
+            uint8_t n = m_router->getPlantEstimates(est, 8);
+            for (uint8_t i = 0; i < n; i++) {
+                ESP_LOGI(TAG, "Plant:   prio %u gain %.2f (applied %.2f, %u updates)",
+                         est[i].priority, est[i].gain, est[i].applied_gain, est[i].samples);
+            }
+        }
     } else {
         ESP_LOGE(TAG, "RouterController not available");
     }
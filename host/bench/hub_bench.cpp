@@ -0,0 +1,299 @@
+/**
+ * @file hub_bench.cpp
+ * @brief sensor_hub reader/writer latency under contention.
+ *
+ * One writer thread posts POWER_UPDATE frames as fast as it can (each one is a
+ * full cache + merge + MERGED_UPDATE publish, SH_MERGE_PER_FRAME) while 0..N
+ * reader threads hammer the snapshot API the MQTT / web / console paths use
+ * (sensor_hub_get_state, has_i2c_source, get_slot_source). Reports, per reader
+ * count, the writer's per-frame latency and the readers' per-call latency
+ * (p50 / p99 / max, wall clock) plus how often a reader had to retry.
+ *
+ * Every frame carries the same value on voltage and all three currents (k mod
+ * 600, inside the packed 0.01 V / 0.01 A range), so a consistent snapshot has
+ * four equal slot values; a reader that ever sees a mix has observed a torn
+ * publish.
+ *
+ * An unstamped frame (timestamp_us 0) must be dated by its arrival, not
+ * re-extended from 0.
+ *
+ * A second table stresses acrouter_meas_ring: three producer threads publish
+ * sequence-stamped frames while the main thread consumes in place, checking
+ * per-producer order and frame integrity, and reports drops.
+ *
+ * Usage: hub_bench [--check] [--frames N]
+ *   --check   exit non-zero on a torn / non-monotonic snapshot, a misdated
+ *             unstamped frame or a corrupt / reordered ring frame (ctest)
+ *   --frames  writer frames per configuration (default 200000)
+ */
+
+#include "sensor_hub.h"
+#include "acrouter_events.h"
+#include "acrouter_meas_ring.h"
+#include "host_clock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t READER_SAMPLES_MAX = 1u << 20;   // per reader thread
+
+struct Latency {
+    double p50 = 0.0, p99 = 0.0, max = 0.0;
+};
+
+Latency summarize(std::vector<double>& us) {
+    Latency l;
+    if (us.empty()) return l;
+    std::sort(us.begin(), us.end());
+    l.p50 = us[us.size() / 2];
+    l.p99 = us[(size_t)(0.99 * (us.size() - 1))];
+    l.max = us.back();
+    return l;
+}
+
+struct ReaderResult {
+    std::vector<double> us;
+    uint64_t calls = 0;
+    uint64_t torn  = 0;
+    uint64_t regressions = 0;   // merge_count went backwards
+};
+
+void readerLoop(const std::atomic<bool>* stop, ReaderResult* rr) {
+    rr->us.reserve(READER_SAMPLES_MAX);
+    uint32_t last_merges = 0;
+    uint32_t i = 0;
+    while (!stop->load(std::memory_order_relaxed)) {
+        const int64_t t0 = host_clock_wall_ns();
+        sensor_hub_state_t st;
+        switch (i++ % 3) {
+            case 0:
+                sensor_hub_get_state(&st);
+                break;
+            case 1:
+                (void)sensor_hub_has_i2c_source();
+                break;
+            default:
+                (void)sensor_hub_get_slot_source(SH_SLOT_GRID);
+                break;
+        }
+        const double us = (host_clock_wall_ns() - t0) / 1000.0;
+        if (rr->us.size() < READER_SAMPLES_MAX) rr->us.push_back(us);
+        rr->calls++;
+
+        if ((i - 1) % 3 != 0) continue;
+        if (st.merge_count < last_merges) rr->regressions++;
+        last_merges = st.merge_count;
+        bool all_valid = true;
+        for (int s = 0; s < SENSOR_HUB_SLOTS; s++) all_valid = all_valid && st.slots[s].valid;
+        if (!all_valid) continue;
+        const float v = st.slots[SH_SLOT_VOLTAGE].value;
+        if (st.slots[SH_SLOT_GRID].value != v || st.slots[SH_SLOT_SOLAR].value != v ||
+            st.slots[SH_SLOT_LOAD].value != v) {
+            rr->torn++;
+        }
+    }
+}
+
+void postFrame(uint32_t k, bool stamped = true) {
+    const float v = (float)(k % 600u);
+    acrouter_measurements_t m;
+    acrouter_measurements_init(&m);
+    m.source       = ACROUTER_SOURCE_I2C;
+    m.source_id    = 0;
+    m.valid        = true;
+    m.timestamp_us = stamped ? (uint64_t)host_clock_now_us() : 0;
+    m.has_voltage  = true;
+    m.voltage_rms  = v;
+    for (int ch = 0; ch < ACROUTER_CH_COUNT; ch++) {
+        m.has_current[ch]  = true;
+        m.current_rms[ch]  = v;
+        m.has_power[ch]    = true;
+        m.power_active[ch] = v;
+        m.direction[ch]    = ACROUTER_DIR_CONSUMING;
+    }
+    esp_event_post(ACROUTER_EVENT, ACROUTER_EVENT_POWER_UPDATE, &m, sizeof(m), 0);
+}
+
+// ------------------------------------------------------------
+// Measurement ring: 3 producers → 1 in-place consumer
+// ------------------------------------------------------------
+
+constexpr int RING_PRODUCERS = 3;
+
+void producerLoop(uint8_t id, uint32_t frames, std::atomic<uint32_t>* sent) {
+    acrouter_measurements_t m;
+    acrouter_measurements_init(&m);
+    m.source    = ACROUTER_SOURCE_I2C;
+    m.source_id = id;
+    m.valid     = true;
+    for (uint32_t seq = 1; seq <= frames; ) {
+        m.timestamp_us = seq;
+        for (int ch = 0; ch < ACROUTER_CH_COUNT; ch++) {
+            m.has_current[ch] = true;
+            m.current_rms[ch] = (float)(seq % 600u);
+        }
+        if (acrouter_meas_publish(&m) == ESP_OK) {
+            seq++;
+        } else {
+            std::this_thread::yield();   // full: let the consumer catch up, then retry
+        }
+    }
+    sent->fetch_add(frames);
+}
+
+bool runRing(uint32_t frames, bool check) {
+    acrouter_meas_ring_attach(nullptr, nullptr);   // polling consumer
+    acrouter_meas_ring_stats_t rs0;
+    acrouter_meas_ring_get_stats(&rs0);
+
+    std::atomic<uint32_t> sent{0};
+    std::vector<std::thread> producers;
+    const int64_t t0 = host_clock_wall_ns();
+    for (int p = 0; p < RING_PRODUCERS; p++) producers.emplace_back(producerLoop, (uint8_t)p, frames, &sent);
+
+    uint64_t last_seq[RING_PRODUCERS] = {};
+    uint64_t consumed = 0, corrupt = 0, reordered = 0;
+    const uint64_t total = (uint64_t)frames * RING_PRODUCERS;
+    while (consumed < total) {
+        const acrouter_meas_packed_t* f = acrouter_meas_ring_peek();
+        if (!f) {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint64_t seq = f->timestamp_us32;
+        bool ok = f->source_id < RING_PRODUCERS;
+        for (int ch = 0; ok && ch < ACROUTER_CH_COUNT; ch++) {
+            ok = acrouter_pk_has_current(f, ch) && f->current_ca[ch] == (seq % 600u) * 100u;
+        }
+        if (!ok) {
+            corrupt++;
+        } else {
+            if (seq != last_seq[f->source_id] + 1) reordered++;
+            last_seq[f->source_id] = seq;
+        }
+        acrouter_meas_ring_release();
+        consumed++;
+    }
+    const double secs = (host_clock_wall_ns() - t0) / 1e9;
+    for (std::thread& t : producers) t.join();
+
+    acrouter_meas_ring_stats_t rs1;
+    acrouter_meas_ring_get_stats(&rs1);
+    acrouter_meas_ring_detach();
+
+    printf("\nacrouter_meas_ring (%d producers x %u frames, depth %d)\n",
+           RING_PRODUCERS, frames, ACROUTER_MEAS_RING_DEPTH);
+    printf("  %.2f Mframes/s, full-ring rejections=%u, high-water=%u, corrupt=%llu, reordered=%llu\n",
+           consumed / secs / 1e6, rs1.dropped - rs0.dropped, rs1.high_water,
+           (unsigned long long)corrupt, (unsigned long long)reordered);
+
+    bool ok = true;
+    if (check && (corrupt || reordered)) {
+        fprintf(stderr, "CHECK FAILED: ring delivered %llu corrupt / %llu reordered frames\n",
+                (unsigned long long)corrupt, (unsigned long long)reordered);
+        ok = false;
+    }
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool check = false;
+    uint32_t frames = 200000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--check"))                       check = true;
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        else {
+            fprintf(stderr, "usage: %s [--check] [--frames N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames == 0 || frames > (1u << 24)) frames = 200000;
+
+    esp_event_loop_create_default();
+    sensor_hub_init();
+    sensor_hub_set_merge_mode(SH_MERGE_PER_FRAME);
+
+    const unsigned hw = std::thread::hardware_concurrency();
+    const unsigned reader_counts[] = { 0, 1, 2, 4, 8 };   // > hw-1 readers = oversubscribed
+
+    printf("sensor_hub snapshot contention (frames=%u per row, %u hw threads)\n", frames, hw);
+    printf("%7s | %9s %9s %9s | %9s %9s %9s | %11s %9s %6s\n",
+           "readers", "wr p50", "wr p99", "wr max", "rd p50", "rd p99", "rd max",
+           "reads", "retries", "torn");
+    printf("%7s | %9s %9s %9s | %9s %9s %9s | %11s %9s %6s\n",
+           "", "us", "us", "us", "us", "us", "us", "", "", "");
+
+    bool ok = true;
+    uint32_t k = 1;
+    for (unsigned nreaders : reader_counts) {
+        sensor_hub_stats_t hs0, hs1;
+        sensor_hub_get_stats(&hs0);
+
+        std::atomic<bool> stop{false};
+        std::vector<ReaderResult> rr(nreaders);
+        std::vector<std::thread> threads;
+        for (unsigned r = 0; r < nreaders; r++) threads.emplace_back(readerLoop, &stop, &rr[r]);
+
+        std::vector<double> wr_us;
+        wr_us.reserve(frames);
+        for (uint32_t f = 0; f < frames; f++, k = (k % (1u << 24)) + 1) {
+            const int64_t t0 = host_clock_wall_ns();
+            postFrame(k);
+            wr_us.push_back((host_clock_wall_ns() - t0) / 1000.0);
+        }
+        stop.store(true);
+        for (std::thread& t : threads) t.join();
+        sensor_hub_get_stats(&hs1);
+
+        std::vector<double> rd_us;
+        uint64_t calls = 0, torn = 0, regressions = 0;
+        for (ReaderResult& r : rr) {
+            rd_us.insert(rd_us.end(), r.us.begin(), r.us.end());
+            calls       += r.calls;
+            torn        += r.torn;
+            regressions += r.regressions;
+        }
+        const Latency w = summarize(wr_us);
+        const Latency rd = summarize(rd_us);
+        printf("%7u | %9.2f %9.2f %9.1f | %9.3f %9.3f %9.1f | %11llu %9u %6llu\n",
+               nreaders, w.p50, w.p99, w.max, rd.p50, rd.p99, rd.max,
+               (unsigned long long)calls, hs1.snapshot_retries - hs0.snapshot_retries,
+               (unsigned long long)torn);
+
+        if (check) {
+            if (torn)        { fprintf(stderr, "CHECK FAILED: %u readers saw a torn snapshot\n", nreaders); ok = false; }
+            if (regressions) { fprintf(stderr, "CHECK FAILED: %u readers saw merge_count go backwards\n", nreaders); ok = false; }
+            if (hs1.merges - hs0.merges != frames) {
+                fprintf(stderr, "CHECK FAILED: %u merges for %u frames\n", hs1.merges - hs0.merges, frames);
+                ok = false;
+            }
+        }
+    }
+
+    {
+        const int64_t before = host_clock_now_us();
+        postFrame(1, false);
+        sensor_hub_state_t st;
+        sensor_hub_get_state(&st);
+        const int64_t acq = (int64_t)st.slots[SH_SLOT_GRID].acquired_us;
+        if (check && (acq < before || acq > host_clock_now_us())) {
+            fprintf(stderr, "CHECK FAILED: unstamped frame dated %lld us, posted at %lld us\n",
+                    (long long)acq, (long long)before);
+            ok = false;
+        }
+    }
+
+    ok = runRing(frames, check) && ok;
+
+    if (check) printf("%s\n", ok ? "CHECK PASSED" : "CHECK FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,595 @@
+/**
+ * @file i2c_bench.cpp
+ * @brief DimmerLink poll throughput on the simulated I2C fabric, and the driver
+ *        quirks the fabric models.
+ *
+ * The real i2c_bus (handle cache, async workers, health), dimmerlink_device and
+ * device_registry run over virtual slaves (sim/sim_i2c.c). The benchmark runs
+ * back-to-back poll cycles — the dl_manager cycle: every device's planned reads
+ * queued at telemetry priority, then waited on — for N DimmerLink modules on
+ * one bus and split over two, with wire time modelled at 100 kHz, and once with
+ * wire time off (the software path alone).
+ *
+ * --check verifies the driver against the quirks:
+ *   - STOP-latched pointer: a repeated-START read returns the previous register,
+ *     the STOP framing the poll path uses reads correctly;
+ *   - garbled first read after idle: identification's warm-up read absorbs it,
+ *     even when the garbage is a plausible v1.3+ VERSION;
+ *   - VERSION gate: a legacy DimmerLink (0x54 = CS_CONFIG = 0x01) classifies as
+ *     a dimmer, an rbAmp (VERSION >= 4, 0x54 = PRODUCT_ID) as rbAmp with UID;
+ *   - NACKs back a device off without further poll traffic (writes still go
+ *     out); a wedged bus times out and is counted;
+ *   - a registry scan finds both families and requests the rbAmp fleet rescan,
+ *     and a module swapped at a known address is re-identified;
+ *   - the async queue serves actuation, telemetry, background in that order,
+ *     keeps its reserved slots for actuation, expires what waited past its
+ *     deadline without touching the bus, and fails what is queued at stop;
+ *   - a queued I2C relay write that fails is re-issued by relay_update();
+ *   - a queued dimmer level write that fails is re-issued by dimmer_update_all();
+ *   - dl_manager polls every module online, and two buses beat one.
+ *
+ * Usage: i2c_bench [--check] [--ms N]   (N = duration of each throughput run)
+ */
+
+#include "sim_i2c.h"
+#include "i2c_bus.h"
+#include "i2c_bus_async.h"
+#include "i2c_bus_health.h"
+#include "dimmerlink_device.h"
+#include "dimmerlink_manager.h"
+#include "device_registry.h"
+#include "esp_now_source.h"
+#include "rbamp_source.h"
+#include "relay_manager.h"
+#include "relay_i2c.h"
+#include "dimmer_manager.h"
+#include "host_clock.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t DL_BASE_ADDR  = 0x50;
+constexpr uint8_t RBAMP_ADDR    = 0x40;
+constexpr uint8_t POLL_WHAT     = DL_POLL_CURRENT | DL_POLL_THERMAL | DL_POLL_DIMMER;
+constexpr int     MAX_MODULES   = 8;
+constexpr int     SIZES[]       = { 1, 2, 4, 8 };
+
+const uint8_t RBAMP_UID[12] = { 0x52, 0x42, 0x41, 0x4D, 0x50, 0x00,
+                                0x13, 0x37, 0xC0, 0xFF, 0xEE, 0x01 };
+
+sim_i2c_regmap_t g_dl[MAX_MODULES];
+sim_i2c_regmap_t g_rbamp;
+
+int g_failures = 0;
+
+void expect(bool cond, const char* what) {
+    if (!cond) {
+        fprintf(stderr, "CHECK FAILED: %s\n", what);
+        g_failures++;
+    }
+}
+
+double nowMs() {
+    return (double)host_clock_wall_ns() / 1e6;
+}
+
+// Module i of n: on bus 0, or alternating over both buses.
+uint8_t busOf(int i, int buses) {
+    return (uint8_t)(buses > 1 ? i % 2 : 0);
+}
+
+void attachModules(int n, int buses) {
+    sim_i2c_reset();
+    for (int i = 0; i < n; i++) {
+        const uint8_t addr = (uint8_t)(DL_BASE_ADDR + i);
+        sim_i2c_regmap_dimmerlink(&g_dl[i], addr, 0x02);
+        sim_i2c_attach(busOf(i, buses), addr, &sim_i2c_regmap_ops, &g_dl[i]);
+        i2c_bus_health_clear(busOf(i, buses), addr);
+    }
+}
+
+// ------------------------------------------------------------
+// Throughput
+// ------------------------------------------------------------
+
+struct RunResult {
+    uint32_t cycles;
+    double   cycles_per_s;
+    double   cycle_us;
+    uint32_t reads_per_cycle;
+    uint32_t failed;            // devices without a complete poll
+};
+
+dl_poll_job_t g_jobs[MAX_MODULES];
+
+// Back-to-back poll cycles for @p ms (same submission loop as dl_manager).
+RunResult runCycles(int n, int buses, uint32_t ms) {
+    static SemaphoreHandle_t done = xSemaphoreCreateCounting(MAX_MODULES * DL_BURST_MAX_READS, 0);
+    RunResult r = {};
+    const double t0 = nowMs();
+    while (nowMs() - t0 < ms) {
+        for (int i = 0; i < n; i++) {
+            dl_poll_job_init(&g_jobs[i], busOf(i, buses), (uint8_t)(DL_BASE_ADDR + i), POLL_WHAT, done);
+        }
+        uint32_t inflight = 0;
+        bool more = true;
+        while (more) {
+            more = false;
+            for (int i = 0; i < n; i++) {
+                if (!dl_poll_job_pending(&g_jobs[i])) continue;
+                esp_err_t err = dl_poll_job_submit(&g_jobs[i]);
+                if (err == ESP_OK) {
+                    inflight++;
+                } else if (err == ESP_ERR_NO_MEM && inflight > 0) {
+                    xSemaphoreTake(done, portMAX_DELAY);
+                    inflight--;
+                }
+                if (dl_poll_job_pending(&g_jobs[i])) more = true;
+            }
+        }
+        while (inflight > 0) {
+            xSemaphoreTake(done, portMAX_DELAY);
+            inflight--;
+        }
+        uint32_t reads = 0;
+        for (int i = 0; i < n; i++) {
+            dl_poll_result_t res;
+            if (dl_poll_job_finish(&g_jobs[i], &res) != ESP_OK) r.failed++;
+            reads += res.reads;
+        }
+        r.reads_per_cycle = reads;
+        r.cycles++;
+    }
+    const double elapsed_ms = nowMs() - t0;
+    r.cycles_per_s = r.cycles * 1000.0 / elapsed_ms;
+    r.cycle_us     = elapsed_ms * 1000.0 / (r.cycles ? r.cycles : 1);
+    return r;
+}
+
+void printRun(const char* mode, int n, int buses, const RunResult& r) {
+    printf("%-10s %7d %5d %10.0f %10.1f %9u %7u\n", mode, n, buses, r.cycle_us, r.cycles_per_s,
+           r.reads_per_cycle, r.failed);
+}
+
+// ------------------------------------------------------------
+// Quirk checks
+// ------------------------------------------------------------
+
+void checkStopLatch() {
+    sim_i2c_reset();
+    sim_i2c_regmap_dimmerlink(&g_dl[0], DL_BASE_ADDR, 0x02);
+    sim_i2c_attach(0, DL_BASE_ADDR, &sim_i2c_regmap_ops, &g_dl[0]);
+
+    uint8_t v = 0;
+    expect(i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_VERSION, &v, 1) == ESP_OK, "first VERSION read");
+    expect(v == 0xFF && g_dl[0].garbled == 1, "first read after power-up not garbled");
+    i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_VERSION, &v, 1);
+    expect(v == 0x02, "second VERSION read not clean");
+
+    // Pointer now at 0x04: a repeated-START read of AC_FREQ gets that register.
+    i2c_bus_read_reg(0, DL_BASE_ADDR, DL_REG_AC_FREQ, &v, 1);
+    expect(v != 50 && g_dl[0].stale == 1, "repeated-START read was not stale on a STOP-latch slave");
+    i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_AC_FREQ, &v, 1);
+    expect(v == 50, "STOP-framed read wrong");
+}
+
+void checkVersionGate() {
+    sim_i2c_reset();
+    sim_i2c_regmap_dimmerlink(&g_dl[0], DL_BASE_ADDR, 0x02);
+    g_dl[0].garble_idle_ms = 30;
+    g_dl[0].garble_value   = 0x05;      // garbage that looks like a v1.3+ VERSION
+    sim_i2c_attach(0, DL_BASE_ADDR, &sim_i2c_regmap_ops, &g_dl[0]);
+    sim_i2c_regmap_rbamp(&g_rbamp, 2, RBAMP_UID);
+    sim_i2c_attach(0, RBAMP_ADDR, &sim_i2c_regmap_ops, &g_rbamp);
+
+    // Without a warm-up, the garbled VERSION opens the v1.3+ path and CS_CONFIG
+    // reads as an rbAmp PRODUCT_ID — the trap identification must avoid.
+    uint8_t ver = 0, pid = 0;
+    i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_VERSION, &ver, 1);
+    i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_CS_CONFIG, &pid, 1);
+    expect(ver == 0x05 && pid == 0x01, "fabric did not reproduce the garbled-VERSION trap");
+
+    vTaskDelay(pdMS_TO_TICKS(60));
+    const uint32_t garbled = g_dl[0].garbled;
+    device_ident_t id;
+    expect(device_identify(0, DL_BASE_ADDR, &id) == ESP_OK, "identify legacy failed");
+    expect(g_dl[0].garbled == garbled + 1, "idle garble not hit during identify");
+    expect(id.family == DEV_FAMILY_LEGACY_DIMMER && id.version == 0x02,
+           "legacy DimmerLink misclassified");
+
+    expect(device_identify(0, RBAMP_ADDR, &id) == ESP_OK, "identify rbAmp failed");
+    expect(id.family == DEV_FAMILY_RBAMP && id.channels == 2 && id.has_uid &&
+           !memcmp(id.uid, RBAMP_UID, sizeof(RBAMP_UID)), "rbAmp misclassified");
+}
+
+void checkPollDecode() {
+    sim_i2c_reset();
+    sim_i2c_regmap_dimmerlink(&g_dl[0], DL_BASE_ADDR, 0x02);
+    g_dl[0].garble_idle_ms = 0;
+    sim_i2c_attach(0, DL_BASE_ADDR, &sim_i2c_regmap_ops, &g_dl[0]);
+
+    expect(dl_device_set_dimmer_level(0, DL_BASE_ADDR, 42) == ESP_OK, "level write failed");
+    expect(g_dl[0].reg[DL_REG_DIM0_LEVEL] == 42, "level write did not land");
+
+    RunResult r = runCycles(1, 1, 1);
+    dl_poll_result_t res;
+    dl_poll_job_finish(&g_jobs[0], &res);
+    expect(r.failed == 0 && res.ok == POLL_WHAT, "poll incomplete");
+    expect(res.current.rms_ma == 4350 && res.current.valid, "current snapshot decoded wrong");
+    expect(res.thermal.temperature_c == 30, "thermal decoded wrong");
+    expect(res.dimmer.level_percent == 42 && res.dimmer.ac_freq_hz == 50, "dimmer status decoded wrong");
+    expect(g_dl[0].stale == 0, "poll path used repeated-START reads");
+}
+
+void checkFaults() {
+    sim_i2c_reset();
+    sim_i2c_regmap_dimmerlink(&g_dl[0], DL_BASE_ADDR, 0x02);
+    sim_i2c_attach(0, DL_BASE_ADDR, &sim_i2c_regmap_ops, &g_dl[0]);
+    i2c_bus_health_clear(0, DL_BASE_ADDR);
+
+    uint8_t v;
+    sim_i2c_inject_nack(0, DL_BASE_ADDR, I2C_BUS_BACKOFF_AFTER);
+    for (int i = 0; i < I2C_BUS_BACKOFF_AFTER; i++) {
+        expect(i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_VERSION, &v, 1) != ESP_OK,
+               "injected NACK not reported");
+    }
+    sim_i2c_stats_t before, after;
+    sim_i2c_get_stats(0, &before);
+    expect(i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_VERSION, &v, 1) == ESP_ERR_NOT_ALLOWED,
+           "NACKing device not backed off");
+    sim_i2c_get_stats(0, &after);
+    expect(after.xfers == before.xfers && after.nacks == before.nacks, "backed-off device touched the bus");
+    // Backoff throttles polling only: an output write still goes out (and its
+    // success ends the backoff).
+    expect(i2c_bus_write_byte(0, DL_BASE_ADDR, DL_REG_DIM0_LEVEL, 37) == ESP_OK &&
+           g_dl[0].reg[DL_REG_DIM0_LEVEL] == 37, "write refused on a backed-off device");
+    expect(i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_VERSION, &v, 1) == ESP_OK,
+           "successful write did not end the backoff");
+    i2c_bus_health_clear(0, DL_BASE_ADDR);
+    expect(i2c_bus_read_reg_stop(0, DL_BASE_ADDR, DL_REG_VERSION, &v, 1) == ESP_OK,
+           "device not usable after clear");
+
+    sim_i2c_regmap_dimmerlink(&g_dl[1], DL_BASE_ADDR + 1, 0x02);
+    sim_i2c_attach(1, DL_BASE_ADDR + 1, &sim_i2c_regmap_ops, &g_dl[1]);
+    sim_i2c_wedge(1, 150);
+    expect(i2c_bus_read_reg_stop(1, DL_BASE_ADDR + 1, DL_REG_VERSION, &v, 1) == ESP_ERR_TIMEOUT,
+           "wedged bus did not time out");
+    sim_i2c_wedge(1, 0);
+    bool counted = false;
+    i2c_bus_dev_health_t h;
+    for (uint8_t i = 0; i2c_bus_get_device_health(1, i, &h) == ESP_OK; i++) {
+        if (h.addr == DL_BASE_ADDR + 1) counted = h.timeout > 0;
+    }
+    expect(counted, "timeout not counted in bus health");
+    expect(i2c_bus_read_reg_stop(1, DL_BASE_ADDR + 1, DL_REG_VERSION, &v, 1) == ESP_OK,
+           "bus not usable after the wedge");
+}
+
+void checkRegistryScan() {
+    sim_i2c_reset();
+    sim_rbamp_source_reset();
+    sim_i2c_regmap_dimmerlink(&g_dl[0], DL_BASE_ADDR, 0x02);
+    sim_i2c_attach(0, DL_BASE_ADDR, &sim_i2c_regmap_ops, &g_dl[0]);
+    sim_i2c_regmap_rbamp(&g_rbamp, 5, RBAMP_UID);
+    sim_i2c_attach(0, RBAMP_ADDR, &sim_i2c_regmap_ops, &g_rbamp);
+
+    devreg_init();
+    expect(devreg_scan_i2c(0) == ESP_OK, "registry scan failed");
+    devreg_scan_stats_t st;
+    devreg_get_scan_stats(&st);
+    expect(st.found_new == 2 && st.rbamp_rescan && sim_rbamp_source_rescans() == 1,
+           "scan did not find both modules / request the rbAmp rescan");
+    bool paused = true;
+    expect(sim_rbamp_source_pauses(&paused) == 1 && !paused && st.quiesce_ms >= DEVREG_SCAN_QUIESCE_MS,
+           "new modules not identified in one quiesced window");
+    bool dl = false, amp = false;
+    for (size_t i = 0; i < devreg_count(); i++) {
+        const device_entry_t* d = devreg_get(i);
+        if (!d || !d->valid) continue;
+        if (d->addr == DL_BASE_ADDR)  dl  = d->family == DEV_FAMILY_LEGACY_DIMMER;
+        if (d->addr == RBAMP_ADDR)    amp = d->family == DEV_FAMILY_RBAMP && d->channels == 2;
+    }
+    expect(dl && amp, "registry entries wrong");
+
+    // Per-channel roles of the 2-channel module reach the rbAmp role table.
+    expect(devreg_set_role(0, RBAMP_ADDR, 0, DEV_ROLE_GRID) == ESP_OK &&
+           devreg_set_role(0, RBAMP_ADDR, 1, DEV_ROLE_SOLAR) == ESP_OK,
+           "per-channel role rejected");
+    expect(devreg_set_role(0, RBAMP_ADDR, 2, DEV_ROLE_LOAD) == ESP_ERR_INVALID_ARG,
+           "role accepted on a channel the variant does not have");
+    rbamp_source_module_cfg_t roles[RBAMP_SOURCE_MAX_ROLES];
+    size_t nr = 0;
+    rbamp_source_get_roles(roles, RBAMP_SOURCE_MAX_ROLES, &nr);
+    bool grid = false, solar = false;
+    for (size_t i = 0; i < nr; i++) {
+        if (roles[i].i2c_addr != RBAMP_ADDR) continue;
+        grid  |= roles[i].channel == 0 && roles[i].role == RBAMP_ROLE_GRID;
+        solar |= roles[i].channel == 1 && roles[i].role == RBAMP_ROLE_SOLAR;
+    }
+    expect(nr == 2 && grid && solar, "channel roles not bridged to rbamp_source");
+
+    // The rbAmp swapped for a legacy DimmerLink whose first read after idle looks
+    // like a v1.3+ VERSION: the known UID must not carry the old identity over.
+    sim_i2c_detach(0, RBAMP_ADDR);
+    sim_i2c_regmap_dimmerlink(&g_dl[1], RBAMP_ADDR, 0x02);
+    g_dl[1].garble_idle_ms = 30;
+    g_dl[1].garble_value   = 0x05;
+    sim_i2c_attach(0, RBAMP_ADDR, &sim_i2c_regmap_ops, &g_dl[1]);
+    vTaskDelay(pdMS_TO_TICKS(60));
+    expect(devreg_scan_i2c(0) == ESP_OK, "rescan after the swap failed");
+    bool swapped = false;
+    for (size_t i = 0; i < devreg_count(); i++) {
+        const device_entry_t* d = devreg_get(i);
+        if (d && d->valid && d->addr == RBAMP_ADDR) {
+            swapped = d->family == DEV_FAMILY_LEGACY_DIMMER && d->online;
+        }
+    }
+    expect(swapped, "swapped module kept the old rbAmp identity");
+}
+
+// An I2C relay (DimmerLink at 100 % / 0 %) whose queued OFF write is NACKed:
+// the relay must not stay reported OFF with the load still on.
+void checkRelayLostWrite() {
+    sim_i2c_reset();
+    sim_i2c_regmap_dimmerlink(&g_dl[0], DL_BASE_ADDR, 0x02);
+    g_dl[0].garble_idle_ms = 0;
+    sim_i2c_attach(0, DL_BASE_ADDR, &sim_i2c_regmap_ops, &g_dl[0]);
+    i2c_bus_health_clear(0, DL_BASE_ADDR);
+
+    relay_manager_init();
+    relay_t* r = relay_get(4);
+    r->type     = RELAY_TYPE_I2C;
+    r->i2c_addr = DL_BASE_ADDR;
+    r->enabled  = true;
+    expect(relay_i2c_begin(r) == ESP_OK && r->initialized, "I2C relay did not initialize");
+
+    expect(relay_turn_on(4, true) == ESP_OK, "relay ON not queued");
+    vTaskDelay(pdMS_TO_TICKS(20));
+    expect(g_dl[0].reg[DL_REG_DIM0_LEVEL] == 100, "relay ON did not land");
+
+    sim_i2c_inject_nack(0, DL_BASE_ADDR, 1);
+    expect(relay_turn_off(4, true) == ESP_OK && !relay_is_on(4), "relay OFF not queued");
+    vTaskDelay(pdMS_TO_TICKS(20));
+    expect(g_dl[0].reg[DL_REG_DIM0_LEVEL] == 100, "fabric did not lose the OFF write");
+
+    relay_update_all();
+    vTaskDelay(pdMS_TO_TICKS(20));
+    expect(g_dl[0].reg[DL_REG_DIM0_LEVEL] == 0 && !relay_is_on(4) && !r->lost_off,
+           "lost relay OFF not retried");
+    relay_update_all();
+    expect(!relay_is_on(4), "relay state flipped after a clean retry");
+}
+
+// A manager-bound DimmerLink whose queued OFF write is NACKed: the router only
+// writes on a change, so the manager has to re-send the level it reports.
+void checkDimmerLostWrite() {
+    sim_i2c_reset();
+    sim_i2c_regmap_dimmerlink(&g_dl[0], DL_BASE_ADDR, 0x02);
+    g_dl[0].garble_idle_ms = 0;
+    sim_i2c_attach(0, DL_BASE_ADDR, &sim_i2c_regmap_ops, &g_dl[0]);
+    i2c_bus_health_clear(0, DL_BASE_ADDR);
+
+    dimmer_manager_init();
+    int id = dimmer_bind_i2c(0, DL_BASE_ADDR);
+    expect(id >= 0, "DimmerLink not bound to a dimmer");
+
+    expect(dimmer_set_level((uint8_t)id, 60) == ESP_OK, "dimmer level not queued");
+    vTaskDelay(pdMS_TO_TICKS(20));
+    expect(g_dl[0].reg[DL_REG_DIM0_LEVEL] == 60, "dimmer level did not land");
+
+    sim_i2c_inject_nack(0, DL_BASE_ADDR, 1);
+    expect(dimmer_set_level((uint8_t)id, 0) == ESP_OK, "dimmer OFF not queued");
+    vTaskDelay(pdMS_TO_TICKS(20));
+    expect(g_dl[0].reg[DL_REG_DIM0_LEVEL] == 60, "fabric did not lose the OFF write");
+
+    dimmer_update_all();
+    vTaskDelay(pdMS_TO_TICKS(20));
+    expect(g_dl[0].reg[DL_REG_DIM0_LEVEL] == 0 && dimmer_get_level((uint8_t)id) == 0 &&
+               dimmer_get_state((uint8_t)id) == DIMMER_STATE_OFF,
+           "lost dimmer OFF not retried");
+}
+
+// Async queue policy on bus 0, with a slow write to DL_BASE_ADDR holding the
+// worker while requests to DL_BASE_ADDR + 1 pile up behind it.
+int g_order[3];
+int g_order_n = 0;
+
+void recordOrder(esp_err_t, void* ctx) {
+    g_order[__atomic_fetch_add(&g_order_n, 1, __ATOMIC_SEQ_CST) % 3] = (int)(intptr_t)ctx;
+}
+
+i2c_bus_xfer_t levelWrite(i2c_bus_prio_t prio, uint8_t addr, const uint8_t* level) {
+    i2c_bus_xfer_t x = {};
+    x.op   = I2C_BUS_OP_WRITE;
+    x.prio = prio;
+    x.addr = addr;
+    x.reg  = DL_REG_DIM0_LEVEL;
+    x.tx   = level;
+    x.len  = 1;
+    return x;
+}
+
+void checkAsyncQueue() {
+    sim_i2c_reset();
+    for (int i = 0; i < 2; i++) {
+        sim_i2c_regmap_dimmerlink(&g_dl[i], (uint8_t)(DL_BASE_ADDR + i), 0x02);
+        g_dl[i].garble_idle_ms = 0;
+        sim_i2c_attach(0, (uint8_t)(DL_BASE_ADDR + i), &sim_i2c_regmap_ops, &g_dl[i]);
+        i2c_bus_health_clear(0, (uint8_t)(DL_BASE_ADDR + i));
+    }
+    static i2c_bus_future_t blocker, fut[I2C_BUS_ASYNC_DEPTH];
+    static bool futures_ready = false;
+    if (!futures_ready) {
+        i2c_bus_future_init(&blocker);
+        for (auto& f : fut) i2c_bus_future_init(&f);
+        futures_ready = true;
+    }
+    const uint8_t one = 1, level = 55;
+
+    // Priority order: queued background, telemetry, actuation run the other way round.
+    sim_i2c_set_latency(0, DL_BASE_ADDR, 30000);
+    i2c_bus_xfer_t b = levelWrite(I2C_BUS_PRIO_ACTUATION, DL_BASE_ADDR, &one);
+    expect(i2c_bus_submit(0, &b, &blocker) == ESP_OK, "blocker not queued");
+    vTaskDelay(pdMS_TO_TICKS(5));
+    g_order_n = 0;
+    const i2c_bus_prio_t prios[3] = { I2C_BUS_PRIO_BACKGROUND, I2C_BUS_PRIO_TELEMETRY,
+                                      I2C_BUS_PRIO_ACTUATION };
+    for (int i = 0; i < 3; i++) {
+        i2c_bus_xfer_t x = levelWrite(prios[i], DL_BASE_ADDR + 1, &one);
+        x.cb  = recordOrder;
+        x.ctx = (void*)(intptr_t)prios[i];
+        expect(i2c_bus_submit(0, &x, &fut[i]) == ESP_OK, "ordered write not queued");
+    }
+    i2c_bus_future_wait(&blocker);
+    for (int i = 0; i < 3; i++) i2c_bus_future_wait(&fut[i]);
+    expect(g_order_n == 3 && g_order[0] == I2C_BUS_PRIO_ACTUATION &&
+           g_order[1] == I2C_BUS_PRIO_TELEMETRY && g_order[2] == I2C_BUS_PRIO_BACKGROUND,
+           "queue not served in priority order");
+
+    // Reserved slots and deadlines: everything queued behind a 300 ms blocker
+    // expires (default deadline 200 ms) and never reaches the slave.
+    i2c_bus_async_stats_t before, after;
+    i2c_bus_async_get_stats(0, &before);
+    g_dl[1].reg[DL_REG_DIM0_LEVEL] = 0;
+    sim_i2c_set_latency(0, DL_BASE_ADDR, 300000);
+    expect(i2c_bus_submit(0, &b, &blocker) == ESP_OK, "blocker not queued");
+    vTaskDelay(pdMS_TO_TICKS(5));
+    int queued = 0, tel = 0, act = 0;
+    for (;;) {
+        i2c_bus_xfer_t x = levelWrite(I2C_BUS_PRIO_TELEMETRY, DL_BASE_ADDR + 1, &level);
+        if (i2c_bus_submit(0, &x, &fut[queued]) != ESP_OK) break;
+        queued++;
+        tel++;
+    }
+    i2c_bus_xfer_t bg = levelWrite(I2C_BUS_PRIO_BACKGROUND, DL_BASE_ADDR + 1, &level);
+    expect(i2c_bus_submit(0, &bg, nullptr) == ESP_ERR_NO_MEM, "background took a reserved slot");
+    for (;;) {
+        i2c_bus_xfer_t x = levelWrite(I2C_BUS_PRIO_ACTUATION, DL_BASE_ADDR + 1, &level);
+        if (i2c_bus_submit(0, &x, &fut[queued]) != ESP_OK) break;
+        queued++;
+        act++;
+    }
+    expect(tel == I2C_BUS_ASYNC_DEPTH - 1 - I2C_BUS_ASYNC_RESERVED && act == I2C_BUS_ASYNC_RESERVED,
+           "reserved slots not kept for actuation");
+    expect(i2c_bus_future_wait(&blocker) == ESP_OK, "blocker failed");
+    int expired = 0;
+    for (int i = 0; i < queued; i++) expired += i2c_bus_future_wait(&fut[i]) == ESP_ERR_TIMEOUT;
+    i2c_bus_async_get_stats(0, &after);
+    expect(expired == queued && after.expired - before.expired == (uint32_t)queued &&
+           after.rejected - before.rejected == 3, "stale requests not expired / refusals not counted");
+    expect(g_dl[1].reg[DL_REG_DIM0_LEVEL] == 0, "expired write reached the slave");
+
+    // Stop with a request queued: it fails, nothing waits forever, and the bus
+    // runs inline until the worker is restarted.
+    sim_i2c_set_latency(0, DL_BASE_ADDR, 50000);
+    expect(i2c_bus_submit(0, &b, &blocker) == ESP_OK, "blocker not queued");
+    vTaskDelay(pdMS_TO_TICKS(5));
+    i2c_bus_xfer_t t = levelWrite(I2C_BUS_PRIO_TELEMETRY, DL_BASE_ADDR + 1, &level);
+    expect(i2c_bus_submit(0, &t, &fut[0]) == ESP_OK, "write not queued before stop");
+    i2c_bus_async_stop(0);
+    expect(i2c_bus_future_wait(&blocker) == ESP_OK &&
+           i2c_bus_future_wait(&fut[0]) == ESP_ERR_INVALID_STATE, "queued request not failed at stop");
+    expect(i2c_bus_submit(0, &t, nullptr) == ESP_OK && g_dl[1].reg[DL_REG_DIM0_LEVEL] == level,
+           "no inline path after stop");
+    sim_i2c_set_latency(0, DL_BASE_ADDR, 0);
+    expect(i2c_bus_async_start(0) == ESP_OK, "worker did not restart");
+}
+
+void checkManager(int n, int buses) {
+    attachModules(n, buses);
+    dl_manager_init();
+    for (int i = 0; i < n; i++) {
+        dl_device_config_t cfg = {};
+        cfg.i2c_addr = (uint8_t)(DL_BASE_ADDR + i);
+        cfg.i2c_bus  = busOf(i, buses);
+        cfg.role     = DL_ROLE_DIMMER;
+        cfg.enabled  = true;
+        snprintf(cfg.name, sizeof(cfg.name), "dl%d", i);
+        dl_manager_register((uint8_t)i, &cfg);
+    }
+    dl_manager_start_polling(10);
+    vTaskDelay(pdMS_TO_TICKS(300));
+    dl_manager_stop_polling();
+    vTaskDelay(pdMS_TO_TICKS(100));     // let the last cycle finish
+    expect(dl_manager_get_active_count() == n, "dl_manager did not bring every module online");
+}
+
+}  // namespace
+
+// The dimmer manager's ESP-NOW backend: no ESP-NOW outputs on this bench.
+extern "C" esp_err_t esp_now_source_set_output(const uint8_t[6], uint8_t, uint8_t, uint16_t,
+                                               uint16_t) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+int main(int argc, char** argv) {
+    bool check = false;
+    uint32_t ms = 1000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--check"))                   check = true;
+        else if (!strcmp(argv[i], "--ms") && i + 1 < argc) ms = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        else {
+            fprintf(stderr, "usage: %s [--check] [--ms N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (ms == 0) ms = 1000;
+
+    for (uint8_t bus = 0; bus < 2; bus++) {
+        i2c_bus_init(bus, 21 + bus * 4, 22 + bus * 4, DL_I2C_SPEED_HZ);
+    }
+
+    if (check) {
+        // Blocking calls first (inline, no workers), then the queued path.
+        checkStopLatch();
+        checkVersionGate();
+        checkFaults();
+    }
+    for (uint8_t bus = 0; bus < 2; bus++) i2c_bus_async_start(bus);
+    if (check) {
+        checkPollDecode();
+        checkAsyncQueue();
+        checkRegistryScan();
+        checkRelayLostWrite();
+        checkDimmerLostWrite();
+        checkManager(4, 2);
+    }
+
+    printf("DimmerLink poll cycles on the simulated I2C fabric (%u ms per run, %u Hz)\n",
+           ms, (unsigned)DL_I2C_SPEED_HZ);
+    printf("%-10s %7s %5s %10s %10s %9s %7s\n", "wire", "modules", "buses", "cycle_us",
+           "cycles/s", "reads/cyc", "failed");
+
+    RunResult one[MAX_MODULES + 1] = {}, two[MAX_MODULES + 1] = {};
+    for (int n : SIZES) {
+        attachModules(n, 1);
+        one[n] = runCycles(n, 1, ms);
+        printRun("100kHz", n, 1, one[n]);
+        if (n == 1) continue;
+        attachModules(n, 2);
+        two[n] = runCycles(n, 2, ms);
+        printRun("100kHz", n, 2, two[n]);
+    }
+    sim_i2c_set_wire_model(false);
+    attachModules(MAX_MODULES, 1);
+    const RunResult sw = runCycles(MAX_MODULES, 1, ms);
+    printRun("off", MAX_MODULES, 1, sw);
+    sim_i2c_set_wire_model(true);
+
+    if (!check) return 0;
+
+    for (int n : SIZES) {
+        expect(one[n].failed == 0 && (n == 1 || two[n].failed == 0), "throughput run had failed polls");
+    }
+    expect(two[MAX_MODULES].cycles_per_s > 1.3 * one[MAX_MODULES].cycles_per_s,
+           "two buses not faster than one");
+    expect(sw.cycles_per_s > one[MAX_MODULES].cycles_per_s, "software path slower than the wire");
+    printf("%s\n", g_failures ? "CHECK FAILED" : "CHECK PASSED");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file meas_bench.cpp
+ * @brief acrouter_measurements_t vs acrouter_meas_packed_t: size and throughput.
+ *
+ * Reports the size of both layouts, the cost of pack / unpack per frame, the
+ * copy throughput of a frame array in each layout (what the ring, the source
+ * cache and the MERGED_UPDATE post pay per frame), and the single-threaded
+ * publish + peek/release rate of acrouter_meas_ring.
+ *
+ * --check verifies the format itself: round-trip precision within one LSB over
+ * random frames, NaN/Inf dropping (flag cleared), saturation at the field
+ * limits, rejection of an unknown version and 32-bit timestamp re-extension
+ * across a wrap.
+ *
+ * Usage: meas_bench [--check] [--frames N]
+ */
+
+#include "acrouter_meas_packed.h"
+#include "acrouter_meas_ring.h"
+#include "acrouter_events.h"
+#include "host_clock.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+volatile uint32_t g_sink;   // keeps the timed loops from being optimised away
+
+acrouter_measurements_t randomFrame(std::mt19937& rng) {
+    std::uniform_real_distribution<float> volts(180.0f, 260.0f);
+    std::uniform_real_distribution<float> amps(0.0f, 60.0f);
+    std::uniform_real_distribution<float> watts(-12000.0f, 12000.0f);
+    std::uniform_int_distribution<int> coin(0, 3);
+
+    acrouter_measurements_t m;
+    acrouter_measurements_init(&m);
+    m.source       = (acrouter_source_t)(1 + coin(rng) % 3);
+    m.source_id    = (uint8_t)coin(rng);
+    m.valid        = true;
+    m.timestamp_us = (uint64_t)rng() << 12;
+    m.has_voltage  = coin(rng) != 0;
+    m.voltage_rms  = volts(rng);
+    for (int ch = 0; ch < ACROUTER_CH_COUNT; ch++) {
+        m.has_current[ch]  = coin(rng) != 0;
+        m.current_rms[ch]  = amps(rng);
+        m.has_power[ch]    = m.has_current[ch] && coin(rng) != 0;
+        m.power_active[ch] = watts(rng);
+        m.direction[ch]    = (acrouter_direction_t)coin(rng);
+    }
+    return m;
+}
+
+// ------------------------------------------------------------
+// Format checks
+// ------------------------------------------------------------
+
+int g_failures = 0;
+
+void expect(bool cond, const char* what) {
+    if (!cond) {
+        fprintf(stderr, "CHECK FAILED: %s\n", what);
+        g_failures++;
+    }
+}
+
+void checkRoundTrip(uint32_t frames) {
+    std::mt19937 rng(1);
+    uint32_t bad = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        const acrouter_measurements_t m = randomFrame(rng);
+        acrouter_meas_packed_t p;
+        acrouter_measurements_t u;
+        acrouter_meas_pack(&m, &p);
+        if (!acrouter_meas_unpack(&p, &u, m.timestamp_us + 5000000ULL)) { bad++; continue; }
+
+        bool ok = u.valid == m.valid && u.source == m.source && u.source_id == m.source_id &&
+                  u.timestamp_us == m.timestamp_us && u.has_voltage == m.has_voltage;
+        if (m.has_voltage) ok = ok && std::fabs(u.voltage_rms - m.voltage_rms) <= ACROUTER_PK_VOLTAGE_LSB;
+        for (int ch = 0; ch < ACROUTER_CH_COUNT; ch++) {
+            ok = ok && u.has_current[ch] == m.has_current[ch] && u.has_power[ch] == m.has_power[ch] &&
+                 u.direction[ch] == m.direction[ch];
+            if (m.has_current[ch]) ok = ok && std::fabs(u.current_rms[ch] - m.current_rms[ch]) <= ACROUTER_PK_CURRENT_LSB;
+            if (m.has_power[ch])   ok = ok && std::fabs(u.power_active[ch] - m.power_active[ch]) <= ACROUTER_PK_POWER_LSB;
+        }
+        if (!ok) bad++;
+    }
+    if (bad) fprintf(stderr, "  round-trip: %u / %u frames outside one LSB\n", bad, frames);
+    expect(bad == 0, "round-trip precision");
+}
+
+void checkEdges() {
+    acrouter_measurements_t m;
+    acrouter_measurements_init(&m);
+    m.valid = true;
+    m.has_voltage = true;
+    m.voltage_rms = NAN;
+    m.has_current[ACROUTER_CH_GRID] = true;
+    m.current_rms[ACROUTER_CH_GRID] = INFINITY;
+    m.has_current[ACROUTER_CH_SOLAR] = true;
+    m.current_rms[ACROUTER_CH_SOLAR] = 1000.0f;      // > 655.35 A
+    m.has_power[ACROUTER_CH_SOLAR] = true;
+    m.power_active[ACROUTER_CH_SOLAR] = -50000.0f;   // < -32767 W
+    m.has_current[ACROUTER_CH_LOAD] = true;
+    m.current_rms[ACROUTER_CH_LOAD] = -1.0f;         // negative RMS → 0
+    m.has_power[ACROUTER_CH_LOAD] = true;
+    m.power_active[ACROUTER_CH_LOAD] = NAN;
+
+    acrouter_meas_packed_t p;
+    acrouter_meas_pack(&m, &p);
+    expect(!acrouter_pk_has_voltage(&p), "NaN voltage keeps its flag");
+    expect(!acrouter_pk_has_current(&p, ACROUTER_CH_GRID), "Inf current keeps its flag");
+    expect(!acrouter_pk_has_power(&p, ACROUTER_CH_LOAD), "NaN power keeps its flag");
+    expect(p.current_ca[ACROUTER_CH_SOLAR] == 65535, "current does not saturate high");
+    expect(p.power_w[ACROUTER_CH_SOLAR] == -32767, "power does not saturate low");
+    expect(p.current_ca[ACROUTER_CH_LOAD] == 0, "negative current does not clamp to 0");
+    expect(acrouter_pk_s16(40000.0f, 1.0f) == 32767, "power does not saturate high");
+
+    acrouter_measurements_t u;
+    acrouter_meas_packed_t bad = p;
+    bad.version = ACROUTER_MEAS_PACKED_VERSION + 1;
+    expect(!acrouter_meas_unpack(&bad, &u, 0) && !u.valid, "unknown version accepted");
+
+    // Timestamp taken just before the low 32 bits wrap, unpacked just after.
+    m.timestamp_us = 0x1FFFFFF00ULL;
+    acrouter_meas_pack(&m, &p);
+    expect(acrouter_meas_unpack(&p, &u, 0x200000100ULL) && u.timestamp_us == 0x1FFFFFF00ULL,
+           "timestamp not re-extended across a 32-bit wrap");
+    // And a frame stamped slightly after the reference (producer raced the reader).
+    m.timestamp_us = 0x300000010ULL;
+    acrouter_meas_pack(&m, &p);
+    expect(acrouter_meas_unpack(&p, &u, 0x2FFFFFFF0ULL) && u.timestamp_us == 0x300000010ULL,
+           "timestamp ahead of the reference not re-extended");
+}
+
+// ------------------------------------------------------------
+// Throughput
+// ------------------------------------------------------------
+
+template <typename T>
+double copyNsPerFrame(const std::vector<T>& src, uint32_t reps) {
+    std::vector<T> dst(src.size());
+    const int64_t t0 = host_clock_wall_ns();
+    for (uint32_t r = 0; r < reps; r++) {
+        memcpy(dst.data(), src.data(), src.size() * sizeof(T));
+        g_sink += ((const uint8_t*)dst.data())[r % (src.size() * sizeof(T))];
+    }
+    return (double)(host_clock_wall_ns() - t0) / ((double)reps * src.size());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool check = false;
+    uint32_t frames = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--check"))                       check = true;
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        else {
+            fprintf(stderr, "usage: %s [--check] [--frames N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames == 0) frames = 1000000;
+
+    // A working set of 256 frames: what a few seconds of a 4-module fleet leaves
+    // in flight between ring, cache and event queue — it stays cache-resident, as
+    // on the target.
+    constexpr size_t SET = 256;
+    std::mt19937 rng(7);
+    std::vector<acrouter_measurements_t> full(SET);
+    std::vector<acrouter_meas_packed_t> packed(SET);
+    for (size_t i = 0; i < SET; i++) {
+        full[i] = randomFrame(rng);
+        acrouter_meas_pack(&full[i], &packed[i]);
+    }
+
+    printf("measurement frame layouts (frames=%u)\n", frames);
+    printf("  %-24s %5zu B\n", "acrouter_measurements_t", sizeof(acrouter_measurements_t));
+    printf("  %-24s %5zu B  (%.0f%%)\n", "acrouter_meas_packed_t", sizeof(acrouter_meas_packed_t),
+           100.0 * sizeof(acrouter_meas_packed_t) / sizeof(acrouter_measurements_t));
+
+    acrouter_meas_packed_t p;
+    int64_t t0 = host_clock_wall_ns();
+    for (uint32_t i = 0; i < frames; i++) {
+        acrouter_meas_pack(&full[i % SET], &p);
+        g_sink += p.flags;
+    }
+    const double pack_ns = (double)(host_clock_wall_ns() - t0) / frames;
+
+    acrouter_measurements_t u;
+    t0 = host_clock_wall_ns();
+    for (uint32_t i = 0; i < frames; i++) {
+        acrouter_meas_unpack(&packed[i % SET], &u, 1ULL << 40);
+        g_sink += u.has_voltage;
+    }
+    const double unpack_ns = (double)(host_clock_wall_ns() - t0) / frames;
+
+    const uint32_t reps = frames / SET ? frames / SET : 1;
+    const double copy_full_ns = copyNsPerFrame(full, reps);
+    const double copy_pk_ns   = copyNsPerFrame(packed, reps);
+
+    printf("\n%-28s %10s\n", "operation", "ns/frame");
+    printf("%-28s %10.2f\n", "pack", pack_ns);
+    printf("%-28s %10.2f\n", "unpack", unpack_ns);
+    printf("%-28s %10.2f\n", "copy acrouter_measurements_t", copy_full_ns);
+    printf("%-28s %10.2f\n", "copy acrouter_meas_packed_t", copy_pk_ns);
+
+    // Ring: publish (pack into the slot) + peek/release, single thread.
+    acrouter_meas_ring_attach(nullptr, nullptr);
+    t0 = host_clock_wall_ns();
+    for (uint32_t i = 0; i < frames; i++) {
+        acrouter_meas_publish(&full[i % SET]);
+        const acrouter_meas_packed_t* f = acrouter_meas_ring_peek();
+        if (f) {
+            g_sink += f->flags;
+            acrouter_meas_ring_release();
+        }
+    }
+    const double ring_ns = (double)(host_clock_wall_ns() - t0) / frames;
+    acrouter_meas_ring_detach();
+    printf("%-28s %10.2f  (%.2f Mframes/s)\n", "ring publish+consume", ring_ns, 1e3 / ring_ns);
+
+    if (!check) return 0;
+
+    expect(sizeof(acrouter_meas_packed_t) == 24, "packed frame is not 24 bytes");
+    expect(sizeof(acrouter_meas_packed_t) < sizeof(acrouter_measurements_t), "packed frame not smaller");
+    checkRoundTrip(frames < 200000 ? frames : 200000);
+    checkEdges();
+    printf("%s\n", g_failures ? "CHECK FAILED" : "CHECK PASSED");
+    return g_failures ? 1 : 0;
+}
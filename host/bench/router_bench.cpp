@@ -0,0 +1,712 @@
+/**
+ * @file router_bench.cpp
+ * @brief Closed-loop benchmark of the control core against the simulated house.
+ *
+ * Runs the real RouterController / sensor_hub / dimmer+relay managers against
+ * sim_plant for every RouterMode and reports:
+ *   - settling time after each disturbance (aggregate heater power back inside a
+ *     ±2 %-of-capacity band around its final value),
+ *   - grid export / import energy (Wh) over a step scenario and a cloudy day,
+ *   - output level changes per minute over the cloudy day (hunting),
+ *   - CPU cost of RouterController::update() (mean / p99 µs, wall clock),
+ *   - sensor_hub merge rate (merges per simulated second) and the share of source
+ *     frames folded into an epoch instead of triggering their own merge.
+ *
+ * A second table reruns the regulating modes (AUTO, ECO, GRID_LIMIT) with each
+ * controller engine — legacy P step, PI, PID — at the built-in default gains.
+ *
+ * The simulation runs on simulated time, so a 30-minute cloudy scenario takes a
+ * fraction of a second and every run with the same seed is bit-identical.
+ *
+ * A third table compares AUTO feedback-only with feed-forward from the load and
+ * solar channels, with the mean prediction error.
+ *
+ * A fourth table runs AUTO (PI) plant-gain tuning on the correct model and with
+ * the DimmerLink heater's nominal power mis-set, with the learned gain and the
+ * NVS commits it cost.
+ *
+ * A fifth table runs AUTO (PI) with and without dead-time compensation on several
+ * module phase layouts, with the acquisition-to-output latency (p50 / p99).
+ *
+ * --check also runs AUTO (legacy P) with the dimmers disabled: the relay alone
+ * must switch on under export and off under import.
+ *
+ * Usage: router_bench [--check] [--seed N] [--trace] [--per-frame] [--engine p|pi|pid] [--ff]
+ *   --check      exit non-zero if a mode falls outside its regression bounds (ctest)
+ *   --trace      print a 1 Hz trace of the AUTO step scenario
+ *   --per-frame  merge on every source frame (pre-epoch behaviour) for comparison
+ *   --engine     engine of the main table's regulating modes (default: built-in)
+ *   --ff         enable AUTO feed-forward in the main table
+ */
+
+#include "RouterController.h"
+#include "sensor_hub.h"
+#include "dimmer_manager.h"
+#include "relay_manager.h"
+#include "acrouter_events.h"
+#include "acrouter_meas_ring.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "host_clock.h"
+#include "sim_plant.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Simulated installation: a 2 kW DimmerLink heater (RMS curve) sharing prio 0
+// with a 500 W one on the LINEAR curve, a 1.5 kW ESP-NOW dimmer node (prio 1)
+// and a 1 kW relay-switched heater (prio 2).
+constexpr uint8_t  DL_BUS          = 0;
+constexpr uint8_t  DL_ADDR         = 0x50;
+constexpr float    DL_LOAD_W       = 2000.0f;
+constexpr uint8_t  DL2_ADDR        = 0x51;
+constexpr float    DL2_LOAD_W      = 500.0f;
+constexpr uint8_t  NODE_MAC[6]     = { 0x24, 0x6F, 0x28, 0x00, 0x00, 0x01 };
+constexpr float    NODE_LOAD_W     = 1500.0f;
+constexpr int      RELAY_GPIO      = 5;
+constexpr float    RELAY_LOAD_W    = 1000.0f;
+
+// Plant-gain scenario: the 2 kW DimmerLink heater configured as 1.2 kW.
+constexpr float    DL_MISSET_W     = 1200.0f;
+
+constexpr uint32_t TICK_MS         = SIM_PLANT_PERIOD_MS;
+constexpr float    SETTLE_BAND     = 0.02f;   // of heater capacity
+constexpr uint32_t SETTLE_TAIL_MS  = 5000;    // final value = mean of the segment's tail
+constexpr uint32_t PREROLL_MS      = 65000;   // > relay min on/off time (60 s default)
+constexpr float    GRID_LIMIT_A    = 10.0f;
+
+struct ModeInfo {
+    RouterMode  mode;
+    const char* name;
+};
+
+const ModeInfo kModes[] = {
+    { RouterMode::OFF,        "OFF"        },
+    { RouterMode::AUTO,       "AUTO"       },
+    { RouterMode::ECO,        "ECO"        },
+    { RouterMode::OFFGRID,    "OFFGRID"    },
+    { RouterMode::MANUAL,     "MANUAL"     },
+    { RouterMode::BOOST,      "BOOST"      },
+    { RouterMode::GRID_LIMIT, "GRID_LIMIT" },
+};
+
+struct Result {
+    float    settle_mean_s = 0.0f;
+    float    settle_max_s  = 0.0f;
+    double   step_export_wh = 0.0, step_import_wh = 0.0;
+    double   day_export_wh  = 0.0, day_import_wh  = 0.0, day_heater_wh = 0.0, day_pv_wh = 0.0;
+    uint32_t updates = 0;
+    double   us_mean = 0.0;
+    double   us_p99  = 0.0;
+    float    changes_per_min = 0.0f;  // cloudy day: ticks on which heater power changed
+    float    ff_error_w      = 0.0f;  // cloudy day: mean AUTO feed-forward prediction error
+    float    ff_active_pct   = 0.0f;  // cloudy day: share of ticks with feed-forward in use
+    float    lat_p50_ms      = 0.0f;  // acquisition-to-output latency, end of the cloudy day
+    float    lat_p99_ms      = 0.0f;
+    float    merges_per_s   = 0.0f;   // per simulated second
+    float    suppressed_pct = 0.0f;   // source frames that did not trigger a merge
+};
+
+// ------------------------------------------------------------
+// Measurement-ring consumer — stands in for the control task
+// ------------------------------------------------------------
+
+std::vector<double> g_update_us;
+
+// The firmware's wake hook notifies the control task; here the sim is single-threaded
+// on simulated time, so drain synchronously — same pump, same update(), no latency.
+void onRingWake(void*) {
+    acrouter_measurements_t m;
+    while (sensor_hub_pump(&m)) {
+        const int64_t t0 = host_clock_wall_ns();
+        RouterController::getInstance().update(m);
+        g_update_us.push_back((host_clock_wall_ns() - t0) / 1000.0);
+    }
+}
+
+// ------------------------------------------------------------
+// Scenario helpers
+// ------------------------------------------------------------
+
+uint64_t g_rng = 1;
+int      g_dl_id = -1;
+int      g_dimmer_ids[3] = { -1, -1, -1 };
+
+float rnd() {
+    g_rng = g_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (float)(g_rng >> 40) / (float)(1ULL << 24);
+}
+
+/** Settling time of one segment from its heater-power samples (one per tick). */
+float settleTime(const std::vector<float>& heater_w, float capacity_w) {
+    const size_t tail = SETTLE_TAIL_MS / TICK_MS;
+    if (heater_w.size() <= tail) return 0.0f;
+    double sum = 0.0;
+    for (size_t i = heater_w.size() - tail; i < heater_w.size(); i++) sum += heater_w[i];
+    const float final_w = (float)(sum / tail);
+    const float band = SETTLE_BAND * capacity_w;
+    size_t last_out = 0;
+    bool   any_out  = false;
+    for (size_t i = 0; i < heater_w.size(); i++) {
+        if (std::fabs(heater_w[i] - final_w) > band) { last_out = i; any_out = true; }
+    }
+    return any_out ? (float)((last_out + 1) * TICK_MS) / 1000.0f : 0.0f;
+}
+
+void resetRouter(RouterMode mode) {
+    RouterController& router = RouterController::getInstance();
+    router.setMode(RouterMode::OFF);
+    router.refreshPriorityMap();           // drop cascade targets left by the previous mode
+    sim_plant_set_pv_w(3000.0f);
+    sim_plant_set_base_load_w(400.0f);
+    // ECO only ever sheds load: start it from the MANUAL level so it has some to shed.
+    if (mode == RouterMode::ECO) router.setMode(RouterMode::MANUAL);
+    sim_plant_run(PREROLL_MS);             // relay debounce expires, hub caches refill
+    router.setMode(mode);
+}
+
+/**
+ * Step scenario (300 s): PV 3 kW, base 400 W; a 1.5 kW appliance switches on at
+ * 60 s and off at 120 s, a cloud cuts PV to 1.2 kW at 180 s and clears at 240 s.
+ */
+void runStep(const ModeInfo& mi, Result& r, bool trace) {
+    resetRouter(mi.mode);
+    sim_plant_reset_meters();
+
+    struct Segment { uint32_t len_ms; float pv_w; float base_w; };
+    const Segment segs[] = {
+        { 60000, 3000.0f,  400.0f },
+        { 60000, 3000.0f, 1900.0f },
+        { 60000, 3000.0f,  400.0f },
+        { 60000, 1200.0f,  400.0f },
+        { 60000, 3000.0f,  400.0f },
+    };
+    const float capacity = sim_plant_heater_capacity_w();
+    float settle_sum = 0.0f;
+    int   settle_n   = 0;
+    uint32_t t_ms    = 0;
+
+    for (size_t s = 0; s < sizeof(segs) / sizeof(segs[0]); s++) {
+        sim_plant_set_pv_w(segs[s].pv_w);
+        sim_plant_set_base_load_w(segs[s].base_w);
+        std::vector<float> heater;
+        heater.reserve(segs[s].len_ms / TICK_MS);
+        for (uint32_t t = 0; t < segs[s].len_ms; t += TICK_MS, t_ms += TICK_MS) {
+            sim_plant_run(TICK_MS);
+            heater.push_back(sim_plant_heater_w());
+            if (trace && (t_ms % 1000) == 0) {
+                const RouterStatus& st = RouterController::getInstance().getStatus();
+                printf("  t=%5.1fs pv=%6.0f base=%6.0f heater=%6.0f grid=%7.1f dimmer=%3u%%\n",
+                       t_ms / 1000.0, segs[s].pv_w, segs[s].base_w, sim_plant_heater_w(),
+                       sim_plant_grid_w(), st.dimmer_percent);
+            }
+        }
+        if (s == 0) continue;   // first segment is the start-up transient, not a disturbance
+        const float ts = settleTime(heater, capacity);
+        settle_sum += ts;
+        settle_n++;
+        r.settle_max_s = std::max(r.settle_max_s, ts);
+    }
+    r.settle_mean_s = settle_n ? settle_sum / settle_n : 0.0f;
+
+    sim_plant_meters_t m;
+    sim_plant_get_meters(&m);
+    r.step_export_wh = m.export_wh;
+    r.step_import_wh = m.import_wh;
+}
+
+/**
+ * Cloudy day (30 min around noon): 4 kW-peak PV under drifting clouds, 300 W base
+ * load, a 2 kW kettle and a cycling fridge. Same seed → same weather for every mode.
+ */
+void runCloudy(const ModeInfo& mi, Result& r, uint32_t seed) {
+    resetRouter(mi.mode);
+    sim_plant_reset_meters();
+    g_rng = 0x853C49E6748FEA9BULL ^ seed;
+
+    const uint32_t dur_ms  = 30 * 60 * 1000;
+    float   cloud_depth    = 0.0f;   // current attenuation target (0..1)
+    float   cloud          = 0.0f;   // smoothed attenuation
+    int32_t cloud_left_ms  = 0;
+    int32_t kettle_left_ms = 0;
+    float   last_heater_w  = sim_plant_heater_w();
+    uint32_t changes       = 0;
+    double  ff_err_sum     = 0.0;
+    uint32_t ff_active     = 0;
+
+    for (uint32_t t = 0; t < dur_ms; t += TICK_MS) {
+        if (cloud_left_ms <= 0 && rnd() < 0.004f) {
+            cloud_depth   = 0.3f + 0.5f * rnd();
+            cloud_left_ms = (int32_t)(10000 + 80000 * rnd());
+        }
+        if (cloud_left_ms > 0) {
+            cloud_left_ms -= TICK_MS;
+            if (cloud_left_ms <= 0) cloud_depth = 0.0f;
+        }
+        cloud += (cloud_depth - cloud) * 0.05f;   // ~4 s edge
+
+        if (kettle_left_ms <= 0 && rnd() < 0.0008f) kettle_left_ms = 180000;
+        if (kettle_left_ms > 0) kettle_left_ms -= TICK_MS;
+
+        const float day_pos = (float)t / dur_ms - 0.5f;         // -0.5..0.5 around noon
+        const float clear   = 4000.0f * std::cos(day_pos * 0.6f);
+        const bool  fridge  = ((t / 1000) % 900) < 300;
+        sim_plant_set_pv_w(clear * (1.0f - cloud));
+        sim_plant_set_base_load_w(300.0f + (fridge ? 120.0f : 0.0f) +
+                                  (kettle_left_ms > 0 ? 2000.0f : 0.0f));
+        sim_plant_run(TICK_MS);
+        const float heater_w = sim_plant_heater_w();
+        if (std::fabs(heater_w - last_heater_w) > 1.0f) changes++;
+        last_heater_w = heater_w;
+
+        const RouterStatus& st = RouterController::getInstance().getStatus();
+        ff_err_sum += st.ff_error_w;
+        if (st.ff_active) ff_active++;
+    }
+    r.changes_per_min = changes / (dur_ms / 60000.0f);
+    r.ff_error_w      = (float)(ff_err_sum / (dur_ms / TICK_MS));
+    r.ff_active_pct   = 100.0f * ff_active / (dur_ms / TICK_MS);
+
+    sim_plant_meters_t m;
+    sim_plant_get_meters(&m);
+    r.day_export_wh = m.export_wh;
+    r.day_import_wh = m.import_wh;
+    r.day_heater_wh = m.heater_wh;
+    r.day_pv_wh     = m.pv_wh;
+}
+
+void setupInstallation() {
+    nvs_flash_init();
+    esp_event_loop_create_default();
+
+    sim_plant_config_t cfg;
+    sim_plant_default_config(&cfg);
+    sim_plant_init(&cfg);
+    sim_plant_add_dimmerlink(DL_BUS, DL_ADDR, DL_LOAD_W);
+    sim_plant_add_dimmerlink(DL_BUS, DL2_ADDR, DL2_LOAD_W);
+    sim_plant_add_espnow_node(NODE_MAC, NODE_LOAD_W);
+    sim_plant_add_relay_load(RELAY_GPIO, RELAY_LOAD_W);
+
+    dimmer_manager_init();
+    relay_manager_init();
+
+    int dl = dimmer_bind_i2c(DL_BUS, DL_ADDR);
+    g_dl_id = dl;
+    dimmer_set_nominal_power(dl, (uint16_t)DL_LOAD_W);
+    dimmer_set_priority(dl, 0);
+
+    int dl2 = dimmer_bind_i2c(DL_BUS, DL2_ADDR);
+    dimmer_set_nominal_power(dl2, (uint16_t)DL2_LOAD_W);
+    dimmer_set_curve(dl2, DIMMER_CURVE_LINEAR);
+    dimmer_set_priority(dl2, 0);
+
+    int node = dimmer_bind_espnow(NODE_MAC);
+    dimmer_set_nominal_power(node, (uint16_t)NODE_LOAD_W);
+    dimmer_set_priority(node, 1);
+    g_dimmer_ids[0] = dl;
+    g_dimmer_ids[1] = dl2;
+    g_dimmer_ids[2] = node;
+
+    relay_set_enabled(0, true);
+    relay_set_gpio(0, RELAY_GPIO);
+    relay_set_nominal_power(0, (uint16_t)RELAY_LOAD_W);
+    relay_set_priority(0, 2);
+
+    sensor_hub_init();
+
+    RouterController& router = RouterController::getInstance();
+    router.begin((uint8_t)dl);
+    router.setManualLevel(50);
+    router.setGridCurrentLimit(GRID_LIMIT_A);
+
+    acrouter_meas_ring_attach(onRingWake, nullptr);
+}
+
+/** Run both scenarios for one mode and collect the metrics. */
+Result runMode(const ModeInfo& mi, uint32_t seed, bool trace) {
+    Result r;
+    g_update_us.clear();
+    sensor_hub_stats_t hs0, hs1;
+    sensor_hub_get_stats(&hs0);
+    const int64_t t0_us = host_clock_now_us();
+    runStep(mi, r, trace && mi.mode == RouterMode::AUTO);
+    runCloudy(mi, r, seed);
+    sensor_hub_get_stats(&hs1);
+
+    const uint32_t frames = hs1.frames_in - hs0.frames_in;
+    const uint32_t merges = hs1.merges - hs0.merges;
+    r.merges_per_s   = merges * 1e6f / (float)(host_clock_now_us() - t0_us);
+    r.suppressed_pct = frames ? 100.0f * (float)(frames - merges) / frames : 0.0f;
+
+    ControlLatency lat;
+    RouterController::getInstance().getControlLatency(lat);
+    r.lat_p50_ms = lat.p50_ms;
+    r.lat_p99_ms = lat.p99_ms;
+
+    r.updates = (uint32_t)g_update_us.size();
+    if (!g_update_us.empty()) {
+        double sum = 0.0;
+        for (double v : g_update_us) sum += v;
+        r.us_mean = sum / g_update_us.size();
+        std::vector<double> sorted = g_update_us;
+        std::sort(sorted.begin(), sorted.end());
+        r.us_p99 = sorted[(size_t)(0.99 * (sorted.size() - 1))];
+    }
+    return r;
+}
+
+/** Put every regulating mode on @p engine (default gains). */
+void setEngine(ControlEngine engine) {
+    RouterController& router = RouterController::getInstance();
+    for (uint8_t i = 0; i < static_cast<uint8_t>(PidLoop::COUNT); i++) {
+        PidGains g = RouterController::defaultPidGains(static_cast<PidLoop>(i));
+        g.engine = engine;
+        router.setPidGains(static_cast<PidLoop>(i), g);
+    }
+}
+
+const char* engineName(ControlEngine e) {
+    switch (e) {
+        case ControlEngine::P:  return "P";
+        case ControlEngine::PI: return "PI";
+        default:                return "PID";
+    }
+}
+
+bool checkBounds(const ModeInfo& mi, const Result& r, const Result& off, bool default_engine) {
+    bool ok = true;
+    auto fail = [&](const char* what) {
+        fprintf(stderr, "CHECK FAILED [%s]: %s\n", mi.name, what);
+        ok = false;
+    };
+    if (r.us_p99 > 2000.0) fail("update() p99 above 2 ms");
+    switch (mi.mode) {
+        case RouterMode::OFF:
+            if (r.day_heater_wh > 0.01) fail("heaters drew power in OFF");
+            break;
+        case RouterMode::AUTO:
+            if (r.step_export_wh > 0.25 * off.step_export_wh) fail("step export not reduced to <25% of OFF");
+            if (r.day_export_wh > 0.35 * off.day_export_wh)   fail("cloudy export not reduced to <35% of OFF");
+            if (r.settle_max_s > 60.0f)                        fail("did not settle within a segment");
+            // The default (P) step must respond per second as it did per frame,
+            // whether the hub merges every frame or one epoch per cycle.
+            if (default_engine && r.settle_max_s > 2.0f)       fail("default engine settles slower than 2 s");
+            break;
+        case RouterMode::BOOST:
+            // BOOST drives the primary (DimmerLink) output only.
+            if (r.day_heater_wh < 0.95 * DL_LOAD_W * 0.5)      fail("primary heater not at full power in BOOST");
+            break;
+        default:
+            break;
+    }
+    return ok;
+}
+
+/** PI/PID must beat the legacy step where it matters: export, settling, hunting. */
+bool checkEngines(const Result& p, const Result& pi, const Result& pid) {
+    bool ok = true;
+    auto fail = [&](const char* what) {
+        fprintf(stderr, "CHECK FAILED [AUTO engines]: %s\n", what);
+        ok = false;
+    };
+    if (pi.day_export_wh >= p.day_export_wh)    fail("PI cloudy export not below P");
+    if (pid.day_export_wh >= p.day_export_wh)   fail("PID cloudy export not below P");
+    if (pi.step_export_wh >= p.step_export_wh)  fail("PI step export not below P");
+    if (pi.settle_max_s > p.settle_max_s)       fail("PI settles slower than P");
+    // P at its per-frame rate moves about as often as PI; hunting would be far above.
+    if (pi.changes_per_min > 1.1f * p.changes_per_min) fail("PI changes the output more often than P");
+    // Watts-domain cascade: one PI move lands on the mixed 2 kW RMS + 500 W LINEAR
+    // priority-0 pair as the requested watts, so a step settles in a couple of ticks.
+    if (pi.settle_max_s > 1.0f)                 fail("PI step response slower than 1 s");
+    return ok;
+}
+
+/**
+ * Feed-forward must cut import on load steps without adding export or hunting.
+ * The cut is checked on the P step, which lags a load step by seconds; with
+ * dead-time compensation PI cancels a step in about one frame, so there it only
+ * must not cost anything.
+ */
+bool checkFeedForward(const Result& p_fb, const Result& p_ff, const Result& pi_fb, const Result& pi_ff) {
+    bool ok = true;
+    auto fail = [&](const char* what) {
+        fprintf(stderr, "CHECK FAILED [AUTO feed-forward]: %s\n", what);
+        ok = false;
+    };
+    if (p_ff.step_import_wh >= p_fb.step_import_wh)        fail("P step import not below feedback-only");
+    if (p_ff.day_import_wh >= p_fb.day_import_wh)          fail("P cloudy import not below feedback-only");
+    if (pi_ff.day_import_wh > 1.02 * pi_fb.day_import_wh)  fail("PI cloudy import grew >2%");
+    if (pi_ff.day_export_wh > 1.1 * pi_fb.day_export_wh)   fail("PI cloudy export grew >10%");
+    if (pi_ff.ff_active_pct < 90.0f)                       fail("feed-forward not in use with load+solar present");
+    if (pi_ff.ff_error_w > 30.0f)                          fail("prediction error above 30 W on a consistent plant");
+    return ok;
+}
+
+/**
+ * Dead-time compensation: on every module phase layout it must settle no slower
+ * than the uncompensated loop, and the control latency must stay inside one
+ * measurement window.
+ */
+bool checkDeadTime(const char* layout, const Result& off, const Result& on) {
+    bool ok = true;
+    auto fail = [&](const char* what) {
+        fprintf(stderr, "CHECK FAILED [AUTO dead time %s]: %s\n", layout, what);
+        ok = false;
+    };
+    if (on.settle_max_s > off.settle_max_s)                        fail("compensated loop settles slower");
+    if (on.step_import_wh > 1.05 * off.step_import_wh)             fail("compensated step import >5% above uncompensated");
+    if (on.lat_p99_ms > (float)RouterConfig::MEAS_WINDOW_MS)       fail("p99 acquisition-to-output latency above one window");
+    return ok;
+}
+
+/** Configured DimmerLink nominal power (the real load stays DL_LOAD_W). */
+void setDlNominal(float w) {
+    dimmer_set_nominal_power(g_dl_id, (uint16_t)w);
+    RouterController::getInstance().refreshPriorityMap();
+}
+
+/** Priority-0 plant estimate (DimmerLink pair). */
+PlantGainInfo level0Estimate() {
+    PlantGainInfo info[8];
+    const uint8_t n = RouterController::getInstance().getPlantEstimates(info, 8);
+    for (uint8_t i = 0; i < n; i++) {
+        if (info[i].priority == 0) return info[i];
+    }
+    return PlantGainInfo();
+}
+
+/**
+ * Plant-gain tuning: on a correct model the estimate must sit near 1 and change
+ * nothing; on a mis-set nominal it must find the error and, in ADAPT, recover
+ * the settling of the correct model without flash churn.
+ */
+bool checkPlant(const Result& ok_off, const PlantGainInfo& ok_est, const Result& bad_off,
+                const PlantGainInfo& bad_est, const Result& bad_adapt, uint32_t commits) {
+    bool ok = true;
+    auto fail = [&](const char* what) {
+        fprintf(stderr, "CHECK FAILED [AUTO plant gain]: %s\n", what);
+        ok = false;
+    };
+    if (ok_est.samples < RouterConfig::PLANT_MIN_SAMPLES)        fail("too few updates on the correct model");
+    if (std::fabs(ok_est.gain - 1.0f) > 0.15f)                   fail("gain estimate off by >15% on the correct model");
+    if (bad_est.gain < 1.25f)                                    fail("mis-set nominal power not detected");
+    if (bad_adapt.settle_max_s > bad_off.settle_max_s)           fail("ADAPT settles slower than the mis-set model");
+    if (bad_adapt.step_import_wh > bad_off.step_import_wh)       fail("ADAPT step import above the mis-set model");
+    if (bad_adapt.day_export_wh > 1.1 * ok_off.day_export_wh)    fail("ADAPT cloudy export >10% above the correct model");
+    if (commits > 10)                                            fail("plant-gain saves not rate-limited");
+    return ok;
+}
+
+/**
+ * Relay-only cascade on the legacy P step: with no dimmer level to size the step
+ * by (nominal power 0 takes the dimmers out of the cascade; they stay enabled so
+ * OFF still has its primary output), 2.6 kW of export must switch the 1 kW relay
+ * on, and import must switch it off again once its minimum on-time has passed.
+ */
+bool checkRelayOnly() {
+    bool ok = true;
+    auto fail = [&](const char* what) {
+        fprintf(stderr, "CHECK FAILED [AUTO relay only]: %s\n", what);
+        ok = false;
+    };
+    RouterController& router = RouterController::getInstance();
+    uint16_t nominal[3];
+    setEngine(ControlEngine::P);
+    for (int i = 0; i < 3; i++) {
+        nominal[i] = dimmer_get_nominal_power((uint8_t)g_dimmer_ids[i]);
+        dimmer_set_nominal_power((uint8_t)g_dimmer_ids[i], 0);
+    }
+    router.refreshPriorityMap();
+
+    resetRouter(RouterMode::AUTO);
+    sim_plant_run(30000);
+    if (!relay_is_on(0)) fail("relay not switched on under export");
+
+    sim_plant_set_pv_w(500.0f);
+    sim_plant_run(90000);
+    if (relay_is_on(0)) fail("relay not switched off under import");
+
+    for (int i = 0; i < 3; i++) dimmer_set_nominal_power((uint8_t)g_dimmer_ids[i], nominal[i]);
+    router.refreshPriorityMap();
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    bool check = false;
+    bool trace = false;
+    bool per_frame = false;
+    bool ff = false;
+    int  engine = -1;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--check"))                    check = true;
+        else if (!strcmp(argv[i], "--trace"))               trace = true;
+        else if (!strcmp(argv[i], "--per-frame"))           per_frame = true;
+        else if (!strcmp(argv[i], "--ff"))                  ff = true;
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(argv[i], "--engine") && i + 1 < argc) {
+            const char* e = argv[++i];
+            engine = !strcmp(e, "p") ? 0 : !strcmp(e, "pi") ? 1 : !strcmp(e, "pid") ? 2 : -2;
+        } else {
+            engine = -2;
+        }
+        if (engine == -2) {
+            fprintf(stderr, "usage: %s [--check] [--seed N] [--trace] [--per-frame] [--engine p|pi|pid] [--ff]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    setupInstallation();
+    sensor_hub_set_merge_mode(per_frame ? SH_MERGE_PER_FRAME : SH_MERGE_EPOCH);
+    if (engine >= 0) setEngine(static_cast<ControlEngine>(engine));
+    RouterController::getInstance().setFeedForward(ff);
+    const float capacity = sim_plant_heater_capacity_w();
+
+    printf("ACRouter control-core benchmark (seed=%u, heaters=%.0f W, tick=%u ms, merge=%s, engine=%s, ff=%s)\n",
+           seed, capacity, TICK_MS, per_frame ? "per-frame" : "epoch",
+           engine >= 0 ? engineName(static_cast<ControlEngine>(engine)) : "default", ff ? "on" : "off");
+    printf("%-10s | %8s %8s | %10s %10s | %10s %10s %10s %7s | %8s %8s %8s | %7s %6s\n",
+           "mode", "settle", "max", "step exp", "step imp", "day exp", "day imp", "day heat", "changes",
+           "updates", "us/upd", "p99", "merge", "supp");
+    printf("%-10s | %8s %8s | %10s %10s | %10s %10s %10s %7s | %8s %8s %8s | %7s %6s\n",
+           "", "s", "s", "Wh", "Wh", "Wh", "Wh", "Wh", "/min", "", "mean", "us", "/s", "%");
+
+    bool ok = true;
+    Result off;
+    for (const ModeInfo& mi : kModes) {
+        const Result r = runMode(mi, seed, trace);
+        printf("%-10s | %8.1f %8.1f | %10.1f %10.1f | %10.1f %10.1f %10.1f %7.1f | %8u %8.2f %8.2f | %7.2f %6.1f\n",
+               mi.name, r.settle_mean_s, r.settle_max_s, r.step_export_wh, r.step_import_wh,
+               r.day_export_wh, r.day_import_wh, r.day_heater_wh, r.changes_per_min, r.updates,
+               r.us_mean, r.us_p99, r.merges_per_s, r.suppressed_pct);
+
+        if (mi.mode == RouterMode::OFF) off = r;
+        if (check) ok = checkBounds(mi, r, off, engine < 0) && ok;
+    }
+
+    // Engine comparison on the regulating modes (default gains).
+    printf("\ncontroller engines (default gains)\n");
+    printf("%-10s %-4s | %8s %8s | %10s %10s | %10s %10s %7s\n",
+           "mode", "eng", "settle", "max", "step exp", "step imp", "day exp", "day imp", "changes");
+    const ModeInfo regulating[] = { kModes[1], kModes[2], kModes[6] };   // AUTO, ECO, GRID_LIMIT
+    const ControlEngine engines[] = { ControlEngine::P, ControlEngine::PI, ControlEngine::PID };
+    Result auto_r[3];
+    for (const ModeInfo& mi : regulating) {
+        for (int e = 0; e < 3; e++) {
+            setEngine(engines[e]);
+            const Result r = runMode(mi, seed, false);
+            printf("%-10s %-4s | %8.1f %8.1f | %10.1f %10.1f | %10.1f %10.1f %7.1f\n",
+                   mi.name, engineName(engines[e]), r.settle_mean_s, r.settle_max_s,
+                   r.step_export_wh, r.step_import_wh, r.day_export_wh, r.day_import_wh,
+                   r.changes_per_min);
+            if (mi.mode == RouterMode::AUTO) auto_r[e] = r;
+        }
+    }
+    if (check) ok = checkEngines(auto_r[0], auto_r[1], auto_r[2]) && ok;
+
+    // AUTO feed-forward from the load + solar channels vs feedback-only.
+    printf("\nAUTO feed-forward (default gains)\n");
+    printf("%-4s %-3s | %8s %8s | %10s %10s | %10s %10s %7s | %8s %7s\n",
+           "eng", "ff", "settle", "max", "step exp", "step imp", "day exp", "day imp", "changes",
+           "pred err", "active");
+    Result ff_r[2][2];
+    for (int e = 0; e < 2; e++) {
+        setEngine(engines[e]);
+        for (int f = 0; f < 2; f++) {
+            RouterController::getInstance().setFeedForward(f != 0);
+            const Result r = runMode(kModes[1], seed, false);
+            printf("%-4s %-3s | %8.1f %8.1f | %10.1f %10.1f | %10.1f %10.1f %7.1f | %8.1f %6.0f%%\n",
+                   engineName(engines[e]), f ? "on" : "off", r.settle_mean_s, r.settle_max_s,
+                   r.step_export_wh, r.step_import_wh, r.day_export_wh, r.day_import_wh,
+                   r.changes_per_min, r.ff_error_w, r.ff_active_pct);
+            ff_r[e][f] = r;
+        }
+    }
+    RouterController::getInstance().setFeedForward(false);
+    if (check) ok = checkFeedForward(ff_r[0][0], ff_r[0][1], ff_r[1][0], ff_r[1][1]) && ok;
+
+    // AUTO plant-gain tuning, PI: correct model vs the DimmerLink set to 1.2 kW.
+    printf("\nAUTO plant-gain tuning (PI, prio-0 estimate; DimmerLink %.0f W configured as %.0f W)\n",
+           DL_LOAD_W, DL_MISSET_W);
+    printf("%-6s %-6s | %8s %8s | %10s %10s | %10s %10s %7s | %6s %7s %7s %7s\n",
+           "model", "tune", "settle", "max", "step exp", "step imp", "day exp", "day imp", "changes",
+           "gain", "applied", "updates", "commits");
+    setEngine(ControlEngine::PI);
+    RouterController& router = RouterController::getInstance();
+    struct PlantRun { bool misset; PlantTuning tune; bool fresh; const char* tune_name; };
+    const PlantRun plant_runs[] = {
+        { false, PlantTuning::OFF,   true,  "off"    },
+        { false, PlantTuning::LEARN, true,  "learn"  },
+        { true,  PlantTuning::OFF,   true,  "off"    },
+        { true,  PlantTuning::ADAPT, true,  "adapt"  },   // learning while it runs
+        { true,  PlantTuning::ADAPT, false, "adapt+" },   // starting from the learned gain
+    };
+    Result plant_r[5];
+    PlantGainInfo plant_est[5];
+    uint32_t adapt_commits = 0;
+    for (int i = 0; i < 5; i++) {
+        const PlantRun& pr = plant_runs[i];
+        setDlNominal(pr.misset ? DL_MISSET_W : DL_LOAD_W);
+        router.setPlantTuning(pr.tune);
+        if (pr.fresh) router.resetPlantEstimates();
+        const uint32_t commits0 = host_nvs_commit_count();
+        plant_r[i] = runMode(kModes[1], seed, false);
+        const uint32_t commits = host_nvs_commit_count() - commits0;
+        if (pr.tune == PlantTuning::ADAPT) adapt_commits += commits;
+        plant_est[i] = level0Estimate();
+        const Result& r = plant_r[i];
+        printf("%-6s %-6s | %8.1f %8.1f | %10.1f %10.1f | %10.1f %10.1f %7.1f | %6.2f %7.2f %7u %7u\n",
+               pr.misset ? "1.2kW" : "ok", pr.tune_name, r.settle_mean_s, r.settle_max_s,
+               r.step_export_wh, r.step_import_wh, r.day_export_wh, r.day_import_wh, r.changes_per_min,
+               plant_est[i].gain, plant_est[i].applied_gain, plant_est[i].samples, commits);
+    }
+    router.setPlantTuning(PlantTuning::OFF);
+    router.resetPlantEstimates();
+    setDlNominal(DL_LOAD_W);
+    if (check) ok = checkPlant(plant_r[0], plant_est[1], plant_r[2], plant_est[3], plant_r[4],
+                               adapt_commits) && ok;
+
+    // AUTO dead-time compensation, PI, across module phase layouts.
+    printf("\nAUTO dead-time compensation (PI; module post offsets grid/solar/load in ms)\n");
+    printf("%-11s %-3s | %8s %8s | %10s %10s | %10s %10s %7s | %7s %7s\n",
+           "phases", "dtc", "settle", "max", "step exp", "step imp", "day exp", "day imp", "changes",
+           "lat p50", "lat p99");
+    struct Layout { uint32_t phase_ms[SIM_SRC_COUNT]; const char* name; };
+    const Layout layouts[] = {
+        { { 0,   70, 140 }, "0/70/140"  },     // default: grid first, merge waits for load
+        { { 140,  0,  70 }, "140/0/70"  },     // grid last: merge closes on the grid frame
+        { { 100,  0,  50 }, "100/0/50"  },
+    };
+    setEngine(ControlEngine::PI);
+    for (const Layout& l : layouts) {
+        sim_plant_set_phases(l.phase_ms);
+        Result dt_r[2];
+        for (int d = 0; d < 2; d++) {
+            router.setDeadTimeCompensation(d != 0);
+            dt_r[d] = runMode(kModes[1], seed, false);
+            const Result& r = dt_r[d];
+            printf("%-11s %-3s | %8.1f %8.1f | %10.1f %10.1f | %10.1f %10.1f %7.1f | %7.0f %7.0f\n",
+                   l.name, d ? "on" : "off", r.settle_mean_s, r.settle_max_s, r.step_export_wh,
+                   r.step_import_wh, r.day_export_wh, r.day_import_wh, r.changes_per_min,
+                   r.lat_p50_ms, r.lat_p99_ms);
+        }
+        if (check) ok = checkDeadTime(l.name, dt_r[0], dt_r[1]) && ok;
+    }
+    router.setDeadTimeCompensation(true);
+    sim_plant_set_phases(layouts[0].phase_ms);
+
+    if (check) ok = checkRelayOnly() && ok;
+
+    RouterController::getInstance().setMode(RouterMode::OFF);
+    if (check) printf("%s\n", ok ? "CHECK PASSED" : "CHECK FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file sim_dimmerlink.c
+ * @brief Virtual DimmerLink modules behind the dl_device_* API.
+ *
+ * Only the calls the dimmer/relay backends make are modelled. A level write is
+ * applied at once — the module latches it at the next half-cycle, which is
+ * below the 10 ms physics step.
+ */
+#include "sim_plant.h"
+#include "dimmerlink_device.h"
+#include "dimmerlink_regs.h"
+#include "i2c_bus.h"
+
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    bool    used;
+    bool    online;
+    uint8_t bus;
+    uint8_t addr;
+    uint8_t level;          ///< applied level, %
+    uint8_t curve;          ///< DL_CURVE_*
+    float   load_w;         ///< physical heater rating
+} sim_dl_t;
+
+static sim_dl_t s_mod[SIM_PLANT_MAX_DIMMERLINK];
+
+static sim_dl_t *find(uint8_t bus, uint8_t addr)
+{
+    for (int i = 0; i < SIM_PLANT_MAX_DIMMERLINK; i++) {
+        if (s_mod[i].used && s_mod[i].bus == bus && s_mod[i].addr == addr) return &s_mod[i];
+    }
+    return NULL;
+}
+
+static sim_dl_t *find_online(uint8_t bus, uint8_t addr)
+{
+    sim_dl_t *m = find(bus, addr);
+    return (m && m->online) ? m : NULL;
+}
+
+float sim_curve_power_fraction(uint8_t curve, float percent)
+{
+    if (percent <= 0.0f) return 0.0f;
+    if (percent >= 100.0f) return 1.0f;
+    float x = percent / 100.0f;
+    switch (curve) {
+        case DL_CURVE_LINEAR: {
+            /* Level maps linearly to conduction angle; a resistive load then draws
+             * P/Pmax = 1 - a/pi + sin(2a)/(2pi) at firing angle a. */
+            float a = (float)M_PI * (1.0f - x);
+            return 1.0f - a / (float)M_PI + sinf(2.0f * a) / (2.0f * (float)M_PI);
+        }
+        case DL_CURVE_LOG:
+            return x * x;
+        case DL_CURVE_RMS:
+        default:
+            return x;      /* RMS-compensated: power proportional to level */
+    }
+}
+
+void sim_dimmerlink_reset(void)
+{
+    memset(s_mod, 0, sizeof(s_mod));
+}
+
+int sim_dimmerlink_add(uint8_t bus, uint8_t addr, float load_w)
+{
+    for (int i = 0; i < SIM_PLANT_MAX_DIMMERLINK; i++) {
+        if (!s_mod[i].used) {
+            s_mod[i] = (sim_dl_t){ .used = true, .online = true, .bus = bus, .addr = addr,
+                                   .curve = DL_CURVE_RMS, .load_w = load_w };
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void sim_dimmerlink_set_online(uint8_t bus, uint8_t addr, bool online)
+{
+    sim_dl_t *m = find(bus, addr);
+    if (m) m->online = online;
+}
+
+float sim_dimmerlink_power_w(void)
+{
+    float p = 0.0f;
+    for (int i = 0; i < SIM_PLANT_MAX_DIMMERLINK; i++) {
+        if (s_mod[i].used) p += s_mod[i].load_w * sim_curve_power_fraction(s_mod[i].curve, s_mod[i].level);
+    }
+    return p;
+}
+
+float sim_dimmerlink_capacity_w(void)
+{
+    float p = 0.0f;
+    for (int i = 0; i < SIM_PLANT_MAX_DIMMERLINK; i++) {
+        if (s_mod[i].used) p += s_mod[i].load_w;
+    }
+    return p;
+}
+
+/* ================================================================
+ * Firmware-facing API
+ * ================================================================ */
+
+bool i2c_bus_is_initialized(uint8_t bus_num)
+{
+    return bus_num < 2;
+}
+
+esp_err_t dl_device_probe(uint8_t bus, uint8_t addr)
+{
+    return find_online(bus, addr) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t dl_device_read_info(uint8_t bus, uint8_t addr, dl_device_info_t *info)
+{
+    if (!info) return ESP_ERR_INVALID_ARG;
+    memset(info, 0, sizeof(*info));
+    if (!find_online(bus, addr)) return ESP_ERR_TIMEOUT;
+    info->version = 3;
+    info->ready   = true;
+    return ESP_OK;
+}
+
+esp_err_t dl_device_set_dimmer_level(uint8_t bus, uint8_t addr, uint8_t percent)
+{
+    sim_dl_t *m = find_online(bus, addr);
+    if (!m) return ESP_ERR_TIMEOUT;
+    m->level = percent > 100 ? 100 : percent;
+    return ESP_OK;
+}
+
+esp_err_t dl_device_set_dimmer_fade(uint8_t bus, uint8_t addr, uint8_t percent, uint8_t fade_100ms)
+{
+    (void)fade_100ms;   /* fades are not modelled; land on the target */
+    return dl_device_set_dimmer_level(bus, addr, percent);
+}
+
+/* No bus worker on the host: a queued write completes inline, like the firmware
+ * before i2c_bus_async_start(). */
+esp_err_t dl_device_set_dimmer_level_async(uint8_t bus, uint8_t addr, uint8_t percent,
+                                           i2c_bus_done_cb_t done, void *ctx)
+{
+    esp_err_t err = dl_device_set_dimmer_level(bus, addr, percent);
+    if (err == ESP_OK && done) done(ESP_OK, ctx);
+    return err;
+}
+
+esp_err_t dl_device_set_dimmer_fade_async(uint8_t bus, uint8_t addr, uint8_t percent,
+                                          uint8_t fade_100ms, i2c_bus_done_cb_t done, void *ctx)
+{
+    (void)fade_100ms;
+    return dl_device_set_dimmer_level_async(bus, addr, percent, done, ctx);
+}
+
+esp_err_t dl_device_set_dimmer_curve(uint8_t bus, uint8_t addr, uint8_t curve)
+{
+    sim_dl_t *m = find_online(bus, addr);
+    if (!m) return ESP_ERR_TIMEOUT;
+    if (curve > DL_CURVE_LOG) return ESP_ERR_INVALID_ARG;
+    m->curve = curve;
+    return ESP_OK;
+}
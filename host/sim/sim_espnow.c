@@ -0,0 +1,128 @@
+/**
+ * @file sim_espnow.c
+ * @brief Virtual ESP-NOW output nodes behind esp_now_source_set_output().
+ *
+ * A SET_OUTPUT is queued and applied once the configured RF latency has
+ * elapsed. The node re-quantizes permille to integer percent and drives an
+ * RMS-curve dimmer, as the DimmerLink-over-ESP-NOW node firmware does.
+ */
+#include "sim_plant.h"
+#include "esp_now_source.h"
+#include "espnow_proto.h"
+#include "esp_timer.h"
+
+#include <string.h>
+
+#define SIM_ESPNOW_PENDING  32
+
+typedef struct {
+    bool    used;
+    uint8_t mac[6];
+    uint8_t level;          ///< applied level, %
+    float   load_w;
+} sim_node_t;
+
+typedef struct {
+    bool    used;
+    int     node;
+    uint8_t level;
+    int64_t apply_at_us;
+} sim_cmd_t;
+
+static sim_node_t s_nodes[SIM_PLANT_MAX_ESPNOW];
+static sim_cmd_t  s_pending[SIM_ESPNOW_PENDING];
+static int64_t    s_latency_us;
+
+void sim_espnow_reset(uint32_t latency_ms)
+{
+    memset(s_nodes, 0, sizeof(s_nodes));
+    memset(s_pending, 0, sizeof(s_pending));
+    s_latency_us = (int64_t)latency_ms * 1000;
+}
+
+int sim_espnow_add(const uint8_t mac[6], float load_w)
+{
+    for (int i = 0; i < SIM_PLANT_MAX_ESPNOW; i++) {
+        if (!s_nodes[i].used) {
+            s_nodes[i].used   = true;
+            s_nodes[i].level  = 0;
+            s_nodes[i].load_w = load_w;
+            memcpy(s_nodes[i].mac, mac, 6);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void sim_espnow_pump(int64_t now_us)
+{
+    /* Commands are queued in send order; apply every due one in that order so a
+     * later SET_OUTPUT to the same node wins. */
+    for (int i = 0; i < SIM_ESPNOW_PENDING; i++) {
+        sim_cmd_t *c = &s_pending[i];
+        if (c->used && c->apply_at_us <= now_us) {
+            s_nodes[c->node].level = c->level;
+            c->used = false;
+        }
+    }
+}
+
+float sim_espnow_power_w(void)
+{
+    float p = 0.0f;
+    for (int i = 0; i < SIM_PLANT_MAX_ESPNOW; i++) {
+        if (s_nodes[i].used) p += s_nodes[i].load_w * sim_curve_power_fraction(1 /*RMS*/, s_nodes[i].level);
+    }
+    return p;
+}
+
+float sim_espnow_capacity_w(void)
+{
+    float p = 0.0f;
+    for (int i = 0; i < SIM_PLANT_MAX_ESPNOW; i++) {
+        if (s_nodes[i].used) p += s_nodes[i].load_w;
+    }
+    return p;
+}
+
+/* ================================================================
+ * Firmware-facing API
+ * ================================================================ */
+
+esp_err_t esp_now_source_set_output(const uint8_t mac[6], uint8_t output_id,
+                                    uint8_t kind, uint16_t value, uint16_t ramp_ms)
+{
+    (void)ramp_ms;
+    if (!mac) return ESP_ERR_INVALID_ARG;
+    int node = -1;
+    for (int i = 0; i < SIM_PLANT_MAX_ESPNOW; i++) {
+        if (s_nodes[i].used && memcmp(s_nodes[i].mac, mac, 6) == 0) { node = i; break; }
+    }
+    if (node < 0 || output_id != 0 || kind != RBN_OUT_KIND_DIMMER) return ESP_ERR_NOT_FOUND;
+
+    if (value > 1000) value = 1000;
+    uint8_t level = (uint8_t)((value + 5) / 10);
+
+    /* Keep send order: take the first free slot after the last used one. */
+    int last = -1;
+    for (int i = 0; i < SIM_ESPNOW_PENDING; i++) {
+        if (s_pending[i].used) last = i;
+    }
+    int slot = -1;
+    for (int i = last + 1; i < SIM_ESPNOW_PENDING && slot < 0; i++) {
+        if (!s_pending[i].used) slot = i;
+    }
+    if (slot < 0) {
+        /* Compact, then append. */
+        int w = 0;
+        for (int r = 0; r < SIM_ESPNOW_PENDING; r++) {
+            if (s_pending[r].used) s_pending[w++] = s_pending[r];
+        }
+        for (int r = w; r < SIM_ESPNOW_PENDING; r++) s_pending[r].used = false;
+        if (w >= SIM_ESPNOW_PENDING) return ESP_ERR_NO_MEM;   /* TX queue full */
+        slot = w;
+    }
+    s_pending[slot] = (sim_cmd_t){ .used = true, .node = node, .level = level,
+                                   .apply_at_us = esp_timer_get_time() + s_latency_us };
+    return ESP_OK;
+}
@@ -0,0 +1,436 @@
+/**
+ * @file sim_i2c.c
+ * @brief Simulated I2C fabric: the host i2c_master driver and the register-map slave.
+ *
+ * One mutex per bus stands for the driver's bus lock and is held for the whole
+ * transaction, wire time included, so two tasks on one bus serialise exactly as
+ * on the SoC and two buses run in parallel. Wire time is real time on the
+ * monotonic clock (not esp_timer, which may be the simulated clock).
+ */
+#include "sim_i2c.h"
+#include "driver/i2c_master.h"
+#include "dimmerlink_regs.h"
+#include "esp_timer.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    bool     used;
+    uint8_t  addr;
+    const sim_i2c_slave_ops_t *ops;
+    void    *ctx;
+    uint32_t latency_us;
+    uint32_t nack_left;
+} sim_slave_t;
+
+struct i2c_master_bus_t {
+    uint8_t port;
+};
+
+struct i2c_master_dev_t {
+    struct i2c_master_bus_t *bus;
+    uint8_t  addr;
+    uint32_t scl_hz;
+};
+
+typedef struct {
+    pthread_mutex_t lock;
+    struct i2c_master_bus_t *handle;    ///< Created by i2c_new_master_bus
+    sim_slave_t     slave[SIM_I2C_MAX_SLAVES];
+    int64_t         wedge_until_us;     ///< Monotonic; 0 = not wedged
+    sim_i2c_stats_t stats;
+} sim_bus_t;
+
+static sim_bus_t s_bus[SIM_I2C_BUSES] = {
+    [0] = { .lock = PTHREAD_MUTEX_INITIALIZER },
+    [1] = { .lock = PTHREAD_MUTEX_INITIALIZER },
+};
+static volatile bool s_wire_model = true;
+
+static int64_t mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Hold the bus for @p us: sleep the bulk (two buses then overlap even on one
+ * core), spin the tail for accuracy below the sleep granularity. */
+static void hold_us(uint32_t us)
+{
+    int64_t until = mono_us() + us;
+    if (us > 200) {
+        struct timespec ts = { .tv_sec = (us - 150) / 1000000,
+                               .tv_nsec = (long)((us - 150) % 1000000) * 1000 };
+        nanosleep(&ts, NULL);
+    }
+    while (mono_us() < until) { }
+}
+
+static sim_slave_t *find_slave(sim_bus_t *b, uint8_t addr)
+{
+    for (int i = 0; i < SIM_I2C_MAX_SLAVES; i++) {
+        if (b->slave[i].used && b->slave[i].addr == addr) return &b->slave[i];
+    }
+    return NULL;
+}
+
+/* Wire time of one transaction: START, address + payload bytes at 9 bits each
+ * (a repeated START re-sends the address), STOP. */
+static uint32_t wire_us(uint32_t scl_hz, size_t wlen, size_t rlen)
+{
+    uint32_t bits = 2 + 9 * (1 + (uint32_t)wlen);
+    if (rlen) bits += 1 + 9 * (1 + (uint32_t)rlen);
+    if (!scl_hz) scl_hz = 100000;
+    return (uint32_t)((uint64_t)bits * 1000000 / scl_hz);
+}
+
+/* Common transaction frame (bus lock held): wedge, address phase, wire time.
+ * Returns the slave to talk to, or NULL with *err set. */
+static sim_slave_t *begin(sim_bus_t *b, uint8_t addr, int timeout_ms, esp_err_t *err)
+{
+    int64_t wedge = __atomic_load_n(&b->wedge_until_us, __ATOMIC_RELAXED);
+    if (wedge && mono_us() < wedge) {
+        hold_us((uint32_t)timeout_ms * 1000);
+        b->stats.timeouts++;
+        *err = ESP_ERR_TIMEOUT;
+        return NULL;
+    }
+    sim_slave_t *s = find_slave(b, addr);
+    if (!s || s->nack_left) {
+        if (s) s->nack_left--;
+        b->stats.nacks++;
+        *err = ESP_ERR_INVALID_STATE;
+        return NULL;
+    }
+    *err = ESP_OK;
+    return s;
+}
+
+static void charge(sim_bus_t *b, const sim_slave_t *s, uint32_t scl_hz, size_t wlen, size_t rlen)
+{
+    uint32_t us = wire_us(scl_hz, wlen, rlen) + (s ? s->latency_us : 0);
+    b->stats.xfers++;
+    b->stats.bytes += (uint32_t)(wlen + rlen);
+    b->stats.wire_us += us;
+    if (s_wire_model) hold_us(us);
+}
+
+// ================================================================
+// Driver API (driver/i2c_master.h)
+// ================================================================
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *cfg, i2c_master_bus_handle_t *ret)
+{
+    if (!cfg || !ret || cfg->i2c_port < 0 || cfg->i2c_port >= SIM_I2C_BUSES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_bus_t *b = &s_bus[cfg->i2c_port];
+    pthread_mutex_lock(&b->lock);
+    esp_err_t err = ESP_ERR_INVALID_STATE;
+    if (!b->handle) {
+        b->handle = calloc(1, sizeof(*b->handle));
+        if (b->handle) {
+            b->handle->port = (uint8_t)cfg->i2c_port;
+            *ret = b->handle;
+            err = ESP_OK;
+        } else {
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    pthread_mutex_unlock(&b->lock);
+    return err;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus)
+{
+    if (!bus) return ESP_ERR_INVALID_ARG;
+    sim_bus_t *b = &s_bus[bus->port];
+    pthread_mutex_lock(&b->lock);
+    b->handle = NULL;
+    pthread_mutex_unlock(&b->lock);
+    free(bus);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t *cfg,
+                                    i2c_master_dev_handle_t *ret)
+{
+    if (!bus || !cfg || !ret) return ESP_ERR_INVALID_ARG;
+    struct i2c_master_dev_t *d = calloc(1, sizeof(*d));
+    if (!d) return ESP_ERR_NO_MEM;
+    d->bus    = bus;
+    d->addr   = (uint8_t)cfg->device_address;
+    d->scl_hz = cfg->scl_speed_hz;
+    sim_bus_t *b = &s_bus[bus->port];
+    pthread_mutex_lock(&b->lock);
+    b->stats.dev_adds++;
+    pthread_mutex_unlock(&b->lock);
+    *ret = d;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t dev)
+{
+    free(dev);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus, uint16_t addr, int timeout_ms)
+{
+    if (!bus) return ESP_ERR_INVALID_ARG;
+    sim_bus_t *b = &s_bus[bus->port];
+    pthread_mutex_lock(&b->lock);
+    esp_err_t err;
+    sim_slave_t *s = begin(b, (uint8_t)addr, timeout_ms, &err);
+    if (err != ESP_ERR_TIMEOUT) {
+        b->stats.probes++;
+        if (s_wire_model) hold_us(wire_us(100000, 0, 0) + (s ? s->latency_us : 0));
+    }
+    pthread_mutex_unlock(&b->lock);
+    return err == ESP_ERR_INVALID_STATE ? ESP_ERR_NOT_FOUND : err;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t *buf, size_t len,
+                              int timeout_ms)
+{
+    if (!dev || (len && !buf)) return ESP_ERR_INVALID_ARG;
+    sim_bus_t *b = &s_bus[dev->bus->port];
+    pthread_mutex_lock(&b->lock);
+    esp_err_t err;
+    sim_slave_t *s = begin(b, dev->addr, timeout_ms, &err);
+    if (err != ESP_ERR_TIMEOUT) charge(b, s, dev->scl_hz, s ? len : 0, 0);
+    if (s) err = s->ops->write(s->ctx, buf, len, true);
+    pthread_mutex_unlock(&b->lock);
+    return err;
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t dev, uint8_t *buf, size_t len,
+                             int timeout_ms)
+{
+    if (!dev || !buf || !len) return ESP_ERR_INVALID_ARG;
+    sim_bus_t *b = &s_bus[dev->bus->port];
+    pthread_mutex_lock(&b->lock);
+    esp_err_t err;
+    sim_slave_t *s = begin(b, dev->addr, timeout_ms, &err);
+    if (err != ESP_ERR_TIMEOUT) charge(b, s, dev->scl_hz, s ? len : 0, 0);
+    if (s) err = s->ops->read(s->ctx, buf, len);
+    pthread_mutex_unlock(&b->lock);
+    return err;
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *wbuf,
+                                      size_t wlen, uint8_t *rbuf, size_t rlen, int timeout_ms)
+{
+    if (!dev || !wbuf || !wlen || !rbuf || !rlen) return ESP_ERR_INVALID_ARG;
+    sim_bus_t *b = &s_bus[dev->bus->port];
+    pthread_mutex_lock(&b->lock);
+    esp_err_t err;
+    sim_slave_t *s = begin(b, dev->addr, timeout_ms, &err);
+    if (err != ESP_ERR_TIMEOUT) charge(b, s, dev->scl_hz, s ? wlen : 0, s ? rlen : 0);
+    if (s) {
+        err = s->ops->write(s->ctx, wbuf, wlen, false);
+        if (err == ESP_OK) err = s->ops->read(s->ctx, rbuf, rlen);
+    }
+    pthread_mutex_unlock(&b->lock);
+    return err;
+}
+
+// ================================================================
+// Fabric control
+// ================================================================
+
+void sim_i2c_reset(void)
+{
+    for (int i = 0; i < SIM_I2C_BUSES; i++) {
+        sim_bus_t *b = &s_bus[i];
+        pthread_mutex_lock(&b->lock);
+        memset(b->slave, 0, sizeof(b->slave));
+        memset(&b->stats, 0, sizeof(b->stats));
+        b->wedge_until_us = 0;
+        pthread_mutex_unlock(&b->lock);
+    }
+}
+
+void sim_i2c_set_wire_model(bool enable)
+{
+    s_wire_model = enable;
+}
+
+esp_err_t sim_i2c_attach(uint8_t bus, uint8_t addr, const sim_i2c_slave_ops_t *ops, void *ctx)
+{
+    if (bus >= SIM_I2C_BUSES || !ops) return ESP_ERR_INVALID_ARG;
+    sim_bus_t *b = &s_bus[bus];
+    esp_err_t err = ESP_ERR_NO_MEM;
+    pthread_mutex_lock(&b->lock);
+    if (find_slave(b, addr)) {
+        err = ESP_ERR_INVALID_STATE;
+    } else {
+        for (int i = 0; i < SIM_I2C_MAX_SLAVES; i++) {
+            if (b->slave[i].used) continue;
+            b->slave[i] = (sim_slave_t){ .used = true, .addr = addr, .ops = ops, .ctx = ctx };
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&b->lock);
+    return err;
+}
+
+void sim_i2c_detach(uint8_t bus, uint8_t addr)
+{
+    if (bus >= SIM_I2C_BUSES) return;
+    sim_bus_t *b = &s_bus[bus];
+    pthread_mutex_lock(&b->lock);
+    sim_slave_t *s = find_slave(b, addr);
+    if (s) memset(s, 0, sizeof(*s));
+    pthread_mutex_unlock(&b->lock);
+}
+
+void sim_i2c_set_latency(uint8_t bus, uint8_t addr, uint32_t us)
+{
+    if (bus >= SIM_I2C_BUSES) return;
+    sim_bus_t *b = &s_bus[bus];
+    pthread_mutex_lock(&b->lock);
+    sim_slave_t *s = find_slave(b, addr);
+    if (s) s->latency_us = us;
+    pthread_mutex_unlock(&b->lock);
+}
+
+void sim_i2c_inject_nack(uint8_t bus, uint8_t addr, uint32_t count)
+{
+    if (bus >= SIM_I2C_BUSES) return;
+    sim_bus_t *b = &s_bus[bus];
+    pthread_mutex_lock(&b->lock);
+    sim_slave_t *s = find_slave(b, addr);
+    if (s) s->nack_left = count;
+    pthread_mutex_unlock(&b->lock);
+}
+
+void sim_i2c_wedge(uint8_t bus, uint32_t ms)
+{
+    if (bus >= SIM_I2C_BUSES) return;
+    /* Not under the bus lock: a wedged bus holds it for a whole timeout, and
+     * releasing it must not wait for that. */
+    __atomic_store_n(&s_bus[bus].wedge_until_us, ms ? mono_us() + (int64_t)ms * 1000 : 0,
+                     __ATOMIC_RELAXED);
+}
+
+void sim_i2c_get_stats(uint8_t bus, sim_i2c_stats_t *stats)
+{
+    if (bus >= SIM_I2C_BUSES || !stats) return;
+    sim_bus_t *b = &s_bus[bus];
+    pthread_mutex_lock(&b->lock);
+    *stats = b->stats;
+    pthread_mutex_unlock(&b->lock);
+}
+
+// ================================================================
+// Register-map slave
+// ================================================================
+
+/* Idle detection at the start of every transaction: after garble_idle_ms of
+ * silence the slave's first answer is garbage, whatever the framing. */
+static void regmap_touch(sim_i2c_regmap_t *m)
+{
+    int64_t now = esp_timer_get_time();
+    if (m->garble_idle_ms && (m->last_us == 0 ||
+                              now - m->last_us >= (int64_t)m->garble_idle_ms * 1000)) {
+        m->garble_armed = true;
+    }
+    m->last_us = now ? now : 1;
+}
+
+static esp_err_t regmap_write(void *ctx, const uint8_t *data, size_t len, bool stop)
+{
+    sim_i2c_regmap_t *m = ctx;
+    regmap_touch(m);
+    if (len == 0) return ESP_OK;
+    m->writes++;
+    if (len == 1 && !stop && m->stop_latch) {
+        m->unlatched = true;        /* pointer never took: the read gets the old one */
+        return ESP_OK;
+    }
+    m->ptr = data[0];
+    if (len > 1) {
+        uint8_t reg = m->ptr;
+        for (size_t i = 1; i < len; i++) m->reg[m->ptr++] = data[i];
+        if (m->on_write) m->on_write(m->hook_ctx, reg, &data[1], len - 1);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t regmap_read(void *ctx, uint8_t *data, size_t len)
+{
+    sim_i2c_regmap_t *m = ctx;
+    regmap_touch(m);
+    m->reads++;
+    if (m->unlatched) {
+        m->unlatched = false;
+        m->stale++;
+    }
+    bool garble = m->garble_armed;
+    m->garble_armed = false;
+    if (garble) m->garbled++;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t v = m->reg[m->ptr++];
+        data[i] = garble ? m->garble_value : v;
+    }
+    return ESP_OK;
+}
+
+const sim_i2c_slave_ops_t sim_i2c_regmap_ops = {
+    .write = regmap_write,
+    .read  = regmap_read,
+};
+
+void sim_i2c_regmap_put(sim_i2c_regmap_t *m, uint8_t reg, uint32_t value, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        m->reg[(uint8_t)(reg + i)] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+void sim_i2c_regmap_dimmerlink(sim_i2c_regmap_t *m, uint8_t addr, uint8_t version)
+{
+    memset(m, 0, sizeof(*m));
+    m->stop_latch     = true;
+    m->garble_idle_ms = 1000;
+    m->garble_value   = 0xFF;
+
+    m->reg[DL_REG_STATUS]        = DL_STATUS_READY;
+    m->reg[DL_REG_VERSION]       = version;
+    m->reg[DL_REG_DIM0_CURVE]    = DL_CURVE_RMS;
+    m->reg[DL_REG_AC_FREQ]       = 50;
+    sim_i2c_regmap_put(m, DL_REG_AC_PERIOD_L, 10000, 2);
+    m->reg[DL_REG_CALIBRATION]   = 1;
+    m->reg[DL_REG_I2C_ADDRESS]   = addr;
+    m->reg[DL_REG_TEMP_CURRENT]  = 50 + 30;
+    m->reg[DL_REG_TEMP_MAX_LEVEL] = 100;
+    m->reg[DL_REG_TEMP_FLAGS]    = DL_TFLAG_STABLE | DL_TFLAG_SENSOR_OK;
+    m->reg[DL_REG_TEMP_PEAK]     = 50 + 34;
+    m->reg[DL_REG_TEMP_RATE]     = 128;
+    m->reg[DL_REG_CS_CONFIG]     = 0x01;    /* the byte a PRODUCT_ID read would see */
+    m->reg[DL_REG_CS0_SENSOR_TYPE] = 66;
+    m->reg[DL_REG_CS0_STATUS]    = DL_CS_STATUS_VALID | DL_CS_STATUS_RT_MODE;
+    sim_i2c_regmap_put(m, DL_REG_CS0_RMS_L, 4350, 2);
+    sim_i2c_regmap_put(m, DL_REG_CS0_PEAK_L, 6150, 2);
+    m->reg[DL_REG_CS0_DIR]       = 1;
+    sim_i2c_regmap_put(m, DL_REG_CS0_DUR_0, 200, 4);
+    sim_i2c_regmap_put(m, DL_REG_CS0_SMPL_0, 1000, 4);
+    sim_i2c_regmap_put(m, DL_REG_CS0_CREST_L, 141, 2);
+    m->reg[DL_REG_VS_STATUS]     = DL_VS_NO_HW;
+}
+
+void sim_i2c_regmap_rbamp(sim_i2c_regmap_t *m, uint8_t hw_variant, const uint8_t uid[12])
+{
+    memset(m, 0, sizeof(*m));
+    m->reg[0x00] = DL_STATUS_READY;
+    m->reg[0x03] = 0x05;            /* VERSION: v1.3+ identity block valid */
+    m->reg[0x54] = 0x01;            /* PRODUCT_ID: rbAmp */
+    m->reg[0x55] = hw_variant;
+    if (uid) memcpy(&m->reg[0x5C], uid, 12);
+}
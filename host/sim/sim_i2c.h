@@ -0,0 +1,140 @@
+/**
+ * @file sim_i2c.h
+ * @brief Simulated I2C fabric behind the host i2c_master driver, with scriptable
+ *        virtual slaves and fault injection.
+ *
+ * The fabric implements driver/i2c_master.h, so the real i2c_bus, the async
+ * queue, the health module, the DimmerLink driver and the device registry run
+ * unmodified on top of it. Each bus serialises its transactions like the real
+ * driver and charges their wire time — 9 bits per byte plus START/STOP at the
+ * device's SCL clock — so bus-bound throughput is measured, not assumed.
+ *
+ * A slave is an ops table (sim_i2c_slave_ops_t) attached at an address. The
+ * register-map slave (sim_i2c_regmap_t) covers both module families with their
+ * quirks switchable:
+ *
+ *   - DimmerLink (legacy, VERSION <= 0x03): the register pointer written in a
+ *     transaction latches only on STOP — a repeated-START read returns the
+ *     previous pointer's data; the first read after the bus has been idle is
+ *     garbled; 0x54 is CS_CONFIG (default 0x01).
+ *   - rbAmp v1.3+ (VERSION >= 0x04): 0x54 is PRODUCT_ID (0x01), 0x55 the
+ *     HW_VARIANT, 0x5C..0x67 the UID; reads are clean in either framing.
+ *
+ * Faults: per-slave clock stretching (added latency), a number of NACKed
+ * transactions, and a wedged bus (SDA held low: every transaction runs to its
+ * timeout) for a given time.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_I2C_BUSES           2
+#define SIM_I2C_MAX_SLAVES      16      ///< Per bus
+
+/**
+ * @brief Virtual slave behaviour. Both hooks run with the bus held.
+ */
+typedef struct {
+    /** Master write after the address ACK. @p stop is false when a repeated
+     *  START follows (combined write-read). Return ESP_OK to ACK the bytes. */
+    esp_err_t (*write)(void *ctx, const uint8_t *data, size_t len, bool stop);
+    /** Master read of @p len bytes. */
+    esp_err_t (*read)(void *ctx, uint8_t *data, size_t len);
+} sim_i2c_slave_ops_t;
+
+/** Fabric counters of one bus (since sim_i2c_reset) */
+typedef struct {
+    uint32_t xfers;             ///< Transactions (a write-read counts once)
+    uint32_t probes;            ///< Zero-length address probes
+    uint32_t bytes;             ///< Payload bytes on the wire
+    uint32_t nacks;             ///< Transactions not acknowledged
+    uint32_t timeouts;          ///< Transactions that ran into a wedge
+    uint32_t dev_adds;          ///< i2c_master_bus_add_device() calls
+    uint64_t wire_us;           ///< Modelled wire time
+} sim_i2c_stats_t;
+
+/** Detach every slave, clear faults and counters (buses stay created). */
+void sim_i2c_reset(void);
+
+/** Charge wire time (default on). Off measures the software path alone. */
+void sim_i2c_set_wire_model(bool enable);
+
+/** Attach a slave. ESP_ERR_INVALID_STATE if the address is taken. */
+esp_err_t sim_i2c_attach(uint8_t bus, uint8_t addr, const sim_i2c_slave_ops_t *ops, void *ctx);
+
+/** Detach a slave; the address NACKs from now on. */
+void sim_i2c_detach(uint8_t bus, uint8_t addr);
+
+/** Clock stretching: @p us added to every transaction with the slave. */
+void sim_i2c_set_latency(uint8_t bus, uint8_t addr, uint32_t us);
+
+/** NACK the next @p count transactions to the slave (address phase). */
+void sim_i2c_inject_nack(uint8_t bus, uint8_t addr, uint32_t count);
+
+/** Wedge the bus for @p ms (0 = release now). */
+void sim_i2c_wedge(uint8_t bus, uint32_t ms);
+
+void sim_i2c_get_stats(uint8_t bus, sim_i2c_stats_t *stats);
+
+// ================================================================
+// Register-map slave
+// ================================================================
+
+/** Called after a master write stored @p len bytes from @p reg. */
+typedef void (*sim_i2c_regmap_hook_t)(void *ctx, uint8_t reg, const uint8_t *data, size_t len);
+
+typedef struct {
+    uint8_t  reg[256];
+    uint8_t  ptr;               ///< Register pointer (auto-increments)
+    bool     stop_latch;        ///< Pointer writes latch only on STOP
+    uint32_t garble_idle_ms;    ///< First read after this much idle is garbled (0 = off)
+    uint8_t  garble_value;      ///< What a garbled read returns
+    int64_t  last_us;           ///< Last transaction (idle detection)
+    bool     garble_armed;      ///< Next read is garbled
+    bool     unlatched;         ///< Last pointer write was dropped (no STOP)
+    sim_i2c_regmap_hook_t on_write;
+    void    *hook_ctx;
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t garbled;           ///< Reads answered with garble_value
+    uint32_t stale;             ///< Repeated-START reads from an unlatched pointer
+} sim_i2c_regmap_t;
+
+/** Ops of the register-map slave (ctx = sim_i2c_regmap_t*). */
+extern const sim_i2c_slave_ops_t sim_i2c_regmap_ops;
+
+/** Legacy DimmerLink at @p addr: quirks on, plausible idle telemetry. */
+void sim_i2c_regmap_dimmerlink(sim_i2c_regmap_t *m, uint8_t addr, uint8_t version);
+
+/** rbAmp v1.3+: identity block filled, clean reads. */
+void sim_i2c_regmap_rbamp(sim_i2c_regmap_t *m, uint8_t hw_variant, const uint8_t uid[12]);
+
+/** Little-endian store of @p len bytes of @p value at @p reg. */
+void sim_i2c_regmap_put(sim_i2c_regmap_t *m, uint8_t reg, uint32_t value, size_t len);
+
+// ================================================================
+// rbamp_source stand-in (sim_rbamp_source.c)
+// ================================================================
+
+/** Clear the role table, the polled-module list and the rescan count. */
+void     sim_rbamp_source_reset(void);
+
+/** Declare a module the rbAmp fleet polls (what rbamp_source_get_modules lists). */
+void     sim_rbamp_source_add_polled(uint8_t addr, uint8_t channels);
+
+/** rbamp_source_rescan() calls since the reset. */
+unsigned sim_rbamp_source_rescans(void);
+
+/** rbamp_source_pause(true) calls since the reset, and whether it is paused now. */
+unsigned sim_rbamp_source_pauses(bool *paused);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,231 @@
+/**
+ * @file sim_plant.c
+ * @brief House model and virtual measurement modules (see sim_plant.h).
+ */
+#include "sim_plant.h"
+#include "host_clock.h"
+#include "acrouter_events.h"
+#include "acrouter_meas_ring.h"
+#include "driver/gpio.h"
+
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    bool  used;
+    int   gpio;
+    float load_w;
+} sim_relay_t;
+
+/* Window accumulator of one virtual module: sums of the true channel value over
+ * its current 200 ms period, averaged when the frame is posted. */
+typedef struct {
+    double   sum_w;
+    double   sum_v;
+    uint32_t n;
+} sim_window_t;
+
+static sim_plant_config_t s_cfg;
+static sim_relay_t        s_relays[SIM_PLANT_MAX_RELAY];
+static sim_window_t       s_win[SIM_SRC_COUNT];
+static sim_plant_meters_t s_meters;
+static float              s_pv_w;
+static float              s_base_w;
+static uint32_t           s_phase_ms;      ///< position within the measurement period
+static uint64_t           s_rng;
+
+/* ================================================================
+ * Helpers
+ * ================================================================ */
+
+static float rng_uniform(void)
+{
+    /* xorshift64* — deterministic per seed, independent of libc rand(). */
+    s_rng ^= s_rng >> 12;
+    s_rng ^= s_rng << 25;
+    s_rng ^= s_rng >> 27;
+    return (float)((s_rng * 2685821657736338717ULL) >> 40) / (float)(1ULL << 24);
+}
+
+static float rng_gauss(void)
+{
+    float u1 = rng_uniform();
+    float u2 = rng_uniform();
+    if (u1 < 1e-7f) u1 = 1e-7f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+static float relay_power_w(void)
+{
+    float p = 0.0f;
+    for (int i = 0; i < SIM_PLANT_MAX_RELAY; i++) {
+        if (s_relays[i].used && gpio_get_level(s_relays[i].gpio)) p += s_relays[i].load_w;
+    }
+    return p;
+}
+
+static acrouter_direction_t direction_of(float w)
+{
+    if (w > 5.0f)  return ACROUTER_DIR_CONSUMING;
+    if (w < -5.0f) return ACROUTER_DIR_SUPPLYING;
+    return ACROUTER_DIR_ZERO;
+}
+
+static void post_frame(int src)
+{
+    sim_window_t *w = &s_win[src];
+    if (w->n == 0) return;
+
+    float p = (float)(w->sum_w / w->n) + s_cfg.noise_w * rng_gauss();
+    float v = (float)(w->sum_v / w->n);
+    memset(w, 0, sizeof(*w));
+
+    static const int ch_of[SIM_SRC_COUNT] = { ACROUTER_CH_GRID, ACROUTER_CH_SOLAR, ACROUTER_CH_LOAD };
+    int ch = ch_of[src];
+
+    acrouter_measurements_t m;
+    acrouter_measurements_init(&m);
+    m.timestamp_us      = (uint64_t)host_clock_now_us();
+    m.source            = ACROUTER_SOURCE_I2C;
+    m.source_id         = (uint8_t)src;
+    m.valid             = true;
+    m.current_rms[ch]   = fabsf(p) / v;
+    m.power_active[ch]  = p;
+    m.direction[ch]     = direction_of(p);
+    m.has_current[ch]   = true;
+    m.has_power[ch]     = true;
+    if (src == SIM_SRC_GRID) {
+        m.voltage_rms = v;
+        m.has_voltage = true;
+    }
+    acrouter_meas_publish(&m);
+}
+
+/* ================================================================
+ * Public API
+ * ================================================================ */
+
+void sim_plant_default_config(sim_plant_config_t *cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->seed              = 1;
+    cfg->mains_v           = 230.0f;
+    cfg->noise_w           = 4.0f;
+    cfg->phase_ms[SIM_SRC_GRID]  = 0;
+    cfg->phase_ms[SIM_SRC_SOLAR] = 70;
+    cfg->phase_ms[SIM_SRC_LOAD]  = 140;
+    cfg->espnow_latency_ms = 20;
+}
+
+void sim_plant_init(const sim_plant_config_t *cfg)
+{
+    if (cfg) {
+        s_cfg = *cfg;
+    } else {
+        sim_plant_default_config(&s_cfg);
+    }
+    memset(s_relays, 0, sizeof(s_relays));
+    memset(s_win, 0, sizeof(s_win));
+    memset(&s_meters, 0, sizeof(s_meters));
+    s_pv_w     = 0.0f;
+    s_base_w   = 0.0f;
+    s_phase_ms = 0;
+    s_rng      = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)s_cfg.seed << 1);
+    sim_dimmerlink_reset();
+    sim_espnow_reset(s_cfg.espnow_latency_ms);
+    if (!host_clock_is_sim()) {
+        host_clock_use_sim(1000000);
+    }
+}
+
+int sim_plant_add_dimmerlink(uint8_t bus, uint8_t addr, float load_w)
+{
+    return sim_dimmerlink_add(bus, addr, load_w);
+}
+
+int sim_plant_add_espnow_node(const uint8_t mac[6], float load_w)
+{
+    return sim_espnow_add(mac, load_w);
+}
+
+int sim_plant_add_relay_load(int gpio, float load_w)
+{
+    for (int i = 0; i < SIM_PLANT_MAX_RELAY; i++) {
+        if (!s_relays[i].used) {
+            s_relays[i] = (sim_relay_t){ .used = true, .gpio = gpio, .load_w = load_w };
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void sim_plant_set_pv_w(float w)        { s_pv_w = w > 0.0f ? w : 0.0f; }
+void sim_plant_set_base_load_w(float w) { s_base_w = w > 0.0f ? w : 0.0f; }
+
+void sim_plant_set_phases(const uint32_t phase_ms[SIM_SRC_COUNT])
+{
+    memcpy(s_cfg.phase_ms, phase_ms, sizeof(s_cfg.phase_ms));
+}
+
+float sim_plant_heater_w(void)
+{
+    return sim_dimmerlink_power_w() + sim_espnow_power_w() + relay_power_w();
+}
+
+float sim_plant_heater_capacity_w(void)
+{
+    float p = sim_dimmerlink_capacity_w() + sim_espnow_capacity_w();
+    for (int i = 0; i < SIM_PLANT_MAX_RELAY; i++) {
+        if (s_relays[i].used) p += s_relays[i].load_w;
+    }
+    return p;
+}
+
+float sim_plant_grid_w(void)
+{
+    return s_base_w + sim_plant_heater_w() - s_pv_w;
+}
+
+void sim_plant_run(uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += SIM_PLANT_STEP_MS) {
+        host_clock_advance_us(SIM_PLANT_STEP_MS * 1000);
+        sim_espnow_pump(host_clock_now_us());
+
+        const float heater = sim_plant_heater_w();
+        const float load   = s_base_w + heater;
+        const float grid   = load - s_pv_w;
+        /* Mains sags slightly under import and rises under export (source impedance). */
+        const float volts  = s_cfg.mains_v - grid * 0.0015f;
+
+        const double h = SIM_PLANT_STEP_MS / 3600000.0;   /* step in hours */
+        if (grid > 0.0f) s_meters.import_wh += grid * h;
+        else             s_meters.export_wh += -grid * h;
+        s_meters.heater_wh += heater * h;
+        s_meters.pv_wh     += s_pv_w * h;
+
+        const float truth[SIM_SRC_COUNT] = { grid, s_pv_w, load };
+        for (int src = 0; src < SIM_SRC_COUNT; src++) {
+            s_win[src].sum_w += truth[src];
+            s_win[src].sum_v += volts;
+            s_win[src].n++;
+        }
+
+        s_phase_ms = (s_phase_ms + SIM_PLANT_STEP_MS) % SIM_PLANT_PERIOD_MS;
+        for (int src = 0; src < SIM_SRC_COUNT; src++) {
+            if (s_phase_ms == s_cfg.phase_ms[src] % SIM_PLANT_PERIOD_MS) {
+                post_frame(src);
+            }
+        }
+    }
+}
+
+void sim_plant_get_meters(sim_plant_meters_t *out)
+{
+    if (out) *out = s_meters;
+}
+
+void sim_plant_reset_meters(void)
+{
+    memset(&s_meters, 0, sizeof(s_meters));
+}
@@ -0,0 +1,109 @@
+/**
+ * @file sim_plant.h
+ * @brief Simulated house for the host build: PV, base load and the heaters the
+ *        router drives, measured by three virtual rbAmp modules.
+ *
+ * The plant replaces the hardware boundary only. Firmware code above it — the
+ * dimmer/relay managers, sensor_hub, RouterController — is the real source:
+ *
+ *   - DimmerLink modules answer the dl_device_* calls (sim_dimmerlink.c).
+ *   - ESP-NOW output nodes answer esp_now_source_set_output() and apply the
+ *     command after an RF latency (sim_espnow.c).
+ *   - GPIO relay heaters follow the driver/gpio.h output latch.
+ *   - Measurements are posted as ACROUTER_EVENT_POWER_UPDATE frames, one per
+ *     module (grid+voltage, solar, load), each a window average over its own
+ *     200 ms period, phase-staggered like free-running modules on the bus.
+ *
+ * Time is the simulated host_clock: sim_plant_run() advances it in 10 ms steps.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_PLANT_STEP_MS        10     ///< Physics step
+#define SIM_PLANT_PERIOD_MS      200    ///< Measurement window per module (5 Hz)
+#define SIM_PLANT_MAX_DIMMERLINK 8
+#define SIM_PLANT_MAX_ESPNOW     8
+#define SIM_PLANT_MAX_RELAY      4
+
+/** Source ids of the three virtual measurement modules. */
+enum {
+    SIM_SRC_GRID  = 0,     ///< grid current/power + mains voltage
+    SIM_SRC_SOLAR = 1,     ///< PV inverter output
+    SIM_SRC_LOAD  = 2,     ///< house consumption incl. heaters
+    SIM_SRC_COUNT = 3,
+};
+
+typedef struct {
+    uint32_t seed;                        ///< noise RNG seed (deterministic runs)
+    float    mains_v;                     ///< nominal mains voltage (230)
+    float    noise_w;                     ///< 1-sigma measurement noise per channel (W)
+    uint32_t phase_ms[SIM_SRC_COUNT];     ///< post offset of each module within the period
+    uint32_t espnow_latency_ms;           ///< SET_OUTPUT → applied at the node
+} sim_plant_config_t;
+
+/** Energy meters (Wh), integrated at the physics step. */
+typedef struct {
+    double import_wh;
+    double export_wh;
+    double heater_wh;
+    double pv_wh;
+} sim_plant_meters_t;
+
+/** Fill @p cfg with the defaults used by the benchmarks. */
+void  sim_plant_default_config(sim_plant_config_t *cfg);
+
+/** Reset the plant (outputs, meters, clock) and switch host_clock to SIM time. */
+void  sim_plant_init(const sim_plant_config_t *cfg);
+
+/** Heater wiring. Returns 0 on success, -1 when the table is full. */
+int   sim_plant_add_dimmerlink(uint8_t bus, uint8_t addr, float load_w);
+int   sim_plant_add_espnow_node(const uint8_t mac[6], float load_w);
+int   sim_plant_add_relay_load(int gpio, float load_w);
+
+/** Disturbances — take effect at the next physics step. */
+void  sim_plant_set_pv_w(float w);
+void  sim_plant_set_base_load_w(float w);
+
+/** Move the modules' post offsets (re-plugged bus); the open windows stretch to them. */
+void  sim_plant_set_phases(const uint32_t phase_ms[SIM_SRC_COUNT]);
+
+/** Advance the plant by @p ms, posting measurement frames on schedule. */
+void  sim_plant_run(uint32_t ms);
+
+/** Instantaneous plant values (not what the sensors report). */
+float sim_plant_heater_w(void);
+float sim_plant_grid_w(void);
+float sim_plant_heater_capacity_w(void);
+
+void  sim_plant_get_meters(sim_plant_meters_t *out);
+void  sim_plant_reset_meters(void);
+
+/* ---- Output-model internals shared between the sim_* translation units ---- */
+
+/** Power fraction (0..1) a resistive load draws at @p percent for DimmerLink @p curve. */
+float sim_curve_power_fraction(uint8_t curve, float percent);
+
+void  sim_dimmerlink_reset(void);
+int   sim_dimmerlink_add(uint8_t bus, uint8_t addr, float load_w);
+float sim_dimmerlink_power_w(void);
+float sim_dimmerlink_capacity_w(void);
+/** Fault injection: an offline module NACKs every transfer. */
+void  sim_dimmerlink_set_online(uint8_t bus, uint8_t addr, bool online);
+
+void  sim_espnow_reset(uint32_t latency_ms);
+int   sim_espnow_add(const uint8_t mac[6], float load_w);
+/** Apply commands whose RF latency has elapsed at @p now_us. */
+void  sim_espnow_pump(int64_t now_us);
+float sim_espnow_power_w(void);
+float sim_espnow_capacity_w(void);
+
+#ifdef __cplusplus
+}
+#endif
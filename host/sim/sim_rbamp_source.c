@@ -0,0 +1,109 @@
+/**
+ * @file sim_rbamp_source.c
+ * @brief Host stand-in for the rbamp_source calls the device registry makes.
+ *
+ * rbamp_source.c drives the external rbAmp library (fleet scan, snapshots) and
+ * is not host-buildable. The registry only needs the role table, the module
+ * list, the rescan trigger and the poll pause: the table is kept here, the
+ * module list is whatever the bench declares polled, rescans and pauses are
+ * counted.
+ */
+#include "sim_i2c.h"
+#include "rbamp_source.h"
+
+#include <string.h>
+
+static rbamp_source_module_cfg_t  s_roles[RBAMP_SOURCE_MAX_ROLES];
+static size_t                     s_role_count;
+static rbamp_source_module_info_t s_mods[RBAMP_SOURCE_MAX_MODULES];
+static size_t                     s_mod_count;
+static unsigned                   s_rescans;
+static unsigned                   s_pauses;
+static bool                       s_paused;
+
+void sim_rbamp_source_reset(void)
+{
+    s_role_count = 0;
+    s_mod_count  = 0;
+    s_rescans    = 0;
+    s_pauses     = 0;
+    s_paused     = false;
+}
+
+void sim_rbamp_source_add_polled(uint8_t addr, uint8_t channels)
+{
+    if (s_mod_count >= RBAMP_SOURCE_MAX_MODULES) return;
+    memset(&s_mods[s_mod_count], 0, sizeof(s_mods[0]));
+    s_mods[s_mod_count].i2c_addr = addr;
+    s_mods[s_mod_count].channels = channels;
+    s_mods[s_mod_count].online   = true;
+    s_mod_count++;
+}
+
+unsigned sim_rbamp_source_rescans(void)
+{
+    return s_rescans;
+}
+
+unsigned sim_rbamp_source_pauses(bool *paused)
+{
+    if (paused) *paused = s_paused;
+    return s_pauses;
+}
+
+void rbamp_source_pause(bool pause)
+{
+    if (pause) s_pauses++;
+    s_paused = pause;
+}
+
+esp_err_t rbamp_source_set_role(uint8_t addr, rbamp_source_role_t role)
+{
+    return rbamp_source_set_channel_role(addr, 0, role);
+}
+
+esp_err_t rbamp_source_set_channel_role(uint8_t addr, uint8_t channel, rbamp_source_role_t role)
+{
+    if (channel >= RBAMP_SOURCE_MAX_CHANNELS) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < s_role_count; i++) {
+        if (s_roles[i].i2c_addr != addr || s_roles[i].channel != channel) continue;
+        if (role == RBAMP_ROLE_NONE) {
+            s_roles[i] = s_roles[--s_role_count];
+        } else {
+            s_roles[i].role = role;
+        }
+        return ESP_OK;
+    }
+    if (role == RBAMP_ROLE_NONE) return ESP_OK;
+    if (s_role_count >= RBAMP_SOURCE_MAX_ROLES) return ESP_ERR_NO_MEM;
+    s_roles[s_role_count++] = (rbamp_source_module_cfg_t){
+        .i2c_addr = addr, .role = role, .channel = channel };
+    return ESP_OK;
+}
+
+esp_err_t rbamp_source_get_roles(rbamp_source_module_cfg_t *mods, size_t max, size_t *n)
+{
+    size_t k = s_role_count < max ? s_role_count : max;
+    memcpy(mods, s_roles, k * sizeof(*mods));
+    *n = k;
+    return ESP_OK;
+}
+
+esp_err_t rbamp_source_get_modules(rbamp_source_module_info_t *out, size_t max, size_t *n)
+{
+    size_t k = s_mod_count < max ? s_mod_count : max;
+    memcpy(out, s_mods, k * sizeof(*out));
+    *n = k;
+    return ESP_OK;
+}
+
+esp_err_t rbamp_source_save_config(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t rbamp_source_rescan(void)
+{
+    s_rescans++;
+    return ESP_OK;
+}
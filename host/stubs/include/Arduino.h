@@ -0,0 +1,30 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino core surface used by the control core (millis/micros/delay).
+ *
+ * millis() follows the firmware clock (host_clock), truncated to 32 bits like
+ * arduino-esp32, so time-gated logging and relay debounce behave identically
+ * under simulated time.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "host_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint32_t millis(void) { return (uint32_t)(host_clock_now_us() / 1000); }
+static inline uint32_t micros(void) { return (uint32_t)host_clock_now_us(); }
+void delay(uint32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+/**
+ * @file i2c_master.h
+ * @brief Host stand-in for the IDF i2c_master driver.
+ *
+ * Only the calls i2c_bus.c makes. The implementation is the simulated I2C
+ * fabric (sim/sim_i2c.c): transactions reach the virtual slaves attached there.
+ * Error codes follow IDF 5.0-5.2: a missing ACK is ESP_ERR_INVALID_STATE on a
+ * transfer and ESP_ERR_NOT_FOUND on a probe; a stuck bus is ESP_ERR_TIMEOUT.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct i2c_master_bus_t *i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t *i2c_master_dev_handle_t;
+
+typedef int i2c_port_num_t;
+
+typedef enum { I2C_CLK_SRC_DEFAULT = 0 } i2c_clock_source_t;
+typedef enum { I2C_ADDR_BIT_LEN_7 = 0, I2C_ADDR_BIT_LEN_10 } i2c_addr_bit_len_t;
+
+typedef struct {
+    i2c_port_num_t     i2c_port;
+    gpio_num_t         sda_io_num;
+    gpio_num_t         scl_io_num;
+    i2c_clock_source_t clk_source;
+    uint8_t            glitch_ignore_cnt;
+    int                intr_priority;
+    size_t             trans_queue_depth;
+    struct {
+        uint32_t enable_internal_pullup : 1;
+    } flags;
+} i2c_master_bus_config_t;
+
+typedef struct {
+    i2c_addr_bit_len_t dev_addr_length;
+    uint16_t           device_address;
+    uint32_t           scl_speed_hz;
+} i2c_device_config_t;
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *cfg, i2c_master_bus_handle_t *ret);
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus);
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus, const i2c_device_config_t *cfg,
+                                    i2c_master_dev_handle_t *ret);
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t dev);
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus, uint16_t addr, int timeout_ms);
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t dev, const uint8_t *buf, size_t len,
+                              int timeout_ms);
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t dev, uint8_t *buf, size_t len,
+                             int timeout_ms);
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t dev, const uint8_t *wbuf,
+                                      size_t wlen, uint8_t *rbuf, size_t rlen, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
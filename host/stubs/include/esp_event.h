@@ -0,0 +1,52 @@
+/**
+ * @file esp_event.h
+ * @brief Host stand-in for the esp_event default loop.
+ *
+ * Posts are copied into a FIFO (like the IDF loop queue) and delivered by
+ * whichever thread holds the dispatcher — on the single-threaded simulator that
+ * is the poster itself, so a post returns only after every handler (and every
+ * event those handlers posted in turn) has run. Nested posts are queued, never
+ * delivered recursively, preserving the IDF ordering.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef const char *esp_event_base_t;
+typedef void       *esp_event_handler_instance_t;
+typedef void (*esp_event_handler_t)(void *handler_arg, esp_event_base_t base,
+                                    int32_t id, void *event_data);
+
+#define ESP_EVENT_ANY_BASE  NULL
+#define ESP_EVENT_ANY_ID    -1
+
+#define ESP_EVENT_DECLARE_BASE(id) extern esp_event_base_t const id
+#define ESP_EVENT_DEFINE_BASE(id)  esp_event_base_t const id = #id
+
+esp_err_t esp_event_loop_create_default(void);
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id,
+                                     esp_event_handler_t handler, void *arg);
+esp_err_t esp_event_handler_unregister(esp_event_base_t base, int32_t id,
+                                       esp_event_handler_t handler);
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance);
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data,
+                         size_t size, TickType_t ticks);
+
+/** Host-only: drop every registered handler and queued event (scenario reset). */
+void      host_event_reset(void);
+/** Host-only: number of events posted / delivered since the last reset. */
+uint32_t  host_event_posted(void);
+uint32_t  host_event_delivered(void);
+
+#ifdef __cplusplus
+}
+#endif
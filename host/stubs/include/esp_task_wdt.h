@@ -0,0 +1,21 @@
+/**
+ * @file esp_task_wdt.h
+ * @brief Host stand-in for the Task Watchdog — subscriptions always succeed, never fire.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline esp_err_t esp_task_wdt_add(TaskHandle_t task)    { (void)task; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_delete(TaskHandle_t task) { (void)task; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_reset(void)               { return ESP_OK; }
+
+#ifdef __cplusplus
+}
+#endif
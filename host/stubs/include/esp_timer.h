@@ -0,0 +1,56 @@
+/**
+ * @file esp_timer.h
+ * @brief Host stand-in for esp_timer: get_time plus one-shot/periodic timers.
+ *
+ * Timer callbacks run as ESP_TIMER_TASK dispatch would: one at a time, never
+ * concurrently with each other. In SIM time they fire from inside
+ * host_clock_advance_us() at their exact expiry; in REAL time a dispatcher
+ * thread fires them.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "host_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t       callback;
+    void                *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char          *name;
+    bool                 skip_unhandled_events;
+} esp_timer_create_args_t;
+
+static inline int64_t esp_timer_get_time(void)
+{
+    return host_clock_now_us();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out);
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t t);
+esp_err_t esp_timer_delete(esp_timer_handle_t t);
+bool      esp_timer_is_active(esp_timer_handle_t t);
+
+/** Host-internal: earliest armed expiry (INT64_MAX if none). */
+int64_t   host_timer_next_due(void);
+/** Host-internal: fire every timer due at or before @p now_us. */
+void      host_timer_fire_due(int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
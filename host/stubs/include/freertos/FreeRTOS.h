@@ -0,0 +1,55 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the FreeRTOS kernel types, backed by pthreads.
+ *
+ * One tick == 1 ms. portMUX critical sections are a spinlock (the firmware only
+ * holds them around short memory operations, same as on target).
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE             ((BaseType_t)0)
+#define pdTRUE              ((BaseType_t)1)
+#define pdFAIL              pdFALSE
+#define pdPASS              pdTRUE
+#define errQUEUE_FULL       ((BaseType_t)0)
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  ((TickType_t)1)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define pdTICKS_TO_MS(t)    ((uint32_t)(t))
+#define tskNO_AFFINITY      ((BaseType_t)0x7FFFFFFF)
+#define tskIDLE_PRIORITY    ((UBaseType_t)0)
+
+#define IRAM_ATTR
+
+typedef struct {
+    volatile int locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+
+void host_mux_enter(portMUX_TYPE *mux);
+void host_mux_exit(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux)      host_mux_enter(mux)
+#define portEXIT_CRITICAL(mux)       host_mux_exit(mux)
+#define portENTER_CRITICAL_ISR(mux)  host_mux_enter(mux)
+#define portEXIT_CRITICAL_ISR(mux)   host_mux_exit(mux)
+#define portYIELD_FROM_ISR(x)        ((void)(x))
+
+#ifdef __cplusplus
+}
+#endif
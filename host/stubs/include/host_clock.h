@@ -0,0 +1,39 @@
+/**
+ * @file host_clock.h
+ * @brief Time base for the host build.
+ *
+ * Two modes:
+ *   - REAL (default): esp_timer_get_time() reads CLOCK_MONOTONIC. Used by the
+ *     concurrency benchmarks, where real threads race on real time.
+ *   - SIM: time only moves when the simulator calls host_clock_advance_us(). A
+ *     plant scenario is then fully deterministic and runs as fast as the CPU
+ *     allows (a simulated hour takes milliseconds).
+ *
+ * FreeRTOS delays/timeouts in the stubs always use real time; only the value
+ * the firmware reads as "now" is virtualised.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Switch to simulated time, starting at @p start_us. */
+void    host_clock_use_sim(int64_t start_us);
+/** Switch back to the monotonic wall clock. */
+void    host_clock_use_real(void);
+/** True while the simulated time base is active. */
+bool    host_clock_is_sim(void);
+/** Advance simulated time (no-op in REAL mode). */
+void    host_clock_advance_us(int64_t delta_us);
+/** Current time in µs (simulated or monotonic). */
+int64_t host_clock_now_us(void);
+/** Monotonic wall clock in ns, regardless of mode (for CPU-cost measurements). */
+int64_t host_clock_wall_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,20 @@
+/**
+ * @file nvs_flash.h
+ * @brief Host stand-in for NVS partition init/erase.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "nvs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t nvs_flash_init(void);
+/** Wipes every namespace of the in-memory store. */
+esp_err_t nvs_flash_erase(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host (Linux) build configuration — stands in for the IDF-generated sdkconfig.h.
+ *
+ * Only the options the control core reads are defined. ESP-NOW output support is
+ * on so dimmer_manager compiles its ESP-NOW dispatch path against the simulated
+ * output node (host/sim/sim_espnow.c).
+ */
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX          1
+#define CONFIG_FREERTOS_UNICORE          0
+#define CONFIG_ACROUTER_ESPNOW_SOURCE    1
+#define CONFIG_ACROUTER_ESPNOW_CHANNEL   1
+#define CONFIG_ACROUTER_ESPNOW_ENERGY_COMMIT_S  300
+#define CONFIG_ACROUTER_SENSOR_HUB_COALESCE   1
+#define CONFIG_ACROUTER_SENSOR_HUB_EPOCH_MS   150
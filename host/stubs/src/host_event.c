@@ -0,0 +1,174 @@
+/**
+ * @file host_event.c
+ * @brief Host esp_event default loop: handler table + FIFO, drained by the poster.
+ */
+#include "esp_event.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_EVENT_MAX_HANDLERS  32
+#define HOST_EVENT_QUEUE_DEPTH   64
+
+typedef struct {
+    esp_event_base_t    base;
+    int32_t             id;
+    esp_event_handler_t fn;
+    void               *arg;
+    bool                used;
+} handler_slot_t;
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t          id;
+    void            *data;
+} queued_event_t;
+
+static handler_slot_t  s_handlers[HOST_EVENT_MAX_HANDLERS];
+static queued_event_t  s_queue[HOST_EVENT_QUEUE_DEPTH];
+static uint32_t        s_head;
+static uint32_t        s_count;
+static bool            s_dispatching;
+static uint32_t        s_posted;
+static uint32_t        s_delivered;
+
+/* s_lock guards the tables; s_dispatch serialises delivery so handlers never
+ * run concurrently (the IDF default loop is a single task). */
+static pthread_mutex_t s_lock     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t s_dispatch = PTHREAD_MUTEX_INITIALIZER;
+
+static bool base_matches(esp_event_base_t want, esp_event_base_t got)
+{
+    /* Bases are unique string objects defined once via ESP_EVENT_DEFINE_BASE,
+     * but compare contents so a base declared in C and used from C++ still hits. */
+    return want == ESP_EVENT_ANY_BASE || want == got ||
+           (want && got && strcmp(want, got) == 0);
+}
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t base, int32_t id,
+                                     esp_event_handler_t handler, void *arg)
+{
+    if (!handler) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < HOST_EVENT_MAX_HANDLERS; i++) {
+        if (!s_handlers[i].used) {
+            s_handlers[i] = (handler_slot_t){ base, id, handler, arg, true };
+            pthread_mutex_unlock(&s_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance)
+{
+    esp_err_t err = esp_event_handler_register(base, id, handler, arg);
+    if (err == ESP_OK && instance) *instance = (void *)handler;
+    return err;
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t base, int32_t id,
+                                       esp_event_handler_t handler)
+{
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < HOST_EVENT_MAX_HANDLERS; i++) {
+        handler_slot_t *h = &s_handlers[i];
+        if (h->used && h->fn == handler && h->id == id && base_matches(h->base, base)) {
+            h->used = false;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+static void deliver(const queued_event_t *ev)
+{
+    handler_slot_t snapshot[HOST_EVENT_MAX_HANDLERS];
+    pthread_mutex_lock(&s_lock);
+    memcpy(snapshot, s_handlers, sizeof(snapshot));
+    pthread_mutex_unlock(&s_lock);
+
+    for (int i = 0; i < HOST_EVENT_MAX_HANDLERS; i++) {
+        const handler_slot_t *h = &snapshot[i];
+        if (!h->used) continue;
+        if (!base_matches(h->base, ev->base)) continue;
+        if (h->id != ESP_EVENT_ANY_ID && h->id != ev->id) continue;
+        h->fn(h->arg, ev->base, ev->id, ev->data);
+        __atomic_add_fetch(&s_delivered, 1, __ATOMIC_RELAXED);
+    }
+}
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data,
+                         size_t size, TickType_t ticks)
+{
+    (void)ticks;
+    void *copy = NULL;
+    if (data && size) {
+        copy = malloc(size);
+        if (!copy) return ESP_ERR_NO_MEM;
+        memcpy(copy, data, size);
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if (s_count >= HOST_EVENT_QUEUE_DEPTH) {
+        pthread_mutex_unlock(&s_lock);
+        free(copy);
+        return ESP_ERR_TIMEOUT;
+    }
+    s_queue[(s_head + s_count) % HOST_EVENT_QUEUE_DEPTH] = (queued_event_t){ base, id, copy };
+    s_count++;
+    s_posted++;
+    bool drain = !s_dispatching;
+    if (drain) s_dispatching = true;
+    pthread_mutex_unlock(&s_lock);
+
+    if (!drain) {
+        /* A handler up the stack (or another thread) is draining; it will pick
+         * this event up after the current one, exactly like the IDF loop. */
+        return ESP_OK;
+    }
+
+    pthread_mutex_lock(&s_dispatch);
+    for (;;) {
+        pthread_mutex_lock(&s_lock);
+        if (s_count == 0) {
+            s_dispatching = false;
+            pthread_mutex_unlock(&s_lock);
+            break;
+        }
+        queued_event_t ev = s_queue[s_head];
+        s_head = (s_head + 1) % HOST_EVENT_QUEUE_DEPTH;
+        s_count--;
+        pthread_mutex_unlock(&s_lock);
+
+        deliver(&ev);
+        free(ev.data);
+    }
+    pthread_mutex_unlock(&s_dispatch);
+    return ESP_OK;
+}
+
+void host_event_reset(void)
+{
+    pthread_mutex_lock(&s_lock);
+    for (uint32_t i = 0; i < s_count; i++) {
+        free(s_queue[(s_head + i) % HOST_EVENT_QUEUE_DEPTH].data);
+    }
+    memset(s_handlers, 0, sizeof(s_handlers));
+    s_head = s_count = 0;
+    s_posted = s_delivered = 0;
+    pthread_mutex_unlock(&s_lock);
+}
+
+uint32_t host_event_posted(void)    { return __atomic_load_n(&s_posted, __ATOMIC_RELAXED); }
+uint32_t host_event_delivered(void) { return __atomic_load_n(&s_delivered, __ATOMIC_RELAXED); }
@@ -0,0 +1,200 @@
+/**
+ * @file host_misc.c
+ * @brief Host clock, logging, error names, esp_system and GPIO latch stubs.
+ */
+#include "host_clock.h"
+#include "esp_timer.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "driver/gpio.h"
+#include "Arduino.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* ================================================================
+ * Clock
+ * ================================================================ */
+
+static volatile bool    s_sim_mode;
+static volatile int64_t s_sim_now_us;
+
+int64_t host_clock_wall_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void host_clock_use_sim(int64_t start_us)
+{
+    __atomic_store_n(&s_sim_now_us, start_us, __ATOMIC_RELEASE);
+    s_sim_mode = true;
+}
+
+void host_clock_use_real(void)
+{
+    s_sim_mode = false;
+}
+
+bool host_clock_is_sim(void)
+{
+    return s_sim_mode;
+}
+
+void host_clock_advance_us(int64_t delta_us)
+{
+    if (!s_sim_mode || delta_us <= 0) return;
+    /* Step through every esp_timer expiry inside the interval so callbacks see
+     * "now" equal to their due time, exactly as on target. */
+    const int64_t target = __atomic_load_n(&s_sim_now_us, __ATOMIC_ACQUIRE) + delta_us;
+    for (;;) {
+        int64_t due = host_timer_next_due();
+        if (due > target) break;
+        if (due > __atomic_load_n(&s_sim_now_us, __ATOMIC_ACQUIRE)) {
+            __atomic_store_n(&s_sim_now_us, due, __ATOMIC_RELEASE);
+        }
+        host_timer_fire_due(due);
+    }
+    __atomic_store_n(&s_sim_now_us, target, __ATOMIC_RELEASE);
+}
+
+int64_t host_clock_now_us(void)
+{
+    if (s_sim_mode) return __atomic_load_n(&s_sim_now_us, __ATOMIC_ACQUIRE);
+    return host_clock_wall_ns() / 1000;
+}
+
+void delay(uint32_t ms)
+{
+    if (s_sim_mode) {
+        host_clock_advance_us((int64_t)ms * 1000);
+        return;
+    }
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+/* ================================================================
+ * Logging
+ * ================================================================ */
+
+static esp_log_level_t s_log_level = ESP_LOG_WARN;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;   /* single global level on host */
+    s_log_level = level;
+}
+
+void host_log_write(esp_log_level_t level, const char *tag, const char *fmt, ...)
+{
+    if (level > s_log_level) return;
+    static const char letters[] = "NEWIDV";
+    fprintf(stderr, "%c (%lld) %s: ", letters[level],
+            (long long)(host_clock_now_us() / 1000), tag ? tag : "?");
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                   return "ESP_OK";
+    case ESP_FAIL:                 return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:      return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_INVALID_VERSION:  return "ESP_ERR_INVALID_VERSION";
+    case ESP_ERR_INVALID_MAC:      return "ESP_ERR_INVALID_MAC";
+    case ESP_ERR_NOT_FINISHED:     return "ESP_ERR_NOT_FINISHED";
+    case ESP_ERR_NOT_ALLOWED:      return "ESP_ERR_NOT_ALLOWED";
+    default:                       return "UNKNOWN_ERROR";
+    }
+}
+
+/* ================================================================
+ * esp_system
+ * ================================================================ */
+
+uint32_t esp_get_free_heap_size(void)         { return 200 * 1024; }
+uint32_t esp_get_minimum_free_heap_size(void) { return 180 * 1024; }
+const char *esp_get_idf_version(void)         { return "host"; }
+
+void esp_restart(void)
+{
+    fprintf(stderr, "esp_restart() called on host — exiting\n");
+    exit(3);
+}
+
+/* ================================================================
+ * GPIO latch
+ * ================================================================ */
+
+static volatile int s_gpio_level[HOST_GPIO_COUNT];
+static gpio_isr_t   s_gpio_isr[HOST_GPIO_COUNT];
+static void        *s_gpio_isr_arg[HOST_GPIO_COUNT];
+
+esp_err_t gpio_config(const gpio_config_t *cfg)
+{
+    return cfg ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t pin)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT) return ESP_ERR_INVALID_ARG;
+    s_gpio_level[pin] = 0;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT) return ESP_ERR_INVALID_ARG;
+    s_gpio_level[pin] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t pin)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT) return 0;
+    return s_gpio_level[pin];
+}
+
+esp_err_t gpio_install_isr_service(int flags)
+{
+    (void)flags;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t isr, void *arg)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT) return ESP_ERR_INVALID_ARG;
+    s_gpio_isr[pin]     = isr;
+    s_gpio_isr_arg[pin] = arg;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t pin)
+{
+    if (pin < 0 || pin >= HOST_GPIO_COUNT) return ESP_ERR_INVALID_ARG;
+    s_gpio_isr[pin] = NULL;
+    return ESP_OK;
+}
+
+void host_gpio_trigger(gpio_num_t pin)
+{
+    if (pin >= 0 && pin < HOST_GPIO_COUNT && s_gpio_isr[pin]) {
+        s_gpio_isr[pin](s_gpio_isr_arg[pin]);
+    }
+}
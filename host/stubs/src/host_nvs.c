@@ -0,0 +1,283 @@
+/**
+ * @file host_nvs.c
+ * @brief In-memory NVS: one flat table of (namespace, key, type, blob) entries.
+ */
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_NVS_MAX_ENTRIES  512
+#define HOST_NVS_MAX_HANDLES  64
+#define HOST_NVS_NAME_MAX     16   /* IDF limit: 15 chars + NUL */
+
+typedef enum { T_U8, T_I8, T_U16, T_I16, T_U32, T_I32, T_U64, T_STR, T_BLOB } nvs_type_t;
+
+typedef struct {
+    bool       used;
+    char       ns[HOST_NVS_NAME_MAX];
+    char       key[HOST_NVS_NAME_MAX];
+    nvs_type_t type;
+    size_t     len;
+    uint8_t   *data;
+} entry_t;
+
+typedef struct {
+    bool            used;
+    char            ns[HOST_NVS_NAME_MAX];
+    nvs_open_mode_t mode;
+} handle_t;
+
+static entry_t         s_entries[HOST_NVS_MAX_ENTRIES];
+static handle_t        s_handles[HOST_NVS_MAX_HANDLES];
+static uint32_t        s_commits;
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* ================================================================
+ * Internals (call with s_lock held)
+ * ================================================================ */
+
+static handle_t *get_handle(nvs_handle_t h)
+{
+    if (h == 0 || h > HOST_NVS_MAX_HANDLES || !s_handles[h - 1].used) return NULL;
+    return &s_handles[h - 1];
+}
+
+static entry_t *find(const char *ns, const char *key)
+{
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        entry_t *e = &s_entries[i];
+        if (e->used && strcmp(e->ns, ns) == 0 && strcmp(e->key, key) == 0) return e;
+    }
+    return NULL;
+}
+
+static esp_err_t put(nvs_handle_t h, const char *key, nvs_type_t type,
+                     const void *v, size_t len)
+{
+    if (!key || strlen(key) >= HOST_NVS_NAME_MAX) return ESP_ERR_NVS_INVALID_NAME;
+    pthread_mutex_lock(&s_lock);
+    handle_t *hd = get_handle(h);
+    if (!hd) { pthread_mutex_unlock(&s_lock); return ESP_ERR_NVS_INVALID_HANDLE; }
+    if (hd->mode == NVS_READONLY) { pthread_mutex_unlock(&s_lock); return ESP_ERR_NVS_READ_ONLY; }
+
+    entry_t *e = find(hd->ns, key);
+    if (!e) {
+        for (int i = 0; i < HOST_NVS_MAX_ENTRIES && !e; i++) {
+            if (!s_entries[i].used) e = &s_entries[i];
+        }
+        if (!e) { pthread_mutex_unlock(&s_lock); return ESP_ERR_NVS_NOT_ENOUGH_SPACE; }
+        memset(e, 0, sizeof(*e));
+        e->used = true;
+        strcpy(e->ns, hd->ns);
+        strcpy(e->key, key);
+    }
+    uint8_t *buf = malloc(len ? len : 1);
+    if (!buf) { pthread_mutex_unlock(&s_lock); return ESP_ERR_NO_MEM; }
+    memcpy(buf, v, len);
+    free(e->data);
+    e->data = buf;
+    e->len  = len;
+    e->type = type;
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+static esp_err_t get_scalar(nvs_handle_t h, const char *key, nvs_type_t type,
+                            void *out, size_t len)
+{
+    if (!key || !out) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_lock);
+    handle_t *hd = get_handle(h);
+    esp_err_t err = ESP_OK;
+    if (!hd) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else {
+        entry_t *e = find(hd->ns, key);
+        if (!e)                    err = ESP_ERR_NVS_NOT_FOUND;
+        else if (e->type != type)  err = ESP_ERR_NVS_TYPE_MISMATCH;
+        else                       memcpy(out, e->data, len);
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+static esp_err_t get_var(nvs_handle_t h, const char *key, nvs_type_t type,
+                         void *out, size_t *len)
+{
+    if (!key || !len) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_lock);
+    handle_t *hd = get_handle(h);
+    esp_err_t err = ESP_OK;
+    if (!hd) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else {
+        entry_t *e = find(hd->ns, key);
+        if (!e) {
+            err = ESP_ERR_NVS_NOT_FOUND;
+        } else if (e->type != type) {
+            err = ESP_ERR_NVS_TYPE_MISMATCH;
+        } else if (out == NULL) {
+            *len = e->len;              /* size query, as on target */
+        } else if (*len < e->len) {
+            err = ESP_ERR_NVS_INVALID_LENGTH;
+        } else {
+            memcpy(out, e->data, e->len);
+            *len = e->len;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+/* ================================================================
+ * Partition / handles
+ * ================================================================ */
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        free(s_entries[i].data);
+    }
+    memset(s_entries, 0, sizeof(s_entries));
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out)
+{
+    if (!ns || !out) return ESP_ERR_INVALID_ARG;
+    if (strlen(ns) >= HOST_NVS_NAME_MAX) return ESP_ERR_NVS_INVALID_NAME;
+
+    pthread_mutex_lock(&s_lock);
+    if (mode == NVS_READONLY) {
+        /* Target returns NOT_FOUND for a read-only open of a namespace that was
+         * never written; callers rely on that to fall back to defaults. */
+        bool exists = false;
+        for (int i = 0; i < HOST_NVS_MAX_ENTRIES && !exists; i++) {
+            exists = s_entries[i].used && strcmp(s_entries[i].ns, ns) == 0;
+        }
+        if (!exists) { pthread_mutex_unlock(&s_lock); return ESP_ERR_NVS_NOT_FOUND; }
+    }
+    for (int i = 0; i < HOST_NVS_MAX_HANDLES; i++) {
+        if (!s_handles[i].used) {
+            s_handles[i].used = true;
+            s_handles[i].mode = mode;
+            strcpy(s_handles[i].ns, ns);
+            *out = (nvs_handle_t)(i + 1);
+            pthread_mutex_unlock(&s_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+void nvs_close(nvs_handle_t h)
+{
+    pthread_mutex_lock(&s_lock);
+    handle_t *hd = get_handle(h);
+    if (hd) hd->used = false;
+    pthread_mutex_unlock(&s_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t h)
+{
+    pthread_mutex_lock(&s_lock);
+    esp_err_t err = get_handle(h) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+    if (err == ESP_OK) s_commits++;
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t h, const char *key)
+{
+    pthread_mutex_lock(&s_lock);
+    handle_t *hd = get_handle(h);
+    esp_err_t err = ESP_ERR_NVS_INVALID_HANDLE;
+    if (hd) {
+        entry_t *e = find(hd->ns, key);
+        if (e) {
+            free(e->data);
+            memset(e, 0, sizeof(*e));
+            err = ESP_OK;
+        } else {
+            err = ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t h)
+{
+    pthread_mutex_lock(&s_lock);
+    handle_t *hd = get_handle(h);
+    if (!hd) { pthread_mutex_unlock(&s_lock); return ESP_ERR_NVS_INVALID_HANDLE; }
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        entry_t *e = &s_entries[i];
+        if (e->used && strcmp(e->ns, hd->ns) == 0) {
+            free(e->data);
+            memset(e, 0, sizeof(*e));
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+uint32_t host_nvs_commit_count(void)
+{
+    pthread_mutex_lock(&s_lock);
+    uint32_t n = s_commits;
+    pthread_mutex_unlock(&s_lock);
+    return n;
+}
+
+/* ================================================================
+ * Typed accessors
+ * ================================================================ */
+
+#define NVS_SCALAR(suffix, ctype, tag)                                              \
+    esp_err_t nvs_set_##suffix(nvs_handle_t h, const char *key, ctype v)            \
+    { return put(h, key, tag, &v, sizeof(v)); }                                    \
+    esp_err_t nvs_get_##suffix(nvs_handle_t h, const char *key, ctype *v)           \
+    { return get_scalar(h, key, tag, v, sizeof(*v)); }
+
+NVS_SCALAR(u8,  uint8_t,  T_U8)
+NVS_SCALAR(i8,  int8_t,   T_I8)
+NVS_SCALAR(u16, uint16_t, T_U16)
+NVS_SCALAR(i16, int16_t,  T_I16)
+NVS_SCALAR(u32, uint32_t, T_U32)
+NVS_SCALAR(i32, int32_t,  T_I32)
+NVS_SCALAR(u64, uint64_t, T_U64)
+
+esp_err_t nvs_set_str(nvs_handle_t h, const char *key, const char *v)
+{
+    if (!v) return ESP_ERR_INVALID_ARG;
+    return put(h, key, T_STR, v, strlen(v) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t h, const char *key, char *out, size_t *len)
+{
+    return get_var(h, key, T_STR, out, len);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t h, const char *key, const void *v, size_t len)
+{
+    if (!v && len) return ESP_ERR_INVALID_ARG;
+    return put(h, key, T_BLOB, v, len);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t h, const char *key, void *out, size_t *len)
+{
+    return get_var(h, key, T_BLOB, out, len);
+}
@@ -0,0 +1,401 @@
+/**
+ * @file host_rtos.c
+ * @brief pthread-backed FreeRTOS subset: tasks, notifications, semaphores, queues.
+ */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ================================================================
+ * Helpers
+ * ================================================================ */
+
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * 1000000ULL;
+    ts.tv_sec  += (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec  = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+/* Wait on @p cv until @p pred holds or @p ticks expire. Returns the predicate. */
+#define WAIT_UNTIL(cv, mtx, ticks, pred)                                       \
+    ({                                                                         \
+        bool ok_ = true;                                                       \
+        if (!(pred)) {                                                         \
+            if ((ticks) == 0) {                                                \
+                ok_ = false;                                                   \
+            } else if ((ticks) == portMAX_DELAY) {                             \
+                while (!(pred)) pthread_cond_wait((cv), (mtx));                \
+            } else {                                                           \
+                struct timespec dl_ = deadline_after(ticks);                   \
+                while (!(pred)) {                                              \
+                    if (pthread_cond_timedwait((cv), (mtx), &dl_) == ETIMEDOUT) { \
+                        ok_ = (pred);                                          \
+                        break;                                                 \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+        ok_;                                                                   \
+    })
+
+static pthread_condattr_t s_cond_attr;
+static pthread_once_t     s_cond_once = PTHREAD_ONCE_INIT;
+
+static void cond_attr_init(void)
+{
+    pthread_condattr_init(&s_cond_attr);
+    pthread_condattr_setclock(&s_cond_attr, CLOCK_MONOTONIC);
+}
+
+static pthread_condattr_t *mono_attr(void)
+{
+    pthread_once(&s_cond_once, cond_attr_init);
+    return &s_cond_attr;
+}
+
+/* ================================================================
+ * Critical sections
+ * ================================================================ */
+
+void host_mux_enter(portMUX_TYPE *mux)
+{
+    while (__atomic_exchange_n(&mux->locked, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&mux->locked, __ATOMIC_RELAXED)) {
+            sched_yield();
+        }
+    }
+}
+
+void host_mux_exit(portMUX_TYPE *mux)
+{
+    __atomic_store_n(&mux->locked, 0, __ATOMIC_RELEASE);
+}
+
+/* ================================================================
+ * Tasks
+ * ================================================================ */
+
+struct host_task {
+    TaskFunction_t  fn;
+    void           *arg;
+    char            name[16];
+    pthread_t       thread;
+    pthread_mutex_t mtx;
+    pthread_cond_t  cv;
+    uint32_t        notify;
+};
+
+static __thread struct host_task *t_self = NULL;
+static struct host_task           s_main_task = { .name = "main" };
+static pthread_once_t             s_main_once = PTHREAD_ONCE_INIT;
+
+static void task_init_sync(struct host_task *t)
+{
+    pthread_mutex_init(&t->mtx, NULL);
+    pthread_cond_init(&t->cv, mono_attr());
+}
+
+static void main_task_init(void)
+{
+    task_init_sync(&s_main_task);
+}
+
+static void *task_trampoline(void *p)
+{
+    struct host_task *t = (struct host_task *)p;
+    t_self = t;
+    t->fn(t->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack,
+                                   void *arg, UBaseType_t prio, TaskHandle_t *out,
+                                   BaseType_t core)
+{
+    (void)stack; (void)prio; (void)core;
+    struct host_task *t = calloc(1, sizeof(*t));
+    if (!t) return pdFAIL;
+    t->fn  = fn;
+    t->arg = arg;
+    strncpy(t->name, name ? name : "task", sizeof(t->name) - 1);
+    task_init_sync(t);
+    if (out) *out = t;
+    if (pthread_create(&t->thread, NULL, task_trampoline, t) != 0) {
+        if (out) *out = NULL;
+        free(t);
+        return pdFAIL;
+    }
+    pthread_detach(t->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                       void *arg, UBaseType_t prio, TaskHandle_t *out)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    /* Only self-deletion is used by the firmware. The handle memory is leaked on
+     * purpose: callers poll their own copy of the handle after the task exits. */
+    if (task == NULL || task == t_self) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = { .tv_sec = ticks / 1000, .tv_nsec = (long)(ticks % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (!t_self) {
+        pthread_once(&s_main_once, main_task_init);
+        t_self = &s_main_task;
+    }
+    return t_self;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task *t = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&t->mtx);
+    WAIT_UNTIL(&t->cv, &t->mtx, ticks, t->notify > 0);
+    uint32_t v = t->notify;
+    if (v > 0) {
+        t->notify = clear_on_exit ? 0 : v - 1;
+    }
+    pthread_mutex_unlock(&t->mtx);
+    return v;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    if (!task) return pdFAIL;
+    pthread_mutex_lock(&task->mtx);
+    task->notify++;
+    pthread_cond_signal(&task->cv);
+    pthread_mutex_unlock(&task->mtx);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_prio_woken)
+{
+    xTaskNotifyGive(task);
+    if (higher_prio_woken) *higher_prio_woken = pdFALSE;
+}
+
+/* ================================================================
+ * Semaphores (mutex == binary semaphore given once at creation)
+ * ================================================================ */
+
+struct host_sem {
+    pthread_mutex_t mtx;
+    pthread_cond_t  cv;
+    UBaseType_t     count;
+    UBaseType_t     max;
+    bool            is_static;
+};
+
+_Static_assert(sizeof(struct host_sem) <= sizeof(StaticSemaphore_t),
+               "StaticSemaphore_t too small for the host semaphore");
+
+static SemaphoreHandle_t sem_init(struct host_sem *s, UBaseType_t max, UBaseType_t initial)
+{
+    pthread_mutex_init(&s->mtx, NULL);
+    pthread_cond_init(&s->cv, mono_attr());
+    s->count = initial;
+    s->max   = max;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    struct host_sem *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    return sem_init(s, max, initial);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buf)
+{
+    if (!buf) return NULL;
+    struct host_sem *s = (struct host_sem *)buf;
+    memset(s, 0, sizeof(*s));
+    s->is_static = true;
+    return sem_init(s, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)  { return xSemaphoreCreateCounting(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return xSemaphoreCreateCounting(1, 0); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks)
+{
+    if (!s) return pdFAIL;
+    pthread_mutex_lock(&s->mtx);
+    bool ok = WAIT_UNTIL(&s->cv, &s->mtx, ticks, s->count > 0);
+    if (ok) s->count--;
+    pthread_mutex_unlock(&s->mtx);
+    return ok ? pdPASS : pdFAIL;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    if (!s) return pdFAIL;
+    pthread_mutex_lock(&s->mtx);
+    BaseType_t rc = pdFAIL;
+    if (s->count < s->max) {
+        s->count++;
+        rc = pdPASS;
+        pthread_cond_signal(&s->cv);
+    }
+    pthread_mutex_unlock(&s->mtx);
+    return rc;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t *woken)
+{
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(s);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    if (!s) return;
+    pthread_mutex_destroy(&s->mtx);
+    pthread_cond_destroy(&s->cv);
+    if (!s->is_static) free(s);
+}
+
+/* ================================================================
+ * Queues (ring of fixed-size items)
+ * ================================================================ */
+
+struct host_queue {
+    pthread_mutex_t mtx;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    UBaseType_t     length;
+    UBaseType_t     item_size;
+    UBaseType_t     head;
+    UBaseType_t     count;
+    uint8_t        *buf;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    if (length == 0 || item_size == 0) return NULL;
+    struct host_queue *q = calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->buf = calloc(length, item_size);
+    if (!q->buf) { free(q); return NULL; }
+    pthread_mutex_init(&q->mtx, NULL);
+    pthread_cond_init(&q->not_empty, mono_attr());
+    pthread_cond_init(&q->not_full, mono_attr());
+    q->length    = length;
+    q->item_size = item_size;
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (!q) return;
+    pthread_mutex_destroy(&q->mtx);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->buf);
+    free(q);
+}
+
+static void q_push(struct host_queue *q, const void *item)
+{
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(q->buf + (size_t)tail * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    if (!q || !item) return pdFAIL;
+    pthread_mutex_lock(&q->mtx);
+    bool ok = WAIT_UNTIL(&q->not_full, &q->mtx, ticks, q->count < q->length);
+    if (ok) q_push(q, item);
+    pthread_mutex_unlock(&q->mtx);
+    return ok ? pdPASS : errQUEUE_FULL;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken)
+{
+    if (woken) *woken = pdFALSE;
+    return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void *item)
+{
+    if (!q || !item) return pdFAIL;
+    pthread_mutex_lock(&q->mtx);
+    if (q->count >= q->length) {
+        /* Mailbox semantics (length-1 queues): replace the pending item. */
+        q->count = 0;
+    }
+    q_push(q, item);
+    pthread_mutex_unlock(&q->mtx);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    if (!q || !item) return pdFAIL;
+    pthread_mutex_lock(&q->mtx);
+    bool ok = WAIT_UNTIL(&q->not_empty, &q->mtx, ticks, q->count > 0);
+    if (ok) {
+        memcpy(item, q->buf + (size_t)q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->mtx);
+    return ok ? pdPASS : pdFAIL;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    if (!q) return 0;
+    pthread_mutex_lock(&q->mtx);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->mtx);
+    return n;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q)
+{
+    if (!q) return pdFAIL;
+    pthread_mutex_lock(&q->mtx);
+    q->head  = 0;
+    q->count = 0;
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->mtx);
+    return pdPASS;
+}
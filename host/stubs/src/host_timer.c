@@ -0,0 +1,166 @@
+/**
+ * @file host_timer.c
+ * @brief Host esp_timer: a small armed-timer table, dispatched on sim or real time.
+ */
+#include "esp_timer.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HOST_TIMER_MAX 32
+
+struct esp_timer {
+    esp_timer_cb_t cb;
+    void          *arg;
+    bool           used;
+    bool           armed;
+    int64_t        due_us;
+    int64_t        period_us;   ///< 0 = one-shot
+};
+
+static struct esp_timer s_timers[HOST_TIMER_MAX];
+static pthread_mutex_t  s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   s_cv   = PTHREAD_COND_INITIALIZER;
+/* Serialises callbacks, like the single esp_timer task. */
+static pthread_mutex_t  s_dispatch = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t   s_thread_once = PTHREAD_ONCE_INIT;
+
+static void *dispatcher(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&s_lock);
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 1000000L;          /* re-evaluate at least every 1 ms */
+        if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+        pthread_cond_timedwait(&s_cv, &s_lock, &ts);
+        pthread_mutex_unlock(&s_lock);
+        if (!host_clock_is_sim()) {
+            host_timer_fire_due(host_clock_now_us());
+        }
+    }
+    return NULL;
+}
+
+static void start_dispatcher(void)
+{
+    pthread_t th;
+    if (pthread_create(&th, NULL, dispatcher, NULL) == 0) {
+        pthread_detach(th);
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    if (!args || !args->callback || !out) return ESP_ERR_INVALID_ARG;
+    pthread_once(&s_thread_once, start_dispatcher);
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < HOST_TIMER_MAX; i++) {
+        if (!s_timers[i].used) {
+            s_timers[i] = (struct esp_timer){ .cb = args->callback, .arg = args->arg, .used = true };
+            *out = &s_timers[i];
+            pthread_mutex_unlock(&s_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t arm(esp_timer_handle_t t, uint64_t us, bool periodic)
+{
+    if (!t || !t->used) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_lock);
+    if (t->armed) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_INVALID_STATE;   /* IDF: must stop before re-starting */
+    }
+    t->armed     = true;
+    t->due_us    = host_clock_now_us() + (int64_t)us;
+    t->period_us = periodic ? (int64_t)us : 0;
+    pthread_cond_signal(&s_cv);
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    return arm(t, timeout_us, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period_us)
+{
+    if (period_us == 0) return ESP_ERR_INVALID_ARG;
+    return arm(t, period_us, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    if (!t || !t->used) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_lock);
+    esp_err_t err = t->armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+    t->armed = false;
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t)
+{
+    if (!t || !t->used) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&s_lock);
+    esp_err_t err = t->armed ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (err == ESP_OK) t->used = false;
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t t)
+{
+    if (!t) return false;
+    pthread_mutex_lock(&s_lock);
+    bool a = t->used && t->armed;
+    pthread_mutex_unlock(&s_lock);
+    return a;
+}
+
+int64_t host_timer_next_due(void)
+{
+    int64_t next = INT64_MAX;
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < HOST_TIMER_MAX; i++) {
+        if (s_timers[i].used && s_timers[i].armed && s_timers[i].due_us < next) {
+            next = s_timers[i].due_us;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return next;
+}
+
+void host_timer_fire_due(int64_t now_us)
+{
+    pthread_mutex_lock(&s_dispatch);
+    for (;;) {
+        /* Earliest due timer first, one at a time, lock released around the call. */
+        struct esp_timer *t = NULL;
+        pthread_mutex_lock(&s_lock);
+        for (int i = 0; i < HOST_TIMER_MAX; i++) {
+            struct esp_timer *c = &s_timers[i];
+            if (c->used && c->armed && c->due_us <= now_us && (!t || c->due_us < t->due_us)) t = c;
+        }
+        esp_timer_cb_t cb = NULL;
+        void *arg = NULL;
+        if (t) {
+            cb  = t->cb;
+            arg = t->arg;
+            if (t->period_us > 0) t->due_us += t->period_us;
+            else                  t->armed = false;
+        }
+        pthread_mutex_unlock(&s_lock);
+        if (!cb) break;
+        cb(arg);
+    }
+    pthread_mutex_unlock(&s_dispatch);
+}
@@ -33,6 +33,8 @@ extern "C" {
 
 extern "C" {
 #include "i2c_bus.h"
+#include "i2c_bus_async.h"
+#include "i2c_bus_health.h"
 #include "device_registry.h"
 #include "dimmerlink_manager.h"
 #include "sensor_hub.h"
@@ -136,6 +138,13 @@ static esp_err_t init_phase1_buses(void) {
             uint8_t found[16];
             uint8_t count = 0;
             i2c_bus_scan(0, found, 16, &count);
+            // Transaction queue: output writes stop blocking the control task
+            if (i2c_bus_async_start(0) != ESP_OK) {
+                ESP_LOGW(TAG, "I2C bus 0 queue worker not started — blocking transfers");
+            }
+            if (hwCfg.i2c_max_freq_hz > hwCfg.i2c_freq_hz) {
+                i2c_bus_set_adaptive_clock(0, true, hwCfg.i2c_max_freq_hz);
+            }
         }
     } else {
         ESP_LOGI(TAG, "I2C bus disabled");
@@ -153,6 +162,12 @@ static esp_err_t init_phase1_buses(void) {
             uint8_t found[16];
             uint8_t count = 0;
             i2c_bus_scan(1, found, 16, &count);
+            if (i2c_bus_async_start(1) != ESP_OK) {
+                ESP_LOGW(TAG, "I2C bus 1 queue worker not started — blocking transfers");
+            }
+            if (hwCfg.i2c_max_freq_hz > hwCfg.i2c1_freq_hz) {
+                i2c_bus_set_adaptive_clock(1, true, hwCfg.i2c_max_freq_hz);
+            }
         }
     }
 
@@ -250,7 +265,7 @@ static esp_err_t init_phase3_sensors(void) {
         // fall back to the Kconfig seed on a device that was never commissioned.
         // Without a role a module stays diagnostic-only and posts nothing.
         if (rbamp_source_load_config() != ESP_OK) {
-            rbamp_source_module_cfg_t rbampRoles[4];
+            rbamp_source_module_cfg_t rbampRoles[4] = {};   // Kconfig seeds channel 0
             size_t rbampRoleN = 0;
             if (CONFIG_ACROUTER_RBAMP_GRID_ADDR != 0) {
                 rbampRoles[rbampRoleN].i2c_addr = (uint8_t)CONFIG_ACROUTER_RBAMP_GRID_ADDR;
@@ -277,17 +292,23 @@ static esp_err_t init_phase3_sensors(void) {
                 ESP_LOGI(TAG, "rbAmp roles seeded from Kconfig (%u)", (unsigned)rbampRoleN);
             }
         }
-        // Optional DRDY interrupt-driven polling (single critical module).
-        // -1 (default) = fixed-cadence timer poll, correct for a fleet.
+        // Optional DRDY interrupt-driven polling: a fleet-wide line (single
+        // critical module) and/or one line per module. None (default) = the
+        // fixed-cadence timer poll.
         rbamp_source_set_drdy_gpio(hwCfg.rbamp_drdy_gpio);
+        for (uint8_t i = 0; i < HW_RBAMP_DRDY_LINES; i++) {
+            if (hwCfg.rbamp_drdy_addr[i]) {
+                rbamp_source_set_module_drdy(hwCfg.rbamp_drdy_addr[i], hwCfg.rbamp_drdy_line[i]);
+            }
+        }
         if (rbamp_source_init(rbampBus) == ESP_OK) {
             // Start regardless of boot-time module count: the poll task tolerates
             // an empty fleet, so a module wired/powered slightly late still works
             // once autoscan (re-run on a future rescan) or commissioning adds it.
             rbamp_source_start(CONFIG_ACROUTER_RBAMP_POLL_MS);
-            rbamp_source_module_cfg_t rbampCur[4];
+            rbamp_source_module_cfg_t rbampCur[RBAMP_SOURCE_MAX_ROLES];
             size_t rbampCurN = 0;
-            rbamp_source_get_roles(rbampCur, 4, &rbampCurN);
+            rbamp_source_get_roles(rbampCur, RBAMP_SOURCE_MAX_ROLES, &rbampCurN);
             ESP_LOGI(TAG, "rbAmp source: %u module(s) found, %u role(s) mapped, polling started",
                      (unsigned)rbamp_source_alive_count(), (unsigned)rbampCurN);
         }
@@ -318,7 +339,7 @@ static esp_err_t init_phase3_sensors(void) {
     // roles down to the drivers so the registry is the role source of truth.
     if (devreg_init() == ESP_OK) {
         ESP_LOGI(TAG, "Device registry initialized (%u entries)", (unsigned)devreg_count());
-        // First boot (empty registry): run one quiescent I2C scan so /api/modules is
+        // First boot (empty registry): run one I2C scan so /api/modules is
         // populated out of the box instead of empty until a manual rescan. A persisted
         // registry is kept as-is (non-destructive) — the user rescans on demand.
         if (devreg_count() == 0) {
@@ -345,6 +366,17 @@ static esp_err_t init_phase4_control(void) {
     }
     ESP_LOGI(TAG, "RouterController initialized");
 
+    // Controller engine + gains per regulating mode (NVS)
+    const SystemConfig& cfg = ConfigManager::getInstance().getConfig();
+    for (uint8_t i = 0; i < ConfigDefaults::PID_LOOPS; i++) {
+        router.setPidGains(static_cast<PidLoop>(i),
+                           PidGains(static_cast<ControlEngine>(cfg.pid_engine[i]),
+                                    cfg.pid_kp[i], cfg.pid_ki[i], cfg.pid_kd[i]));
+    }
+    router.setFeedForward(cfg.auto_ff != 0);
+    router.setPlantTuning(static_cast<PlantTuning>(cfg.plant_tune));
+    router.setDeadTimeCompensation(cfg.auto_dtc != 0);
+
     // Subscribe to event bus (Sensor Hub merged updates from rbAmp/ESP-NOW)
     router.subscribeEvents();
     ESP_LOGI(TAG, "RouterController subscribed to event bus");
@@ -64,6 +64,7 @@ void system_main_loop(void) {
     while (1) {
         serialCmd.process();
         relay_update_all();
+        dimmer_update_all();
 
         wifiMgr.handle();
         ntpMgr.handle();